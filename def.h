@@ -3,8 +3,10 @@
 #include <stdio.h>
 #include <stdio.h>
 #include <stdlib.h>
+#if defined(_WIN32)
 #include <windows.h>
 #include <crtdbg.h>
+#endif
 
 #include <iostream>
 #include <filesystem>
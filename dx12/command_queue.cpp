@@ -1,4 +1,7 @@
 ﻿#include "dx12/command_queue.h"
+#include "dx12/frame_descriptors.h"
+
+#include "utility/flight_recorder.h"
 
 //#pragma comment(lib,"d3d12.lib")
 
@@ -30,4 +33,37 @@ ID3D12CommandQueue* CommandQueue::get() const noexcept {
     return commandQueue_.Get();
 }
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コマンドリストを投入して実行する
+ * @param	lists		コマンドリストの配列
+ * @param	num			コマンドリスト数
+ */
+void CommandQueue::execute(ID3D12CommandList* const* lists, uint32_t num) noexcept {
+    // コマンドリストが参照するテーブルへのディスクリプタのコピーを実行前に済ませる
+    if (auto* frameDescriptors = FrameDescriptors::pointer()) {
+        frameDescriptors->flush();
+    }
+
+    commandQueue_->ExecuteCommandLists(num, lists);
+    FLIGHT_RECORD(utility::FlightEvent::QueueSubmit, "CommandQueue", num);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	投入済みのコマンドが完了したらフェンス値を設定するようシグナルを積む
+ * @param	fence		フェンス
+ * @param	value		設定するフェンス値
+ * @return	シグナルを積めた場合は true
+ */
+bool CommandQueue::signal(const Fence& fence, uint64_t value) noexcept {
+    auto res = commandQueue_->Signal(fence.get(), value);
+    if (FAILED(res)) {
+        ASSERT(false, "フェンスのシグナルに失敗");
+        return false;
+    }
+    FLIGHT_RECORD(utility::FlightEvent::FenceSignal, "CommandQueue", value);
+    return true;
+}
+
 }  // namespace dx12
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "dx12/device.h"
+#include "dx12/fence.h"
 
 #include "utility/noncopyable.h"
 
@@ -37,6 +38,23 @@ public:
      */
     [[nodiscard]] ID3D12CommandQueue* get() const noexcept;
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コマンドリストを投入して実行する
+     * @param	lists		コマンドリストの配列
+     * @param	num			コマンドリスト数
+     */
+    void execute(ID3D12CommandList* const* lists, uint32_t num) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	投入済みのコマンドが完了したらフェンス値を設定するようシグナルを積む
+     * @param	fence		フェンス
+     * @param	value		設定するフェンス値
+     * @return	シグナルを積めた場合は true
+     */
+    bool signal(const Fence& fence, uint64_t value) noexcept;
+
 private:
     Microsoft::WRL::ComPtr<ID3D12CommandQueue> commandQueue_;  ///< コマンドキュー
 };
@@ -1,19 +1,50 @@
 ﻿#include "dx12/descriptor_heap.h"
 #include <format>
 
+#include "utility/flight_recorder.h"
+#include "utility/spin_lock.h"
+
+namespace {
+// 静的なヒープの破棄順に依存しないよう、破棄処理の無いものだけで生成済みのヒープを管理する
+utility::SharedSpinLock heapListLock{};  ///< 生成済みのヒープのリストの同期オブジェクト
+dx12::DescriptorHeap*   heapListHead{};  ///< 生成済みのヒープのリストの先頭
+}  // namespace
+
 namespace dx12 {
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ
+ */
+DescriptorHeap::~DescriptorHeap() {
+    if (!linked_) {
+        return;
+    }
+
+    // reclaimAll が巡回中のヒープは破棄されないよう、排他ロックの中でリストから外す
+    std::lock_guard<utility::SharedSpinLock> lock(heapListLock);
+    if (prevHeap_) {
+        prevHeap_->nextHeap_ = nextHeap_;
+    } else {
+        heapListHead = nextHeap_;
+    }
+    if (nextHeap_) {
+        nextHeap_->prevHeap_ = prevHeap_;
+    }
+}
+
 //---------------------------------------------------------------------------------
 /**
  * @brief	ディスクリプタヒープを生成する
  * @param	type			ヒープが管理する対象の種類
  * @param	capacity		最大管理数
+ * @param	shaderVisible	シェーダーから参照できるヒープにするか否か（ CBV_SRV_UAV のみ、 false はステージング用）
  * @return	作成に成功した場合は true
  */
 
-bool DescriptorHeap::create(Type type, uint32_t capacity) noexcept {
-    auto flag = type == Type::CBV_SRV_UAV ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE
-                                          : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+bool DescriptorHeap::create(Type type, uint32_t capacity, bool shaderVisible) noexcept {
+    auto flag = (type == Type::CBV_SRV_UAV && shaderVisible) ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE
+                                                             : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
     // ディスクリプタヒープ作成
     desc_                = {};
     desc_.Type           = static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(type);
@@ -31,6 +62,21 @@ bool DescriptorHeap::create(Type type, uint32_t capacity) noexcept {
     heap_->SetName(std::format(L"DescriptorHeap type:{} capacity:{} ", static_cast<uint32_t>(type), capacity).data());
 
     capacity_ = capacity;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        allocator_.reset(capacity);
+    }
+
+    if (!linked_) {
+        std::lock_guard<utility::SharedSpinLock> lock(heapListLock);
+        nextHeap_ = heapListHead;
+        if (nextHeap_) {
+            nextHeap_->prevHeap_ = this;
+        }
+        heapListHead = this;
+        linked_      = true;
+    }
     return true;
 }
 
@@ -38,13 +84,138 @@ bool DescriptorHeap::create(Type type, uint32_t capacity) noexcept {
 /**
  * @brief	ヒープから指定数を確保する
  * @param	num			確保数
- * @return	CPU と GPU のディスクリプタハンドル
+ * @return	CPU と GPU のディスクリプタハンドル（容量が足りない場合は valid() が false ）
  */
 DescriptorHeap::Handle DescriptorHeap::allocate(uint32_t num) noexcept {
-    const auto temp = currentIndex_;
-    currentIndex_ += num;
+    utility::RangeAllocator::Allocation allocation;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        allocation = allocator_.allocate(num);
+    }
+
+    if (!allocation.valid()) {
+        ASSERT(false, "ディスクリプタヒープの容量が足りません");
+        return {};
+    }
+
+    FLIGHT_RECORD(utility::FlightEvent::DescriptorAlloc, "DescriptorHeap", allocation.offset_, num);
+
+    auto handle        = handleFromIndex(allocation.offset_);
+    handle.allocation_ = allocation;
+    return handle;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	確保した範囲を即座に解放する（ GPU が参照していないこと）
+ * @param	handle		allocate で取得したハンドル
+ */
+void DescriptorHeap::free(const Handle& handle) noexcept {
+    if (!handle.allocation_.valid()) {
+        return;
+    }
+
+    FLIGHT_RECORD(utility::FlightEvent::DescriptorFree, "DescriptorHeap", handle.allocation_.offset_, handle.allocation_.num_);
+    notifyFree(handle);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    allocator_.free(handle.allocation_);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	確保した範囲をフェンスの完了後に解放する
+ * @param	handle		allocate で取得したハンドル
+ * @param	fenceValue	範囲を参照するコマンドの完了時にシグナルされるフェンス値
+ */
+void DescriptorHeap::free(const Handle& handle, uint64_t fenceValue) {
+    if (!handle.allocation_.valid()) {
+        return;
+    }
 
-    return handleFromIndex(temp);
+    FLIGHT_RECORD(utility::FlightEvent::DescriptorFree, "DescriptorHeap", handle.allocation_.offset_, handle.allocation_.num_);
+    notifyFree(handle);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    allocator_.free(handle.allocation_, fenceValue);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フェンスが完了した遅延解放の範囲を回収する
+ * @param	fence		完了値を取得するフェンス
+ * @return	回収した範囲の数
+ */
+uint32_t DescriptorHeap::reclaim(const utility::FenceSource& fence) noexcept {
+    const auto completed = fence.completedValue();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocator_.reclaim(completed);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	生成済みのすべてのヒープで、フェンスが完了した遅延解放の範囲を回収する
+ * @param	fence		完了値を取得するフェンス
+ * @return	回収した範囲の数
+ */
+uint32_t DescriptorHeap::reclaimAll(const utility::FenceSource& fence) noexcept {
+    const auto completed = fence.completedValue();
+
+    uint32_t count = 0;
+    heapListLock.lockShared();
+    for (auto* heap = heapListHead; heap; heap = heap->nextHeap_) {
+        std::lock_guard<std::mutex> lock(heap->mutex_);
+        count += heap->allocator_.reclaim(completed);
+    }
+    heapListLock.unlockShared();
+    return count;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	範囲を解放する際に呼び出す処理を追加する
+ * @param	hook		呼び出す処理
+ * @return	削除に使う登録番号
+ */
+DescriptorHeap::FreeHookId DescriptorHeap::addFreeHook(FreeHook hook) {
+    std::unique_lock lock(hookMutex_);
+    const auto       id = ++lastHookId_;
+    freeHooks_.emplace_back(id, std::move(hook));
+    return id;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	範囲を解放する際に呼び出す処理を削除する（他のスレッドで実行中の処理の完了を待つ）
+ * @param	id			addFreeHook で取得した登録番号
+ */
+void DescriptorHeap::removeFreeHook(FreeHookId id) noexcept {
+    std::unique_lock lock(hookMutex_);
+    std::erase_if(freeHooks_, [id](const auto& hook) { return hook.first == id; });
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	範囲を解放する際に呼び出す処理を実行する
+ *
+ * 割り当ての mutex_ とは別の共有ロックの中で呼び出すので、処理の削除は実行中の呼び出しの完了を待つ
+ * @param	handle		解放するハンドル
+ */
+void DescriptorHeap::notifyFree(const Handle& handle) noexcept {
+    std::shared_lock lock(hookMutex_);
+    for (const auto& [id, hook] : freeHooks_) {
+        hook(handle);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	空いているディスクリプタ数を取得する（遅延解放待ちは含まない）
+ */
+uint32_t DescriptorHeap::freeNum() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocator_.freeNum();
 }
 
 //---------------------------------------------------------------------------------
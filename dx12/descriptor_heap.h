@@ -3,7 +3,9 @@
 #include "dx12/device.h"
 #include "dx12/command_list.h"
 
+#include "utility/fence_source.h"
 #include "utility/noncopyable.h"
+#include "utility/range_allocator.h"
 
 namespace dx12 {
 
@@ -11,6 +13,10 @@ namespace dx12 {
 /**
  * @brief
  * ディスクリプタヒープ
+ *
+ * 確保は RangeAllocator で行い、解放した範囲は前後と結合して再利用する
+ * GPU が参照中のディスクリプタは、フェンス値を指定して解放し reclaim で回収する
+ * 生成済みのヒープは、 SwapChain::present から reclaimAll で毎フレーム回収される
  */
 class DescriptorHeap final : public utility::Noncopyable {
 public:
@@ -30,12 +36,24 @@ public:
      * @brief	登録情報
      */
     struct Handle {
-        uint32_t                    index_{};
-        D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle_{};
-        D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle_{};
-        uint32_t                    incrementSize_{};
+        uint32_t                            index_{};          ///< 先頭インデックス
+        D3D12_CPU_DESCRIPTOR_HANDLE         cpuHandle_{};      ///< 先頭の CPU ハンドル
+        D3D12_GPU_DESCRIPTOR_HANDLE         gpuHandle_{};      ///< 先頭の GPU ハンドル
+        uint32_t                            incrementSize_{};  ///< ディスクリプタ 1 つのサイズ
+        utility::RangeAllocator::Allocation allocation_{};     ///< 確保した範囲（解放に利用する）
+
+        //---------------------------------------------------------------------------------
+        /**
+         * @brief	有効なハンドルか否か
+         */
+        [[nodiscard]] bool valid() const noexcept {
+            return cpuHandle_.ptr != 0;
+        }
     };
 
+    using FreeHook   = std::function<void(const Handle& handle)>;
+    using FreeHookId = uint32_t;
+
 public:
     //---------------------------------------------------------------------------------
     /**
@@ -47,25 +65,90 @@ public:
     /**
      * @brief	デストラクタ
      */
-    ~DescriptorHeap() = default;
+    ~DescriptorHeap();
 
     //---------------------------------------------------------------------------------
     /**
      * @brief	ディスクリプタヒープを生成する
      * @param	type			ヒープが管理する対象の種類
      * @param	capacity		最大管理数
+     * @param	shaderVisible	シェーダーから参照できるヒープにするか否か（ CBV_SRV_UAV のみ、 false はステージング用）
      * @return	作成に成功した場合は true
      */
-    bool create(Type type, uint32_t capacity) noexcept;
+    bool create(Type type, uint32_t capacity, bool shaderVisible = true) noexcept;
 
     //---------------------------------------------------------------------------------
     /**
      * @brief	ヒープから指定数を確保する
      * @param	num			確保数
-     * @return	CPU と GPU のディスクリプタハンドル
+     * @return	CPU と GPU のディスクリプタハンドル（容量が足りない場合は valid() が false ）
      */
     [[nodiscard]] Handle allocate(uint32_t num) noexcept;
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	確保した範囲を即座に解放する（ GPU が参照していないこと）
+     * @param	handle		allocate で取得したハンドル
+     */
+    void free(const Handle& handle) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	確保した範囲をフェンスの完了後に解放する
+     * @param	handle		allocate で取得したハンドル
+     * @param	fenceValue	範囲を参照するコマンドの完了時にシグナルされるフェンス値
+     */
+    void free(const Handle& handle, uint64_t fenceValue);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フェンスが完了した遅延解放の範囲を回収する
+     * @param	fence		完了値を取得するフェンス
+     * @return	回収した範囲の数
+     */
+    uint32_t reclaim(const utility::FenceSource& fence) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	生成済みのすべてのヒープで、フェンスが完了した遅延解放の範囲を回収する
+     * @param	fence		完了値を取得するフェンス
+     * @return	回収した範囲の数
+     */
+    static uint32_t reclaimAll(const utility::FenceSource& fence) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	範囲を解放する際に呼び出す処理を追加する
+     *
+     * ステージングヒープのディスクリプタをキーにしたキャッシュを、スロットの再利用前に無効化するのに使う
+     * 処理は free を呼び出したスレッドで、遅延解放の場合も free の呼び出し時に行う
+     * 処理の中でこのヒープの解放や、処理の追加と削除を行わないこと
+     * @param	hook		呼び出す処理
+     * @return	削除に使う登録番号
+     */
+    [[nodiscard]] FreeHookId addFreeHook(FreeHook hook);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	範囲を解放する際に呼び出す処理を削除する（他のスレッドで実行中の処理の完了を待つ）
+     * @param	id			addFreeHook で取得した登録番号
+     */
+    void removeFreeHook(FreeHookId id) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	空いているディスクリプタ数を取得する（遅延解放待ちは含まない）
+     */
+    [[nodiscard]] uint32_t freeNum() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	シェーダーから参照できるヒープか否か（ false の場合は CPU 専用のステージングヒープ）
+     */
+    [[nodiscard]] bool shaderVisible() const noexcept {
+        return desc_.Flags == D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    }
+
     //---------------------------------------------------------------------------------
     /**
      * @brief	インデックスを指定してハンドルを取得する
@@ -82,9 +165,24 @@ public:
     void setToCommandList(dx12::CommandList& commandList) noexcept;
 
 private:
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> heap_{};          ///< ディスクリプタヒープ
-    uint32_t                                     currentIndex_{};  ///< 現在の登録番号
-    uint32_t                                     capacity_{};      ///< 最大管理数
-    D3D12_DESCRIPTOR_HEAP_DESC                   desc_{};          ///< ディスクリプタヒープフォーマット情報
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	範囲を解放する際に呼び出す処理を実行する
+     * @param	handle		解放するハンドル
+     */
+    void notifyFree(const Handle& handle) noexcept;
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> heap_{};        ///< ディスクリプタヒープ
+    utility::RangeAllocator                      allocator_{};   ///< 登録番号の割り当て
+    mutable std::mutex                           mutex_{};       ///< 割り当ての同期オブジェクト
+    std::vector<std::pair<FreeHookId, FreeHook>> freeHooks_{};   ///< 範囲を解放する際に呼び出す処理
+    FreeHookId                                   lastHookId_{};  ///< 最後に割り当てた登録番号
+    mutable std::shared_mutex                    hookMutex_{};   ///< 解放時の処理の同期オブジェクト（実行中は共有ロック）
+    uint32_t                                     capacity_{};    ///< 最大管理数
+    D3D12_DESCRIPTOR_HEAP_DESC                   desc_{};        ///< ディスクリプタヒープフォーマット情報
+    DescriptorHeap*                              prevHeap_{};    ///< 生成済みのヒープのリストの前
+    DescriptorHeap*                              nextHeap_{};    ///< 生成済みのヒープのリストの次
+    bool                                         linked_{};      ///< 生成済みのヒープのリストに登録済みか否か
 };
 }  // namespace dx12
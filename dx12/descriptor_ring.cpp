@@ -0,0 +1,167 @@
+﻿#include "dx12/descriptor_ring.h"
+
+namespace dx12 {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ（リングの範囲を最後に endFrame したフェンス値の完了後にヒープに返す）
+ */
+DescriptorRing::~DescriptorRing() {
+    if (heap_) {
+        heap_->free(region_, lastFence_);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	リングを作成する
+ * @param	heap		リングの範囲を確保するシェーダーから参照できるヒープ（リングより長く生存すること）
+ * @param	capacity	リングのディスクリプタ数
+ * @return	作成に成功した場合は true
+ */
+bool DescriptorRing::create(DescriptorHeap& heap, uint32_t capacity) noexcept {
+    auto region = heap.allocate(capacity);
+    if (!region.valid() || region.gpuHandle_.ptr == 0) {
+        ASSERT(false, "シェーダーから参照できるヒープにリングを確保できません");
+        heap.free(region);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (heap_) {
+        // 以前のリングは GPU が参照している可能性があるのでフェンスの完了を待って返す
+        heap_->free(region_, lastFence_);
+    }
+    heap_   = &heap;
+    region_ = region;
+    allocator_.reset(capacity);
+    return true;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	個別のディスクリプタを並べたテーブルを確保してコピーを予約する
+ * @param	sources		コピー元のディスクリプタ（ステージングヒープの CPU ハンドル）
+ * @param	num			ディスクリプタ数
+ * @return	確保したテーブル（リングが足りない場合は valid() が false ）
+ */
+DescriptorRing::Table DescriptorRing::copyTable(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, uint32_t num) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto table = allocate(num);
+    if (!table.valid()) {
+        return table;
+    }
+
+    // コピー先は 1 つの範囲、コピー元は 1 個ずつの範囲とする
+    destStarts_.emplace_back(table.cpuHandle_);
+    destSizes_.emplace_back(num);
+    for (uint32_t i = 0; i < num; ++i) {
+        srcStarts_.emplace_back(sources[i]);
+        srcSizes_.emplace_back(1);
+    }
+    return table;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	連続したディスクリプタをテーブルとして確保してコピーを予約する
+ * @param	source		コピー元の先頭（ステージングヒープのハンドル）
+ * @param	num			ディスクリプタ数
+ * @return	確保したテーブル（リングが足りない場合は valid() が false ）
+ */
+DescriptorRing::Table DescriptorRing::copyTable(const DescriptorHeap::Handle& source, uint32_t num) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto table = allocate(num);
+    if (!table.valid()) {
+        return table;
+    }
+
+    destStarts_.emplace_back(table.cpuHandle_);
+    destSizes_.emplace_back(num);
+    srcStarts_.emplace_back(source.cpuHandle_);
+    srcSizes_.emplace_back(num);
+    return table;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	予約したコピーをまとめて行う（テーブルを参照するコマンドリストの実行前に呼び出す）
+ */
+void DescriptorRing::flush() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (destStarts_.empty()) {
+        return;
+    }
+
+    dx12::Device::instance().device()->CopyDescriptors(
+        static_cast<uint32_t>(destStarts_.size()), destStarts_.data(), destSizes_.data(),
+        static_cast<uint32_t>(srcStarts_.size()), srcStarts_.data(), srcSizes_.data(),
+        D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    // 容量は次のフレームで再利用する
+    destStarts_.clear();
+    destSizes_.clear();
+    srcStarts_.clear();
+    srcSizes_.clear();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	予約したコピーを行い、フレームを終了する
+ * @param	fenceValue	フレームのコマンドの完了時にシグナルされるフェンス値
+ */
+void DescriptorRing::endFrame(uint64_t fenceValue) noexcept {
+    flush();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    allocator_.endFrame(fenceValue);
+    lastFence_ = fenceValue;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フェンスが完了したフレームの範囲を回収する
+ * @param	fence		完了値を取得するフェンス
+ * @return	回収したフレームの数
+ */
+uint32_t DescriptorRing::reclaim(const utility::FenceSource& fence) noexcept {
+    const auto completed = fence.completedValue();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocator_.reclaim(completed);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	使用中のディスクリプタ数を取得する
+ */
+uint32_t DescriptorRing::usedNum() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocator_.usedNum();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	リングからテーブルを確保する（ mutex_ をロックして呼び出す）
+ * @param	num			ディスクリプタ数
+ * @return	確保したテーブル（リングが足りない場合は valid() が false ）
+ */
+DescriptorRing::Table DescriptorRing::allocate(uint32_t num) noexcept {
+    const auto offset = allocator_.allocate(num);
+    if (offset == utility::FrameRingAllocator::invalidOffset) {
+        ASSERT(false, "ディスクリプタリングの容量が足りません");
+        return {};
+    }
+
+    const auto stride = static_cast<uint64_t>(offset) * region_.incrementSize_;
+
+    Table table;
+    table.cpuHandle_.ptr = region_.cpuHandle_.ptr + stride;
+    table.gpuHandle_.ptr = region_.gpuHandle_.ptr + stride;
+    table.num_           = num;
+    return table;
+}
+
+}  // namespace dx12
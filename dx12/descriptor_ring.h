@@ -0,0 +1,128 @@
+﻿#pragma once
+
+#include "dx12/descriptor_heap.h"
+
+#include "utility/fence_source.h"
+#include "utility/frame_ring_allocator.h"
+#include "utility/noncopyable.h"
+
+namespace dx12 {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フレームごとに使い捨てるディスクリプタテーブルのリング
+ *
+ * シェーダーから参照できるヒープの一部をリングとして確保し、
+ * CPU 専用のステージングヒープに作成したディスクリプタを描画ごとのテーブルとしてコピーする
+ * コピーは flush でまとめて CopyDescriptors 1 回で行い、
+ * 使い終わった範囲は endFrame で記録したフェンス値の完了後に reclaim で回収する
+ */
+class DescriptorRing final : public utility::Noncopyable {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	確保したテーブル
+     */
+    struct Table {
+        D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle_{};  ///< 先頭の CPU ハンドル
+        D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle_{};  ///< 先頭の GPU ハンドル（ SetGraphicsRootDescriptorTable に渡す）
+        uint32_t                    num_{};        ///< ディスクリプタ数
+
+        //---------------------------------------------------------------------------------
+        /**
+         * @brief	有効なテーブルか否か
+         */
+        [[nodiscard]] bool valid() const noexcept {
+            return gpuHandle_.ptr != 0;
+        }
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    DescriptorRing() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ（リングの範囲を最後に endFrame したフェンス値の完了後にヒープに返す）
+     */
+    ~DescriptorRing();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	リングを作成する
+     * @param	heap		リングの範囲を確保するシェーダーから参照できるヒープ（リングより長く生存すること）
+     * @param	capacity	リングのディスクリプタ数
+     * @return	作成に成功した場合は true
+     */
+    bool create(DescriptorHeap& heap, uint32_t capacity) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	個別のディスクリプタを並べたテーブルを確保してコピーを予約する
+     * @param	sources		コピー元のディスクリプタ（ステージングヒープの CPU ハンドル）
+     * @param	num			ディスクリプタ数
+     * @return	確保したテーブル（リングが足りない場合は valid() が false ）
+     */
+    [[nodiscard]] Table copyTable(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, uint32_t num) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	連続したディスクリプタをテーブルとして確保してコピーを予約する
+     * @param	source		コピー元の先頭（ステージングヒープのハンドル）
+     * @param	num			ディスクリプタ数
+     * @return	確保したテーブル（リングが足りない場合は valid() が false ）
+     */
+    [[nodiscard]] Table copyTable(const DescriptorHeap::Handle& source, uint32_t num) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	予約したコピーをまとめて行う（テーブルを参照するコマンドリストの実行前に呼び出す）
+     */
+    void flush() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	予約したコピーを行い、フレームを終了する
+     * @param	fenceValue	フレームのコマンドの完了時にシグナルされるフェンス値
+     */
+    void endFrame(uint64_t fenceValue) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フェンスが完了したフレームの範囲を回収する
+     * @param	fence		完了値を取得するフェンス
+     * @return	回収したフレームの数
+     */
+    uint32_t reclaim(const utility::FenceSource& fence) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	使用中のディスクリプタ数を取得する
+     */
+    [[nodiscard]] uint32_t usedNum() const noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	リングからテーブルを確保する（ mutex_ をロックして呼び出す）
+     * @param	num			ディスクリプタ数
+     * @return	確保したテーブル（リングが足りない場合は valid() が false ）
+     */
+    Table allocate(uint32_t num) noexcept;
+
+private:
+    DescriptorHeap*                          heap_{};        ///< リングの範囲を確保したヒープ
+    DescriptorHeap::Handle                   region_{};      ///< リングの範囲
+    utility::FrameRingAllocator              allocator_{};   ///< リング内の割り当て
+    uint64_t                                 lastFence_{};   ///< 最後に endFrame で記録したフェンス値
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> destStarts_{};  ///< 予約したコピー先の先頭
+    std::vector<uint32_t>                    destSizes_{};   ///< 予約したコピー先の個数
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> srcStarts_{};   ///< 予約したコピー元の先頭
+    std::vector<uint32_t>                    srcSizes_{};    ///< 予約したコピー元の個数
+    mutable std::mutex                       mutex_{};       ///< 割り当てとコピー予約の同期オブジェクト
+};
+}  // namespace dx12
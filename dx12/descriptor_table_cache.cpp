@@ -0,0 +1,367 @@
+﻿#include "dx12/descriptor_table_cache.h"
+
+#include <cstring>
+
+namespace dx12 {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ（キャッシュの範囲をヒープに返し、ステージングヒープの解放時の処理を解除する）
+ */
+DescriptorTableCache::~DescriptorTableCache() {
+    if (stagingHeap_) {
+        stagingHeap_->removeFreeHook(freeHookId_);
+    }
+    if (heap_) {
+        // 現在のフレームで参照したテーブルがあるので、フレームの完了後に返す
+        heap_->free(region_, fenceValue_);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	キャッシュを作成する
+ * @param	heap		キャッシュの範囲を確保するシェーダーから参照できるヒープ（キャッシュより長く生存すること）
+ * @param	capacity	キャッシュするディスクリプタ数の上限
+ * @param	stagingHeap	コピー元のステージングヒープ（指定すると解放時に invalidate する、キャッシュより長く生存すること）
+ * @return	作成に成功した場合は true
+ */
+bool DescriptorTableCache::create(DescriptorHeap& heap, uint32_t capacity, DescriptorHeap* stagingHeap) noexcept {
+    ASSERT(!heap_, "キャッシュはすでに作成されています");
+
+    auto region = heap.allocate(capacity);
+    if (!region.valid() || region.gpuHandle_.ptr == 0) {
+        ASSERT(false, "シェーダーから参照できるヒープにキャッシュを確保できません");
+        heap.free(region);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    heap_   = &heap;
+    region_ = region;
+    allocator_.reset(capacity);
+
+    if (stagingHeap) {
+        stagingHeap_ = stagingHeap;
+        freeHookId_  = stagingHeap_->addFreeHook([this](const DescriptorHeap::Handle& handle) { invalidate(handle); });
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームを開始する
+ * @param	fenceValue	このフレームのコマンドの完了時にシグナルされるフェンス値
+ * @param	fence		完了値を取得するフェンス（破棄できるテーブルの判定に利用する）
+ */
+void DescriptorTableCache::beginFrame(uint64_t fenceValue, const utility::FenceSource& fence) noexcept {
+    const auto completed = fence.completedValue();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ASSERT(fenceValue_ <= fenceValue, "フェンス値が単調増加になっていません");
+    fenceValue_     = fenceValue;
+    completedValue_ = completed;
+
+    // 破棄したテーブルのうち、参照していたフレームが完了した範囲を再利用できるようにする
+    allocator_.reclaim(completed);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ディスクリプタの並びに対応するテーブルを取得する（無ければ作成してコピーを予約する）
+ * @param	sources		コピー元のディスクリプタ（ステージングヒープの CPU ハンドル）
+ * @param	num			ディスクリプタ数
+ * @return	テーブル（範囲が足りない場合は valid() が false ）
+ */
+DescriptorTableCache::Table DescriptorTableCache::get(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, uint32_t num) noexcept {
+    // ハンドルの並びをそのままキーとして扱い、ヒット時は文字列を作らない
+    const std::string_view key(reinterpret_cast<const char*>(sources), sizeof(D3D12_CPU_DESCRIPTOR_HANDLE) * num);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (const auto* index = tables_.findValue(key)) {
+        auto& entry           = entries_[*index];
+        entry.lastFenceValue_ = fenceValue_;
+        touch(*index);
+        stats_.hitNum_++;
+        return tableOf(entry);
+    }
+
+    // 空きが無ければ古いテーブルから破棄する（断片化で確保できない場合も同様）
+    auto allocation = allocator_.allocate(num);
+    while (!allocation.valid() && evict()) {
+        allocation = allocator_.allocate(num);
+    }
+    if (!allocation.valid()) {
+        stats_.failNum_++;
+        return {};
+    }
+
+    uint32_t index;
+    if (!freeEntries_.empty()) {
+        index = freeEntries_.back();
+        freeEntries_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(entries_.size());
+        entries_.emplace_back();
+    }
+
+    auto& entry           = entries_[index];
+    entry.key_            = key;
+    entry.allocation_     = allocation;
+    entry.lastFenceValue_ = fenceValue_;
+    tables_.tryEmplace(entry.key_, index);
+    touch(index);
+    stats_.missNum_++;
+
+    const auto table = tableOf(entry);
+    destStarts_.emplace_back(table.cpuHandle_);
+    destSizes_.emplace_back(num);
+    for (uint32_t i = 0; i < num; ++i) {
+        srcStarts_.emplace_back(sources[i]);
+        srcSizes_.emplace_back(1);
+    }
+    return table;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	予約したコピーをまとめて行う（テーブルを参照するコマンドリストの実行前に呼び出す）
+ */
+void DescriptorTableCache::flush() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (destStarts_.empty()) {
+        return;
+    }
+
+    dx12::Device::instance().device()->CopyDescriptors(
+        static_cast<uint32_t>(destStarts_.size()), destStarts_.data(), destSizes_.data(),
+        static_cast<uint32_t>(srcStarts_.size()), srcStarts_.data(), srcSizes_.data(),
+        D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    destStarts_.clear();
+    destSizes_.clear();
+    srcStarts_.clear();
+    srcSizes_.clear();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	指定したディスクリプタをコピー元に含むテーブルを破棄する
+ * @param	sources		解放したディスクリプタ（ステージングヒープの CPU ハンドル）
+ * @param	num			ディスクリプタ数
+ * @return	破棄したテーブル数
+ */
+uint32_t DescriptorTableCache::invalidate(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, uint32_t num) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < num; ++i) {
+        count += invalidateRange(sources[i].ptr, sources[i].ptr + 1);
+    }
+    return count;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ステージングヒープの範囲をコピー元に含むテーブルを破棄する
+ * @param	handle		解放したステージングヒープのハンドル
+ * @return	破棄したテーブル数
+ */
+uint32_t DescriptorTableCache::invalidate(const DescriptorHeap::Handle& handle) {
+    const auto begin = handle.cpuHandle_.ptr;
+    const auto end   = begin + static_cast<SIZE_T>(handle.allocation_.num_) * handle.incrementSize_;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return invalidateRange(begin, end);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	すべてのテーブルを破棄する
+ */
+void DescriptorTableCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (newest_ != noEntry) {
+        release(newest_);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ヒット率の計測値を取得する
+ */
+DescriptorTableCache::Stats DescriptorTableCache::stats() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ヒット率の計測値を初期化する
+ */
+void DescriptorTableCache::resetStats() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = {};
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	キャッシュしているテーブル数を取得する
+ */
+uint32_t DescriptorTableCache::size() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<uint32_t>(tables_.size());
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	エントリを最も新しく参照したものにする
+ * @param	index		エントリのインデックス
+ */
+void DescriptorTableCache::touch(uint32_t index) noexcept {
+    if (newest_ == index) {
+        return;
+    }
+
+    unlink(index);
+
+    auto& entry  = entries_[index];
+    entry.older_ = newest_;
+    entry.newer_ = noEntry;
+    if (newest_ != noEntry) {
+        entries_[newest_].newer_ = index;
+    }
+    newest_ = index;
+    if (oldest_ == noEntry) {
+        oldest_ = index;
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	エントリを参照順のリストから外す
+ * @param	index		エントリのインデックス
+ */
+void DescriptorTableCache::unlink(uint32_t index) noexcept {
+    auto& entry = entries_[index];
+    if (entry.newer_ != noEntry) {
+        entries_[entry.newer_].older_ = entry.older_;
+    } else if (newest_ == index) {
+        newest_ = entry.older_;
+    }
+    if (entry.older_ != noEntry) {
+        entries_[entry.older_].newer_ = entry.newer_;
+    } else if (oldest_ == index) {
+        oldest_ = entry.newer_;
+    }
+    entry.newer_ = noEntry;
+    entry.older_ = noEntry;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	最も古く参照したテーブルを破棄する
+ * @return	破棄した場合は true（参照中のフレームが完了していない場合は false ）
+ */
+bool DescriptorTableCache::evict() noexcept {
+    // 最も古いテーブルが参照中なら、より新しいテーブルもすべて参照中
+    if (oldest_ == noEntry || entries_[oldest_].lastFenceValue_ > completedValue_) {
+        return false;
+    }
+
+    release(oldest_);
+    stats_.evictNum_++;
+    return true;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コピー元が範囲に含まれるテーブルを破棄する（ mutex_ をロックして呼び出す）
+ * @param	begin		範囲の先頭（ CPU ハンドルの値）
+ * @param	end			範囲の終端（ CPU ハンドルの値、終端は含まない）
+ * @return	破棄したテーブル数
+ */
+uint32_t DescriptorTableCache::invalidateRange(SIZE_T begin, SIZE_T end) {
+    uint32_t count = 0;
+    for (auto index = oldest_; index != noEntry;) {
+        const auto& entry = entries_[index];
+        const auto  newer = entry.newer_;
+
+        // キーはハンドルの並びをそのまま詰めたもの（文字列のアライメントは保証されないのでコピーして読む）
+        const auto num = static_cast<uint32_t>(entry.key_.size() / sizeof(D3D12_CPU_DESCRIPTOR_HANDLE));
+        for (uint32_t i = 0; i < num; ++i) {
+            D3D12_CPU_DESCRIPTOR_HANDLE source;
+            std::memcpy(&source, entry.key_.data() + i * sizeof(source), sizeof(source));
+            if (begin <= source.ptr && source.ptr < end) {
+                release(index);
+                count++;
+                break;
+            }
+        }
+        index = newer;
+    }
+    return count;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	エントリを破棄してテーブルの範囲を返す（参照中のフレームが完了していなければ完了後に返す）
+ * @param	index		エントリのインデックス
+ */
+void DescriptorTableCache::release(uint32_t index) {
+    auto& entry = entries_[index];
+    unlink(index);
+
+    // 解放されたステージングのスロットからコピーしないよう、 flush 前の予約も取り消す
+    cancelCopy(tableOf(entry));
+    if (entry.lastFenceValue_ <= completedValue_) {
+        allocator_.free(entry.allocation_);
+    } else {
+        // 遅延解放はフェンス値の順に並べるので、参照したフレーム以降の現在のフレームの完了を待つ
+        allocator_.free(entry.allocation_, fenceValue_);
+    }
+    tables_.erase(entry.key_);
+    entry.key_.clear();
+    entry.allocation_ = {};
+    freeEntries_.push_back(index);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	テーブルへの未実行のコピーの予約を取り消す
+ *
+ * コピー元は 1 個ずつ予約しているので、コピー先の個数の合計がコピー元の位置になる
+ * @param	table		コピー先のテーブル
+ */
+void DescriptorTableCache::cancelCopy(const Table& table) noexcept {
+    size_t source = 0;
+    for (size_t i = 0; i < destStarts_.size(); ++i) {
+        if (destStarts_[i].ptr == table.cpuHandle_.ptr) {
+            const auto first = srcStarts_.begin() + static_cast<ptrdiff_t>(source);
+            srcStarts_.erase(first, first + destSizes_[i]);
+            srcSizes_.erase(srcSizes_.begin() + static_cast<ptrdiff_t>(source), srcSizes_.begin() + static_cast<ptrdiff_t>(source + destSizes_[i]));
+            destStarts_.erase(destStarts_.begin() + static_cast<ptrdiff_t>(i));
+            destSizes_.erase(destSizes_.begin() + static_cast<ptrdiff_t>(i));
+            return;
+        }
+        source += destSizes_[i];
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	エントリのテーブルを取得する
+ * @param	entry		エントリ
+ */
+DescriptorTableCache::Table DescriptorTableCache::tableOf(const Entry& entry) const noexcept {
+    const auto stride = static_cast<uint64_t>(entry.allocation_.offset_) * region_.incrementSize_;
+
+    Table table;
+    table.cpuHandle_.ptr = region_.cpuHandle_.ptr + stride;
+    table.gpuHandle_.ptr = region_.gpuHandle_.ptr + stride;
+    table.num_           = entry.allocation_.num_;
+    return table;
+}
+
+}  // namespace dx12
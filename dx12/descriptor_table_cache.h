@@ -0,0 +1,229 @@
+﻿#pragma once
+
+#include "dx12/descriptor_heap.h"
+#include "dx12/descriptor_ring.h"
+
+#include "utility/fence_source.h"
+#include "utility/flat_map.h"
+#include "utility/noncopyable.h"
+#include "utility/range_allocator.h"
+
+namespace dx12 {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ディスクリプタテーブルの重複排除キャッシュ
+ *
+ * コピー元のディスクリプタハンドルの並びをキー（ハッシュは FlatHash<std::string> ）として、
+ * 作成済みのテーブルがあればコピーせずにそのまま返す
+ * テーブルはシェーダーから参照できるヒープに確保した専用の範囲に置き、フレームをまたいで再利用する
+ *
+ * 範囲が足りない場合は最も長く参照されていないテーブルから破棄するが、
+ * 最後に参照したフレームのフェンスが完了していないテーブルは破棄しない
+ * （すべて参照中の場合は無効なテーブルを返すので、呼び出し側は DescriptorRing で代用する）
+ *
+ * キーはステージングヒープのハンドルの値なので、スロットが解放されたら invalidate で該当するテーブルを破棄する
+ * （ create にステージングヒープを渡すと、ヒープの解放時に自動で invalidate する）
+ * 破棄したテーブルの範囲は、現在のフレームのフェンスが完了するまで再利用しない
+ */
+class DescriptorTableCache final : public utility::Noncopyable {
+public:
+    using Table = DescriptorRing::Table;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ヒット率の計測値
+     */
+    struct Stats {
+        uint64_t hitNum_{};    ///< 作成済みのテーブルを返した回数
+        uint64_t missNum_{};   ///< テーブルを作成した回数
+        uint64_t evictNum_{};  ///< テーブルを破棄した回数
+        uint64_t failNum_{};   ///< 範囲が足りず作成できなかった回数
+
+        //---------------------------------------------------------------------------------
+        /**
+         * @brief	ヒット率を取得する
+         * @return	0.0 〜 1.0 （要求が無い場合は 0.0 ）
+         */
+        [[nodiscard]] double hitRate() const noexcept {
+            const auto total = hitNum_ + missNum_ + failNum_;
+            return total > 0 ? static_cast<double>(hitNum_) / static_cast<double>(total) : 0.0;
+        }
+    };
+
+private:
+    static constexpr uint32_t noEntry = ~0u;  ///< エントリが無いことを表す値
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  キャッシュしたテーブル
+     */
+    struct Entry {
+        std::string                         key_{};             ///< コピー元ハンドルの並び
+        utility::RangeAllocator::Allocation allocation_{};      ///< キャッシュ範囲内のテーブルの位置
+        uint64_t                            lastFenceValue_{};  ///< 最後に参照したフレームのフェンス値
+        uint32_t                            newer_{noEntry};    ///< 次に新しく参照したエントリ
+        uint32_t                            older_{noEntry};    ///< 次に古く参照したエントリ
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    DescriptorTableCache() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ（キャッシュの範囲をヒープに返し、ステージングヒープの解放時の処理を解除する）
+     */
+    ~DescriptorTableCache();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キャッシュを作成する
+     * @param	heap		キャッシュの範囲を確保するシェーダーから参照できるヒープ（キャッシュより長く生存すること）
+     * @param	capacity	キャッシュするディスクリプタ数の上限
+     * @param	stagingHeap	コピー元のステージングヒープ（指定すると解放時に invalidate する、キャッシュより長く生存すること）
+     * @return	作成に成功した場合は true
+     */
+    bool create(DescriptorHeap& heap, uint32_t capacity, DescriptorHeap* stagingHeap = nullptr) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームを開始する
+     * @param	fenceValue	このフレームのコマンドの完了時にシグナルされるフェンス値
+     * @param	fence		完了値を取得するフェンス（破棄できるテーブルの判定に利用する）
+     */
+    void beginFrame(uint64_t fenceValue, const utility::FenceSource& fence) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ディスクリプタの並びに対応するテーブルを取得する（無ければ作成してコピーを予約する）
+     * @param	sources		コピー元のディスクリプタ（ステージングヒープの CPU ハンドル）
+     * @param	num			ディスクリプタ数
+     * @return	テーブル（範囲が足りない場合は valid() が false ）
+     */
+    [[nodiscard]] Table get(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, uint32_t num) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	予約したコピーをまとめて行う（テーブルを参照するコマンドリストの実行前に呼び出す）
+     */
+    void flush() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	指定したディスクリプタをコピー元に含むテーブルを破棄する
+     * @param	sources		解放したディスクリプタ（ステージングヒープの CPU ハンドル）
+     * @param	num			ディスクリプタ数
+     * @return	破棄したテーブル数
+     */
+    uint32_t invalidate(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, uint32_t num);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ステージングヒープの範囲をコピー元に含むテーブルを破棄する
+     * @param	handle		解放したステージングヒープのハンドル
+     * @return	破棄したテーブル数
+     */
+    uint32_t invalidate(const DescriptorHeap::Handle& handle);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	すべてのテーブルを破棄する
+     */
+    void clear();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ヒット率の計測値を取得する
+     */
+    [[nodiscard]] Stats stats() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ヒット率の計測値を初期化する
+     */
+    void resetStats() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キャッシュしているテーブル数を取得する
+     */
+    [[nodiscard]] uint32_t size() const noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	エントリを最も新しく参照したものにする
+     * @param	index		エントリのインデックス
+     */
+    void touch(uint32_t index) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	エントリを参照順のリストから外す
+     * @param	index		エントリのインデックス
+     */
+    void unlink(uint32_t index) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	最も古く参照したテーブルを破棄する
+     * @return	破棄した場合は true（参照中のフレームが完了していない場合は false ）
+     */
+    bool evict() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コピー元が範囲に含まれるテーブルを破棄する（ mutex_ をロックして呼び出す）
+     * @param	begin		範囲の先頭（ CPU ハンドルの値）
+     * @param	end			範囲の終端（ CPU ハンドルの値、終端は含まない）
+     * @return	破棄したテーブル数
+     */
+    uint32_t invalidateRange(SIZE_T begin, SIZE_T end);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	エントリを破棄してテーブルの範囲を返す（参照中のフレームが完了していなければ完了後に返す）
+     * @param	index		エントリのインデックス
+     */
+    void release(uint32_t index);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	テーブルへの未実行のコピーの予約を取り消す
+     * @param	table		コピー先のテーブル
+     */
+    void cancelCopy(const Table& table) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	エントリのテーブルを取得する
+     * @param	entry		エントリ
+     */
+    Table tableOf(const Entry& entry) const noexcept;
+
+private:
+    DescriptorHeap*                          heap_{};            ///< キャッシュの範囲を確保したヒープ
+    DescriptorHeap*                          stagingHeap_{};     ///< 解放時に invalidate するステージングヒープ
+    DescriptorHeap::FreeHookId               freeHookId_{};      ///< ステージングヒープに追加した解放時の処理
+    DescriptorHeap::Handle                   region_{};          ///< キャッシュの範囲
+    utility::RangeAllocator                  allocator_{};       ///< キャッシュ範囲内の割り当て
+    utility::FlatMap<std::string, uint32_t>  tables_{};          ///< コピー元ハンドルの並びからエントリへの対応
+    std::vector<Entry>                       entries_{};         ///< エントリ
+    std::vector<uint32_t>                    freeEntries_{};     ///< 再利用できるエントリ
+    uint32_t                                 newest_{noEntry};   ///< 最も新しく参照したエントリ
+    uint32_t                                 oldest_{noEntry};   ///< 最も古く参照したエントリ
+    uint64_t                                 fenceValue_{};      ///< 現在のフレームのフェンス値
+    uint64_t                                 completedValue_{};  ///< 完了済みのフェンス値
+    Stats                                    stats_{};           ///< ヒット率の計測値
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> destStarts_{};      ///< 予約したコピー先の先頭
+    std::vector<uint32_t>                    destSizes_{};       ///< 予約したコピー先の個数
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> srcStarts_{};       ///< 予約したコピー元の先頭
+    std::vector<uint32_t>                    srcSizes_{};        ///< 予約したコピー元の個数
+    mutable std::mutex                       mutex_{};           ///< キャッシュの同期オブジェクト
+};
+}  // namespace dx12
@@ -1,5 +1,7 @@
 ﻿#include "dx12/device.h"
 
+#include "utility/flight_recorder.h"
+
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "dxguid.lib")
 #pragma comment(lib, "dxgi.lib")
@@ -8,6 +10,10 @@ namespace dx12 {
 using namespace Microsoft::WRL;
 using namespace DirectX;
 
+namespace {
+constexpr const char* crashDumpPath = "flight_record.bin";  ///< アサート・クラッシュ時にフライトレコーダーを書き出すファイル
+}  // namespace
+
 //---------------------------------------------------------------------------------
 /**
  * @brief
@@ -40,6 +46,9 @@ public:
      * @return	デバイスの作成に成功した場合は true
      */
     bool create() noexcept {
+        // 以降の初期化やフレーム処理でのアサート・クラッシュ時に直近のイベントを書き出す
+        utility::FlightRecorder::instance().installCrashHandler(crashDumpPath);
+
 #if _DEBUG
         ComPtr<ID3D12Debug> debug;
         if (SUCCEEDED(D3D12GetDebugInterface(IID_PPV_ARGS(debug.GetAddressOf())))) {
@@ -47,15 +56,12 @@ public:
         }
 #endif
         // ディスプレイアダプタ設定
-        setDisplayAdapter();
+        if (!setDisplayAdapter()) {
+            return false;
+        }
 
         // デバイスの作成
-        createDevice();
-
-        // ディスプレイモードの確認
-        checkDisplayMode();
-
-        return true;
+        return createDevice();
     }
 
     //---------------------------------------------------------------------------------
@@ -192,6 +198,15 @@ public:
         return dxgiAdapter_.Get();
     }
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	対応解像度のリストを取得する
+     * @return	対応解像度のリスト
+     */
+    const std::vector<XMUINT2>& displaySizes() const noexcept {
+        return adapterSizeList_;
+    }
+
 private:
     ComPtr<ID3D12Device>    device_;           ///< デバイス
     ComPtr<IDXGISwapChain3> swapChain_;        ///< スワップチェイン
@@ -217,6 +232,24 @@ bool Device::create() noexcept {
     return impl_->create();
 }
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ディスプレイモードを列挙して対応解像度を取得する
+ * @return	ディスプレイのモードが取得できれば true
+ */
+bool Device::checkDisplayMode() noexcept {
+    return impl_->checkDisplayMode();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	対応解像度のリストを取得する
+ * @return	checkDisplayMode で取得した解像度（重複無し）
+ */
+const std::vector<DirectX::XMUINT2>& Device::displaySizes() const noexcept {
+    return impl_->displaySizes();
+}
+
 //---------------------------------------------------------------------------------
 /**
  * @brief	デバイスを取得する
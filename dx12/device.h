@@ -27,10 +27,28 @@ public:
     //---------------------------------------------------------------------------------
     /**
      * @brief	デバイスを作成する
+     *
+     * ディスプレイモードの列挙は含まない（ checkDisplayMode を別途呼び出す）
      * @return	正しく作成できた場合は true
      */
     bool create() noexcept;
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ディスプレイモードを列挙して対応解像度を取得する
+     *
+     * アダプタのみを参照するので、作成後に他の初期化と並列に呼び出してよい
+     * @return	ディスプレイのモードが取得できれば true
+     */
+    bool checkDisplayMode() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	対応解像度のリストを取得する
+     * @return	checkDisplayMode で取得した解像度（重複無し）
+     */
+    [[nodiscard]] const std::vector<DirectX::XMUINT2>& displaySizes() const noexcept;
+
     //---------------------------------------------------------------------------------
     /**
      * @brief	デバイスを取得する
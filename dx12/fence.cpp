@@ -1,5 +1,7 @@
 ﻿#include "dx12/fence.h"
 
+#include "utility/flight_recorder.h"
+
 namespace dx12 {
 
 //---------------------------------------------------------------------------------
@@ -31,4 +33,29 @@ ID3D12Fence* Fence::get() const noexcept {
     return fence_.Get();
 }
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief	GPU 側で完了済みのフェンス値を取得する
+ */
+uint64_t Fence::completedValue() const noexcept {
+    return fence_ ? fence_->GetCompletedValue() : 0;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	GPU 側でフェンス値に到達するまで CPU を待機させる
+ * @param	value		待機するフェンス値
+ */
+void Fence::wait(uint64_t value) const noexcept {
+    FLIGHT_RECORD(utility::FlightEvent::FenceWait, "Fence", value);
+    if (completedValue() >= value) {
+        return;
+    }
+
+    auto event = CreateEvent(nullptr, false, false, "WAIT_GPU");
+    fence_->SetEventOnCompletion(value, event);
+    WaitForSingleObject(event, INFINITE);
+    CloseHandle(event);
+}
+
 }  // namespace dx12
@@ -2,7 +2,7 @@
 
 #include "dx12/device.h"
 
-#include "utility/noncopyable.h"
+#include "utility/fence_source.h"
 
 namespace dx12 {
 //---------------------------------------------------------------------------------
@@ -10,7 +10,7 @@ namespace dx12 {
  * @brief
  * フェンス
  */
-class Fence final : public utility::Noncopyable {
+class Fence final : public utility::FenceSource {
 public:
     //---------------------------------------------------------------------------------
     /**
@@ -37,6 +37,19 @@ public:
      */
     [[nodiscard]] ID3D12Fence* get() const noexcept;
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	GPU 側で完了済みのフェンス値を取得する
+     */
+    [[nodiscard]] uint64_t completedValue() const noexcept override;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	GPU 側でフェンス値に到達するまで CPU を待機させる
+     * @param	value		待機するフェンス値
+     */
+    void wait(uint64_t value) const noexcept;
+
 private:
     Microsoft::WRL::ComPtr<ID3D12Fence> fence_;  ///< フェンス
 };
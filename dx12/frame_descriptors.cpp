@@ -0,0 +1,277 @@
+﻿#include "dx12/frame_descriptors.h"
+#include "dx12/swap_chain.h"
+
+#include "utility/profiler.h"
+
+namespace dx12 {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フレームごとのディスクリプタテーブルのインプリメントクラス
+ */
+class FrameDescriptors::Impl {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    Impl() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~Impl() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ヒープとリング、キャッシュを作成する
+     * @param	stagingCapacity			ステージングヒープのディスクリプタ数
+     * @param	shaderVisibleCapacity	シェーダーから参照できるヒープのディスクリプタ数
+     * @param	ringCapacity			リングのディスクリプタ数
+     * @param	cacheCapacity			キャッシュのディスクリプタ数（ 0 の場合はキャッシュを使わない）
+     * @return	作成に成功した場合は true
+     */
+    bool create(uint32_t stagingCapacity, uint32_t shaderVisibleCapacity, uint32_t ringCapacity, uint32_t cacheCapacity) noexcept {
+        ASSERT(!created_, "フレームのディスクリプタはすでに作成されています");
+        ASSERT(static_cast<uint64_t>(ringCapacity) + cacheCapacity <= shaderVisibleCapacity, "リングとキャッシュがシェーダーから参照できるヒープに収まりません");
+
+        if (!stagingHeap_.create(DescriptorHeap::Type::CBV_SRV_UAV, stagingCapacity, false)) {
+            return false;
+        }
+        if (!shaderVisibleHeap_.create(DescriptorHeap::Type::CBV_SRV_UAV, shaderVisibleCapacity)) {
+            return false;
+        }
+        if (!ring_.create(shaderVisibleHeap_, ringCapacity)) {
+            return false;
+        }
+        if (cacheCapacity > 0) {
+            // キャッシュのキーはステージングヒープのハンドルなので、スロットの解放時に無効化させる
+            if (!cache_.create(shaderVisibleHeap_, cacheCapacity, &stagingHeap_)) {
+                return false;
+            }
+            // 最初のフレームのテーブルを、そのフレームの完了前に破棄しないようにする
+            cache_.beginFrame(SwapChain::instance().frameFenceValue(), utility::ManualFenceSource{});
+            useCache_ = true;
+        }
+
+        created_ = true;
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	作成済みか否か
+     */
+    bool created() const noexcept {
+        return created_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ビューを作成する CPU 専用のステージングヒープを取得する
+     */
+    DescriptorHeap& stagingHeap() noexcept {
+        return stagingHeap_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	テーブルを置くシェーダーから参照できるヒープを取得する
+     */
+    DescriptorHeap& shaderVisibleHeap() noexcept {
+        return shaderVisibleHeap_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ステージングヒープのディスクリプタを並べたテーブルを取得する
+     * @param	sources		コピー元のディスクリプタ（ステージングヒープの CPU ハンドル）
+     * @param	num			ディスクリプタ数
+     * @return	テーブル（リングが足りない場合は valid() が false ）
+     */
+    Table table(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, uint32_t num) noexcept {
+        ASSERT(created_, "フレームのディスクリプタが作成されていません");
+        if (useCache_) {
+            if (const auto table = cache_.get(sources, num); table.valid()) {
+                return table;
+            }
+        }
+        return ring_.copyTable(sources, num);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キャッシュのヒット率の計測値を取得する
+     */
+    DescriptorTableCache::Stats cacheStats() const noexcept {
+        auto stats = cache_.stats();
+        stats.hitNum_   += cacheStats_.hitNum_;
+        stats.missNum_  += cacheStats_.missNum_;
+        stats.evictNum_ += cacheStats_.evictNum_;
+        stats.failNum_  += cacheStats_.failNum_;
+        return stats;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	シェーダーから参照できるヒープをコマンドリストに設定する
+     * @param	commandList		設定先のコマンドリスト
+     */
+    void setToCommandList(CommandList& commandList) noexcept {
+        shaderVisibleHeap_.setToCommandList(commandList);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	予約したコピーをまとめて行う
+     */
+    void flush() noexcept {
+        if (created_) {
+            cache_.flush();
+            ring_.flush();
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームを終了し、フェンスが完了したフレームのリングの範囲を回収する
+     * @param	fenceValue	終了したフレームのコマンドの完了時にシグナルされるフェンス値
+     * @param	fence		完了値を取得するフェンス
+     */
+    void endFrame(uint64_t fenceValue, const utility::FenceSource& fence) noexcept {
+        if (!created_) {
+            return;
+        }
+        ring_.endFrame(fenceValue);
+        ring_.reclaim(fence);
+        PROFILE_COUNTER("FrameDescriptors/ring", ring_.usedNum());
+
+        if (useCache_) {
+            cache_.beginFrame(fenceValue + 1, fence);
+
+            // ヒット率はフレームごとに出力し、累計は cacheStats_ に移す
+            const auto stats = cache_.stats();
+            cache_.resetStats();
+            cacheStats_.hitNum_   += stats.hitNum_;
+            cacheStats_.missNum_  += stats.missNum_;
+            cacheStats_.evictNum_ += stats.evictNum_;
+            cacheStats_.failNum_  += stats.failNum_;
+            PROFILE_COUNTER("FrameDescriptors/cacheHitRate", stats.hitRate() * 100.0);
+            PROFILE_COUNTER("FrameDescriptors/cacheTables", cache_.size());
+            PROFILE_COUNTER("FrameDescriptors/cacheEvict", stats.evictNum_);
+        }
+    }
+
+private:
+    DescriptorHeap              stagingHeap_{};        ///< ビューを作成する CPU 専用のヒープ
+    DescriptorHeap              shaderVisibleHeap_{};  ///< テーブルを置くシェーダーから参照できるヒープ
+    DescriptorRing              ring_{};               ///< フレームごとに使い捨てるテーブルのリング
+    DescriptorTableCache        cache_{};              ///< フレームをまたいで再利用するテーブルのキャッシュ（ヒープより先に破棄する）
+    DescriptorTableCache::Stats cacheStats_{};         ///< 前のフレームまでのキャッシュのヒット率の累計
+    bool                        useCache_{};           ///< キャッシュを使うか否か
+    bool                        created_{};            ///< 作成済みか否か
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ
+ */
+FrameDescriptors::~FrameDescriptors() {
+    impl_.reset();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ヒープとリング、キャッシュを作成する
+ * @param	stagingCapacity			ステージングヒープのディスクリプタ数
+ * @param	shaderVisibleCapacity	シェーダーから参照できるヒープのディスクリプタ数（リングとキャッシュ以外はバインドレスのビューなどに使える）
+ * @param	ringCapacity			リングのディスクリプタ数
+ * @param	cacheCapacity			キャッシュのディスクリプタ数（ 0 の場合はキャッシュを使わない）
+ * @return	作成に成功した場合は true
+ */
+bool FrameDescriptors::create(uint32_t stagingCapacity, uint32_t shaderVisibleCapacity, uint32_t ringCapacity, uint32_t cacheCapacity) noexcept {
+    return impl_->create(stagingCapacity, shaderVisibleCapacity, ringCapacity, cacheCapacity);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	作成済みか否か
+ */
+bool FrameDescriptors::created() const noexcept {
+    return impl_->created();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ビューを作成する CPU 専用のステージングヒープを取得する
+ */
+DescriptorHeap& FrameDescriptors::stagingHeap() noexcept {
+    return impl_->stagingHeap();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	テーブルを置くシェーダーから参照できるヒープを取得する
+ */
+DescriptorHeap& FrameDescriptors::shaderVisibleHeap() noexcept {
+    return impl_->shaderVisibleHeap();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ステージングヒープのディスクリプタを並べたテーブルを取得する（コピーは flush で行う）
+ * @param	sources		コピー元のディスクリプタ（ステージングヒープの CPU ハンドル）
+ * @param	num			ディスクリプタ数
+ * @return	テーブル（キャッシュにもリングにも置けない場合は valid() が false ）
+ */
+FrameDescriptors::Table FrameDescriptors::table(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, uint32_t num) noexcept {
+    return impl_->table(sources, num);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	キャッシュのヒット率の計測値を取得する（作成してからの累計）
+ */
+DescriptorTableCache::Stats FrameDescriptors::cacheStats() const noexcept {
+    return impl_->cacheStats();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	シェーダーから参照できるヒープをコマンドリストに設定する
+ * @param	commandList		設定先のコマンドリスト
+ */
+void FrameDescriptors::setToCommandList(CommandList& commandList) noexcept {
+    impl_->setToCommandList(commandList);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	予約したコピーをまとめて行う（ CommandQueue::execute から呼び出される）
+ */
+void FrameDescriptors::flush() noexcept {
+    impl_->flush();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームを終了し、フェンスが完了したフレームのリングの範囲を回収する（ SwapChain::present から呼び出される）
+ *
+ * キャッシュは次のフレームを開始し、このフレームのヒット率をプロファイラのカウンターに出力する
+ * @param	fenceValue	終了したフレームのコマンドの完了時にシグナルされるフェンス値
+ * @param	fence		完了値を取得するフェンス
+ */
+void FrameDescriptors::endFrame(uint64_t fenceValue, const utility::FenceSource& fence) noexcept {
+    impl_->endFrame(fenceValue, fence);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ */
+FrameDescriptors::FrameDescriptors() {
+    impl_.reset(new FrameDescriptors::Impl());
+}
+}  // namespace dx12
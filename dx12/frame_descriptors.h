@@ -0,0 +1,120 @@
+﻿#pragma once
+
+#include "dx12/command_list.h"
+#include "dx12/descriptor_heap.h"
+#include "dx12/descriptor_ring.h"
+#include "dx12/descriptor_table_cache.h"
+
+#include "utility/fence_source.h"
+#include "utility/singleton.h"
+
+namespace dx12 {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フレームごとのディスクリプタテーブル
+ *
+ * ビューは CPU 専用のステージングヒープに作成し、描画時に必要なものだけを
+ * シェーダーから参照できるヒープのリングへコピーしてテーブルとして使う
+ * 同じ並びのテーブルは DescriptorTableCache でフレームをまたいで再利用し、キャッシュに置けない場合のみリングを使う
+ * コピーは CommandQueue::execute の前に flush でまとめて行い、
+ * リングの範囲は SwapChain::present で記録したフレームのフェンスの完了後に回収する
+ * キャッシュのヒット率はフレームごとにプロファイラのカウンターに出力する
+ *
+ * シェーダーから参照できる CBV_SRV_UAV ヒープは同時に 1 つしか設定できないので、
+ * テーブルを使うコマンドリストには setToCommandList でこのヒープを設定する
+ */
+class FrameDescriptors final : public utility::Singleton<FrameDescriptors> {
+private:
+    friend class utility::Singleton<FrameDescriptors>;
+
+public:
+    using Table = DescriptorRing::Table;
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~FrameDescriptors();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ヒープとリング、キャッシュを作成する
+     * @param	stagingCapacity			ステージングヒープのディスクリプタ数
+     * @param	shaderVisibleCapacity	シェーダーから参照できるヒープのディスクリプタ数（リングとキャッシュ以外はバインドレスのビューなどに使える）
+     * @param	ringCapacity			リングのディスクリプタ数
+     * @param	cacheCapacity			キャッシュのディスクリプタ数（ 0 の場合はキャッシュを使わない）
+     * @return	作成に成功した場合は true
+     */
+    bool create(uint32_t stagingCapacity, uint32_t shaderVisibleCapacity, uint32_t ringCapacity, uint32_t cacheCapacity) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	作成済みか否か
+     */
+    [[nodiscard]] bool created() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ビューを作成する CPU 専用のステージングヒープを取得する
+     */
+    [[nodiscard]] DescriptorHeap& stagingHeap() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	テーブルを置くシェーダーから参照できるヒープを取得する
+     */
+    [[nodiscard]] DescriptorHeap& shaderVisibleHeap() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ステージングヒープのディスクリプタを並べたテーブルを取得する（コピーは flush で行う）
+     * @param	sources		コピー元のディスクリプタ（ステージングヒープの CPU ハンドル）
+     * @param	num			ディスクリプタ数
+     * @return	テーブル（キャッシュにもリングにも置けない場合は valid() が false ）
+     */
+    [[nodiscard]] Table table(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, uint32_t num) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キャッシュのヒット率の計測値を取得する（作成してからの累計）
+     */
+    [[nodiscard]] DescriptorTableCache::Stats cacheStats() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	シェーダーから参照できるヒープをコマンドリストに設定する
+     * @param	commandList		設定先のコマンドリスト
+     */
+    void setToCommandList(CommandList& commandList) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	予約したコピーをまとめて行う（ CommandQueue::execute から呼び出される）
+     */
+    void flush() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームを終了し、フェンスが完了したフレームのリングの範囲を回収する（ SwapChain::present から呼び出される）
+     *
+     * キャッシュは次のフレームを開始し、このフレームのヒット率をプロファイラのカウンターに出力する
+     * @param	fenceValue	終了したフレームのコマンドの完了時にシグナルされるフェンス値
+     * @param	fence		完了値を取得するフェンス
+     */
+    void endFrame(uint64_t fenceValue, const utility::FenceSource& fence) noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    FrameDescriptors();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;  ///< インプリメントクラスポインタ
+};
+}  // namespace dx12
@@ -1,15 +1,27 @@
 ﻿#pragma once
 
+#include "utility/alloc_counter.h"
+#include "utility/flat_map.h"
 #include "utility/noncopyable.h"
+#include "utility/hashed_string.h"
+#include "utility/slot_map.h"
+#include "utility/spin_lock.h"
 
 namespace dx12::graphics {
 //---------------------------------------------------------------------------------
 /**
  * @brief
  * 描画オブジェクトのコンテナ
+ *
+ * オブジェクトはスロットマップに格納し、登録キーから世代付きハンドルを引く
+ * 描画時の参照はハンドルを保持しておき get(Handle) で行う（配列の添字のみでロックを取らない）
+ * 登録と参照は複数スレッドから並行して行ってよい
  */
 template <class T>
 class Container final : public utility::Noncopyable {
+public:
+    using Handle = utility::SlotHandle;
+
 private:
     Container() = default;
 
@@ -26,32 +38,153 @@ public:
     //---------------------------------------------------------------------------------
     /**
      * @brief	オブジェクトを登録する
+     *
+     * 名前をインターンテーブルに登録し、別の名前とハッシュ値が衝突している場合はアサートする
+     * @param	key		登録キー
+     * @param	args	初期設定に利用する情報
+     * @return	オブジェクトのハンドル（登録済みの場合は既存のもの）
+     */
+    template <class... Args>
+    Handle registerObj(const utility::HashedString& key, Args&&... args) {
+        key.intern();
+        return registerObj(key.hash(), std::forward<Args>(args)...);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	オブジェクトを登録する
+     *
+     * 参照を止めないよう、オブジェクトの生成は登録キーのロックの外で行い、ロック中は対応の追加のみ行う
+     * 同じキーを並行して登録した場合は先に追加した方を採用し、もう一方で生成したオブジェクトは破棄する
+     * @param	key		登録キー（ TO_HASH で計算したハッシュ値）
      * @param	args	初期設定に利用する情報
+     * @return	オブジェクトのハンドル（登録済みの場合は既存のもの）
      */
     template <class... Args>
-    void registerObj(uint32_t key, Args&&... args) {
-        if (container_.find(key) != container_.end()) {
-            return;
+    Handle registerObj(uint32_t key, Args&&... args) {
+        if (const auto h = handle(key); h.valid()) {
+            return h;
+        }
+
+        MEMORY_TAG(utility::alloc::MemoryTag::Container);
+        const auto created = objects_.emplace(std::forward<Args>(args)...);
+        if (!created.valid()) {
+            return created;
+        }
+
+        Handle registered;
+        {
+            std::lock_guard<utility::WriterPreferSpinLock> lock(keyLock_);
+            if (const auto* h = keys_.findValue(key)) {
+                registered = *h;
+            } else {
+                keys_.tryEmplace(key, created);
+                return created;
+            }
         }
 
-        auto o = std::make_unique<T>(std::forward<Args>(args)...);
-        container_.emplace(key, std::move(o));
+        // 他のスレッドが先に登録したので、生成したオブジェクトは破棄する
+        objects_.remove(created);
+        return registered;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	オブジェクトを破棄する
+     *
+     * 破棄したオブジェクトのハンドルは以降 nullptr を返す
+     * 破棄するオブジェクトを他のスレッドが参照していないこと
+     * @param	key		登録キー
+     * @return	破棄した場合は true
+     */
+    bool remove(const utility::HashedString& key) noexcept {
+        return remove(key.hash());
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	オブジェクトを破棄する
+     * @param	key		登録キー（ TO_HASH で計算したハッシュ値）
+     * @return	破棄した場合は true
+     */
+    bool remove(uint32_t key) noexcept {
+        std::lock_guard<utility::WriterPreferSpinLock> lock(keyLock_);
+
+        const auto it = keys_.find(key);
+        if (it == keys_.end()) {
+            return false;
+        }
+
+        objects_.remove(it->second);
+        keys_.erase(it);
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	登録キーからハンドルを取得する
+     * @param	key		登録キー
+     * @return	オブジェクトのハンドル（未登録の場合は無効なハンドル）
+     */
+    [[nodiscard]] Handle handle(const utility::HashedString& key) const noexcept {
+        return handle(key.hash());
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	登録キーからハンドルを取得する
+     * @param	key		登録キー（ TO_HASH で計算したハッシュ値）
+     * @return	オブジェクトのハンドル（未登録の場合は無効なハンドル）
+     */
+    [[nodiscard]] Handle handle(uint32_t key) const noexcept {
+        keyLock_.lockShared();
+        const auto* h      = keys_.findValue(key);
+        const auto  result = h ? *h : Handle{};
+        keyLock_.unlockShared();
+        return result;
     }
 
     //---------------------------------------------------------------------------------
     /**
      * @brief	オブジェクトを取得する
+     * @param	h		オブジェクトのハンドル
+     * @return	オブジェクトのポインタ（破棄済みの場合は nullptr ）
+     */
+    [[nodiscard]] T* get(Handle h) const noexcept {
+        return objects_.get(h);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	オブジェクトを取得する
+     * @param	key		登録キー
+     * @return	オブジェクトのポインタ
+     */
+    [[nodiscard]] T* get(const utility::HashedString& key) const noexcept {
+        return get(key.hash());
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	オブジェクトを取得する
+     * @param	key		登録キー（ TO_HASH で計算したハッシュ値）
      * @return	オブジェクトのポインタ
      */
     [[nodiscard]] T* get(uint32_t key) const noexcept {
-        if (container_.find(key) == container_.end()) {
-            return nullptr;
-        }
+        return get(handle(key));
+    }
 
-        return container_.at(key).get();
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	登録中のオブジェクト数を取得する
+     */
+    [[nodiscard]] uint32_t size() const noexcept {
+        return objects_.size();
     }
 
 private:
-    std::unordered_map<uint32_t, std::unique_ptr<T>> container_;
+    utility::SlotMap<T>                   objects_{};  ///< オブジェクト
+    utility::FlatMap<uint32_t, Handle>    keys_{};     ///< 登録キーからハンドルへの対応
+    mutable utility::WriterPreferSpinLock keyLock_{};  ///< 登録キーの同期オブジェクト
 };
 }  // namespace dx12::graphics
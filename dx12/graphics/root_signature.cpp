@@ -2,14 +2,43 @@
 
 #include "dx12/device.h"
 
+namespace {
+//---------------------------------------------------------------------------------
+/**
+ * @brief	スタティックサンプラ( s0 )の設定を取得する
+ */
+D3D12_STATIC_SAMPLER_DESC defaultSampler() noexcept {
+    D3D12_STATIC_SAMPLER_DESC sampler = {};
+    sampler.Filter                    = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+    sampler.AddressU                  = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler.AddressV                  = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler.AddressW                  = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler.MipLODBias                = 0;
+    sampler.MaxAnisotropy             = 0;
+    sampler.ComparisonFunc            = D3D12_COMPARISON_FUNC_NEVER;
+    sampler.BorderColor               = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
+    sampler.MinLOD                    = 0.0f;
+    sampler.MaxLOD                    = D3D12_FLOAT32_MAX;
+    sampler.ShaderRegister            = 0;
+    sampler.RegisterSpace             = 0;
+    sampler.ShaderVisibility          = D3D12_SHADER_VISIBILITY_ALL;
+    return sampler;
+}
+}  // namespace
+
 namespace dx12::graphics {
 
 //---------------------------------------------------------------------------------
 /**
  * @brief	コンストラクタ
+ * @param	layout			ルートパラメータの構成
  */
-RootSignature::RootSignature() {
-    create();
+RootSignature::RootSignature(Layout layout) : layout_(layout) {
+    if (layout == Layout::Bindless) {
+        createBindless();
+    } else {
+        createDefault();
+    }
 }
 
 //---------------------------------------------------------------------------------
@@ -22,6 +51,36 @@ void RootSignature::setToCommandList(CommandList& commandList) noexcept {
     commandList.get()->SetGraphicsRootSignature(rootSignature_.Get());
 }
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ヒープ全体をバインドレスのテーブルとして設定する（ Bindless のみ、ルートシグネチャの設定後に呼び出す）
+ * @param	commandList		設定先のコマンドリスト
+ * @param	descriptorHeap	インデックスの基準となるシェーダーから参照できるヒープ
+ */
+void RootSignature::setBindlessTable(CommandList& commandList, DescriptorHeap& descriptorHeap) noexcept {
+    ASSERT(layout_ == Layout::Bindless, "バインドレスのルートシグネチャではありません");
+
+    // SRV と CBV のテーブルはどちらもヒープの先頭を指し、インデックスはヒープ先頭からの位置になる
+    const auto start = descriptorHeap.handleFromIndex(0).gpuHandle_;
+    descriptorHeap.setToCommandList(commandList);
+    commandList.get()->SetGraphicsRootDescriptorTable(bindlessSrvParameter, start);
+    commandList.get()->SetGraphicsRootDescriptorTable(bindlessCbvParameter, start);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	描画で参照するディスクリプタのインデックスをルート定数として設定する（ Bindless のみ）
+ * @param	commandList		設定先のコマンドリスト
+ * @param	indices			GpuObj::descriptorIndex で取得したインデックス
+ * @param	num				インデックス数（ bindlessIndexNum 以下）
+ */
+void RootSignature::setBindlessIndices(CommandList& commandList, const uint32_t* indices, uint32_t num) noexcept {
+    ASSERT(layout_ == Layout::Bindless, "バインドレスのルートシグネチャではありません");
+    ASSERT(num <= bindlessIndexNum, "ルート定数に収まらないインデックス数です");
+
+    commandList.get()->SetGraphicsRoot32BitConstants(bindlessIndexParameter, std::min(num, bindlessIndexNum), indices, 0);
+}
+
 //---------------------------------------------------------------------------------
 /**
  * @brief	ルートシグネチャを取得する
@@ -33,10 +92,10 @@ ID3D12RootSignature* RootSignature::get() const noexcept {
 
 //---------------------------------------------------------------------------------
 /**
- * @brief	ルートシグネチャを作成する
+ * @brief	オブジェクトごとのテーブルを設定するルートシグネチャを作成する
  * @return	作成に成功した場合は true
  */
-bool RootSignature::create() noexcept {
+bool RootSignature::createDefault() noexcept {
     // コンスタントバッファ( b0 )
     D3D12_DESCRIPTOR_RANGE r0            = {};
     r0.RangeType                         = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
@@ -62,20 +121,7 @@ bool RootSignature::create() noexcept {
     r2.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
 
     // スタティックサンプラ( s0 )
-    D3D12_STATIC_SAMPLER_DESC sampler = {};
-    sampler.Filter                    = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
-    sampler.AddressU                  = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
-    sampler.AddressV                  = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
-    sampler.AddressW                  = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
-    sampler.MipLODBias                = 0;
-    sampler.MaxAnisotropy             = 0;
-    sampler.ComparisonFunc            = D3D12_COMPARISON_FUNC_NEVER;
-    sampler.BorderColor               = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
-    sampler.MinLOD                    = 0.0f;
-    sampler.MaxLOD                    = D3D12_FLOAT32_MAX;
-    sampler.ShaderRegister            = 0;
-    sampler.RegisterSpace             = 0;
-    sampler.ShaderVisibility          = D3D12_SHADER_VISIBILITY_ALL;
+    const auto sampler = defaultSampler();
 
     // ルートパラメータ
     constexpr auto       paramNum                         = 3;
@@ -100,10 +146,74 @@ bool RootSignature::create() noexcept {
     rootSignatureDesc.NumStaticSamplers         = 1;
     rootSignatureDesc.pStaticSamplers           = &sampler;
     rootSignatureDesc.Flags                     = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+
+    return create(rootSignatureDesc);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	バインドレスのルートシグネチャを作成する
+ * @return	作成に成功した場合は true
+ */
+bool RootSignature::createBindless() noexcept {
+    // テクスチャ配列( t0 ~, space1 )、ヒープ全体を参照する
+    D3D12_DESCRIPTOR_RANGE srv            = {};
+    srv.RangeType                         = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    srv.NumDescriptors                    = UINT_MAX;
+    srv.BaseShaderRegister                = 0;
+    srv.RegisterSpace                     = 1;
+    srv.OffsetInDescriptorsFromTableStart = 0;
+
+    // コンスタントバッファ配列( b0 ~, space2 )、ヒープ全体を参照する
+    D3D12_DESCRIPTOR_RANGE cbv            = {};
+    cbv.RangeType                         = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
+    cbv.NumDescriptors                    = UINT_MAX;
+    cbv.BaseShaderRegister                = 0;
+    cbv.RegisterSpace                     = 2;
+    cbv.OffsetInDescriptorsFromTableStart = 0;
+
+    // スタティックサンプラ( s0 )
+    const auto sampler = defaultSampler();
+
+    // ルートパラメータ
+    constexpr auto       paramNum                                            = 3;
+    D3D12_ROOT_PARAMETER rootParameters[paramNum]                            = {};
+    rootParameters[bindlessIndexParameter].ParameterType                     = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParameters[bindlessIndexParameter].ShaderVisibility                  = D3D12_SHADER_VISIBILITY_ALL;
+    rootParameters[bindlessIndexParameter].Constants.ShaderRegister          = 0;
+    rootParameters[bindlessIndexParameter].Constants.RegisterSpace           = 0;
+    rootParameters[bindlessIndexParameter].Constants.Num32BitValues          = bindlessIndexNum;
+    rootParameters[bindlessSrvParameter].ParameterType                       = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParameters[bindlessSrvParameter].ShaderVisibility                    = D3D12_SHADER_VISIBILITY_ALL;
+    rootParameters[bindlessSrvParameter].DescriptorTable.NumDescriptorRanges = 1;
+    rootParameters[bindlessSrvParameter].DescriptorTable.pDescriptorRanges   = &srv;
+    rootParameters[bindlessCbvParameter].ParameterType                       = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParameters[bindlessCbvParameter].ShaderVisibility                    = D3D12_SHADER_VISIBILITY_ALL;
+    rootParameters[bindlessCbvParameter].DescriptorTable.NumDescriptorRanges = 1;
+    rootParameters[bindlessCbvParameter].DescriptorTable.pDescriptorRanges   = &cbv;
+
+    // ルートシグネチャ
+    D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc = {};
+    rootSignatureDesc.NumParameters             = paramNum;
+    rootSignatureDesc.pParameters               = rootParameters;
+    rootSignatureDesc.NumStaticSamplers         = 1;
+    rootSignatureDesc.pStaticSamplers           = &sampler;
+    rootSignatureDesc.Flags                     = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+
+    return create(rootSignatureDesc);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ルートシグネチャをシリアライズして作成する
+ * @param	desc			ルートシグネチャの設定
+ * @return	作成に成功した場合は true
+ */
+bool RootSignature::create(const D3D12_ROOT_SIGNATURE_DESC& desc) noexcept {
     Microsoft::WRL::ComPtr<ID3DBlob> signature;
     Microsoft::WRL::ComPtr<ID3DBlob> error;
 
-    auto res = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, signature.GetAddressOf(), error.GetAddressOf());
+    auto res = D3D12SerializeRootSignature(&desc, D3D_ROOT_SIGNATURE_VERSION_1, signature.GetAddressOf(), error.GetAddressOf());
     if (FAILED(res)) {
         char* p = static_cast<char*>(error->GetBufferPointer());
         ASSERT(false, p);
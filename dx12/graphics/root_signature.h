@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "dx12/command_list.h"
+#include "dx12/descriptor_heap.h"
 #include "utility/noncopyable.h"
 
 namespace dx12::graphics {
@@ -8,14 +9,34 @@ namespace dx12::graphics {
 /**
  * @brief
  * ルートシグネチャ
+ *
+ * Default はオブジェクトごとのディスクリプタテーブル（ b0, b1, t0 ）を設定する
+ * Bindless はヒープ全体を 1 つのテーブルとして設定し、描画ごとにはルート定数でインデックスのみを渡す
+ * （シェーダー側は space1 の Texture2D 配列、 space2 の ConstantBuffer 配列をインデックスで参照する）
  */
 class RootSignature : public utility::Noncopyable {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ルートパラメータの構成
+     */
+    enum class Layout {
+        Default,   ///< オブジェクトごとのディスクリプタテーブル
+        Bindless,  ///< ヒープ全体のテーブルとインデックスのルート定数
+    };
+
+    static constexpr uint32_t bindlessIndexNum       = 16;  ///< Bindless で描画ごとに渡せるインデックス数（ b0 のルート定数）
+    static constexpr uint32_t bindlessIndexParameter = 0;   ///< Bindless のインデックスのルートパラメータ
+    static constexpr uint32_t bindlessSrvParameter   = 1;   ///< Bindless の SRV テーブル（ t0, space1 ）のルートパラメータ
+    static constexpr uint32_t bindlessCbvParameter   = 2;   ///< Bindless の CBV テーブル（ b0, space2 ）のルートパラメータ
+
 public:
     //---------------------------------------------------------------------------------
     /**
      * @brief	コンストラクタ
+     * @param	layout			ルートパラメータの構成
      */
-    RootSignature();
+    explicit RootSignature(Layout layout = Layout::Default);
 
     //---------------------------------------------------------------------------------
     /**
@@ -30,6 +51,23 @@ public:
      */
     void setToCommandList(CommandList& commandList) noexcept;
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ヒープ全体をバインドレスのテーブルとして設定する（ Bindless のみ、ルートシグネチャの設定後に呼び出す）
+     * @param	commandList		設定先のコマンドリスト
+     * @param	descriptorHeap	インデックスの基準となるシェーダーから参照できるヒープ
+     */
+    void setBindlessTable(CommandList& commandList, DescriptorHeap& descriptorHeap) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	描画で参照するディスクリプタのインデックスをルート定数として設定する（ Bindless のみ）
+     * @param	commandList		設定先のコマンドリスト
+     * @param	indices			GpuObj::descriptorIndex で取得したインデックス
+     * @param	num				インデックス数（ bindlessIndexNum 以下）
+     */
+    void setBindlessIndices(CommandList& commandList, const uint32_t* indices, uint32_t num) noexcept;
+
     //---------------------------------------------------------------------------------
     /**
      * @brief	ルートシグネチャを取得する
@@ -40,13 +78,28 @@ public:
 private:
     //---------------------------------------------------------------------------------
     /**
-     * @brief	ルートシグネチャを作成する
+     * @brief	オブジェクトごとのテーブルを設定するルートシグネチャを作成する
+     * @return	作成に成功した場合は true
+     */
+    bool createDefault() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	バインドレスのルートシグネチャを作成する
      * @return	作成に成功した場合は true
      */
-    bool create() noexcept;
+    bool createBindless() noexcept;
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ルートシグネチャをシリアライズして作成する
+     * @param	desc			ルートシグネチャの設定
+     * @return	作成に成功した場合は true
+     */
+    bool create(const D3D12_ROOT_SIGNATURE_DESC& desc) noexcept;
 
 private:
     Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature_{};  ///< ルートシグネチャ
+    Layout                                      layout_{};         ///< ルートパラメータの構成
 };
 }  // namespace dx12::graphics
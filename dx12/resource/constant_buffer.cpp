@@ -1,4 +1,5 @@
 ﻿#include "dx12/resource/constant_buffer.h"
+#include "utility/flight_recorder.h"
 
 namespace {
 
@@ -56,6 +57,7 @@ bool ConstantBufferResource::create(uint32_t stride, uint32_t num) noexcept {
     size_          = num_ * alignedStride_;
 
 	setName("コンスタントバッファ");
+    FLIGHT_RECORD(utility::FlightEvent::ResourceCreate, "ConstantBuffer", size_, num_);
 
     return true;
 }
@@ -5,6 +5,7 @@
 #include "dx12/descriptor_heap.h"
 #include "dx12/resource/gpu_resource.h"
 #include "dx12/resource/gpu_obj.h"
+#include "utility/object_pool.h"
 
 namespace dx12::resource {
 
@@ -63,7 +64,7 @@ public:
     /**
      * @brief	コンストラクタ
      */
-    ConstantBuffer() { resource_.reset(new ConstantBufferResource()); }
+    ConstantBuffer() { resource_ = utility::makePooled<ConstantBufferResource>(); }
 
     //---------------------------------------------------------------------------------
     /**
@@ -72,10 +73,9 @@ public:
     ConstantBuffer(ConstantBuffer&& src) noexcept {
         resource_ = std::move(src.resource_);
         data_     = src.data_;
-        handle_   = src.handle_;
+        moveView(src);
 
-        src.data_   = {};
-        src.handle_ = {};
+        src.data_ = {};
     }
 
     //---------------------------------------------------------------------------------
@@ -105,14 +105,16 @@ public:
     }
 
 public:
+    using GpuObj::createView;
+
     //---------------------------------------------------------------------------------
     /**
      * @brief	ビューを生成する
      * @param	descriptorHeap	ビュー（ディスクリプタ）登録先のヒープ
      */
     void createView(DescriptorHeap& descriptorHeap) noexcept override final {
-        // ヒープ登録ハンドルを取得する
-        handle_ = descriptorHeap.allocate(resource_->num());
+        // ヒープ登録ハンドルを取得する（作り直す場合、以前のものはフェンスの完了後に返す）
+        allocateView(descriptorHeap, resource_->num());
 
         for (auto i = 0; i < resource_->num(); ++i) {
             D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc{};
@@ -132,9 +134,7 @@ public:
      * @param	args					コマンドリスト設定時の引数
      */
     void setToCommandList(CommandList& commandList, const Args& args) noexcept override final {
-        D3D12_GPU_DESCRIPTOR_HANDLE handle{};
-        handle.ptr = handle_.gpuHandle_.ptr + (args.handleIndex_ * handle_.incrementSize_);
-        commandList.get()->SetGraphicsRootDescriptorTable(args.rootParameterIndex_, handle);
+        commandList.get()->SetGraphicsRootDescriptorTable(args.rootParameterIndex_, gpuTable(args.handleIndex_));
     }
 
 private:
@@ -148,8 +148,7 @@ private:
     }
 
 private:
-    std::unique_ptr<ConstantBufferResource> resource_{};  ///< コンスタントバッファGPUリソース
-    type*                                   data_{};      ///< CPUで内容を変更する際のアクセス先アドレス
-    DescriptorHeap::Handle                  handle_{};    ///< ヒープ登録ハンドル
+    utility::PoolPtr<ConstantBufferResource> resource_{};  ///< コンスタントバッファGPUリソース
+    type*                                    data_{};      ///< CPUで内容を変更する際のアクセス先アドレス
 };
 }  // namespace dx12::resource
@@ -1,6 +1,7 @@
 ﻿#include "dx12/resource/depth_stencil.h"
 
 #include "window/window.h"
+#include "utility/flight_recorder.h"
 
 namespace dx12::resource {
 
@@ -43,6 +44,8 @@ bool DepthStencilResource::create() noexcept {
         return false;
     }
 
+    FLIGHT_RECORD(utility::FlightEvent::ResourceCreate, "DepthStencil", resourceDesc.Width, resourceDesc.Height);
+
     return true;
 }
 
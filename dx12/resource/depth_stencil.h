@@ -3,6 +3,7 @@
 #include "dx12/command_list.h"
 #include "utility/noncopyable.h"
 #include "dx12/resource/gpu_resource.h"
+#include "utility/object_pool.h"
 
 namespace dx12::resource {
 
@@ -44,7 +45,7 @@ public:
     /**
      * @brief	コンストラクタ
      */
-    DepthStencil() { resource_ = std::make_unique<DepthStencilResource>(); }
+    DepthStencil() { resource_ = utility::makePooled<DepthStencilResource>(); }
 
     //---------------------------------------------------------------------------------
     /**
@@ -74,8 +75,8 @@ public:
     [[nodiscard]] D3D12_CPU_DESCRIPTOR_HANDLE view() noexcept;
 
 private:
-    DescriptorHeap                        heap_{};      ///< ディスクリプタヒープ
-    DescriptorHeap::Handle                handle_{};    ///< ヒープ登録ハンドル
-    std::unique_ptr<DepthStencilResource> resource_{};  ///< リソース
+    DescriptorHeap                         heap_{};      ///< ディスクリプタヒープ
+    DescriptorHeap::Handle                 handle_{};    ///< ヒープ登録ハンドル
+    utility::PoolPtr<DepthStencilResource> resource_{};  ///< リソース
 };
 }  // namespace dx12::resource
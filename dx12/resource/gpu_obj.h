@@ -3,6 +3,8 @@
 #include "dx12/device.h"
 #include "dx12/command_list.h"
 #include "dx12/descriptor_heap.h"
+#include "dx12/frame_descriptors.h"
+#include "dx12/swap_chain.h"
 #include "utility/noncopyable.h"
 
 namespace dx12::resource {
@@ -11,6 +13,11 @@ namespace dx12::resource {
 /**
  * @brief
  * GPU オブジェクト
+ *
+ * ビューのディスクリプタは createView で指定したヒープから確保し、作り直しと破棄の際に
+ * 現在のフレームのフェンス値（ SwapChain::frameFenceValue ）の完了後に返す（ GPU が参照中のディスクリプタを上書きしない）
+ * ヒープを指定しない場合は FrameDescriptors のステージングヒープに作成し、
+ * 設定時にフレームのリングへコピーしたテーブルを使う
  */
 class GpuObj : public utility::Noncopyable {
 public:
@@ -33,9 +40,11 @@ public:
 
     //---------------------------------------------------------------------------------
     /**
-     * @brief	デストラクタ
+     * @brief	デストラクタ（ビューのディスクリプタをフェンスの完了後にヒープに返す）
      */
-    virtual ~GpuObj() = default;
+    virtual ~GpuObj() {
+        releaseView();
+    }
 
 public:
     //---------------------------------------------------------------------------------
@@ -45,6 +54,14 @@ public:
      */
     virtual void createView(DescriptorHeap& descriptorHeap) noexcept = 0;
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	FrameDescriptors のステージングヒープにビューを生成する
+     */
+    void createView() noexcept {
+        createView(FrameDescriptors::instance().stagingHeap());
+    }
+
     //---------------------------------------------------------------------------------
     /**
      * @brief	コマンドリストに設定する
@@ -52,5 +69,97 @@ public:
      * @param	args					コマンドリスト設定時の引数
      */
     virtual void setToCommandList(CommandList& commandList, const Args& args) noexcept = 0;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ビューを参照するコマンドの完了時にシグナルされるフェンス値を設定する
+     *
+     * setToCommandList では自動で設定する
+     * 破棄より後のフレームで完了するコマンドから参照する場合のみ、そのフェンス値を設定する
+     * @param	fenceValue		SwapChain::frameFence のフェンス値
+     */
+    void setFenceValue(uint64_t fenceValue) noexcept {
+        fenceValue_ = std::max(fenceValue_, fenceValue);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ビューを破棄し、現在のフレームのコマンドが完了した後にディスクリプタをヒープに返す
+     *
+     * バインドレスで descriptorIndex を渡したコマンドも、現在のフレーム以前のものなので完了を待てる
+     */
+    void releaseView() {
+        if (heap_) {
+            heap_->free(handle_, std::max(fenceValue_, SwapChain::instance().frameFenceValue()));
+        }
+        heap_   = nullptr;
+        handle_ = {};
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	バインドレス描画でシェーダーに渡すディスクリプタのインデックスを取得する
+     * @param	handleIndex		ディスクリプタを複数持つ場合の番号
+     * @return	ヒープ先頭からのインデックス（ビューを破棄するまで変わらない）
+     */
+    [[nodiscard]] uint32_t descriptorIndex(uint32_t handleIndex = 0) const noexcept {
+        ASSERT(handle_.valid() && handleIndex < handle_.allocation_.num_, "ビューが生成されていません");
+        return handle_.index_ + handleIndex;
+    }
+
+protected:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ディスクリプタテーブルとして設定する GPU ハンドルを取得する
+     *
+     * ステージングヒープのビューは、 FrameDescriptors のキャッシュかリングにコピーしたテーブルを返す
+     * 現在のフレームで参照するので、ビューのフェンス値を現在のフレームの値に進める
+     * @param	handleIndex		ディスクリプタを複数持つ場合の番号
+     * @return	GPU ハンドル（キャッシュにもリングにも置けない場合は ptr が 0 ）
+     */
+    [[nodiscard]] D3D12_GPU_DESCRIPTOR_HANDLE gpuTable(uint32_t handleIndex) noexcept {
+        setFenceValue(SwapChain::instance().frameFenceValue());
+
+        const auto offset = static_cast<SIZE_T>(handleIndex) * handle_.incrementSize_;
+        if (heap_ && !heap_->shaderVisible()) {
+            D3D12_CPU_DESCRIPTOR_HANDLE source{handle_.cpuHandle_.ptr + offset};
+            return FrameDescriptors::instance().table(&source, 1).gpuHandle_;
+        }
+        return {handle_.gpuHandle_.ptr + offset};
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ビューのディスクリプタを確保する（確保済みのものはフェンスの完了後に返す）
+     * @param	descriptorHeap	ビュー（ディスクリプタ）登録先のヒープ
+     * @param	num				ディスクリプタ数
+     */
+    void allocateView(DescriptorHeap& descriptorHeap, uint32_t num) {
+        releaseView();
+        handle_ = descriptorHeap.allocate(num);
+        if (handle_.valid()) {
+            heap_ = &descriptorHeap;
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ビューのディスクリプタの所有権を移す（移動元は空になる）
+     * @param	src		移動元
+     */
+    void moveView(GpuObj& src) {
+        releaseView();
+        handle_     = src.handle_;
+        heap_       = src.heap_;
+        fenceValue_ = std::max(fenceValue_, src.fenceValue_);
+
+        src.handle_ = {};
+        src.heap_   = nullptr;
+    }
+
+protected:
+    DescriptorHeap::Handle handle_{};      ///< ヒープ登録ハンドル
+    DescriptorHeap*        heap_{};        ///< handle_ を確保したヒープ
+    uint64_t               fenceValue_{};  ///< ビューを参照するコマンドの完了時にシグナルされるフェンス値
 };
 }  // namespace dx12::resource
@@ -1,5 +1,6 @@
 ﻿#include "dx12/resource/mesh.h"
 #include "dx12/device.h"
+#include "utility/flight_recorder.h"
 
 namespace dx12::resource {
 
@@ -47,6 +48,7 @@ bool VertexBufferResource::create(uint32_t stride, uint32_t num) noexcept {
     size_          = num_ * alignedStride_;
 
     setName("頂点バッファ");
+    FLIGHT_RECORD(utility::FlightEvent::ResourceCreate, "VertexBuffer", size_, num_);
 
     return true;
 }
@@ -95,6 +97,7 @@ bool IndexBufferResource::create(uint32_t stride, uint32_t num) noexcept {
     size_          = num_ * alignedStride_;
 
     setName("インデックスバッファ");
+    FLIGHT_RECORD(utility::FlightEvent::ResourceCreate, "IndexBuffer", size_, num_);
 
     return true;
 }
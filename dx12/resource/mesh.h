@@ -2,7 +2,9 @@
 
 #include "dx12/command_list.h"
 #include "dx12/resource/gpu_resource.h"
+#include "utility/alloc_counter.h"
 #include "utility/noncopyable.h"
+#include "utility/object_pool.h"
 
 namespace dx12::resource {
 
@@ -76,8 +78,9 @@ public:
      * @brief	コンストラクタ
      */
     Mesh() {
-        vertexBufferResource_.reset(new VertexBufferResource());
-        indexBufferResource_.reset(new IndexBufferResource());
+        MEMORY_TAG(utility::alloc::MemoryTag::Mesh);
+        vertexBufferResource_ = utility::makePooled<VertexBufferResource>();
+        indexBufferResource_  = utility::makePooled<IndexBufferResource>();
     }
 
     //---------------------------------------------------------------------------------
@@ -182,8 +185,8 @@ private:
     void setIndexData(void* data) noexcept;
 
 private:
-    std::unique_ptr<VertexBufferResource> vertexBufferResource_{};  ///< 頂点バッファリソース
-    std::unique_ptr<IndexBufferResource>  indexBufferResource_{};   ///< インデックスバッファリソース
+    utility::PoolPtr<VertexBufferResource> vertexBufferResource_{};  ///< 頂点バッファリソース
+    utility::PoolPtr<IndexBufferResource>  indexBufferResource_{};   ///< インデックスバッファリソース
 
     D3D12_VERTEX_BUFFER_VIEW vertexView_{};  ///< 頂点バッファビュー
     D3D12_INDEX_BUFFER_VIEW  indexView_{};   ///< インデックスバッファビュー
@@ -112,7 +112,7 @@ void RenderTarget::finishRendering(CommandList& commandList) noexcept {
  * @param	descriptorHeap	ビュー（ディスクリプタ）登録先のヒープ
  */
 void RenderTarget::createView(DescriptorHeap& descriptorHeap) noexcept {
-    handle_ = descriptorHeap.allocate(1);
+    allocateView(descriptorHeap, 1);
 
     D3D12_SHADER_RESOURCE_VIEW_DESC sdesc = {};
     sdesc.Shader4ComponentMapping         = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
@@ -130,7 +130,7 @@ void RenderTarget::createView(DescriptorHeap& descriptorHeap) noexcept {
  * @param	args					コマンドリスト設定時の引数
  */
 void RenderTarget::setToCommandList(CommandList& commandList, const Args& agrs) noexcept {
-    commandList.get()->SetGraphicsRootDescriptorTable(agrs.rootParameterIndex_, handle_.gpuHandle_);
+    commandList.get()->SetGraphicsRootDescriptorTable(agrs.rootParameterIndex_, gpuTable(0));
 }
 
 }  // namespace dx12::resource
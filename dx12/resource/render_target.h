@@ -5,6 +5,7 @@
 #include "dx12/resource/texture.h"
 #include "utility/noncopyable.h"
 #include "dx12/resource/gpu_obj.h"
+#include "utility/object_pool.h"
 
 namespace dx12::resource {
 
@@ -19,7 +20,7 @@ public:
     /**
      * @brief    コンストラクタ
      */
-    RenderTarget() { resource_ = std::make_unique<TextureResource>(); }
+    RenderTarget() { resource_ = utility::makePooled<TextureResource>(); }
 
     //---------------------------------------------------------------------------------
     /**
@@ -52,6 +53,8 @@ public:
     void finishRendering(CommandList& commandList) noexcept;
 
 public:
+    using GpuObj::createView;
+
     //---------------------------------------------------------------------------------
     /**
      * @brief	ビューを生成する
@@ -69,8 +72,7 @@ public:
 
 
 public:
-    std::unique_ptr<TextureResource> resource_{};  ///< リソース
-    DescriptorHeap::Handle           handle_{};    ///< ヒープ登録ハンドル
+    utility::PoolPtr<TextureResource> resource_{};  ///< リソース
 
     dx12::DescriptorHeap   rtvDescriptorHeap_{};  ///< RTV用ディスクリプタヒープ
     DescriptorHeap::Handle rtvHandle_{};          ///< RTV用ヒープ登録ハンドル
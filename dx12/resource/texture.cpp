@@ -1,11 +1,75 @@
 ﻿#include "dx12/resource/texture.h"
 #include "dx12/command_queue.h"
 #include "dx12/fence.h"
+#include "utility/alloc_counter.h"
+#include "utility/flight_recorder.h"
 #include "../file_loader/texture/WICTextureLoader12.h"
 #include "../file_loader/texture/d3dx12.h"
 
 namespace dx12::resource {
 
+namespace {
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * テクスチャの転送で共有するコマンドキュー
+ *
+ * 転送ごとにキューとフェンスを作らず、投入ごとにフェンス値を 1 つ進めて完了を判定する
+ * 転送コマンドはリソースを PIXEL_SHADER_RESOURCE に遷移させるので DIRECT キューを使う
+ */
+class UploadQueue final : public utility::Noncopyable {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	共有のキューを取得する（初回の呼び出しで作成する）
+     */
+    static UploadQueue& instance() {
+        static UploadQueue queue;
+        return queue;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	記録済みのコマンドリストを投入する
+     * @param	commandList		閉じたコマンドリスト
+     * @return	転送の完了時にシグナルされるフェンス値
+     */
+    uint64_t submit(CommandList& commandList) noexcept {
+        std::array<ID3D12CommandList*, 1> lists = {commandList.get()};
+
+        // 投入とシグナルの順序がフェンス値の順序と一致するようにまとめてロックする
+        std::lock_guard<std::mutex> lock(mutex_);
+        commandQueue_.execute(lists.data(), static_cast<uint32_t>(lists.size()));
+        commandQueue_.signal(fence_, ++fenceValue_);
+        return fenceValue_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	完了の判定に使うフェンスを取得する
+     */
+    [[nodiscard]] const Fence& fence() const noexcept {
+        return fence_;
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    UploadQueue() {
+        commandQueue_.create();
+        fence_.create();
+    }
+
+private:
+    CommandQueue commandQueue_{};  ///< 転送用のコマンドキュー
+    Fence        fence_{};         ///< 転送の完了を判定するフェンス
+    uint64_t     fenceValue_{};    ///< 最後にシグナルしたフェンス値
+    std::mutex   mutex_{};         ///< 投入の同期オブジェクト
+};
+}  // namespace
+
 //---------------------------------------------------------------------------------
 /**
  * @brief	テクスチャをファイルから作成する
@@ -16,60 +80,20 @@ bool TextureResource::create(std::string_view path) noexcept {
     D3D12_SUBRESOURCE_DATA     subRes{};
     std::unique_ptr<uint8_t[]> decodedData{};
 
-    // GPUリソースの作成とファイルの読み込み
-    {
-        auto temp = std::wstring(path.begin(), path.end());
-
-        // D3D12_RESOURCE_STATE_COPY_DEST の CreateCommittedResource は LoadWICTextureFromFile 内で処理されている
-        auto res = DirectX::LoadWICTextureFromFile(Device::instance().device(), temp.data(),
-                                                   gpuResource_.GetAddressOf(), decodedData, subRes);
-        if (FAILED(res)) {
-            ASSERT(false, "テクスチャ読み込みと生成に失敗");
-        }
-
-        resourcesDesc_ = gpuResource_->GetDesc();
-
-        alignedStride_ = subRes.RowPitch;
-        num_           = resourcesDesc_.Height;
-        size_          = num_ * alignedStride_;
+    if (!load(path, decodedData, subRes)) {
+        return false;
     }
 
     // 上記で作成したGPUメモリ上のリソース（GPUリソース）へ読み込んだデータを転送する
     {
-        CommandList  uploadCommandList{};
-        CommandQueue commandQueue{};
-        Fence        fence{};
-
+        CommandList uploadCommandList{};
         uploadCommandList.create();
-        commandQueue.create();
-        fence.create();
 
         Microsoft::WRL::ComPtr<ID3D12Resource> stagingTexture;
+        upload(uploadCommandList, stagingTexture, subRes);
 
-        auto   bufferSize = GetRequiredIntermediateSize(gpuResource_.Get(), 0, 1);
-        auto&& upload     = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-        auto&& buffer     = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
-        Device::instance().device()->CreateCommittedResource(
-            &upload, D3D12_HEAP_FLAG_NONE,
-            &buffer, D3D12_RESOURCE_STATE_GENERIC_READ,
-            nullptr, IID_PPV_ARGS(stagingTexture.GetAddressOf()));
-
-        uploadCommandList.reset();
-        UpdateSubresources(uploadCommandList.get(), gpuResource_.Get(), stagingTexture.Get(), 0, 0, 1, &subRes);
-        auto&& barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            gpuResource_.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-        uploadCommandList.get()->ResourceBarrier(1, &barrier);
-        uploadCommandList.get()->Close();
-        std::array<ID3D12CommandList*, 1> lists = {uploadCommandList.get()};
-        commandQueue.get()->ExecuteCommandLists(1, static_cast<ID3D12CommandList**>(lists.data()));
-
-        fence.get()->Signal(0);
-        commandQueue.get()->Signal(fence.get(), 1);
-
-        auto event = CreateEvent(nullptr, false, false, "WAIT_GPU");
-        fence.get()->SetEventOnCompletion(1, event);
-        WaitForSingleObject(event, INFINITE);
-        CloseHandle(event);
+        auto& uploadQueue = UploadQueue::instance();
+        uploadQueue.fence().wait(uploadQueue.submit(uploadCommandList));
     }
 
     setName(path.data());
@@ -77,6 +101,38 @@ bool TextureResource::create(std::string_view path) noexcept {
     return true;
 }
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief	テクスチャをファイルから非同期に読み込む
+ * @param	path				ファイルパス
+ * @return	成功した場合は true を返すタスク
+ */
+utility::Task<bool> TextureResource::createAsync(std::string path) {
+    // 呼び出し元のスレッドに関わらず、読み込みとデコードはワーカー上で行う
+    co_await utility::schedule();
+
+    D3D12_SUBRESOURCE_DATA     subRes{};
+    std::unique_ptr<uint8_t[]> decodedData{};
+
+    if (!load(path, decodedData, subRes)) {
+        co_return false;
+    }
+
+    // 転送に使うオブジェクトはフェンス到達までコルーチンフレーム上に保持される
+    CommandList                            uploadCommandList{};
+    Microsoft::WRL::ComPtr<ID3D12Resource> stagingTexture;
+
+    uploadCommandList.create();
+    upload(uploadCommandList, stagingTexture, subRes);
+
+    auto& uploadQueue = UploadQueue::instance();
+    co_await utility::waitFence(uploadQueue.fence(), uploadQueue.submit(uploadCommandList));
+
+    setName(path);
+
+    co_return true;
+}
+
 //---------------------------------------------------------------------------------
 /**
  * @brief    テクスチャを引数から作成する
@@ -125,18 +181,75 @@ bool TextureResource::create(uint32_t w, uint32_t h, uint32_t mipLevel, uint32_t
     size_          = num_ * alignedStride_;
 
     setName("テクスチャ");
+    FLIGHT_RECORD(utility::FlightEvent::ResourceCreate, "Texture", size_, num_);
 
     return true;
 }
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ファイルを読み込み GPU リソースを作成する
+ * @param	path				ファイルパス
+ * @param	decodedData			デコード済みデータの格納先
+ * @param	subRes				転送元サブリソースの格納先
+ * @return	成功した場合は true
+ */
+bool TextureResource::load(std::string_view path, std::unique_ptr<uint8_t[]>& decodedData, D3D12_SUBRESOURCE_DATA& subRes) noexcept {
+    MEMORY_TAG(utility::alloc::MemoryTag::Texture);
+    auto temp = std::wstring(path.begin(), path.end());
+
+    // D3D12_RESOURCE_STATE_COPY_DEST の CreateCommittedResource は LoadWICTextureFromFile 内で処理されている
+    auto res = DirectX::LoadWICTextureFromFile(Device::instance().device(), temp.data(),
+                                               gpuResource_.GetAddressOf(), decodedData, subRes);
+    if (FAILED(res)) {
+        ASSERT(false, "テクスチャ読み込みと生成に失敗");
+        return false;
+    }
+
+    resourcesDesc_ = gpuResource_->GetDesc();
+
+    alignedStride_ = subRes.RowPitch;
+    num_           = resourcesDesc_.Height;
+    size_          = num_ * alignedStride_;
+
+    FLIGHT_RECORD(utility::FlightEvent::ResourceCreate, "Texture", size_, num_);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	転送コマンドを記録する
+ * @param	commandList			記録に利用するコマンドリスト（閉じた状態で戻る）
+ * @param	stagingTexture		転送元バッファの格納先（転送完了まで保持すること）
+ * @param	subRes				転送元サブリソース
+ */
+void TextureResource::upload(CommandList& commandList, Microsoft::WRL::ComPtr<ID3D12Resource>& stagingTexture,
+                             const D3D12_SUBRESOURCE_DATA& subRes) noexcept {
+    auto   bufferSize = GetRequiredIntermediateSize(gpuResource_.Get(), 0, 1);
+    auto&& upload     = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    auto&& buffer     = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
+    Device::instance().device()->CreateCommittedResource(
+        &upload, D3D12_HEAP_FLAG_NONE,
+        &buffer, D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr, IID_PPV_ARGS(stagingTexture.GetAddressOf()));
+
+    commandList.reset();
+    UpdateSubresources(commandList.get(), gpuResource_.Get(), stagingTexture.Get(), 0, 0, 1, &subRes);
+    auto&& barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+        gpuResource_.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    commandList.get()->ResourceBarrier(1, &barrier);
+    commandList.get()->Close();
+}
+
 //---------------------------------------------------------------------------------
 /**
  * @brief	ビューを生成する
  * @param	descriptorHeap	ビュー（ディスクリプタ）登録先のヒープ
  */
 void Texture::createView(DescriptorHeap& descriptorHeap) noexcept {
-    // ヒープ登録ハンドルを取得する
-    handle_ = descriptorHeap.allocate(1);
+    // ヒープ登録ハンドルを取得する（作り直す場合、以前のものはフェンスの完了後に返す）
+    allocateView(descriptorHeap, 1);
 
     D3D12_SHADER_RESOURCE_VIEW_DESC sdesc = {};
     sdesc.Shader4ComponentMapping         = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
@@ -154,7 +267,7 @@ void Texture::createView(DescriptorHeap& descriptorHeap) noexcept {
  * @param	args					コマンドリスト設定時の引数
  */
 void Texture::setToCommandList(CommandList& commandList, const Args& args) noexcept {
-    commandList.get()->SetGraphicsRootDescriptorTable(args.rootParameterIndex_, handle_.gpuHandle_);
+    commandList.get()->SetGraphicsRootDescriptorTable(args.rootParameterIndex_, gpuTable(0));
 }
 
 }  // namespace dx12::resource
@@ -3,9 +3,12 @@
 #include "dx12/command_list.h"
 #include "utility/noncopyable.h"
 #include "dx12/command_list.h"
+#include "dx12/command_queue.h"
 #include "dx12/descriptor_heap.h"
 #include "dx12/resource/gpu_resource.h"
 #include "dx12/resource/gpu_obj.h"
+#include "utility/coroutine.h"
+#include "utility/object_pool.h"
 
 namespace dx12::resource {
 
@@ -36,6 +39,17 @@ public:
      */
     bool create(std::string_view path) noexcept;
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	テクスチャをファイルから非同期に読み込む
+     *
+     * 読み込みはワーカー上で行い、転送は共有の転送キューに投入して完了をスレッドをブロックせずにフェンスで待機する
+     * 完了までリソースを破棄しないこと
+     * @param	path				ファイルパス
+     * @return	成功した場合は true を返すタスク
+     */
+    [[nodiscard]] utility::Task<bool> createAsync(std::string path);
+
     //---------------------------------------------------------------------------------
     /**
      * @brief    テクスチャを引数から作成する
@@ -47,6 +61,27 @@ public:
      * @return    成功した場合は true
      */
     bool create(uint32_t w, uint32_t h, uint32_t mipLevel, uint32_t arraySize, DXGI_FORMAT format, const float color[4] = {}) noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ファイルを読み込み GPU リソースを作成する
+     * @param	path				ファイルパス
+     * @param	decodedData			デコード済みデータの格納先
+     * @param	subRes				転送元サブリソースの格納先
+     * @return	成功した場合は true
+     */
+    bool load(std::string_view path, std::unique_ptr<uint8_t[]>& decodedData, D3D12_SUBRESOURCE_DATA& subRes) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	転送コマンドを記録する
+     * @param	commandList			記録に利用するコマンドリスト（閉じた状態で戻る）
+     * @param	stagingTexture		転送元バッファの格納先（転送完了まで保持すること）
+     * @param	subRes				転送元サブリソース
+     */
+    void upload(CommandList& commandList, Microsoft::WRL::ComPtr<ID3D12Resource>& stagingTexture,
+                const D3D12_SUBRESOURCE_DATA& subRes) noexcept;
 };
 
 //---------------------------------------------------------------------------------
@@ -60,7 +95,7 @@ public:
     /**
      * @brief	コンストラクタ
      */
-    Texture() { resource_ = std::make_unique<TextureResource>(); }
+    Texture() { resource_ = utility::makePooled<TextureResource>(); }
 
     //---------------------------------------------------------------------------------
     /**
@@ -68,7 +103,7 @@ public:
      */
     Texture(Texture&& src) {
         resource_ = std::move(src.resource_);
-        handle_   = src.handle_;
+        moveView(src);
     }
 
     //---------------------------------------------------------------------------------
@@ -87,6 +122,16 @@ public:
         return resource_->create(path);
     }
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	テクスチャをファイルから非同期に読み込む
+     * @param	path				ファイルパス
+     * @return	成功した場合は true を返すタスク
+     */
+    [[nodiscard]] utility::Task<bool> createAsync(std::string path) {
+        return resource_->createAsync(std::move(path));
+    }
+
     //---------------------------------------------------------------------------------
     /**
      * @brief    テクスチャを引数から作成する
@@ -101,6 +146,8 @@ public:
     }
 
 public:
+    using GpuObj::createView;
+
     //---------------------------------------------------------------------------------
     /**
      * @brief	ビューを生成する
@@ -117,8 +164,7 @@ public:
     void setToCommandList(CommandList& commandList, const Args& args) noexcept override final;
 
 private:
-    std::unique_ptr<TextureResource> resource_{};  ///< リソース
-    DescriptorHeap::Handle           handle_{};    ///< ヒープ登録ハンドル
+    utility::PoolPtr<TextureResource> resource_{};  ///< リソース
 };
 
 }  // namespace dx12::resource
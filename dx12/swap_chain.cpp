@@ -1,7 +1,13 @@
 ﻿#include "dx12/swap_chain.h"
 #include "dx12/device.h"
+#include "dx12/descriptor_heap.h"
+#include "dx12/frame_descriptors.h"
 
 #include "window/window.h"
+#include "input/input.h"
+#include "utility/coroutine.h"
+#include "utility/profiler.h"
+#include "utility/flight_recorder.h"
 
 #pragma comment(lib, "d3d12.lib")
 
@@ -37,11 +43,17 @@ public:
      */
     bool create(const CommandQueue& commandQueue, resource::FrameBuffer& frameBuffer) noexcept {
         frameBufferNum_ = frameBuffer.bufferNum();
+        commandQueue_   = &commandQueue;
 
         if (!createSwapChain(commandQueue)) {
             return false;
         }
 
+        if (!frameFence_.create()) {
+            ASSERT(false, "フレームのフェンス作成に失敗");
+            return false;
+        }
+
         if (!setFrameBuffer(frameBuffer)) {
             return false;
         }
@@ -58,6 +70,22 @@ public:
         return swapChain_->GetCurrentBackBufferIndex();
     }
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームの終端でシグナルするフェンスを取得する
+     */
+    const Fence& frameFence() const noexcept {
+        return frameFence_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	現在のフレームのコマンドの完了時にシグナルされるフェンス値を取得する
+     */
+    uint64_t frameFenceValue() const noexcept {
+        return frameFenceValue_.load(std::memory_order_acquire);
+    }
+
     //---------------------------------------------------------------------------------
     /**
      * @brief	プレゼンテーション
@@ -71,6 +99,11 @@ public:
         const auto sync = 1;  // VSync を有効にする（モニター依存）
         const auto flag = 0;
         swapChain_->Present(sync, flag);
+        FLIGHT_RECORD(utility::FlightEvent::Present, "SwapChain", swapChain_->GetCurrentBackBufferIndex());
+
+        // このフレームで投入したコマンドの完了を示す値をシグナルし、次のフレームの値に進める
+        commandQueue_->signal(frameFence_, frameFenceValue_.load(std::memory_order_relaxed));
+        frameFenceValue_.fetch_add(1, std::memory_order_acq_rel);
     }
 
 private:
@@ -126,8 +159,11 @@ private:
     }
 
 private:
-    ComPtr<IDXGISwapChain3> swapChain_      = {};  ///< スワップチェイン
-    uint32_t                frameBufferNum_ = {};  ///< フレームバッファの数
+    ComPtr<IDXGISwapChain3> swapChain_       = {};   ///< スワップチェイン
+    uint32_t                frameBufferNum_  = {};   ///< フレームバッファの数
+    const CommandQueue*     commandQueue_    = {};   ///< フレームのフェンスをシグナルするコマンドキュー
+    Fence                   frameFence_      = {};   ///< フレームの終端でシグナルするフェンス
+    std::atomic<uint64_t>   frameFenceValue_ = {1};  ///< 現在のフレームの終端でシグナルするフェンス値
 };
 
 //---------------------------------------------------------------------------------
@@ -158,12 +194,49 @@ uint32_t SwapChain::currentBufferIndex() const noexcept {
     return impl_->currentBufferIndex();
 }
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームの終端でシグナルするフェンスを取得する
+ */
+const Fence& SwapChain::frameFence() const noexcept {
+    return impl_->frameFence();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	現在のフレームのコマンドの完了時にシグナルされるフェンス値を取得する
+ */
+uint64_t SwapChain::frameFenceValue() const noexcept {
+    return impl_->frameFenceValue();
+}
+
 //---------------------------------------------------------------------------------
 /**
  * @brief	プレゼンテーション
  */
 void SwapChain::present() noexcept {
-    impl_->present();
+    {
+        PROFILE_SCOPE("SwapChain::present");
+        impl_->present();
+    }
+
+    // スコープの回収、 TIME_PRINT の集計、アロケーション統計、フライトレコーダへの記録をフレーム単位で行う
+    PROFILE_FRAME();
+
+    // フレームのテーブルのリングを区切り、 GPU が完了したフレームで遅延解放したディスクリプタを回収する
+    // （ impl_->present でフェンス値は次のフレームに進んでいるので、終了したフレームの値は 1 つ前）
+    if (auto* frameDescriptors = FrameDescriptors::pointer()) {
+        frameDescriptors->endFrame(impl_->frameFenceValue() - 1, impl_->frameFence());
+    }
+    dx12::DescriptorHeap::reclaimAll(impl_->frameFence());
+
+    // 次のフレームで参照する入力状態を確定する
+    input::Input::instance().update();
+
+    // フェンスに到達したコルーチンと次フレーム待ちのコルーチンをワーカー上で再開する
+    auto& scheduler = utility::CoroutineScheduler::instance();
+    scheduler.poll();
+    scheduler.advanceFrame();
 }
 
 //---------------------------------------------------------------------------------
@@ -37,9 +37,26 @@ public:
      */
     [[nodiscard]] uint32_t currentBufferIndex() const noexcept;
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームの終端でシグナルするフェンスを取得する
+     */
+    [[nodiscard]] const Fence& frameFence() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	現在のフレームのコマンドの完了時にシグナルされるフェンス値を取得する
+     *
+     * 現在のフレームで GPU が参照するものは、この値でフェンス付きの解放を行う
+     */
+    [[nodiscard]] uint64_t frameFenceValue() const noexcept;
+
     //---------------------------------------------------------------------------------
     /**
      * @brief	プレゼンテーション
+     *
+     * フレームの終端として、フレームのフェンスをシグナルし、プロファイラのフレームを区切り、
+     * 完了済みのディスクリプタを回収して、次のフレームの入力状態を更新し、待機中のコルーチンを再開する
      */
     void present() noexcept;
 
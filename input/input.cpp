@@ -1,6 +1,14 @@
 ﻿#include "input.h"
 
+#include "utility/ring_buffer.h"
+
 namespace input {
+
+namespace {
+constexpr uint32_t eventCapacity = 1024;  ///< 1 フレームで溜められるイベント数
+constexpr uint32_t eventBatchNum = 64;    ///< 1 回の取り出しでまとめて取り出すイベント数
+}  // namespace
+
 //---------------------------------------------------------------------------------
 /**
  * @brief
@@ -8,8 +16,8 @@ namespace input {
  */
 class Input::Impl {
 public:
-    byte              keyState_[256] = {};  ///< ハードから設定されたキー情報配列
-    std::shared_mutex mtx_           = {};  ///< 同期オブジェクト
+    utility::MpmcRingBuffer<Event, eventCapacity> events_{};    ///< 未反映の入力イベント
+    InputSnapshot                                 snapshot_{};  ///< フレームの入力状態
 
 public:
     //---------------------------------------------------------------------------------
@@ -26,23 +34,31 @@ public:
 
     //---------------------------------------------------------------------------------
     /**
-     * @brief	キー情報の取得
-     * @param	key		キーの識別子
-     * @return	入力されていればtrue
+     * @brief	入力イベントを追加する
+     * @param	event		入力イベント
+     * @return	キューが満杯で追加できなかった場合は false
      */
-    bool getKey(uint16_t sKey) noexcept {
-        std::shared_lock<decltype(mtx_)> lock(mtx_);
-        return (keyState_[sKey] & 0x80);
+    bool pushEvent(const Event& event) noexcept {
+        if (!events_.push(event)) {
+            TRACE("入力イベントのキューが満杯のため破棄しました : type [ %d ]", static_cast<int32_t>(event.type_));
+            return false;
+        }
+        return true;
     }
 
     //---------------------------------------------------------------------------------
     /**
-     * @brief	キー情報の更新
-     * @param	pState		ハードから設定されたキー情報配列のポインタ
+     * @brief	届いているイベントを反映してフレームの入力状態を更新する
      */
-    void updateKeyState(void* pState) noexcept {
-        std::lock_guard<decltype(mtx_)> lock(mtx_);
-        memcpy_s(keyState_, 256, pState, 256);
+    void update() noexcept {
+        snapshot_.beginFrame();
+
+        std::array<Event, eventBatchNum> batch;
+        while (auto num = events_.popBatch(batch.data(), eventBatchNum)) {
+            for (uint32_t i = 0; i < num; ++i) {
+                snapshot_.apply(batch[i]);
+            }
+        }
     }
 };
 
@@ -54,23 +70,60 @@ Input::~Input() {
     impl_.reset();
 }
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief	入力イベントを追加する（任意のスレッドから呼び出せる）
+ * @param	event		入力イベント
+ * @return	キューが満杯で追加できなかった場合は false
+ */
+bool Input::pushEvent(const Event& event) noexcept {
+    return impl_->pushEvent(event);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	届いているイベントを反映してフレームの入力状態を更新する
+ */
+void Input::update() noexcept {
+    impl_->update();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームの入力状態を取得する
+ */
+const InputSnapshot& Input::snapshot() const noexcept {
+    return impl_->snapshot_;
+}
+
 //---------------------------------------------------------------------------------
 /**
  * @brief	キー情報の取得
  * @param	key		キーの識別子
  * @return	入力されていればtrue
  */
-bool Input::getKey(uint16_t key) noexcept {
-    return impl_->getKey(key);
+bool Input::getKey(uint16_t key) const noexcept {
+    return impl_->snapshot_.isDown(key);
 }
 
 //---------------------------------------------------------------------------------
 /**
- * @brief	キー情報の更新
- * @param	pState		ハードから設定されたキー情報配列のポインタ
+ * @brief	このフレームでキーが押されたか否かの取得
+ * @param	key		キーの識別子
+ * @return	押された瞬間であればtrue
+ */
+bool Input::getKeyPressed(uint16_t key) const noexcept {
+    return impl_->snapshot_.isPressed(key);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	このフレームでキーが離されたか否かの取得
+ * @param	key		キーの識別子
+ * @return	離された瞬間であればtrue
  */
-void Input::updateKeyState(void* pState) noexcept {
-    impl_->updateKeyState(pState);
+bool Input::getKeyReleased(uint16_t key) const noexcept {
+    return impl_->snapshot_.isReleased(key);
 }
 
 //---------------------------------------------------------------------------------
@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include "input/input_snapshot.h"
 #include "utility/singleton.h"
 
 namespace input {
@@ -7,6 +8,10 @@ namespace input {
 /**
  * @brief
  * 入力情報の管理
+ *
+ * プラットフォーム側（ウィンドウスレッド）は pushEvent でイベントを積み、
+ * 利用側は毎フレーム update を呼んでからそのフレームの入力状態を参照する（ SwapChain::present の末尾で呼ばれる）
+ * 入力状態の参照は update を呼ぶスレッドから行うこと
  */
 class Input : public utility::Singleton<Input> {
 private:
@@ -20,20 +25,49 @@ public:
     ~Input();
 
 public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	入力イベントを追加する（任意のスレッドから呼び出せる）
+     * @param	event		入力イベント
+     * @return	キューが満杯で追加できなかった場合は false
+     */
+    bool pushEvent(const Event& event) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	届いているイベントを反映してフレームの入力状態を更新する
+     */
+    void update() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームの入力状態を取得する
+     */
+    [[nodiscard]] const InputSnapshot& snapshot() const noexcept;
+
     //---------------------------------------------------------------------------------
     /**
      * @brief	キー情報の取得
      * @param	key		キーの識別子
      * @return	入力されていればtrue
      */
-    bool getKey(uint16_t key) noexcept;
+    bool getKey(uint16_t key) const noexcept;
 
     //---------------------------------------------------------------------------------
     /**
-     * @brief	キー情報の更新
-     * @param	pState		ハードから設定されたキー情報配列のポインタ
+     * @brief	このフレームでキーが押されたか否かの取得
+     * @param	key		キーの識別子
+     * @return	押された瞬間であればtrue
+     */
+    bool getKeyPressed(uint16_t key) const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	このフレームでキーが離されたか否かの取得
+     * @param	key		キーの識別子
+     * @return	離された瞬間であればtrue
      */
-    void updateKeyState(void* pState) noexcept;
+    bool getKeyReleased(uint16_t key) const noexcept;
 
 private:
     //---------------------------------------------------------------------------------
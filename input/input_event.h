@@ -0,0 +1,71 @@
+﻿#pragma once
+
+#include <chrono>
+#include <iterator>
+
+namespace input {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 入力イベントの種類
+ */
+enum class EventType : uint8_t {
+    KeyDown,          ///< キーが押された
+    KeyUp,            ///< キーが離された
+    MouseMove,        ///< マウスが移動した（ x_ y_ はクライアント座標）
+    MouseButtonDown,  ///< マウスボタンが押された
+    MouseButtonUp,    ///< マウスボタンが離された
+    MouseWheel,       ///< ホイールが回転した（ y_ は回転量）
+    FocusLost,        ///< フォーカスを失った（押下中の入力をすべて離したものとする）
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * マウスボタン
+ */
+enum class MouseButton : uint8_t {
+    Left,
+    Right,
+    Middle,
+    X1,
+    X2,
+    Num,
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * マウスボタンに対応するキーコード（ Windows の VK_LBUTTON / VK_RBUTTON / VK_MBUTTON / VK_XBUTTON1 / VK_XBUTTON2 ）
+ *
+ * マウスボタンのイベントはこのキーコードのキー状態にも反映する
+ */
+constexpr uint16_t mouseButtonKeys[] = {0x01, 0x02, 0x04, 0x05, 0x06};
+static_assert(std::size(mouseButtonKeys) == static_cast<size_t>(MouseButton::Num), "マウスボタンとキーコードの対応が不足しています");
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 入力イベント
+ *
+ * キーコードはプラットフォームの仮想キーコード（ Windows では VK_* ）をそのまま使う
+ */
+struct Event {
+    EventType type_{};  ///< 種類
+    uint16_t  code_{};  ///< キーコードまたは MouseButton
+    int32_t   x_{};     ///< マウスの X 座標
+    int32_t   y_{};     ///< マウスの Y 座標またはホイールの回転量
+    uint64_t  time_{};  ///< 発生時間（ steady_clock のナノ秒）
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	イベントの発生時間に使う現在時間を取得する
+ * @return	steady_clock のナノ秒
+ */
+inline uint64_t eventTime() noexcept {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+}  // namespace input
@@ -0,0 +1,72 @@
+﻿#include "input_snapshot.h"
+
+namespace input {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームを開始する（前フレームの押下／解放の瞬間とホイール量をクリアする）
+ */
+void InputSnapshot::beginFrame() noexcept {
+    keyPressed_.reset();
+    keyReleased_.reset();
+    buttonPressed_.reset();
+    buttonReleased_.reset();
+    wheel_ = 0;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	イベントを反映する
+ * @param	event		入力イベント
+ */
+void InputSnapshot::apply(const Event& event) noexcept {
+    lastEventTime_ = event.time_;
+
+    switch (event.type_) {
+        case EventType::KeyDown:
+            if (event.code_ < keyNum && !keyDown_[event.code_]) {
+                keyDown_[event.code_]    = true;
+                keyPressed_[event.code_] = true;
+            }
+            break;
+        case EventType::KeyUp:
+            if (event.code_ < keyNum && keyDown_[event.code_]) {
+                keyDown_[event.code_]     = false;
+                keyReleased_[event.code_] = true;
+            }
+            break;
+        case EventType::MouseMove:
+            mouseX_ = event.x_;
+            mouseY_ = event.y_;
+            break;
+        case EventType::MouseButtonDown:
+            if (event.code_ < buttonNum && !buttonDown_[event.code_]) {
+                buttonDown_[event.code_]    = true;
+                buttonPressed_[event.code_] = true;
+                apply(Event{EventType::KeyDown, mouseButtonKeys[event.code_], 0, 0, event.time_});
+            }
+            mouseX_ = event.x_;
+            mouseY_ = event.y_;
+            break;
+        case EventType::MouseButtonUp:
+            if (event.code_ < buttonNum && buttonDown_[event.code_]) {
+                buttonDown_[event.code_]     = false;
+                buttonReleased_[event.code_] = true;
+                apply(Event{EventType::KeyUp, mouseButtonKeys[event.code_], 0, 0, event.time_});
+            }
+            mouseX_ = event.x_;
+            mouseY_ = event.y_;
+            break;
+        case EventType::MouseWheel:
+            wheel_ += event.y_;
+            break;
+        case EventType::FocusLost:
+            // 押下中の入力はすべて離されたものとする
+            keyReleased_ |= keyDown_;
+            buttonReleased_ |= buttonDown_;
+            keyDown_.reset();
+            buttonDown_.reset();
+            break;
+    }
+}
+}  // namespace input
@@ -0,0 +1,148 @@
+﻿#pragma once
+
+#include <bitset>
+
+#include "input/input_event.h"
+
+namespace input {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 1 フレーム分の入力状態
+ *
+ * フレーム開始時に beginFrame を呼び、そのフレームに届いたイベントを apply で反映する
+ * 押された／離された瞬間はフレーム内で押して離した場合も両方検出する
+ * マウスボタンは mouseButtonKeys のキーコードのキー状態にも反映する
+ */
+class InputSnapshot final {
+public:
+    static constexpr uint32_t keyNum = 256;  ///< キーコードの数
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    InputSnapshot() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~InputSnapshot() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームを開始する（前フレームの押下／解放の瞬間とホイール量をクリアする）
+     */
+    void beginFrame() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	イベントを反映する
+     * @param	event		入力イベント
+     */
+    void apply(const Event& event) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キーが押されているか否かを取得する
+     * @param	key			キーコード
+     */
+    [[nodiscard]] bool isDown(uint16_t key) const noexcept {
+        return key < keyNum && keyDown_[key];
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	このフレームでキーが押されたか否かを取得する
+     * @param	key			キーコード
+     */
+    [[nodiscard]] bool isPressed(uint16_t key) const noexcept {
+        return key < keyNum && keyPressed_[key];
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	このフレームでキーが離されたか否かを取得する
+     * @param	key			キーコード
+     */
+    [[nodiscard]] bool isReleased(uint16_t key) const noexcept {
+        return key < keyNum && keyReleased_[key];
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	マウスボタンが押されているか否かを取得する
+     * @param	button		マウスボタン
+     */
+    [[nodiscard]] bool isDown(MouseButton button) const noexcept {
+        return buttonDown_[static_cast<size_t>(button)];
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	このフレームでマウスボタンが押されたか否かを取得する
+     * @param	button		マウスボタン
+     */
+    [[nodiscard]] bool isPressed(MouseButton button) const noexcept {
+        return buttonPressed_[static_cast<size_t>(button)];
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	このフレームでマウスボタンが離されたか否かを取得する
+     * @param	button		マウスボタン
+     */
+    [[nodiscard]] bool isReleased(MouseButton button) const noexcept {
+        return buttonReleased_[static_cast<size_t>(button)];
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	マウスの X 座標を取得する
+     */
+    [[nodiscard]] int32_t mouseX() const noexcept {
+        return mouseX_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	マウスの Y 座標を取得する
+     */
+    [[nodiscard]] int32_t mouseY() const noexcept {
+        return mouseY_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	このフレームのホイール回転量を取得する
+     */
+    [[nodiscard]] int32_t wheel() const noexcept {
+        return wheel_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	最後に反映したイベントの発生時間を取得する
+     */
+    [[nodiscard]] uint64_t lastEventTime() const noexcept {
+        return lastEventTime_;
+    }
+
+private:
+    static constexpr size_t buttonNum = static_cast<size_t>(MouseButton::Num);
+
+    std::bitset<keyNum>    keyDown_{};         ///< 押されているキー
+    std::bitset<keyNum>    keyPressed_{};      ///< このフレームで押されたキー
+    std::bitset<keyNum>    keyReleased_{};     ///< このフレームで離されたキー
+    std::bitset<buttonNum> buttonDown_{};      ///< 押されているマウスボタン
+    std::bitset<buttonNum> buttonPressed_{};   ///< このフレームで押されたマウスボタン
+    std::bitset<buttonNum> buttonReleased_{};  ///< このフレームで離されたマウスボタン
+    int32_t                mouseX_{};          ///< マウスの X 座標
+    int32_t                mouseY_{};          ///< マウスの Y 座標
+    int32_t                wheel_{};           ///< このフレームのホイール回転量
+    uint64_t               lastEventTime_{};   ///< 最後に反映したイベントの発生時間
+};
+}  // namespace input
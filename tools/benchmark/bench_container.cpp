@@ -0,0 +1,81 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 描画オブジェクトのコンテナとシングルトンのベンチマーク
+ */
+#include "tools/benchmark/benchmark.h"
+#include "dx12/graphics/container.h"
+#include "utility/time_counter.h"
+
+namespace {
+
+constexpr uint32_t objectNum = 1024;  ///< コンテナに登録するオブジェクト数
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンテナに登録するオブジェクト
+ */
+struct Object {
+    uint32_t value_;  ///< 値
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	登録済みのキーを取得する（初回のみ登録する）
+ */
+const std::vector<uint32_t>& objectKeys() {
+    static const auto keys = [] {
+        std::vector<uint32_t> keys;
+        for (uint32_t i = 0; i < objectNum; i++) {
+            const auto name = "object" + std::to_string(i);
+            const auto key  = utility::stringToHash(name);
+            dx12::graphics::Container<Object>::instance().registerObj(key, Object{i});
+            keys.push_back(key);
+        }
+        return keys;
+    }();
+    return keys;
+}
+
+}  // namespace
+
+BENCHMARK("container/Container::get/hit") {
+    const auto& keys  = objectKeys();
+    uint32_t    index = 0;
+    state.measure([&] {
+        const auto* o = dx12::graphics::Container<Object>::instance().get(keys[index++ % objectNum]);
+        bench::doNotOptimize(o);
+    });
+}
+
+BENCHMARK("container/Container::get/miss") {
+    objectKeys();
+    uint32_t key = 0;
+    state.measure([&] {
+        const auto* o = dx12::graphics::Container<Object>::instance().get(key++);
+        bench::doNotOptimize(o);
+    });
+}
+
+BENCHMARK("container/Container::get/handle") {
+    const auto& keys = objectKeys();
+
+    // 描画時の参照と同じく、ハンドルを事前に解決しておく
+    std::vector<dx12::graphics::Container<Object>::Handle> handles;
+    for (auto key : keys) {
+        handles.push_back(dx12::graphics::Container<Object>::instance().handle(key));
+    }
+
+    uint32_t index = 0;
+    state.measure([&] {
+        const auto* o = dx12::graphics::Container<Object>::instance().get(handles[index++ % objectNum]);
+        bench::doNotOptimize(o);
+    });
+}
+
+BENCHMARK("singleton/Singleton::instance") {
+    state.measure([&] {
+        auto* instance = &utility::TimeContainer::instance();
+        bench::doNotOptimize(instance);
+    });
+}
@@ -0,0 +1,207 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フラットマップと std::unordered_map のベンチマーク
+ *
+ * 要素数ごとに追加・検索成功・検索失敗を比較する
+ * キーは乱数なので、検索はマップ内のランダムな位置を参照する
+ */
+#include "tools/benchmark/benchmark.h"
+
+#include <random>
+#include <unordered_map>
+
+#include "utility/flat_map.h"
+
+namespace {
+
+using FlatMap       = utility::FlatMap<uint64_t, uint64_t>;
+using UnorderedMap  = std::unordered_map<uint64_t, uint64_t>;
+using FlatStringMap = utility::FlatMap<std::string, uint32_t>;
+using StdStringMap  = std::unordered_map<std::string, uint32_t>;
+
+constexpr uint32_t stringNum = 1000;  ///< 文字列キーの要素数
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	乱数のキーを作成する
+ * @param	num			キー数
+ * @param	seed		乱数のシード（登録用と検索失敗用で変える）
+ */
+std::vector<uint64_t> makeKeys(size_t num, uint64_t seed) {
+    std::mt19937_64       rng(seed);
+    std::vector<uint64_t> keys(num);
+    for (auto& key : keys) {
+        key = rng();
+    }
+    return keys;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	要素を追加する
+ */
+void insert(FlatMap& map, uint64_t key) {
+    map.tryEmplace(key, key);
+}
+void insert(UnorderedMap& map, uint64_t key) {
+    map.try_emplace(key, key);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	空のマップに num 個を追加する（ num 個ごとにクリアする。クリアの時間も含む）
+ */
+template <class Map>
+void insertBench(bench::State& state, size_t num) {
+    const auto keys  = makeKeys(num, 1);
+    Map        map;
+    size_t     index = 0;
+    state.measure([&] {
+        insert(map, keys[index]);
+        if (++index == num) {
+            map.clear();
+            index = 0;
+        }
+    });
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	num 個を登録したマップを検索する
+ * @param	hit			登録済みのキーで検索するか否か
+ */
+template <class Map>
+void findBench(bench::State& state, size_t num, bool hit) {
+    const auto keys = makeKeys(num, 1);
+    Map        map;
+    map.reserve(num);
+    for (auto key : keys) {
+        insert(map, key);
+    }
+
+    const auto queries = hit ? keys : makeKeys(std::min<size_t>(num, 1 << 20), 2);
+    size_t     index   = 0;
+    state.measure([&] {
+        bench::doNotOptimize(map.contains(queries[index]));
+        if (++index == queries.size()) {
+            index = 0;
+        }
+    });
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	文字列キーの名前を作成する
+ */
+std::vector<std::string> makeNames() {
+    std::vector<std::string> names;
+    for (uint32_t i = 0; i < stringNum; i++) {
+        names.push_back("render/pass/" + std::to_string(i));
+    }
+    return names;
+}
+
+}  // namespace
+
+BENCHMARK("flatmap/FlatMap/insert/1K") {
+    insertBench<FlatMap>(state, 1000);
+}
+
+BENCHMARK("flatmap/std::unordered_map/insert/1K") {
+    insertBench<UnorderedMap>(state, 1000);
+}
+
+BENCHMARK("flatmap/FlatMap/hit/1K") {
+    findBench<FlatMap>(state, 1000, true);
+}
+
+BENCHMARK("flatmap/std::unordered_map/hit/1K") {
+    findBench<UnorderedMap>(state, 1000, true);
+}
+
+BENCHMARK("flatmap/FlatMap/miss/1K") {
+    findBench<FlatMap>(state, 1000, false);
+}
+
+BENCHMARK("flatmap/std::unordered_map/miss/1K") {
+    findBench<UnorderedMap>(state, 1000, false);
+}
+
+BENCHMARK("flatmap/FlatMap/insert/100K") {
+    insertBench<FlatMap>(state, 100000);
+}
+
+BENCHMARK("flatmap/std::unordered_map/insert/100K") {
+    insertBench<UnorderedMap>(state, 100000);
+}
+
+BENCHMARK("flatmap/FlatMap/hit/100K") {
+    findBench<FlatMap>(state, 100000, true);
+}
+
+BENCHMARK("flatmap/std::unordered_map/hit/100K") {
+    findBench<UnorderedMap>(state, 100000, true);
+}
+
+BENCHMARK("flatmap/FlatMap/miss/100K") {
+    findBench<FlatMap>(state, 100000, false);
+}
+
+BENCHMARK("flatmap/std::unordered_map/miss/100K") {
+    findBench<UnorderedMap>(state, 100000, false);
+}
+
+BENCHMARK("flatmap/FlatMap/insert/10M") {
+    insertBench<FlatMap>(state, 10000000);
+}
+
+BENCHMARK("flatmap/std::unordered_map/insert/10M") {
+    insertBench<UnorderedMap>(state, 10000000);
+}
+
+BENCHMARK("flatmap/FlatMap/hit/10M") {
+    findBench<FlatMap>(state, 10000000, true);
+}
+
+BENCHMARK("flatmap/std::unordered_map/hit/10M") {
+    findBench<UnorderedMap>(state, 10000000, true);
+}
+
+BENCHMARK("flatmap/FlatMap/miss/10M") {
+    findBench<FlatMap>(state, 10000000, false);
+}
+
+BENCHMARK("flatmap/std::unordered_map/miss/10M") {
+    findBench<UnorderedMap>(state, 10000000, false);
+}
+
+BENCHMARK("flatmap/FlatMap/string_view/1K") {
+    // string_view のまま検索できる
+    const auto    names = makeNames();
+    FlatStringMap map;
+    for (uint32_t i = 0; i < stringNum; i++) {
+        map.tryEmplace(names[i], i);
+    }
+
+    uint32_t index = 0;
+    state.measure([&] {
+        const std::string_view name = names[index++ % stringNum];
+        bench::doNotOptimize(map.findValue(name));
+    });
+}
+
+BENCHMARK("flatmap/std::unordered_map/string_view/1K") {
+    // 異種検索を使わない場合は std::string の作成が必要になる
+    const auto   names = makeNames();
+    StdStringMap map;
+    for (uint32_t i = 0; i < stringNum; i++) {
+        map.try_emplace(names[i], i);
+    }
+
+    uint32_t index = 0;
+    state.measure([&] {
+        const std::string_view name = names[index++ % stringNum];
+        bench::doNotOptimize(map.find(std::string(name)) != map.end());
+    });
+}
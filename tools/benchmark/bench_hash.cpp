@@ -0,0 +1,97 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ハッシュ関数のベンチマーク
+ *
+ * crc32 / crc32c / hash64 / hash128 は 8 B 〜 64 MB を 2 倍ずつ変えて計測し、スループット（ bytes/s ）を出力する
+ */
+#include "tools/benchmark/benchmark.h"
+#include "utility/crc32.h"
+#include "utility/hash.h"
+
+#include <cstdio>
+
+namespace {
+
+constexpr size_t sweepMinSize = 8;                    ///< スループット計測の最小サイズ
+constexpr size_t sweepMaxSize = 64ull * 1024 * 1024;  ///< スループット計測の最大サイズ
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	指定サイズの入力データを作成する
+ */
+std::vector<char> makeData(size_t size) {
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<char>('a' + i % 26);
+    }
+    return data;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	スループット計測で共有する入力データを取得する（最大サイズ分を 1 度だけ作成する）
+ */
+const std::vector<char>& sweepData() {
+    static const auto data = makeData(sweepMaxSize);
+    return data;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ハッシュ関数のスループット計測をサイズごとに登録する（名前順に実行されるよう桁を揃える）
+ * @param	hashName	ハッシュ関数名
+ * @param	func		ハッシュ関数
+ */
+template <class Func>
+void addSweep(const char* hashName, Func func) {
+    for (size_t size = sweepMinSize; size <= sweepMaxSize; size *= 2) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "hash/%s/%08zu", hashName, size);
+        bench::add(name, [func, size](bench::State& state) {
+            const auto* data = sweepData().data();
+            state.setBytesPerOp(size);
+            state.measure([&] {
+                bench::doNotOptimize(data);
+                bench::doNotOptimize(func(data, size));
+            });
+        });
+    }
+}
+
+const bool sweepRegistered = [] {
+    addSweep("crc32", [](const char* data, size_t size) { return utility::crc32(data, size); });
+    addSweep("crc32c", [](const char* data, size_t size) { return utility::crc32c(data, size); });
+    addSweep("hash64", [](const char* data, size_t size) { return utility::hash64(static_cast<const void*>(data), size); });
+    addSweep("hash128", [](const char* data, size_t size) { return utility::hash128(static_cast<const void*>(data), size); });
+    return true;
+}();
+
+}  // namespace
+
+BENCHMARK("hash/stringToHash/16") {
+    const auto       data = makeData(16);
+    std::string_view str(data.data(), data.size());
+    state.measure([&] {
+        bench::doNotOptimize(str);
+        bench::doNotOptimize(utility::stringToHash(str));
+    });
+}
+
+BENCHMARK("hash/stringToHash/1024") {
+    const auto       data = makeData(1024);
+    std::string_view str(data.data(), data.size());
+    state.measure([&] {
+        bench::doNotOptimize(str);
+        bench::doNotOptimize(utility::stringToHash(str));
+    });
+}
+
+BENCHMARK("hash/stringToHashT/16") {
+    // 実行時に評価させるため const ではない配列を渡す
+    char str[] = "texture/albedo00";
+    state.measure([&] {
+        bench::doNotOptimize(str);
+        bench::doNotOptimize(utility::stringToHashT(str));
+    });
+}
@@ -0,0 +1,128 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 共有ロックのベンチマーク
+ *
+ * 競合無しの共有ロックと、スレッド数（1 〜 64）と書き込み割合（0 / 1 / 10 / 50 %）を変えて
+ * 複数スレッドが競合する場合を比較する
+ */
+#include "tools/benchmark/benchmark.h"
+#include "utility/spin_lock.h"
+
+#include <cstdio>
+
+namespace {
+
+constexpr uint32_t contendedThreadNums[]    = {1, 2, 4, 8, 16, 32, 64};  ///< 競合させるスレッド数
+constexpr uint32_t contendedWritePercents[] = {0, 1, 10, 50};             ///< 書き込みを行う割合（%）
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	std::shared_mutex を同じインターフェースで扱う
+ */
+class StdSharedMutex final : utility::Noncopyable {
+public:
+    void lock() {
+        mutex_.lock();
+    }
+    void unlock() {
+        mutex_.unlock();
+    }
+    void lockShared() {
+        mutex_.lock_shared();
+    }
+    void unlockShared() {
+        mutex_.unlock_shared();
+    }
+
+private:
+    std::shared_mutex mutex_;
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	競合無しで共有ロックの取得と解放を計測する
+ */
+template <class Lock>
+void uncontended(bench::State& state) {
+    Lock     lock;
+    uint64_t value = 0;
+    state.measure([&] {
+        lock.lockShared();
+        bench::doNotOptimize(value);
+        lock.unlockShared();
+    });
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	複数スレッドで読み込みと書き込みを混ぜて計測する
+ * @param	state			計測状態
+ * @param	threadNum		競合させるスレッド数
+ * @param	writePercent	書き込みを行う割合（%）
+ */
+template <class Lock>
+void contended(bench::State& state, uint32_t threadNum, uint32_t writePercent) {
+    Lock     lock;
+    uint64_t value = 0;
+    state.measureThreads(threadNum, [&](uint32_t) {
+        thread_local uint32_t count = 0;
+        if (++count % 100 < writePercent) {
+            lock.lock();
+            value++;
+            lock.unlock();
+        } else {
+            lock.lockShared();
+            bench::doNotOptimize(value);
+            lock.unlockShared();
+        }
+    });
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	競合計測をスレッド数と書き込み割合の組み合わせで登録する（名前順に実行されるよう桁を揃える）
+ * @param	lockName	ロック名
+ */
+template <class Lock>
+void addContended(const char* lockName) {
+    for (auto threadNum : contendedThreadNums) {
+        for (auto writePercent : contendedWritePercents) {
+            char name[128];
+            std::snprintf(name, sizeof(name), "lock/contended/%s/threads:%02u/write:%02u", lockName, threadNum, writePercent);
+            bench::add(name, [threadNum, writePercent](bench::State& state) {
+                contended<Lock>(state, threadNum, writePercent);
+            });
+        }
+    }
+}
+
+const bool contendedRegistered = [] {
+    addContended<utility::WriterPreferSpinLock>("WriterPreferSpinLock");
+    addContended<utility::TicketSharedLock>("TicketSharedLock");
+    addContended<utility::BigReaderLock<>>("BigReaderLock");
+    addContended<StdSharedMutex>("std::shared_mutex");
+    return true;
+}();
+
+}  // namespace
+
+BENCHMARK("lock/SharedSpinLock/uncontended") {
+    uncontended<utility::SharedSpinLock>(state);
+}
+
+BENCHMARK("lock/WriterPreferSpinLock/uncontended") {
+    uncontended<utility::WriterPreferSpinLock>(state);
+}
+
+BENCHMARK("lock/TicketSharedLock/uncontended") {
+    uncontended<utility::TicketSharedLock>(state);
+}
+
+BENCHMARK("lock/BigReaderLock/uncontended") {
+    uncontended<utility::BigReaderLock<>>(state);
+}
+
+BENCHMARK("lock/std::shared_mutex/uncontended") {
+    uncontended<StdSharedMutex>(state);
+}
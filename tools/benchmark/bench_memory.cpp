@@ -0,0 +1,51 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * メモリ確保のベンチマーク
+ */
+#include "tools/benchmark/benchmark.h"
+#include "utility/frame_arena.h"
+#include "utility/object_pool.h"
+
+namespace {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	確保するオブジェクト
+ */
+struct Object {
+    uint64_t value_[8];  ///< 値
+};
+
+}  // namespace
+
+BENCHMARK("memory/new+delete/64") {
+    state.measure([&] {
+        auto* o = new Object();
+        bench::doNotOptimize(o);
+        delete o;
+    });
+}
+
+BENCHMARK("memory/ObjectPool/64") {
+    utility::ObjectPool<Object> pool;
+    state.measure([&] {
+        auto* o = pool.create();
+        bench::doNotOptimize(o);
+        pool.destroy(o);
+    });
+}
+
+BENCHMARK("memory/FrameArena/64") {
+    auto&    arena = utility::FrameArena::instance();
+    uint32_t count = 0;
+    state.measure([&] {
+        auto* o = arena.create<Object>();
+        bench::doNotOptimize(o);
+        // チャンクが増え続けないように定期的にフレームを区切る
+        if (++count % 4096 == 0) {
+            arena.reset();
+        }
+    });
+    arena.reset();
+}
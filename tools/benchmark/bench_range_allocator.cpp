@@ -0,0 +1,113 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 範囲アロケーター（ディスクリプタヒープの割り当て）のベンチマーク
+ */
+#include "tools/benchmark/benchmark.h"
+#include "utility/frame_ring_allocator.h"
+#include "utility/range_allocator.h"
+
+#include <random>
+
+namespace {
+
+constexpr uint32_t heapCapacity = 1u << 20;  ///< 管理する範囲の大きさ（ディスクリプタヒープの上限相当）
+constexpr uint32_t liveNum      = 4096;      ///< 確保したまま保持する範囲の数
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	確保する個数の列を取得する（ 1 〜 8 個が大半で、時々大きな範囲を含む）
+ */
+const std::vector<uint32_t>& requestSizes() {
+    static const auto sizes = [] {
+        std::mt19937          rng(1234);
+        std::vector<uint32_t> sizes(liveNum);
+        for (auto& size : sizes) {
+            size = (rng() % 16 == 0) ? 16 + rng() % 240 : 1 + rng() % 8;
+        }
+        return sizes;
+    }();
+    return sizes;
+}
+
+}  // namespace
+
+BENCHMARK("range_allocator/bump/1") {
+    // 従来のバンプポインタ（解放できないので上限で巻き戻す）
+    uint32_t current = 0;
+    state.measure([&] {
+        if (current + 1 > heapCapacity) {
+            current = 0;
+        }
+        const auto offset = current;
+        current += 1;
+        bench::doNotOptimize(offset);
+    });
+}
+
+BENCHMARK("range_allocator/RangeAllocator::allocate+free/1") {
+    utility::RangeAllocator allocator(heapCapacity);
+    state.measure([&] {
+        const auto allocation = allocator.allocate(1);
+        bench::doNotOptimize(allocation);
+        allocator.free(allocation);
+    });
+}
+
+BENCHMARK("range_allocator/RangeAllocator::allocate+free/churn") {
+    // 断片化した状態で、最も古い範囲を解放して新しい範囲を確保する
+    utility::RangeAllocator                          allocator(heapCapacity);
+    const auto&                                      sizes = requestSizes();
+    std::vector<utility::RangeAllocator::Allocation> live(liveNum);
+    for (uint32_t i = 0; i < liveNum; i++) {
+        live[i] = allocator.allocate(sizes[i]);
+    }
+
+    uint32_t index = 0;
+    state.measure([&] {
+        const auto slot = index++ % liveNum;
+        allocator.free(live[slot]);
+        live[slot] = allocator.allocate(sizes[(slot * 7) % liveNum]);
+        bench::doNotOptimize(live[slot]);
+    });
+}
+
+BENCHMARK("range_allocator/RangeAllocator::free+reclaim/deferred") {
+    // 1 フレーム分（ 64 個）をフェンス付きで解放し、フェンスの完了で回収する
+    utility::RangeAllocator                          allocator(heapCapacity);
+    const auto&                                      sizes = requestSizes();
+    std::vector<utility::RangeAllocator::Allocation> live(liveNum);
+    for (uint32_t i = 0; i < liveNum; i++) {
+        live[i] = allocator.allocate(sizes[i]);
+    }
+
+    uint32_t index = 0;
+    uint64_t fence = 0;
+    state.measure([&] {
+        const auto slot = index++ % liveNum;
+        allocator.free(live[slot], fence);
+        if (index % 64 == 0) {
+            allocator.reclaim(fence++);
+        }
+        live[slot] = allocator.allocate(sizes[(slot * 7) % liveNum]);
+        bench::doNotOptimize(live[slot]);
+    });
+}
+
+BENCHMARK("range_allocator/FrameRingAllocator::allocate/table") {
+    // 描画ごとのテーブル（ 1 〜 8 個）を確保し、 1024 回ごとにフレームを終了して 2 フレーム前を回収する
+    utility::FrameRingAllocator allocator(heapCapacity);
+    const auto&                 sizes = requestSizes();
+    uint32_t                    index = 0;
+    uint64_t                    fence = 0;
+    state.measure([&] {
+        const auto offset = allocator.allocate(1 + sizes[index++ % liveNum] % 8);
+        bench::doNotOptimize(offset);
+        if (index % 1024 == 0) {
+            allocator.endFrame(++fence);
+            if (fence > 2) {
+                allocator.reclaim(fence - 2);
+            }
+        }
+    });
+}
@@ -0,0 +1,252 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * スレッド間通信とジョブシステムのベンチマーク
+ */
+#include "tools/benchmark/benchmark.h"
+
+#include <condition_variable>
+
+#include "utility/histogram.h"
+#include "utility/job_system.h"
+#include "utility/ring_buffer.h"
+
+namespace {
+
+constexpr uint32_t ringCapacity   = 1024;      ///< リングバッファの容量
+constexpr uint32_t scalingDataNum = 1u << 20;  ///< スケーリング計測で処理する要素数
+constexpr uint32_t scalingGrain   = 4096;      ///< スケーリング計測の分割単位
+
+double scalingBaseNs = 0.0;  ///< ワーカー 1 でのスケーリング計測の結果（ナノ秒）
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	生産者 1 スレッドと消費者 1 スレッドで受け渡す
+ *
+ * 操作数は受け渡した要素数（スレッド 0 が生産者、スレッド 1 が消費者）
+ */
+template <class Push, class Pop>
+void producerConsumer(bench::State& state, Push&& push, Pop&& pop) {
+    state.measureThreads(2, [&](uint32_t thread) {
+        if (thread == 0) {
+            push(1);
+        } else {
+            bench::doNotOptimize(pop());
+        }
+    });
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	std::mutex と std::queue による比較用のキュー（リングバッファと同じインターフェース）
+ */
+class MutexQueue final : utility::Noncopyable {
+public:
+    void pushWait(uint64_t value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [&] { return queue_.size() < ringCapacity; });
+        queue_.push(value);
+        notEmpty_.notify_one();
+    }
+    void popWait(uint64_t& value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [&] { return !queue_.empty(); });
+        value = queue_.front();
+        queue_.pop();
+        notFull_.notify_one();
+    }
+
+private:
+    std::mutex              mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::queue<uint64_t>    queue_;
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	要求と応答の 2 本のキューで往復させ、往復の遅延を計測する
+ *
+ * 操作数は往復数（スレッド 0 が要求を送って応答を待ち、スレッド 1 が要求をそのまま返す）
+ * スレッド 0 で往復ごとの時間をヒストグラムに記録し、 p50 / p99 をナノ秒で出力する
+ */
+template <class Queue>
+void pingPong(bench::State& state) {
+    Queue              request;
+    Queue              reply;
+    utility::Histogram latency;
+    state.measureThreads(2, [&](uint32_t thread) {
+        uint64_t value = 0;
+        if (thread == 0) {
+            const auto start = std::chrono::steady_clock::now();
+            request.pushWait(value);
+            reply.popWait(value);
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            latency.record(static_cast<uint64_t>(ns));
+        } else {
+            request.popWait(value);
+            reply.pushWait(value);
+        }
+    });
+
+    const auto stats = latency.stats(utility::Histogram::Window::Current);
+    state.counter("p50_ns", stats.p50_);
+    state.counter("p99_ns", stats.p99_);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ワーカー数を指定してジョブシステムを起動し、計算量のある parallelFor を計測する
+ *
+ * ワーカー 1 の結果を基準に速度向上率（ speedup ）を出力する
+ * @param	workerNum	ワーカー数
+ */
+void measureScaling(bench::State& state, uint32_t workerNum) {
+    auto& jobSystem = utility::JobSystem::instance();
+    jobSystem.start(workerNum);
+
+    std::vector<uint64_t> data(scalingDataNum, 1);
+    state.measure([&] {
+        jobSystem.parallelFor(0, scalingDataNum, scalingGrain, [&](uint32_t begin, uint32_t end) {
+            for (auto i = begin; i < end; i++) {
+                // メモリ帯域ではなく計算で律速するよう、要素ごとに数回かき混ぜる
+                auto v = data[i] + i;
+                for (uint32_t r = 0; r < 16; r++) {
+                    v ^= v << 13;
+                    v ^= v >> 7;
+                    v ^= v << 17;
+                }
+                data[i] = v;
+            }
+        });
+    });
+    bench::doNotOptimize(data.data());
+
+    jobSystem.stop();
+
+    const auto ns = state.result().nsPerOp_;
+    if (workerNum == 1) {
+        scalingBaseNs = ns;
+    }
+    if (scalingBaseNs > 0.0 && ns > 0.0) {
+        state.counter("speedup", scalingBaseNs / ns);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ワーカー数 1 〜 論理コア数のスケーリング計測を登録する（名前順に実行されるよう桁を揃える）
+ */
+const bool scalingRegistered = [] {
+    const auto maxWorker = std::max(1u, std::thread::hardware_concurrency());
+    for (uint32_t n = 1; n <= maxWorker; n++) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "job/scaling/workers:%03u", n);
+        bench::add(name, [n](bench::State& state) { measureScaling(state, n); });
+    }
+    return true;
+}();
+
+}  // namespace
+
+BENCHMARK("ring/SpscRingBuffer/push+pop") {
+    utility::SpscRingBuffer<uint64_t, ringCapacity> ring;
+    uint64_t                                        value = 0;
+    state.measure([&] {
+        ring.push(value++);
+        ring.pop(value);
+    });
+}
+
+BENCHMARK("ring/SpscRingBuffer/1:1") {
+    utility::SpscRingBuffer<uint64_t, ringCapacity> ring;
+    producerConsumer(
+        state, [&](uint64_t v) { ring.pushWait(v); },
+        [&] {
+            uint64_t v = 0;
+            ring.popWait(v);
+            return v;
+        });
+}
+
+BENCHMARK("ring/MpmcRingBuffer/1:1") {
+    utility::MpmcRingBuffer<uint64_t, ringCapacity> ring;
+    producerConsumer(
+        state, [&](uint64_t v) { ring.pushWait(v); },
+        [&] {
+            uint64_t v = 0;
+            ring.popWait(v);
+            return v;
+        });
+}
+
+BENCHMARK("ring/std::queue+mutex/1:1") {
+    std::mutex              mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::queue<uint64_t>    queue;
+    producerConsumer(
+        state,
+        [&](uint64_t v) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [&] { return queue.size() < ringCapacity; });
+            queue.push(v);
+            notEmpty.notify_one();
+        },
+        [&] {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [&] { return !queue.empty(); });
+            const auto v = queue.front();
+            queue.pop();
+            notFull.notify_one();
+            return v;
+        });
+}
+
+BENCHMARK("ring/SpscRingBuffer/ping-pong") {
+    pingPong<utility::SpscRingBuffer<uint64_t, ringCapacity>>(state);
+}
+
+BENCHMARK("ring/MpmcRingBuffer/ping-pong") {
+    pingPong<utility::MpmcRingBuffer<uint64_t, ringCapacity>>(state);
+}
+
+BENCHMARK("ring/std::queue+mutex/ping-pong") {
+    pingPong<MutexQueue>(state);
+}
+
+BENCHMARK("job/JobSystem::run+wait") {
+    auto& jobSystem = utility::JobSystem::instance();
+    jobSystem.start();
+
+    // 空のジョブを 64 個ずつ投入して完了を待つ（操作数はジョブ数）
+    constexpr uint32_t batchNum = 64;
+    uint32_t           count    = 0;
+    utility::JobCounter counter;
+    state.measure([&] {
+        jobSystem.run([] {}, &counter);
+        if (++count % batchNum == 0) {
+            jobSystem.wait(counter);
+        }
+    });
+    jobSystem.wait(counter);
+
+    jobSystem.stop();
+}
+
+BENCHMARK("job/JobSystem::parallelFor/65536") {
+    auto& jobSystem = utility::JobSystem::instance();
+    jobSystem.start();
+
+    std::vector<uint32_t> data(65536, 1);
+    state.measure([&] {
+        jobSystem.parallelFor(0, static_cast<uint32_t>(data.size()), 1024, [&](uint32_t begin, uint32_t end) {
+            for (auto i = begin; i < end; i++) {
+                data[i] = data[i] * 3 + 1;
+            }
+        });
+    });
+    bench::doNotOptimize(data.data());
+
+    jobSystem.stop();
+}
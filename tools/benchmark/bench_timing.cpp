@@ -0,0 +1,53 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 時間計測とログのベンチマーク
+ */
+#include "tools/benchmark/benchmark.h"
+#include "utility/histogram.h"
+#include "utility/logger.h"
+#include "utility/profiler.h"
+#include "utility/time_counter.h"
+
+BENCHMARK("timing/TimeContainer::add") {
+    double value = 0.0;
+    state.measure([&] {
+        utility::TimeContainer::instance().add("benchmark", value);
+        value += 0.25;
+    });
+    utility::TimeContainer::instance().remove("benchmark");
+}
+
+BENCHMARK("timing/Histogram::record") {
+    utility::Histogram histogram;
+    uint64_t           value = 0;
+    state.measure([&] {
+        histogram.record(value);
+        value += 997;
+    });
+}
+
+BENCHMARK("timing/PROFILE_SCOPE") {
+    uint32_t count = 0;
+    state.measure([&] {
+        PROFILE_SCOPE("benchmark");
+        // リングバッファが溢れないように定期的にフレームを区切る
+        if (++count % 1024 == 0) {
+            PROFILE_FRAME();
+        }
+    });
+}
+
+BENCHMARK("log/Logger::write") {
+    // 出力先を外し、呼び出し側の記録コストだけを計測する
+    auto& logger = utility::Logger::instance();
+    logger.clearSinks();
+    logger.start();
+
+    uint32_t count = 0;
+    state.measure([&] {
+        logger.write(utility::LogLevel::Info, "frame %u: %s %f", count++, "benchmark", 1.5);
+    });
+
+    logger.stop();
+}
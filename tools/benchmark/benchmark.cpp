@@ -0,0 +1,260 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * utility のマイクロベンチマーク
+ *
+ * エンジン本体（ engine.vcxproj ）とは別の単体の実行ファイルで、 Linux でもビルドできる
+ *   g++ -std=c++20 -O2 -DNDEBUG -DENABLE_ALLOC_COUNTER -include def.h -I. \
+ *       $(find tools/benchmark utility -name "*.cpp") -lpthread -o engine_benchmark
+ * ENABLE_ALLOC_COUNTER を定義しない場合は 1 操作あたりの確保回数を計測しない
+ *
+ * 使い方
+ *   engine_benchmark [--filter 文字列] [--min-time ミリ秒] [--out 結果ファイル]
+ *                    [--baseline 基準ファイル] [--threshold パーセント] [--list]
+ *
+ * 結果ファイルは CSV （ name,ns_per_op,allocs_per_op,op_num,thread_num ）で、そのまま基準ファイルとして使える
+ * 基準より時間が threshold パーセントを超えて遅い、または確保回数が増えたベンチマークがあれば終了コード 1 を返す
+ */
+#include "tools/benchmark/benchmark.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	登録済みのベンチマーク
+ */
+struct Entry {
+    std::string          name_;  ///< ベンチマーク名
+    bench::BenchmarkFunc func_;  ///< ベンチマーク関数
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コマンドライン引数
+ */
+struct Options {
+    std::string filter_{};           ///< 名前に含まれる文字列で絞り込む
+    double      minSec_    = 0.2;    ///< 計測時間の下限（秒）
+    std::string out_{};              ///< 結果ファイルのパス
+    std::string baseline_{};         ///< 基準ファイルのパス
+    double      threshold_ = 10.0;   ///< 遅くなったとみなす割合（パーセント）
+    bool        list_      = false;  ///< 名前の一覧だけを出力する
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	登録済みのベンチマークを取得する
+ */
+std::vector<Entry>& registry() {
+    static std::vector<Entry> entries;
+    return entries;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コマンドライン引数を解析する
+ * @return	成功した場合は true
+ */
+bool parse(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        const bool             has = i + 1 < argc;
+        if (arg == "--filter" && has) {
+            options.filter_ = argv[++i];
+        } else if (arg == "--min-time" && has) {
+            options.minSec_ = std::atof(argv[++i]) / 1000.0;
+        } else if (arg == "--out" && has) {
+            options.out_ = argv[++i];
+        } else if (arg == "--baseline" && has) {
+            options.baseline_ = argv[++i];
+        } else if (arg == "--threshold" && has) {
+            options.threshold_ = std::atof(argv[++i]);
+        } else if (arg == "--list") {
+            options.list_ = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	結果を CSV で書き出す
+ * @param	path		出力先のファイルパス
+ * @param	results		計測結果
+ * @return	成功した場合は true
+ */
+bool writeResults(const std::string& path, const std::vector<bench::Result>& results) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file << "name,ns_per_op,allocs_per_op,op_num,thread_num\n";
+    for (const auto& result : results) {
+        file << result.name_ << ',' << result.nsPerOp_ << ',' << result.allocsPerOp_ << ',' << result.opNum_ << ',' << result.threadNum_ << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	基準の CSV を読み込む
+ * @param	path		ファイルパス
+ * @param	baseline	名前から結果へのテーブルの格納先
+ * @return	成功した場合は true
+ */
+bool readBaseline(const std::string& path, std::unordered_map<std::string, bench::Result>& baseline) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::string line;
+    std::getline(file, line);  // ヘッダー
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        bench::Result      result;
+        std::string        field;
+        if (!std::getline(stream, result.name_, ',')) {
+            continue;
+        }
+        std::getline(stream, field, ',');
+        result.nsPerOp_ = std::atof(field.c_str());
+        std::getline(stream, field, ',');
+        result.allocsPerOp_ = std::atof(field.c_str());
+        baseline[result.name_] = result;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	バイト毎秒を SI 接頭辞付きで表示する
+ * @param	bytesPerSec	バイト毎秒
+ */
+void printThroughput(double bytesPerSec) {
+    static constexpr const char* units[] = {"", "K", "M", "G", "T"};
+
+    uint32_t unit = 0;
+    while (bytesPerSec >= 1000.0 && unit + 1 < std::size(units)) {
+        bytesPerSec /= 1000.0;
+        unit++;
+    }
+    std::printf("  bytes/s=%.2f%s", bytesPerSec, units[unit]);
+}
+
+}  // namespace
+
+namespace bench {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ * @param	name		ベンチマーク名
+ * @param	func		ベンチマーク関数
+ */
+Registrar::Registrar(const char* name, BenchmarkFunc func) {
+    registry().push_back({name, std::move(func)});
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ベンチマークを実行時に登録する（ main の前に、静的変数の初期化などから呼び出す）
+ * @param	name		ベンチマーク名（ "分類/対象/条件" の形式で、カンマを含まないこと）
+ * @param	func		ベンチマーク関数
+ */
+void add(std::string name, BenchmarkFunc func) {
+    registry().push_back({std::move(name), std::move(func)});
+}
+
+}  // namespace bench
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s [--filter text] [--min-time ms] [--out file] [--baseline file] [--threshold percent] [--list]\n", argv[0]);
+        return 2;
+    }
+
+    auto entries = registry();
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.name_ < b.name_;
+    });
+
+    std::unordered_map<std::string, bench::Result> baseline;
+    if (!options.baseline_.empty() && !readBaseline(options.baseline_, baseline)) {
+        std::fprintf(stderr, "%s を読み込めません\n", options.baseline_.c_str());
+        return 2;
+    }
+
+    std::printf("%-44s %12s %10s %12s", "name", "ns/op", "allocs/op", "ops");
+    if (!baseline.empty()) {
+        std::printf(" %12s %8s", "base ns/op", "diff");
+    }
+    std::printf("\n");
+
+    std::vector<bench::Result> results;
+    uint32_t                   regressionNum = 0;
+    for (const auto& entry : entries) {
+        if (entry.name_.find(options.filter_) == std::string::npos) {
+            continue;
+        }
+        if (options.list_) {
+            std::printf("%s\n", entry.name_.c_str());
+            continue;
+        }
+
+        bench::State state(entry.name_, options.minSec_);
+        entry.func_(state);
+        const auto& result = state.result();
+        if (result.opNum_ == 0) {
+            continue;
+        }
+        results.push_back(result);
+
+        std::printf("%-44s %12.2f", result.name_.c_str(), result.nsPerOp_);
+        if (result.allocsPerOp_ >= 0.0) {
+            std::printf(" %10.3f", result.allocsPerOp_);
+        } else {
+            std::printf(" %10s", "-");
+        }
+        std::printf(" %12llu", static_cast<unsigned long long>(result.opNum_));
+
+        const auto it = baseline.find(result.name_);
+        if (it != baseline.end()) {
+            const auto& base = it->second;
+            const auto  diff = base.nsPerOp_ > 0.0 ? (result.nsPerOp_ / base.nsPerOp_ - 1.0) * 100.0 : 0.0;
+            std::printf(" %12.2f %+7.1f%%", base.nsPerOp_, diff);
+
+            // 確保回数は計測の揺れが無いので、わずかでも増えれば退行とみなす
+            const bool slower = diff > options.threshold_;
+            const bool allocs = result.allocsPerOp_ >= 0.0 && base.allocsPerOp_ >= 0.0 && result.allocsPerOp_ > base.allocsPerOp_ + 0.01;
+            if (slower || allocs) {
+                std::printf("  REGRESSION%s", allocs ? " (allocs)" : "");
+                regressionNum++;
+            }
+        }
+        if (result.bytesPerOp_ > 0 && result.nsPerOp_ > 0.0) {
+            printThroughput(static_cast<double>(result.bytesPerOp_) * 1e9 / result.nsPerOp_);
+        }
+        for (const auto& [name, value] : result.counters_) {
+            std::printf("  %s=%.2f", name.c_str(), value);
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+
+    if (!options.out_.empty() && !writeResults(options.out_, results)) {
+        std::fprintf(stderr, "%s に書き出せません\n", options.out_.c_str());
+        return 2;
+    }
+    if (regressionNum > 0) {
+        std::printf("\n%u benchmark(s) regressed (threshold %.1f%%)\n", regressionNum, options.threshold_);
+        return 1;
+    }
+    return 0;
+}
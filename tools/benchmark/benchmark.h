@@ -0,0 +1,249 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "utility/alloc_counter.h"
+#include "utility/noncopyable.h"
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * マイクロベンチマークのハーネス
+ *
+ * BENCHMARK で登録した関数の中で State::measure を呼び出し、 1 操作あたりの時間と確保回数を計測する
+ * 準備や後始末は measure の外に書けば計測に含まれない
+ * 条件を変えて掃引する場合は bench::add で実行時に登録する（名前順に実行される）
+ */
+namespace bench {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	計測結果
+ */
+struct Result {
+    std::string name_;           ///< ベンチマーク名
+    double      nsPerOp_{};      ///< 1 操作あたりのナノ秒
+    double      allocsPerOp_{};  ///< 1 操作あたりのヒープ確保回数（計測できない場合は負の値）
+    uint64_t    opNum_{};        ///< 計測した操作数
+    uint32_t    threadNum_{};    ///< 計測に使ったスレッド数
+    uint64_t    bytesPerOp_{};   ///< 1 操作で処理するバイト数（ 0 の場合はスループットを出力しない）
+
+    std::vector<std::pair<std::string, double>> counters_{};  ///< 追加の計測値（名前と値）
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	最適化で値の計算が消されないようにする
+ * @param	value		計算結果
+ */
+template <class T>
+inline void doNotOptimize(const T& value) noexcept {
+#if defined(_MSC_VER)
+    static const void* volatile sink;
+    sink = &value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 1 つのベンチマークの計測状態
+ */
+class State final : utility::Noncopyable {
+public:
+    using Clock = std::chrono::steady_clock;
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     * @param	name		ベンチマーク名
+     * @param	minSec		計測時間の下限（秒）
+     */
+    State(std::string_view name, double minSec)
+        : minSec_(minSec) {
+        result_.name_ = name;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	呼び出しスレッドで func を繰り返し呼び出して計測する
+     *
+     * 計測時間が minSec を超えるまで繰り返し回数を増やしながら計測し直す
+     * @param	func		1 操作を行う関数
+     */
+    template <class Func>
+    void measure(Func&& func) {
+        uint64_t opNum = 1;
+        for (;;) {
+            const auto allocStart = utility::alloc::threadCount();
+            const auto start      = Clock::now();
+            for (uint64_t i = 0; i < opNum; i++) {
+                func();
+            }
+            const auto sec = std::chrono::duration<double>(Clock::now() - start).count();
+            if (finish(sec, utility::alloc::threadCount() - allocStart, opNum, 1)) {
+                return;
+            }
+            opNum = nextOpNum(opNum, sec);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	複数のスレッドで同時に func を繰り返し呼び出して計測する
+     *
+     * 全スレッドの準備ができてから一斉に開始し、全スレッドが終わるまでの時間を全操作数で割る
+     * @param	threadNum	スレッド数
+     * @param	func		1 操作を行う関数（引数はスレッドインデックス）
+     */
+    template <class Func>
+    void measureThreads(uint32_t threadNum, Func&& func) {
+        uint64_t opNum = 1;
+        for (;;) {
+            std::atomic<uint32_t>    ready{};
+            std::atomic<bool>        go{};
+            std::atomic<uint64_t>    allocNum{};
+            std::vector<std::thread> threads;
+            threads.reserve(threadNum);
+
+            for (uint32_t t = 0; t < threadNum; t++) {
+                threads.emplace_back([&, t] {
+                    ready.fetch_add(1);
+                    while (!go.load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                    const auto allocStart = utility::alloc::threadCount();
+                    for (uint64_t i = 0; i < opNum; i++) {
+                        func(t);
+                    }
+                    allocNum.fetch_add(utility::alloc::threadCount() - allocStart);
+                });
+            }
+            while (ready.load() < threadNum) {
+                std::this_thread::yield();
+            }
+
+            const auto start = Clock::now();
+            go.store(true, std::memory_order_release);
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            const auto sec = std::chrono::duration<double>(Clock::now() - start).count();
+            if (finish(sec, allocNum.load(), opNum * threadNum, threadNum)) {
+                return;
+            }
+            opNum = nextOpNum(opNum, sec);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	1 操作で処理するバイト数を設定する（結果にバイト毎秒を出力する）
+     * @param	bytes		バイト数
+     */
+    void setBytesPerOp(uint64_t bytes) noexcept {
+        result_.bytesPerOp_ = bytes;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	追加の計測値を結果に加える（速度向上率やパーセンタイルなど）
+     * @param	name		計測値の名前
+     * @param	value		値
+     */
+    void counter(std::string_view name, double value) {
+        result_.counters_.emplace_back(name, value);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	計測結果を取得する（ measure を呼び出していない場合は opNum_ が 0 ）
+     */
+    [[nodiscard]] const Result& result() const noexcept {
+        return result_;
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	計測時間が十分なら結果を確定する
+     * @param	sec			計測時間（秒）
+     * @param	allocNum	計測中の確保回数
+     * @param	opNum		全スレッドの操作数
+     * @param	threadNum	スレッド数
+     * @return	確定した場合は true
+     */
+    bool finish(double sec, uint64_t allocNum, uint64_t opNum, uint32_t threadNum) noexcept {
+        if (sec < minSec_ && opNum < maxOpNum) {
+            return false;
+        }
+        result_.nsPerOp_     = sec * 1e9 / static_cast<double>(opNum);
+        result_.allocsPerOp_ = utility::alloc::enabled() ? static_cast<double>(allocNum) / static_cast<double>(opNum) : -1.0;
+        result_.opNum_       = opNum;
+        result_.threadNum_   = threadNum;
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	次に計測する繰り返し回数を求める（計測時間の下限を少し超える回数にする）
+     * @param	opNum		今回の繰り返し回数
+     * @param	sec			今回の計測時間（秒）
+     */
+    uint64_t nextOpNum(uint64_t opNum, double sec) const noexcept {
+        const auto scale = sec > 0.0 ? minSec_ * 1.2 / sec : 100.0;
+        const auto next  = static_cast<double>(opNum) * std::clamp(scale, 2.0, 100.0);
+        return static_cast<uint64_t>(std::min(next, static_cast<double>(maxOpNum)));
+    }
+
+private:
+    static constexpr uint64_t maxOpNum = 1ull << 32;  ///< 繰り返し回数の上限
+
+    double minSec_;  ///< 計測時間の下限（秒）
+    Result result_;  ///< 計測結果
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ベンチマーク関数の型
+ */
+using BenchmarkFunc = std::function<void(State& state)>;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ベンチマークの登録（静的変数として定義すると main の前に登録される）
+ */
+class Registrar final : utility::Noncopyable {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     * @param	name		ベンチマーク名（ "分類/対象/条件" の形式で、カンマを含まないこと）
+     * @param	func		ベンチマーク関数
+     */
+    Registrar(const char* name, BenchmarkFunc func);
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ベンチマークを実行時に登録する（ main の前に、静的変数の初期化などから呼び出す）
+ * @param	name		ベンチマーク名（ "分類/対象/条件" の形式で、カンマを含まないこと）
+ * @param	func		ベンチマーク関数
+ */
+void add(std::string name, BenchmarkFunc func);
+
+}  // namespace bench
+
+#define BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_IMPL(a, b)
+#define BENCHMARK(name)                                                                                                            \
+    static void                   BENCHMARK_CONCAT(benchmarkFunc, __LINE__)(bench::State & state);                                 \
+    static const bench::Registrar BENCHMARK_CONCAT(benchmarkRegistrar, __LINE__)(name, BENCHMARK_CONCAT(benchmarkFunc, __LINE__)); \
+    static void                   BENCHMARK_CONCAT(benchmarkFunc, __LINE__)(bench::State & state)
@@ -0,0 +1,277 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フライトレコーダーのダンプファイルのデコーダー
+ *
+ * エンジンに依存しない単体のツールで、 Linux でもビルドできる
+ *   g++ -std=c++17 -O2 tools/flight_decode/flight_decode.cpp -o flight_decode
+ *
+ * 使い方
+ *   flight_decode [--frames N] [--thread 名前またはインデックス] ダンプファイル
+ *
+ * すべてのスレッドのレコードを時刻順に並べ、ダンプ時刻からの相対時間（マイクロ秒）で出力する
+ */
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../utility/flight_record_format.h"
+
+namespace {
+
+using namespace utility::flight;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デコードしたスレッド
+ */
+struct Thread {
+    uint32_t            index_;    ///< スレッドインデックス
+    std::string         name_;     ///< スレッド名
+    std::vector<Record> records_;  ///< レコード（古い順）
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デコードしたダンプファイル
+ */
+struct Dump {
+    FileHeader                                header_;   ///< ファイルヘッダー
+    std::vector<Thread>                       threads_;  ///< スレッド
+    std::unordered_map<uint32_t, std::string> names_;    ///< ハッシュ値から名前へのテーブル
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コマンドライン引数
+ */
+struct Options {
+    const char* path_   = nullptr;  ///< ダンプファイルのパス
+    uint32_t    frames_ = 0;        ///< 出力する直近のフレーム数（ 0 はすべて）
+    const char* thread_ = nullptr;  ///< 出力するスレッドの名前またはインデックス（ nullptr はすべて）
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	イベントの種類の表示名
+ */
+const char* eventName(uint16_t type) {
+    static const char* const names[] = {
+        "Frame",
+        "Scope",
+        "ResourceCreate",
+        "QueueSubmit",
+        "FenceSignal",
+        "FenceWait",
+        "DescriptorAlloc",
+        "Present",
+        "Marker",
+        "DescriptorFree",
+    };
+    static_assert(std::size(names) == static_cast<size_t>(EventType::Num));
+    return type < std::size(names) ? names[type] : "Unknown";
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	構造体をそのまま読み込む
+ */
+template <class T>
+bool read(std::ifstream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ダンプファイルを読み込む
+ * @param	path		ファイルパス
+ * @param	dump		読み込み先
+ * @return	成功した場合は true
+ */
+bool load(const char* path, Dump& dump) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::fprintf(stderr, "%s を開けません\n", path);
+        return false;
+    }
+
+    auto& header = dump.header_;
+    if (!read(file, header) || std::memcmp(header.magic_, fileMagic, sizeof(fileMagic)) != 0) {
+        std::fprintf(stderr, "フライトレコーダーのダンプファイルではありません\n");
+        return false;
+    }
+    if (header.version_ != fileVersion || header.recordSize_ != sizeof(Record)) {
+        std::fprintf(stderr, "対応していないバージョンです（ version %u, record %u bytes ）\n", header.version_, header.recordSize_);
+        return false;
+    }
+
+    dump.threads_.resize(header.threadNum_);
+    for (auto& thread : dump.threads_) {
+        ThreadHeader threadHeader{};
+        if (!read(file, threadHeader)) {
+            std::fprintf(stderr, "スレッドヘッダーが途切れています\n");
+            return false;
+        }
+        threadHeader.name_[threadNameMax - 1] = '\0';
+
+        thread.index_ = threadHeader.index_;
+        thread.name_  = threadHeader.name_;
+        thread.records_.resize(threadHeader.recordNum_);
+        if (!file.read(reinterpret_cast<char*>(thread.records_.data()), sizeof(Record) * thread.records_.size())) {
+            std::fprintf(stderr, "レコードが途切れています（スレッド %u ）\n", thread.index_);
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header.nameNum_; i++) {
+        NameHeader name{};
+        if (!read(file, name)) {
+            std::fprintf(stderr, "名前テーブルが途切れています\n");
+            return false;
+        }
+        std::string str(name.length_, '\0');
+        if (!file.read(str.data(), name.length_)) {
+            std::fprintf(stderr, "名前テーブルが途切れています\n");
+            return false;
+        }
+        dump.names_.emplace(name.hash_, std::move(str));
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	スレッドが出力対象か否か
+ */
+bool matchThread(const Thread& thread, const char* filter) {
+    if (filter == nullptr) {
+        return true;
+    }
+    char* end   = nullptr;
+    auto  index = std::strtoul(filter, &end, 10);
+    if (end != filter && *end == '\0') {
+        return thread.index_ == index;
+    }
+    return thread.name_ == filter;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コマンドライン引数を解析する
+ * @return	成功した場合は true
+ */
+bool parse(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            options.frames_ = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--thread") == 0 && i + 1 < argc) {
+            options.thread_ = argv[++i];
+        } else if (argv[i][0] == '-' || options.path_ != nullptr) {
+            return false;
+        } else {
+            options.path_ = argv[i];
+        }
+    }
+    return options.path_ != nullptr;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	タイムライン上の 1 イベント
+ */
+struct Event {
+    const Record* record_;  ///< レコード
+    const Thread* thread_;  ///< 記録したスレッド
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s [--frames N] [--thread name|index] dump-file\n", argv[0]);
+        return 2;
+    }
+
+    Dump dump;
+    if (!load(options.path_, dump)) {
+        return 1;
+    }
+
+    // 全スレッドのレコードを時刻順に並べる
+    std::vector<Event> events;
+    for (const auto& thread : dump.threads_) {
+        for (const auto& record : thread.records_) {
+            events.push_back({&record, &thread});
+        }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.record_->time_ < b.record_->time_;
+    });
+
+    // 直近 N フレームに絞る（ N + 1 個前のフレームの区切り以降を残す）
+    uint64_t begin = 0;
+    if (options.frames_ > 0) {
+        uint32_t frameNum = 0;
+        for (auto it = events.rbegin(); it != events.rend(); ++it) {
+            if (it->record_->type_ == static_cast<uint16_t>(EventType::Frame) && ++frameNum > options.frames_) {
+                begin = it->record_->time_ + 1;
+                break;
+            }
+        }
+    }
+
+    const auto& header     = dump.header_;
+    const auto  toMicrosec = [&](uint64_t time) {
+        return (static_cast<double>(time) - static_cast<double>(header.dumpTime_)) * header.nanosecPerTick_ / 1000.0;
+    };
+    const auto nameOf = [&](uint32_t hash) -> std::string {
+        if (hash == 0) {
+            return "";
+        }
+        auto it = dump.names_.find(hash);
+        if (it != dump.names_.end()) {
+            return it->second;
+        }
+        char temp[16];
+        std::snprintf(temp, sizeof(temp), "#%08x", hash);
+        return temp;
+    };
+
+    std::printf("threads %u, names %u, %.3f ns/tick\n", header.threadNum_, header.nameNum_, header.nanosecPerTick_);
+    for (const auto& thread : dump.threads_) {
+        std::printf("  [%2u] %-24s %zu records\n", thread.index_, thread.name_.c_str(), thread.records_.size());
+    }
+    std::printf("\n%14s  %-16s %-16s %s\n", "time(us)", "thread", "event", "name / args");
+
+    for (const auto& event : events) {
+        const auto& record = *event.record_;
+        if (record.time_ < begin || !matchThread(*event.thread_, options.thread_)) {
+            continue;
+        }
+
+        const auto type = static_cast<EventType>(record.type_);
+        std::printf("%14.3f  %-16.16s %-16s ", toMicrosec(record.time_), event.thread_->name_.c_str(), eventName(record.type_));
+        switch (type) {
+        case EventType::Frame:
+            std::printf("frame %" PRIu64 " (%.3f us)\n", record.arg0_, static_cast<double>(record.arg1_) * header.nanosecPerTick_ / 1000.0);
+            break;
+        case EventType::Scope:
+            std::printf("%*s%s %.3f us (thread %" PRIu64 ")\n", static_cast<int>(record.arg1_ & 0xffff) * 2, "",
+                        nameOf(record.name_).c_str(), static_cast<double>(record.arg0_) * header.nanosecPerTick_ / 1000.0, record.arg1_ >> 16);
+            break;
+        default:
+            std::printf("%s %" PRIu64 " %" PRIu64 "\n", nameOf(record.name_).c_str(), record.arg0_, record.arg1_);
+            break;
+        }
+    }
+
+    return 0;
+}
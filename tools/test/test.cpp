@@ -0,0 +1,113 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * utility と input の単体テスト
+ *
+ * エンジン本体（ engine.vcxproj ）とは別の単体の実行ファイルで、 Linux でもビルドできる
+ *   g++ -std=c++20 -O1 -D_DEBUG -include def.h -I. \
+ *       $(find tools/test utility input -name "*.cpp") -lpthread -o engine_test
+ * _DEBUG を定義すると ASSERT も有効になる
+ *
+ * 使い方
+ *   engine_test [--filter 文字列] [--list]
+ *
+ * 失敗したテストがあれば終了コード 1 を返す
+ */
+#include "tools/test/test.h"
+
+namespace {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	登録済みのテスト
+ */
+struct Entry {
+    const char*    name_;  ///< テスト名
+    test::TestFunc func_;  ///< テスト関数
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	登録済みのテストを取得する
+ */
+std::vector<Entry>& registry() {
+    static std::vector<Entry> entries;
+    return entries;
+}
+
+uint32_t failNum = 0;  ///< 実行中のテストで失敗した CHECK の数
+
+}  // namespace
+
+namespace test {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ * @param	name		テスト名
+ * @param	func		テスト関数
+ */
+Registrar::Registrar(const char* name, TestFunc func) {
+    registry().push_back({name, func});
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	実行中のテストを失敗として記録する
+ * @param	file		ソースファイル名
+ * @param	line		行番号
+ * @param	expression	失敗した条件式
+ */
+void fail(const char* file, int line, const char* expression) {
+    std::printf("    %s:%d: CHECK( %s ) failed\n", file, line, expression);
+    failNum++;
+}
+
+}  // namespace test
+
+int main(int argc, char** argv) {
+    std::string_view filter{};
+    bool             list = false;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter text] [--list]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    auto entries = registry();
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return std::string_view(a.name_) < std::string_view(b.name_);
+    });
+
+    uint32_t runNum    = 0;
+    uint32_t failedNum = 0;
+    for (const auto& entry : entries) {
+        if (std::string_view(entry.name_).find(filter) == std::string_view::npos) {
+            continue;
+        }
+        if (list) {
+            std::printf("%s\n", entry.name_);
+            continue;
+        }
+
+        failNum = 0;
+        entry.func_();
+        runNum++;
+        if (failNum > 0) {
+            failedNum++;
+        }
+        std::printf("[%s] %s\n", failNum == 0 ? "  OK  " : " FAIL ", entry.name_);
+        std::fflush(stdout);
+    }
+
+    if (!list) {
+        std::printf("\n%u test(s), %u failed\n", runNum, failedNum);
+    }
+    return failedNum > 0 ? 1 : 0;
+}
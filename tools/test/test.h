@@ -0,0 +1,60 @@
+﻿#pragma once
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * utility の単体テストのハーネス
+ *
+ * TEST で登録した関数の中で CHECK を使って条件を確認する
+ * CHECK が失敗してもテストは続行し、失敗した箇所をすべて出力する
+ */
+#include "utility/noncopyable.h"
+
+namespace test {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	テスト関数の型
+ */
+using TestFunc = void (*)();
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * テストの登録（静的変数として定義すると main の前に登録される）
+ */
+class Registrar final : utility::Noncopyable {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     * @param	name		テスト名（ "分類/対象/条件" の形式）
+     * @param	func		テスト関数
+     */
+    Registrar(const char* name, TestFunc func);
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	実行中のテストを失敗として記録する
+ * @param	file		ソースファイル名
+ * @param	line		行番号
+ * @param	expression	失敗した条件式
+ */
+void fail(const char* file, int line, const char* expression);
+
+}  // namespace test
+
+#define TEST_CONCAT_IMPL(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_IMPL(a, b)
+#define TEST(name)                                                                                            \
+    static void                  TEST_CONCAT(testFunc, __LINE__)();                                           \
+    static const test::Registrar TEST_CONCAT(testRegistrar, __LINE__)(name, TEST_CONCAT(testFunc, __LINE__)); \
+    static void                  TEST_CONCAT(testFunc, __LINE__)()
+
+#define CHECK(expression)                                \
+    do {                                                 \
+        if (!(expression)) {                             \
+            test::fail(__FILE__, __LINE__, #expression); \
+        }                                                \
+    } while (0)
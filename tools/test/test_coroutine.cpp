@@ -0,0 +1,218 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * コルーチンスケジューラのテスト（ ManualFenceSource と実際のジョブシステムで動かす）
+ */
+#include "tools/test/test.h"
+
+#include <chrono>
+#include <fstream>
+
+#include "utility/coroutine.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto timeout = std::chrono::seconds(10);  ///< 再開を待つ時間の上限
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	条件を満たすまでフェンス待ちを確認しながら待機する
+ * @param	condition	条件
+ * @return	時間内に条件を満たした場合は true
+ */
+template <class Func>
+bool waitUntil(Func&& condition) {
+    const auto limit = Clock::now() + timeout;
+    while (!condition()) {
+        if (Clock::now() > limit) {
+            return false;
+        }
+        utility::CoroutineScheduler::instance().poll();
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	テスト中だけジョブシステムを起動する
+ */
+struct JobSystemScope {
+    JobSystemScope() {
+        utility::JobSystem::instance().start(2);
+    }
+    ~JobSystemScope() {
+        utility::JobSystem::instance().stop();
+    }
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フェンス値に到達するまで待機するタスク
+ */
+utility::Task<> fenceTask(const utility::FenceSource& fence, uint64_t value, std::atomic<bool>& resumed) {
+    co_await utility::waitFence(fence, value);
+    resumed.store(true);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	次のフレームまで待機し、待機前後のフレーム番号を記録するタスク
+ */
+utility::Task<> frameTask(std::atomic<uint64_t>& before, std::atomic<uint64_t>& after) {
+    before.store(utility::CoroutineScheduler::instance().frame());
+    co_await utility::nextFrame();
+    after.store(utility::CoroutineScheduler::instance().frame());
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ワーカー上に移り、移る前後のワーカーインデックスを記録するタスク
+ */
+utility::Task<> scheduleTask(std::atomic<int32_t>& before, std::atomic<int32_t>& after) {
+    before.store(utility::JobSystem::workerIndex());
+    co_await utility::schedule();
+    after.store(utility::JobSystem::workerIndex());
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ファイルを読み込むタスク
+ */
+utility::Task<std::vector<uint8_t>> readTask(std::string path) {
+    co_return co_await utility::readFile(path);
+}
+
+}  // namespace
+
+TEST("coroutine/waitFence/resumes only after the fence reaches the value") {
+    JobSystemScope              jobs;
+    auto&                       scheduler = utility::CoroutineScheduler::instance();
+    utility::ManualFenceSource  fence;
+    std::atomic<bool>           resumed{};
+
+    scheduler.spawn(fenceTask(fence, 5, resumed));
+    CHECK(waitUntil([&] { return scheduler.inFlight() == 1; }));
+
+    // 到達していないフェンス値では何度 poll しても再開しない
+    fence.signal(4);
+    for (int i = 0; i < 100; i++) {
+        scheduler.poll();
+        std::this_thread::yield();
+    }
+    CHECK(!resumed.load());
+    CHECK(scheduler.inFlight() == 1);
+
+    fence.signal(5);
+    CHECK(waitUntil([&] { return resumed.load() && scheduler.inFlight() == 0; }));
+}
+
+TEST("coroutine/waitFence/already reached value does not suspend") {
+    JobSystemScope             jobs;
+    auto&                      scheduler = utility::CoroutineScheduler::instance();
+    utility::ManualFenceSource fence;
+    std::atomic<bool>          resumed{};
+
+    fence.signal(10);
+    scheduler.spawn(fenceTask(fence, 3, resumed));
+    CHECK(waitUntil([&] { return resumed.load() && scheduler.inFlight() == 0; }));
+}
+
+TEST("coroutine/nextFrame/resumes on the next advanceFrame") {
+    JobSystemScope        jobs;
+    auto&                 scheduler = utility::CoroutineScheduler::instance();
+    std::atomic<uint64_t> before{~0ull};
+    std::atomic<uint64_t> after{~0ull};
+
+    scheduler.spawn(frameTask(before, after));
+    CHECK(waitUntil([&] { return before.load() != ~0ull; }));
+
+    // フレームを進めるまでは再開しない
+    for (int i = 0; i < 100; i++) {
+        scheduler.poll();
+        std::this_thread::yield();
+    }
+    CHECK(after.load() == ~0ull);
+
+    // 待機の登録より先にフレームを進めた場合は次のフレームで再開するので、完了するまで進める
+    CHECK(waitUntil([&] {
+        scheduler.advanceFrame();
+        return after.load() != ~0ull && scheduler.inFlight() == 0;
+    }));
+    CHECK(after.load() > before.load());
+}
+
+TEST("coroutine/schedule/moves the coroutine onto a worker") {
+    constexpr int32_t    notRun = -2;
+    std::atomic<int32_t> before{notRun};
+    std::atomic<int32_t> after{notRun};
+
+    // ワーカーの停止を待ってからタスクを破棄するよう、ジョブシステムより先に宣言する
+    auto           task = scheduleTask(before, after);
+    JobSystemScope jobs;
+
+    // spawn はワーカー上で開始するので、待機オブジェクトを使って呼び出しスレッドで開始する
+    auto awaiter = task.operator co_await();
+    awaiter.await_suspend(std::noop_coroutine()).resume();
+    CHECK(before.load() == -1);
+    CHECK(waitUntil([&] { return after.load() != notRun; }));
+    CHECK(after.load() >= 0);
+}
+
+TEST("coroutine/readFile/reads the whole file on a worker") {
+    JobSystemScope jobs;
+
+    const auto           path = std::filesystem::temp_directory_path() / "engine_test_coroutine_read.bin";
+    std::vector<uint8_t> expected(100000);
+    for (size_t i = 0; i < expected.size(); i++) {
+        expected[i] = static_cast<uint8_t>(i * 31);
+    }
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(expected.data()), static_cast<std::streamsize>(expected.size()));
+    }
+
+    CHECK(utility::syncWait(readTask(path.string())) == expected);
+    std::filesystem::remove(path);
+
+    // 存在しないファイルは空のデータになる
+    CHECK(utility::syncWait(readTask((path.string() + ".missing"))).empty());
+}
+
+TEST("coroutine/inFlight/drains after fences and frames complete") {
+    JobSystemScope             jobs;
+    auto&                      scheduler = utility::CoroutineScheduler::instance();
+    utility::ManualFenceSource fence;
+
+    constexpr uint32_t    taskNum = 64;
+    std::atomic<bool>     resumed[taskNum]{};
+    std::atomic<uint64_t> before[taskNum]{};
+    std::atomic<uint64_t> after[taskNum]{};
+    for (uint32_t i = 0; i < taskNum; i++) {
+        after[i].store(~0ull);
+        scheduler.spawn(fenceTask(fence, i + 1, resumed[i]));
+        scheduler.spawn(frameTask(before[i], after[i]));
+    }
+    CHECK(scheduler.inFlight() == taskNum * 2);
+
+    // フェンスを半分まで進めると、その分だけ完了する
+    fence.signal(taskNum / 2);
+    CHECK(waitUntil([&] { return scheduler.inFlight() == taskNum * 2 - taskNum / 2; }));
+    for (uint32_t i = 0; i < taskNum; i++) {
+        CHECK(resumed[i].load() == (i < taskNum / 2));
+    }
+
+    // フェンス待ちが完了しても、次フレーム待ちはフレームを進めるまで残る
+    fence.signal(taskNum);
+    CHECK(waitUntil([&] { return scheduler.inFlight() == taskNum; }));
+    for (auto& a : after) {
+        CHECK(a.load() == ~0ull);
+    }
+
+    CHECK(waitUntil([&] {
+        scheduler.advanceFrame();
+        return scheduler.inFlight() == 0;
+    }));
+}
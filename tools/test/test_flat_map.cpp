@@ -0,0 +1,186 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * オープンアドレス方式のハッシュマップ（ FlatMap ）のテスト
+ */
+#include "tools/test/test.h"
+
+#include <atomic>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "utility/flat_map.h"
+
+namespace {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	わざと衝突させるハッシュ（同じプローブ列と制御バイトに集める）
+ */
+struct CollidingHash {
+    [[nodiscard]] uint64_t operator()(uint64_t value) const noexcept {
+        return value & 0x7;
+    }
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	追加と削除をランダムに繰り返し、 std::unordered_map と内容が一致するか確認する
+ * @return	一致しなかった回数
+ */
+template <class Map>
+uint32_t randomChurn(Map& map, uint32_t opNum, uint64_t keyRange, uint32_t seed) {
+    std::unordered_map<uint64_t, uint64_t> reference;
+    std::mt19937_64                        random(seed);
+    uint32_t                               mismatch = 0;
+
+    for (uint32_t i = 0; i < opNum; i++) {
+        const auto key = random() % keyRange;
+        switch (random() % 4) {
+        case 0:
+        case 1:
+            map.insertOrAssign(key, uint64_t(i));
+            reference[key] = i;
+            break;
+        case 2:
+            mismatch += (map.erase(key) != (reference.erase(key) != 0)) ? 1 : 0;
+            break;
+        default: {
+            const auto* value = map.findValue(key);
+            const auto  it    = reference.find(key);
+            mismatch += ((value != nullptr) != (it != reference.end())) ? 1 : 0;
+            mismatch += (value && *value != it->second) ? 1 : 0;
+            break;
+        }
+        }
+        mismatch += (map.size() != reference.size()) ? 1 : 0;
+    }
+
+    // 反復で全要素を 1 回ずつ巡回できる
+    size_t visited = 0;
+    for (const auto& [key, value] : map) {
+        const auto it = reference.find(key);
+        mismatch += (it == reference.end() || it->second != value) ? 1 : 0;
+        visited++;
+    }
+    mismatch += (visited != reference.size()) ? 1 : 0;
+    return mismatch;
+}
+
+}  // namespace
+
+TEST("flat_map/stress/random insert and erase match std::unordered_map") {
+    // 削除済みの印が溜まる状態と、再構築による拡張の両方を通す
+    utility::FlatMap<uint64_t, uint64_t> small;
+    CHECK(randomChurn(small, 200000, 64, 1) == 0);
+
+    utility::FlatMap<uint64_t, uint64_t> large;
+    CHECK(randomChurn(large, 200000, 20000, 2) == 0);
+}
+
+TEST("flat_map/stress/colliding hashes probe across groups") {
+    utility::FlatMap<uint64_t, uint64_t, CollidingHash> map;
+    CHECK(randomChurn(map, 50000, 512, 3) == 0);
+}
+
+TEST("flat_map/stress/string keys survive rehash and heterogeneous lookup") {
+    utility::FlatMap<std::string, uint32_t> map;
+    constexpr uint32_t                      num = 20000;
+    for (uint32_t i = 0; i < num; i++) {
+        map.tryEmplace("key" + std::to_string(i), i);
+    }
+    for (uint32_t i = 0; i < num; i += 2) {
+        map.erase("key" + std::to_string(i));
+    }
+    CHECK(map.size() == num / 2);
+
+    uint32_t mismatch = 0;
+    for (uint32_t i = 0; i < num; i++) {
+        const auto  key   = "key" + std::to_string(i);
+        const auto* value = map.findValue(std::string_view(key));
+        mismatch += (i % 2 == 0) ? (value != nullptr) : (!value || *value != i);
+    }
+    CHECK(mismatch == 0);
+}
+
+TEST("flat_map/concurrency/const lookups from many threads") {
+    // 変更しない間は、複数のスレッドから同時に検索できる
+    utility::FlatMap<uint64_t, uint64_t> map;
+    constexpr uint64_t                   num = 10000;
+    for (uint64_t i = 0; i < num; i++) {
+        map.tryEmplace(i * 3, i);
+    }
+
+    const auto&              shared = map;
+    std::atomic<uint32_t>    mismatch{};
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < 4; t++) {
+        threads.emplace_back([&shared, &mismatch, t]() {
+            for (uint64_t i = 0; i < num * 3; i++) {
+                const auto  key   = (i + t * 7919) % (num * 3);
+                const auto* value = shared.findValue(key);
+                const bool  ok    = (key % 3 == 0) ? (value && *value == key / 3) : (value == nullptr);
+                if (!ok) {
+                    mismatch.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHECK(mismatch.load() == 0);
+}
+
+TEST("flat_map/concurrency/readers and a writer behind a shared_mutex") {
+    // TimeContainer と同じ使い方（検索は共有ロック、追加と削除は排他ロック）
+    utility::FlatMap<uint64_t, uint64_t> map;
+    std::shared_mutex                    mutex;
+    std::atomic<bool>                    finished{};
+    std::atomic<uint32_t>                mismatch{};
+    std::atomic<uint64_t>                found{};
+    constexpr uint64_t                   keyRange = 4096;
+
+    std::vector<std::thread> readers;
+    for (uint32_t t = 0; t < 3; t++) {
+        readers.emplace_back([&, t]() {
+            uint64_t key = t;
+            while (!finished.load(std::memory_order_acquire)) {
+                key = (key + 131) % keyRange;
+                std::shared_lock lock(mutex);
+                if (const auto* value = map.findValue(key)) {
+                    // 値は常にキーから決まるので、再構築の途中を読んでいれば一致しない
+                    if (*value != key * 2 + 1) {
+                        mismatch.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    found.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    std::mt19937_64 random(4);
+    for (uint32_t i = 0; i < 100000; i++) {
+        const auto       key = random() % keyRange;
+        std::unique_lock lock(mutex);
+        if (random() % 3 == 0) {
+            map.erase(key);
+        } else {
+            map.insertOrAssign(key, key * 2 + 1);
+        }
+        if (i % 1024 == 0) {
+            lock.unlock();
+            std::this_thread::yield();
+        }
+    }
+    finished.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    CHECK(mismatch.load() == 0);
+    CHECK(found.load() > 0);
+}
@@ -0,0 +1,95 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フライトレコーダーの書き出しのテスト
+ */
+#include "tools/test/test.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "utility/flight_recorder.h"
+#include "utility/profiler.h"
+
+namespace {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	書き出したファイルを読み込む
+ */
+std::vector<char> readFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ファイルの先頭からヘッダーを取り出す
+ */
+utility::flight::FileHeader readHeader(const std::vector<char>& data) {
+    utility::flight::FileHeader header{};
+    if (data.size() >= sizeof(header)) {
+        std::memcpy(&header, data.data(), sizeof(header));
+    }
+    return header;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ファイルにハッシュ値の名前が含まれているか
+ */
+bool containsName(const std::vector<char>& data, std::string_view name) {
+    return std::search(data.begin(), data.end(), name.begin(), name.end()) != data.end();
+}
+
+}  // namespace
+
+TEST("flight_recorder/dump/writes the header, records and names") {
+    FLIGHT_RECORD(utility::FlightEvent::Marker, "test/flight_recorder/dump", 1, 2);
+
+    const auto path = std::filesystem::temp_directory_path() / "engine_test_flight_dump.bin";
+    CHECK(utility::FlightRecorder::instance().dump(path));
+
+    const auto data   = readFile(path);
+    const auto header = readHeader(data);
+    CHECK(std::memcmp(header.magic_, utility::flight::fileMagic, sizeof(header.magic_)) == 0);
+    CHECK(header.version_ == utility::flight::fileVersion);
+    CHECK(header.recordSize_ == sizeof(utility::flight::Record));
+    CHECK(header.threadNum_ >= 1);
+    CHECK(header.nanosecPerTick_ > 0.0);
+    CHECK(containsName(data, "test/flight_recorder/dump"));
+    std::filesystem::remove(path);
+}
+
+TEST("flight_recorder/dumpOnCrash/writes to the installed path with the cached tick rate") {
+    auto& recorder = utility::FlightRecorder::instance();
+    FLIGHT_RECORD(utility::FlightEvent::Marker, "test/flight_recorder/crash");
+
+    const auto path = std::filesystem::temp_directory_path() / "engine_test_flight_crash.bin";
+    std::filesystem::remove(path);
+    CHECK(!recorder.dumpOnCrash());
+
+    recorder.installCrashHandler(path);
+    // テスト中のクラッシュで書き出さないよう、ハンドラは戻しておく
+    utility::setAssertHook(nullptr);
+#if defined(_WIN32)
+    SetUnhandledExceptionFilter(nullptr);
+#else
+    for (const auto sig : {SIGSEGV, SIGABRT, SIGFPE, SIGILL}) {
+        std::signal(sig, SIG_DFL);
+    }
+#endif
+
+    CHECK(recorder.dumpOnCrash());
+    const auto data   = readFile(path);
+    const auto header = readHeader(data);
+    CHECK(std::memcmp(header.magic_, utility::flight::fileMagic, sizeof(header.magic_)) == 0);
+    CHECK(header.nanosecPerTick_ == utility::Profiler::instance().toMicrosec(1'000'000) / 1000.0);
+    CHECK(containsName(data, "test/flight_recorder/crash"));
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,133 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 入力状態（ InputSnapshot ）と入力管理（ Input ）のテスト
+ */
+#include "tools/test/test.h"
+
+#include "input/input.h"
+
+namespace {
+
+constexpr uint16_t keyA = 'A';  ///< テストに使うキーコード
+constexpr uint16_t keyB = 'B';  ///< テストに使うキーコード
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	キーのイベントを作成する
+ */
+input::Event keyEvent(input::EventType type, uint16_t key) {
+    return input::Event{type, key, 0, 0, input::eventTime()};
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	マウスボタンのイベントを作成する
+ */
+input::Event buttonEvent(input::EventType type, input::MouseButton button) {
+    return input::Event{type, static_cast<uint16_t>(button), 10, 20, input::eventTime()};
+}
+
+}  // namespace
+
+TEST("input/snapshot/press and release in the same frame reports both edges") {
+    input::InputSnapshot snapshot;
+    snapshot.beginFrame();
+    snapshot.apply(keyEvent(input::EventType::KeyDown, keyA));
+    snapshot.apply(keyEvent(input::EventType::KeyUp, keyA));
+    CHECK(!snapshot.isDown(keyA));
+    CHECK(snapshot.isPressed(keyA));
+    CHECK(snapshot.isReleased(keyA));
+
+    // 次のフレームでは瞬間の状態が消える
+    snapshot.beginFrame();
+    CHECK(!snapshot.isPressed(keyA));
+    CHECK(!snapshot.isReleased(keyA));
+}
+
+TEST("input/snapshot/held key stays down without repeating the press edge") {
+    input::InputSnapshot snapshot;
+    snapshot.beginFrame();
+    snapshot.apply(keyEvent(input::EventType::KeyDown, keyA));
+    CHECK(snapshot.isDown(keyA));
+    CHECK(snapshot.isPressed(keyA));
+
+    for (int frame = 0; frame < 3; frame++) {
+        snapshot.beginFrame();
+        CHECK(snapshot.isDown(keyA));
+        CHECK(!snapshot.isPressed(keyA));
+        CHECK(!snapshot.isReleased(keyA));
+    }
+
+    // 押下中の KeyDown は押された瞬間にしない
+    snapshot.apply(keyEvent(input::EventType::KeyDown, keyA));
+    CHECK(!snapshot.isPressed(keyA));
+
+    snapshot.beginFrame();
+    snapshot.apply(keyEvent(input::EventType::KeyUp, keyA));
+    CHECK(!snapshot.isDown(keyA));
+    CHECK(snapshot.isReleased(keyA));
+}
+
+TEST("input/snapshot/focus lost releases every held key and button") {
+    input::InputSnapshot snapshot;
+    snapshot.beginFrame();
+    snapshot.apply(keyEvent(input::EventType::KeyDown, keyA));
+    snapshot.apply(keyEvent(input::EventType::KeyDown, keyB));
+    snapshot.apply(buttonEvent(input::EventType::MouseButtonDown, input::MouseButton::Left));
+
+    snapshot.beginFrame();
+    snapshot.apply(input::Event{input::EventType::FocusLost, 0, 0, 0, input::eventTime()});
+    CHECK(!snapshot.isDown(keyA));
+    CHECK(!snapshot.isDown(keyB));
+    CHECK(!snapshot.isDown(input::MouseButton::Left));
+    CHECK(snapshot.isReleased(keyA));
+    CHECK(snapshot.isReleased(keyB));
+    CHECK(snapshot.isReleased(input::MouseButton::Left));
+    CHECK(snapshot.isReleased(input::mouseButtonKeys[0]));
+
+    // 離されていないキーは離された瞬間にしない
+    CHECK(!snapshot.isReleased('C'));
+
+    // 押下中のものが無いので KeyUp は無視する
+    snapshot.beginFrame();
+    snapshot.apply(keyEvent(input::EventType::KeyUp, keyA));
+    CHECK(!snapshot.isReleased(keyA));
+}
+
+TEST("input/snapshot/mouse buttons are mirrored into the key state") {
+    input::InputSnapshot snapshot;
+    snapshot.beginFrame();
+    snapshot.apply(buttonEvent(input::EventType::MouseButtonDown, input::MouseButton::Right));
+    CHECK(snapshot.isDown(input::MouseButton::Right));
+    CHECK(snapshot.isDown(input::mouseButtonKeys[static_cast<size_t>(input::MouseButton::Right)]));
+    CHECK(snapshot.isPressed(input::mouseButtonKeys[static_cast<size_t>(input::MouseButton::Right)]));
+    CHECK(!snapshot.isDown(input::mouseButtonKeys[static_cast<size_t>(input::MouseButton::Left)]));
+    CHECK(snapshot.mouseX() == 10);
+    CHECK(snapshot.mouseY() == 20);
+
+    snapshot.beginFrame();
+    snapshot.apply(buttonEvent(input::EventType::MouseButtonUp, input::MouseButton::Right));
+    CHECK(!snapshot.isDown(input::mouseButtonKeys[static_cast<size_t>(input::MouseButton::Right)]));
+    CHECK(snapshot.isReleased(input::mouseButtonKeys[static_cast<size_t>(input::MouseButton::Right)]));
+}
+
+TEST("input/Input/update applies queued events to getKey") {
+    auto& in = input::Input::instance();
+    in.update();
+
+    CHECK(in.pushEvent(keyEvent(input::EventType::KeyDown, keyA)));
+    CHECK(in.pushEvent(buttonEvent(input::EventType::MouseButtonDown, input::MouseButton::Left)));
+    CHECK(!in.getKey(keyA));  // update するまでは反映しない
+
+    in.update();
+    CHECK(in.getKey(keyA));
+    CHECK(in.getKeyPressed(keyA));
+    CHECK(in.getKey(input::mouseButtonKeys[static_cast<size_t>(input::MouseButton::Left)]));
+
+    CHECK(in.pushEvent(input::Event{input::EventType::FocusLost, 0, 0, 0, input::eventTime()}));
+    in.update();
+    CHECK(!in.getKey(keyA));
+    CHECK(in.getKeyReleased(keyA));
+    CHECK(!in.getKey(input::mouseButtonKeys[static_cast<size_t>(input::MouseButton::Left)]));
+}
@@ -0,0 +1,172 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 非同期ロガー（ Logger ）のスレッドごとのリングバッファの並行テスト
+ */
+#include "tools/test/test.h"
+
+#include <cstdio>
+#include <thread>
+
+#include "utility/logger.h"
+
+namespace {
+
+constexpr uint32_t ringCapacity = 1024;  ///< ロガーのスレッドごとのエントリ数
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 出力された行を集める出力先
+ */
+class CaptureSink final : public utility::LogSink {
+public:
+    CaptureSink(std::vector<std::string>& lines, std::mutex& mutex) : lines_(lines), mutex_(mutex) {}
+
+    void write(utility::LogLevel, std::string_view line) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lines_.emplace_back(line);
+    }
+
+private:
+    std::vector<std::string>& lines_;  ///< 出力された行の格納先
+    std::mutex&               mutex_;  ///< lines_ の同期オブジェクト
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	テスト中だけ出力先を CaptureSink に差し替える
+ */
+struct CaptureScope {
+    CaptureScope() {
+        auto& logger = utility::Logger::instance();
+        logger.flush();
+        logger.clearSinks();
+        logger.addSink(std::make_unique<CaptureSink>(lines_, mutex_));
+    }
+    ~CaptureScope() {
+        auto& logger = utility::Logger::instance();
+        logger.stop();
+        logger.clearSinks();
+        logger.addSink(std::make_unique<utility::DebugLogSink>());
+    }
+
+    std::vector<std::string> lines_{};  ///< 出力された行
+    std::mutex               mutex_{};  ///< lines_ の同期オブジェクト
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	出力された行を集計した結果
+ */
+struct Summary {
+    std::vector<uint32_t> written_{};     ///< スレッドごとに出力されたエントリ数
+    uint64_t              reported_{};    ///< 破棄した数として通知された合計
+    uint32_t              outOfOrder_{};  ///< 同じスレッド内で順序が入れ替わった、または重複した数
+    uint32_t              malformed_{};   ///< 引数を復元できなかった行の数
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	"stress <スレッド> <通し番号> <文字列>" の行と破棄の通知を集計する
+ */
+Summary summarize(const std::vector<std::string>& lines, uint32_t threadNum) {
+    Summary              summary;
+    std::vector<int64_t> last(threadNum, -1);
+    summary.written_.resize(threadNum);
+
+    for (const auto& line : lines) {
+        unsigned long long dropped = 0;
+        if (const auto pos = line.find("] [--] "); pos != std::string::npos) {
+            if (std::sscanf(line.c_str() + pos, "] [--] %llu log entries dropped", &dropped) == 1) {
+                summary.reported_ += dropped;
+            }
+            continue;
+        }
+
+        const auto pos = line.find("stress ");
+        if (pos == std::string::npos) {
+            continue;
+        }
+        uint32_t thread   = 0;
+        uint32_t index    = 0;
+        char     text[16] = {};
+        if (std::sscanf(line.c_str() + pos, "stress %u %u %15s", &thread, &index, text) != 3 || thread >= threadNum ||
+            std::string_view(text) != "payload") {
+            summary.malformed_++;
+            continue;
+        }
+        if (static_cast<int64_t>(index) <= last[thread]) {
+            summary.outOfOrder_++;
+        }
+        last[thread] = index;
+        summary.written_[thread]++;
+    }
+    return summary;
+}
+
+}  // namespace
+
+TEST("logger/stress/every entry is written once in order or counted as dropped") {
+    constexpr uint32_t threadNum = 4;
+    constexpr uint32_t entryNum  = 20000;
+
+    auto&        logger = utility::Logger::instance();
+    CaptureScope capture;
+    const auto   droppedBefore = logger.droppedNum();
+
+    // バックグラウンドスレッドの回収と並行して、複数のスレッドから記録する
+    logger.start();
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadNum; t++) {
+        threads.emplace_back([&logger, t] {
+            for (uint32_t i = 0; i < entryNum; i++) {
+                logger.write(utility::LogLevel::Info, "stress %u %u %s", t, i, "payload");
+                if (i % 64 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    logger.stop();
+
+    const auto dropped = logger.droppedNum() - droppedBefore;
+    const auto summary = summarize(capture.lines_, threadNum);
+
+    uint64_t written = 0;
+    for (auto num : summary.written_) {
+        written += num;
+    }
+    CHECK(summary.malformed_ == 0);
+    CHECK(summary.outOfOrder_ == 0);
+    CHECK(written + dropped == threadNum * entryNum);
+    CHECK(summary.reported_ == dropped);
+}
+
+TEST("logger/ring/drops only what does not fit while nothing drains") {
+    constexpr uint32_t overflowNum = 100;
+
+    auto&        logger = utility::Logger::instance();
+    CaptureScope capture;
+    const auto   droppedBefore = logger.droppedNum();
+
+    // 新しいスレッドは空のリングバッファから始まる
+    std::thread writer([&logger] {
+        for (uint32_t i = 0; i < ringCapacity + overflowNum; i++) {
+            logger.write(utility::LogLevel::Info, "stress %u %u %s", 0u, i, "payload");
+        }
+    });
+    writer.join();
+    CHECK(logger.droppedNum() - droppedBefore == overflowNum);
+
+    // 残ったのはリングバッファに収まった先頭の分
+    logger.flush();
+    const auto summary = summarize(capture.lines_, 1);
+    CHECK(summary.malformed_ == 0);
+    CHECK(summary.outOfOrder_ == 0);
+    CHECK(summary.written_[0] == ringCapacity);
+    CHECK(summary.reported_ == overflowNum);
+}
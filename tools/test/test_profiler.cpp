@@ -0,0 +1,44 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * プロファイラから TimeContainer への集計のテスト
+ */
+#include "tools/test/test.h"
+
+#include "utility/profiler.h"
+#include "utility/time_counter.h"
+
+namespace {
+
+constexpr const char* scopeName = "test/profiler/scope";  ///< 計測に使うスコープ名
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	スコープを指定回数記録してフレームを区切り、集計した回数を返す
+ */
+uint64_t recordScopes(uint32_t num) {
+    for (uint32_t i = 0; i < num; i++) {
+        PROFILE_SCOPE(scopeName);
+    }
+    PROFILE_FRAME();
+
+    auto& container = TIME_CONTAINER();
+    container.rotate();
+    return container.stats(scopeName).count_;
+}
+
+}  // namespace
+
+TEST("profiler/markFrame/records finished scopes into the time histogram") {
+    TIME_CONTAINER().remove(scopeName);
+    CHECK(recordScopes(3) == 3);
+    CHECK(recordScopes(2) == 2);
+}
+
+TEST("profiler/markFrame/re-creates the histogram after remove") {
+    // 記録先を保持したままだと、 remove で破棄したヒストグラムに書き込んでしまう
+    CHECK(recordScopes(1) == 1);
+    TIME_CONTAINER().remove(scopeName);
+    CHECK(TIME_CONTAINER().stats(scopeName).count_ == 0);
+    CHECK(recordScopes(4) == 4);
+}
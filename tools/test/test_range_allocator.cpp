@@ -0,0 +1,214 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 連続範囲の割り当て（ RangeAllocator ）のテスト
+ */
+#include "tools/test/test.h"
+
+#include "utility/fence_source.h"
+#include "utility/range_allocator.h"
+
+namespace {
+using Allocation = utility::RangeAllocator::Allocation;
+}  // namespace
+
+TEST("range/allocate/splits the free range from the front") {
+    utility::RangeAllocator allocator(100);
+    const auto              a = allocator.allocate(10);
+    const auto              b = allocator.allocate(20);
+    CHECK(a.valid() && a.offset_ == 0 && a.num_ == 10);
+    CHECK(b.valid() && b.offset_ == 10 && b.num_ == 20);
+    CHECK(allocator.freeNum() == 70);
+    CHECK(allocator.largestFree() == 70);
+}
+
+TEST("range/free/coalesces with both neighbours") {
+    utility::RangeAllocator allocator(64);
+    const auto              a = allocator.allocate(16);
+    const auto              b = allocator.allocate(16);
+    const auto              c = allocator.allocate(16);
+    const auto              d = allocator.allocate(16);
+    CHECK(allocator.freeNum() == 0);
+    CHECK(allocator.largestFree() == 0);
+
+    // 離れた 2 つを解放しても結合されない
+    allocator.free(a);
+    allocator.free(c);
+    CHECK(allocator.freeNum() == 32);
+    CHECK(allocator.largestFree() == 16);
+
+    // 間を解放すると前後と結合する
+    allocator.free(b);
+    CHECK(allocator.largestFree() == 48);
+    const auto big = allocator.allocate(48);
+    CHECK(big.valid() && big.offset_ == 0);
+
+    allocator.free(big);
+    allocator.free(d);
+    CHECK(allocator.freeNum() == 64);
+    CHECK(allocator.largestFree() == 64);
+}
+
+TEST("range/largestFree/tracks the biggest hole, not the total") {
+    utility::RangeAllocator allocator(1000);
+    std::vector<Allocation> allocations;
+    for (int i = 0; i < 10; i++) {
+        allocations.push_back(allocator.allocate(100));
+    }
+
+    // 100 ・ 200 ・ 300 の穴を空ける
+    allocator.free(allocations[0]);
+    allocator.free(allocations[2]);
+    allocator.free(allocations[3]);
+    allocator.free(allocations[5]);
+    allocator.free(allocations[6]);
+    allocator.free(allocations[7]);
+    CHECK(allocator.freeNum() == 600);
+    CHECK(allocator.largestFree() == 300);
+
+    // 最大の穴より大きい確保は合計が足りていても失敗する
+    CHECK(!allocator.allocate(301).valid());
+    const auto fit = allocator.allocate(300);
+    CHECK(fit.valid() && fit.offset_ == 500);
+    CHECK(allocator.largestFree() == 200);
+}
+
+TEST("range/free/deferred ranges are reclaimed in fence order") {
+    utility::RangeAllocator allocator(30);
+    const auto              a = allocator.allocate(10);
+    const auto              b = allocator.allocate(10);
+    const auto              c = allocator.allocate(10);
+
+    allocator.free(a, 1);
+    allocator.free(b, 2);
+    allocator.free(c, 2);
+    CHECK(allocator.pendingNum() == 3);
+    CHECK(allocator.freeNum() == 0);
+    CHECK(!allocator.allocate(1).valid());  // フェンス完了前は再利用しない
+
+    CHECK(allocator.reclaim(0) == 0);
+    CHECK(allocator.reclaim(1) == 1);
+    CHECK(allocator.pendingNum() == 2);
+    CHECK(allocator.freeNum() == 10);
+    CHECK(allocator.largestFree() == 10);
+
+    const auto reuse = allocator.allocate(10);
+    CHECK(reuse.valid() && reuse.offset_ == a.offset_);
+
+    CHECK(allocator.reclaim(5) == 2);
+    CHECK(allocator.pendingNum() == 0);
+    CHECK(allocator.freeNum() == 20);
+    CHECK(allocator.largestFree() == 20);
+}
+
+TEST("range/free/deferred frees with non-monotonic fences are reclaimed by fence") {
+    // 複数の所有者が別々のフレームのフェンス値で解放すると、解放順とフェンス値の順が一致しない
+    utility::RangeAllocator allocator(40);
+    const auto              a = allocator.allocate(10);
+    const auto              b = allocator.allocate(10);
+    const auto              c = allocator.allocate(10);
+    const auto              d = allocator.allocate(10);
+
+    allocator.free(a, 5);
+    allocator.free(b, 2);
+    allocator.free(c, 7);
+    allocator.free(d, 3);
+    CHECK(allocator.pendingNum() == 4);
+
+    // 先頭のフェンス値が未完了でも、完了した分はすべて解放される
+    CHECK(allocator.reclaim(3) == 2);
+    CHECK(allocator.freeNum() == 20);
+    const auto reuse = allocator.allocate(10);
+    CHECK(reuse.valid() && (reuse.offset_ == b.offset_ || reuse.offset_ == d.offset_));
+
+    CHECK(allocator.reclaim(4) == 0);
+    CHECK(allocator.reclaim(5) == 1);
+    CHECK(allocator.reclaim(7) == 1);
+    CHECK(allocator.pendingNum() == 0);
+    CHECK(allocator.freeNum() == 30);
+}
+
+TEST("range/reclaim/deferred free is reused once the frame fence advances") {
+    // SwapChain::present と同じく、フレームごとにフェンス値で解放して完了済みの分を回収する
+    // GPU は 2 フレーム遅れて完了するので、ヒープが 3 フレーム分あれば枯渇しない
+    constexpr uint32_t         perFrame = 16;
+    utility::RangeAllocator    allocator(perFrame * 3);
+    utility::ManualFenceSource fence;
+
+    uint32_t failed = 0;
+    uint32_t reused = 0;
+    for (uint64_t frame = 1; frame <= 100; frame++) {
+        const auto allocation = allocator.allocate(perFrame);
+        failed += allocation.valid() ? 0 : 1;
+        reused += (frame > 3 && allocation.valid()) ? 1 : 0;
+        allocator.free(allocation, frame);
+
+        if (frame > 2) {
+            fence.signal(frame - 2);
+        }
+        allocator.reclaim(fence.completedValue());
+    }
+    CHECK(failed == 0);
+    CHECK(reused == 97);
+    CHECK(allocator.pendingNum() == 2);
+
+    // フェンスが進まなければ回収されない
+    CHECK(allocator.reclaim(fence.completedValue()) == 0);
+    fence.signal(100);
+    CHECK(allocator.reclaim(fence.completedValue()) == 2);
+    CHECK(allocator.freeNum() == perFrame * 3);
+}
+
+TEST("range/allocate/alignment pads the front and keeps the padding free") {
+    utility::RangeAllocator allocator(256);
+    const auto              head = allocator.allocate(3);
+    const auto              a    = allocator.allocate(16, 16);
+    CHECK(a.valid() && a.offset_ == 16 && a.num_ == 16);
+    CHECK(allocator.freeNum() == 256 - 3 - 16);
+
+    // 余白は空きのまま残り、小さい確保で使える
+    const auto gap = allocator.allocate(13);
+    CHECK(gap.valid() && gap.offset_ == 3);
+
+    const auto b = allocator.allocate(1, 64);
+    CHECK(b.valid() && b.offset_ == 64);
+
+    // すべて解放すると 1 つの空き領域に戻る
+    allocator.free(head);
+    allocator.free(a);
+    allocator.free(gap);
+    allocator.free(b);
+    CHECK(allocator.freeNum() == 256);
+    CHECK(allocator.largestFree() == 256);
+}
+
+TEST("range/allocate/alignment finds a fitting hole when nearly full") {
+    utility::RangeAllocator allocator(64);
+    const auto              a = allocator.allocate(8);
+    const auto              b = allocator.allocate(24);
+    const auto              c = allocator.allocate(32);
+    allocator.free(b);  // [ 8, 32 ) が空く
+
+    // 余白込みで 31 個分は無いが、 16 にそろえれば 16 個は入る
+    const auto aligned = allocator.allocate(16, 16);
+    CHECK(aligned.valid() && aligned.offset_ == 16);
+    CHECK(!allocator.allocate(16, 32).valid());
+
+    allocator.free(a);
+    allocator.free(aligned);
+    allocator.free(c);
+    CHECK(allocator.largestFree() == 64);
+}
+
+TEST("range/allocate/fails on a full heap and recovers after free") {
+    utility::RangeAllocator allocator(16);
+    const auto              all = allocator.allocate(16);
+    CHECK(all.valid());
+    CHECK(!allocator.allocate(1).valid());
+    CHECK(!allocator.allocate(1, 4).valid());
+    CHECK(!utility::RangeAllocator(0).allocate(1).valid());
+    CHECK(!allocator.allocate(17).valid());
+
+    allocator.free(all);
+    CHECK(allocator.allocate(16).valid());
+}
@@ -0,0 +1,240 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * リングバッファ（ SpscRingBuffer ・ MpmcRingBuffer ）の並行テスト
+ */
+#include "tools/test/test.h"
+
+#include <thread>
+
+#include "utility/ring_buffer.h"
+
+namespace {
+
+constexpr uint32_t indexBits = 24;                      ///< 要素の値のうち通し番号に使うビット数
+constexpr uint32_t indexMask = (1u << indexBits) - 1;  ///< 通し番号を取り出すマスク
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	生産者と通し番号から要素の値を作る
+ */
+constexpr uint32_t makeValue(uint32_t producer, uint32_t index) noexcept {
+    return (producer << indexBits) | index;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	生産者ごと・通し番号ごとに受け取った回数を数える
+ */
+struct DeliveryCounter {
+    DeliveryCounter(uint32_t producerNum, uint32_t itemNum)
+        : itemNum_(itemNum), received_(producerNum * itemNum) {}
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	受け取った要素を記録する
+     */
+    void receive(uint32_t value) noexcept {
+        received_[(value >> indexBits) * itemNum_ + (value & indexMask)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	すべての要素をちょうど 1 回ずつ受け取ったか否か
+     */
+    [[nodiscard]] bool exactlyOnce() const noexcept {
+        for (const auto& received : received_) {
+            if (received.load() != 1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t                           itemNum_;   ///< 生産者ごとの要素数
+    std::vector<std::atomic<uint32_t>> received_;  ///< 要素ごとの受け取り回数
+};
+
+}  // namespace
+
+TEST("ring/spsc/delivers every item in order across single and batch calls") {
+    constexpr uint32_t itemNum = 500000;
+
+    utility::SpscRingBuffer<uint32_t, 256> ring;
+
+    // 生産者は 1 つずつとまとめての追加を交互に行う
+    std::thread producer([&] {
+        uint32_t batch[7];
+        uint32_t next = 0;
+        while (next < itemNum) {
+            if (next % 2 == 0) {
+                if (ring.push(next)) {
+                    next++;
+                }
+            } else {
+                const auto num = std::min<uint32_t>(static_cast<uint32_t>(std::size(batch)), itemNum - next);
+                for (uint32_t i = 0; i < num; i++) {
+                    batch[i] = next + i;
+                }
+                next += ring.pushBatch(batch, num);
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    // 消費者も 1 つずつとまとめての取り出しを交互に行い、順序が保たれていることを確認する
+    uint32_t expected   = 0;
+    uint32_t outOfOrder = 0;
+    uint32_t batch[5];
+    while (expected < itemNum) {
+        uint32_t value = 0;
+        if (expected % 3 == 0 && ring.pop(value)) {
+            outOfOrder += value != expected;
+            expected++;
+        } else if (const auto num = ring.popBatch(batch, static_cast<uint32_t>(std::size(batch))); num > 0) {
+            for (uint32_t i = 0; i < num; i++) {
+                outOfOrder += batch[i] != expected;
+                expected++;
+            }
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    CHECK(outOfOrder == 0);
+    CHECK(ring.size() == 0);
+}
+
+TEST("ring/spsc/blocking push and pop hand over every item") {
+    constexpr uint32_t itemNum = 100000;
+
+    // 容量を小さくして待機が頻繁に起きるようにする
+    utility::SpscRingBuffer<uint32_t, 4> ring;
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < itemNum; i++) {
+            ring.pushWait(i);
+        }
+    });
+
+    uint32_t outOfOrder = 0;
+    for (uint32_t i = 0; i < itemNum; i++) {
+        uint32_t value = 0;
+        ring.popWait(value);
+        outOfOrder += value != i;
+    }
+    producer.join();
+
+    CHECK(outOfOrder == 0);
+}
+
+TEST("ring/mpmc/N producers and M consumers deliver every item exactly once") {
+    constexpr uint32_t producerNum = 4;
+    constexpr uint32_t consumerNum = 3;
+    constexpr uint32_t itemNum     = 100000;
+
+    utility::MpmcRingBuffer<uint32_t, 1024> ring;
+    DeliveryCounter                         counter(producerNum, itemNum);
+    std::atomic<uint32_t>                   receivedNum{};
+    std::atomic<uint32_t>                   outOfOrder{};
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producerNum; p++) {
+        threads.emplace_back([&, p] {
+            uint32_t batch[8];
+            uint32_t next = 0;
+            while (next < itemNum) {
+                if ((next + p) % 2 == 0) {
+                    if (ring.push(makeValue(p, next))) {
+                        next++;
+                    }
+                } else {
+                    const auto num = std::min<uint32_t>(static_cast<uint32_t>(std::size(batch)), itemNum - next);
+                    for (uint32_t i = 0; i < num; i++) {
+                        batch[i] = makeValue(p, next + i);
+                    }
+                    next += ring.pushBatch(batch, num);
+                }
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    // 各消費者から見て、同じ生産者の要素は追加した順に届く
+    for (uint32_t c = 0; c < consumerNum; c++) {
+        threads.emplace_back([&, c] {
+            std::vector<int64_t> last(producerNum, -1);
+            const auto           check = [&](uint32_t value) {
+                auto&      prev  = last[value >> indexBits];
+                const auto index = static_cast<int64_t>(value & indexMask);
+                if (index <= prev) {
+                    outOfOrder.fetch_add(1, std::memory_order_relaxed);
+                }
+                prev = index;
+                counter.receive(value);
+            };
+
+            uint32_t batch[6];
+            while (receivedNum.load(std::memory_order_relaxed) < producerNum * itemNum) {
+                uint32_t value = 0;
+                if (c % 2 == 0 && ring.pop(value)) {
+                    check(value);
+                    receivedNum.fetch_add(1, std::memory_order_relaxed);
+                } else if (const auto num = ring.popBatch(batch, static_cast<uint32_t>(std::size(batch))); num > 0) {
+                    for (uint32_t i = 0; i < num; i++) {
+                        check(batch[i]);
+                    }
+                    receivedNum.fetch_add(num, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(receivedNum.load() == producerNum * itemNum);
+    CHECK(outOfOrder.load() == 0);
+    CHECK(counter.exactlyOnce());
+    CHECK(ring.size() == 0);
+}
+
+TEST("ring/mpmc/blocking push and pop with more threads than slots") {
+    constexpr uint32_t producerNum = 3;
+    constexpr uint32_t consumerNum = 3;
+    constexpr uint32_t itemNum     = 20000;
+
+    utility::MpmcRingBuffer<uint32_t, 2> ring;
+    DeliveryCounter                      counter(producerNum, itemNum);
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producerNum; p++) {
+        threads.emplace_back([&, p] {
+            for (uint32_t i = 0; i < itemNum; i++) {
+                ring.pushWait(makeValue(p, i));
+            }
+        });
+    }
+
+    // 消費者ごとの取り出し数を固定すると、全体で過不足なく取り出せた場合だけ終了する
+    for (uint32_t c = 0; c < consumerNum; c++) {
+        threads.emplace_back([&] {
+            for (uint32_t i = 0; i < producerNum * itemNum / consumerNum; i++) {
+                uint32_t value = 0;
+                ring.popWait(value);
+                counter.receive(value);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(counter.exactlyOnce());
+    CHECK(ring.size() == 0);
+}
@@ -0,0 +1,81 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * タスクグラフ（ TaskGraph ）の実行順のテスト
+ */
+#include "tools/test/test.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "utility/task_graph.h"
+
+namespace {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	後続ノードの処理時間だけが異なる 3 つの開始ノードを持つグラフ
+ *
+ * 開始ノードの優先度（クリティカルパス長）は long > middle > short の順になる
+ */
+struct RootOrderGraph {
+    RootOrderGraph() {
+        using namespace std::chrono_literals;
+        const char* names[]   = {"short", "long", "middle"};
+        const auto  durations = {2ms, 12ms, 6ms};
+
+        auto duration = durations.begin();
+        for (const auto* name : names) {
+            const auto root = graph_.addNode(name, [this, name] {
+                std::lock_guard<std::mutex> lock(mutex_);
+                started_.emplace_back(name);
+            });
+            const auto work = graph_.addNode(std::string(name) + "/work", [d = *duration++] {
+                std::this_thread::sleep_for(d);
+            });
+            graph_.addDependency(root, work);
+        }
+        graph_.build();
+
+        // 1 回目の実行で処理時間を計測して優先度を決める
+        graph_.execute();
+        started_.clear();
+    }
+
+    utility::TaskGraph       graph_;      ///< グラフ
+    std::mutex               mutex_;      ///< started_ の同期オブジェクト
+    std::vector<std::string> started_{};  ///< 開始ノードの開始順
+};
+
+const std::vector<std::string> expectedOrder = {"long", "middle", "short"};  ///< 優先度の高い順
+
+}  // namespace
+
+TEST("task_graph/execute/roots start in priority order from a non-worker thread") {
+    // ワーカーが無い場合は投入した順にその場で実行されるので、投入順がそのまま開始順になる
+    RootOrderGraph graph;
+    graph.graph_.execute();
+    CHECK(graph.started_ == expectedOrder);
+}
+
+TEST("task_graph/execute/roots start in priority order from a worker") {
+    auto& jobSystem = utility::JobSystem::instance();
+    jobSystem.start(1);
+
+    // ワーカー 1 つの中から実行すると、自身のキューから LIFO で取り出した順が開始順になる
+    // （呼び出しスレッドは wait で盗まないよう、ジョブシステムを使わずに完了を待つ）
+    RootOrderGraph    graph;
+    std::atomic<bool> done{};
+    jobSystem.run([&] {
+        graph.started_.clear();
+        graph.graph_.execute();
+        done.store(true);
+    });
+    while (!done.load()) {
+        std::this_thread::yield();
+    }
+    jobSystem.stop();
+
+    CHECK(graph.started_ == expectedOrder);
+}
@@ -0,0 +1,181 @@
+﻿//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ワークスティーリング用の両端キュー（ WorkStealQueue ）の並行テスト
+ */
+#include "tools/test/test.h"
+
+#include <thread>
+
+#include "utility/work_steal_queue.h"
+
+namespace {
+
+constexpr uint32_t capacity = 1024;  ///< テストに使うキューの容量
+
+using Queue = utility::WorkStealQueue<uint32_t*, capacity>;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	要素ごとに取り出された回数を数える
+ */
+struct TakenCounter {
+    explicit TakenCounter(uint32_t num) : values_(num), taken_(num) {
+        for (uint32_t i = 0; i < num; i++) {
+            values_[i] = i;
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	取り出した要素を記録する
+     */
+    void take(uint32_t* item) noexcept {
+        taken_[*item].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	すべての要素がちょうど 1 回ずつ取り出されたか否か
+     */
+    [[nodiscard]] bool exactlyOnce() const noexcept {
+        for (const auto& taken : taken_) {
+            if (taken.load() != 1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<uint32_t>              values_;  ///< 要素の中身（インデックス）
+    std::vector<std::atomic<uint32_t>> taken_;   ///< 要素ごとの取り出し回数
+};
+
+}  // namespace
+
+TEST("work_steal/order/owner pops LIFO, thieves steal FIFO") {
+    Queue    queue;
+    uint32_t values[4] = {0, 1, 2, 3};
+    for (auto& value : values) {
+        CHECK(queue.push(&value));
+    }
+    CHECK(queue.size() == 4);
+
+    CHECK(queue.pop() == &values[3]);
+    CHECK(queue.steal() == &values[0]);
+    CHECK(queue.pop() == &values[2]);
+    CHECK(queue.steal() == &values[1]);
+    CHECK(queue.pop() == nullptr);
+    CHECK(queue.steal() == nullptr);
+    CHECK(queue.size() == 0);
+}
+
+TEST("work_steal/push/fails when full and recovers after pop") {
+    Queue                 queue;
+    std::vector<uint32_t> values(capacity + 1);
+    for (uint32_t i = 0; i < capacity; i++) {
+        CHECK(queue.push(&values[i]));
+    }
+    CHECK(!queue.push(&values[capacity]));
+
+    CHECK(queue.steal() == &values[0]);
+    CHECK(queue.push(&values[capacity]));
+    CHECK(queue.pop() == &values[capacity]);
+}
+
+TEST("work_steal/stress/every item is taken exactly once by owner or thieves") {
+    constexpr uint32_t itemNum  = 200000;
+    constexpr uint32_t thiefNum = 3;
+
+    Queue             queue;
+    TakenCounter      counter(itemNum);
+    std::atomic<bool> done{};
+
+    std::vector<std::thread> thieves;
+    for (uint32_t i = 0; i < thiefNum; i++) {
+        thieves.emplace_back([&] {
+            while (!done.load(std::memory_order_acquire)) {
+                if (auto* item = queue.steal()) {
+                    counter.take(item);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // 所有スレッドは追加と取り出しを交互に行い、満杯なら自分で取り出して空ける
+    for (uint32_t i = 0; i < itemNum; i++) {
+        while (!queue.push(&counter.values_[i])) {
+            if (auto* item = queue.pop()) {
+                counter.take(item);
+            }
+        }
+        if (i % 3 == 0) {
+            if (auto* item = queue.pop()) {
+                counter.take(item);
+            }
+        }
+    }
+    while (auto* item = queue.pop()) {
+        counter.take(item);
+    }
+
+    // 所有スレッドが空にしても、盗んだ要素の記録が終わるまで待つ
+    done.store(true, std::memory_order_release);
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+
+    CHECK(queue.size() == 0);
+    CHECK(counter.exactlyOnce());
+}
+
+TEST("work_steal/stress/pop and steal race for the last item") {
+    constexpr uint32_t roundNum = 20000;
+
+    Queue                 queue;
+    uint32_t              value = 0;
+    std::atomic<uint32_t> round{};     // 盗む側が開始する回
+    std::atomic<uint32_t> finished{};  // 盗む側が終了した回
+    std::atomic<uint32_t> stolenNum{};
+
+    std::thread thief([&] {
+        for (uint32_t r = 1; r <= roundNum; r++) {
+            while (round.load(std::memory_order_acquire) != r) {
+                std::this_thread::yield();
+            }
+            if (queue.steal() == &value) {
+                stolenNum.fetch_add(1, std::memory_order_relaxed);
+            }
+            finished.store(r, std::memory_order_release);
+        }
+    });
+
+    uint32_t poppedNum = 0;
+    uint32_t lostNum   = 0;
+    for (uint32_t r = 1; r <= roundNum; r++) {
+        CHECK(queue.push(&value));
+        round.store(r, std::memory_order_release);
+
+        // 要素が 1 つだけの状態で pop と steal を競合させる
+        const auto* item = queue.pop();
+        while (finished.load(std::memory_order_acquire) != r) {
+            std::this_thread::yield();
+        }
+        if (item == &value) {
+            poppedNum++;
+        }
+
+        // どちらも取れなかった回があれば要素が失われている
+        if (queue.size() != 0) {
+            lostNum++;
+            queue.pop();
+        }
+    }
+    thief.join();
+
+    // 各回でちょうど一方だけが取り出す
+    CHECK(lostNum == 0);
+    CHECK(poppedNum + stolenNum.load() == roundNum);
+}
@@ -0,0 +1,481 @@
+﻿#include "alloc_counter.h"
+
+#include <atomic>
+#include <new>
+
+namespace {
+using utility::alloc::MemoryTag;
+using utility::alloc::memoryTagNum;
+
+constexpr uint32_t maxThreadNum = 256;  ///< 個別のカウンタを持てる最大スレッド数
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	タグごとのカウンタ
+ */
+struct TagCounter {
+    std::atomic<uint64_t> allocNum_;    ///< 確保回数
+    std::atomic<uint64_t> allocBytes_;  ///< 確保サイズ
+    std::atomic<uint64_t> freeNum_;     ///< 解放回数
+    std::atomic<uint64_t> freeBytes_;   ///< 解放サイズ
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * スレッドごとのカウンタ
+ *
+ * 所有スレッドのみが書き込むので、加算はアトミックな読み書きだけで済む
+ * スレッド終了後も累計を保つために破棄しない
+ */
+struct ThreadCounter {
+    TagCounter tags_[memoryTagNum];  ///< タグごとのカウンタ
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	タグごとの合計
+ */
+struct TagTotal {
+    uint64_t allocNum_{};    ///< 確保回数
+    uint64_t allocBytes_{};  ///< 確保サイズ
+    uint64_t freeNum_{};     ///< 解放回数
+    uint64_t freeBytes_{};   ///< 解放サイズ
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームごとの集計の状態
+ */
+struct FrameState {
+    uint64_t frame_{};                          ///< 区切ったフレーム数
+    uint64_t peakBytes_[memoryTagNum]{};        ///< タグごとのピーク
+    uint64_t peakTotalBytes_{};                 ///< 全タグの合計のピーク
+    uint64_t frameStartNum_[memoryTagNum]{};    ///< フレーム開始時の確保回数
+    uint64_t frameStartBytes_[memoryTagNum]{};  ///< フレーム開始時の確保サイズ
+    uint64_t lastFrameNum_[memoryTagNum]{};     ///< 直前のフレームの確保回数
+    uint64_t lastFrameBytes_[memoryTagNum]{};   ///< 直前のフレームの確保サイズ
+};
+
+std::atomic<ThreadCounter*> threadCounters[maxThreadNum]{};  ///< スレッドごとのカウンタ
+std::atomic<uint32_t>       threadCounterNum{};              ///< 登録したスレッド数（ maxThreadNum を超えることがある）
+ThreadCounter               sharedCounter{};                 ///< maxThreadNum を超えたスレッドが共有するカウンタ
+std::mutex                  frameMutex;                      ///< frameState の排他制御
+FrameState                  frameState;                      ///< フレームごとの集計の状態
+
+thread_local MemoryTag threadTag{};       ///< 呼び出しスレッドのタグ
+thread_local uint64_t  threadAllocNum{};  ///< スレッドごとの確保回数
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	全スレッドのカウンタをタグごとに合計する
+ * @param	totals		合計の格納先
+ */
+void sumCounters(TagTotal (&totals)[memoryTagNum]) noexcept {
+    const auto sum = [&totals](const ThreadCounter& counter) {
+        for (size_t i = 0; i < memoryTagNum; i++) {
+            totals[i].allocNum_ += counter.tags_[i].allocNum_.load(std::memory_order_relaxed);
+            totals[i].allocBytes_ += counter.tags_[i].allocBytes_.load(std::memory_order_relaxed);
+            totals[i].freeNum_ += counter.tags_[i].freeNum_.load(std::memory_order_relaxed);
+            totals[i].freeBytes_ += counter.tags_[i].freeBytes_.load(std::memory_order_relaxed);
+        }
+    };
+
+    const auto num = std::min(threadCounterNum.load(std::memory_order_relaxed), maxThreadNum);
+    for (uint32_t i = 0; i < num; i++) {
+        if (const auto* counter = threadCounters[i].load(std::memory_order_acquire)) {
+            sum(*counter);
+        }
+    }
+    sum(sharedCounter);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	合計からスナップショットを作成し、ピークを更新する（ frameMutex をロックして呼び出す）
+ * @param	totals		タグごとの合計
+ * @return	スナップショット
+ */
+utility::alloc::Snapshot makeSnapshot(const TagTotal (&totals)[memoryTagNum]) noexcept {
+    utility::alloc::Snapshot snapshot;
+    snapshot.frame_ = frameState.frame_;
+
+    for (size_t i = 0; i < memoryTagNum; i++) {
+        // 他スレッドの解放を先に読むことがあるので、確保中の値は 0 未満にしない
+        auto& stats            = snapshot.tags_[i];
+        stats.liveBytes_       = totals[i].allocBytes_ > totals[i].freeBytes_ ? totals[i].allocBytes_ - totals[i].freeBytes_ : 0;
+        stats.liveNum_         = totals[i].allocNum_ > totals[i].freeNum_ ? totals[i].allocNum_ - totals[i].freeNum_ : 0;
+        stats.allocNum_        = totals[i].allocNum_;
+        stats.allocBytes_      = totals[i].allocBytes_;
+        stats.frameAllocNum_   = frameState.lastFrameNum_[i];
+        stats.frameAllocBytes_ = frameState.lastFrameBytes_[i];
+
+        frameState.peakBytes_[i] = std::max(frameState.peakBytes_[i], stats.liveBytes_);
+        stats.peakBytes_         = frameState.peakBytes_[i];
+
+        auto& total = snapshot.total_;
+        total.liveBytes_ += stats.liveBytes_;
+        total.liveNum_ += stats.liveNum_;
+        total.allocNum_ += stats.allocNum_;
+        total.allocBytes_ += stats.allocBytes_;
+        total.frameAllocNum_ += stats.frameAllocNum_;
+        total.frameAllocBytes_ += stats.frameAllocBytes_;
+    }
+
+    frameState.peakTotalBytes_ = std::max(frameState.peakTotalBytes_, snapshot.total_.liveBytes_);
+    snapshot.total_.peakBytes_ = frameState.peakTotalBytes_;
+    return snapshot;
+}
+
+#if defined(ENABLE_ALLOC_COUNTER)
+thread_local ThreadCounter* threadCounter{};  ///< 呼び出しスレッドのカウンタ
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	カウンタに加算する
+ * @param	counter		加算先
+ * @param	value		加算する値
+ * @param	shared		複数スレッドで共有しているカウンタか否か
+ */
+void add(std::atomic<uint64_t>& counter, uint64_t value, bool shared) noexcept {
+    if (shared) {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    } else {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	呼び出しスレッドのカウンタを取得する
+ *
+ * operator new から呼び出されるので、初回の作成でも operator new を使わない
+ */
+ThreadCounter& localCounter() noexcept {
+    if (!threadCounter) {
+        const auto index = threadCounterNum.fetch_add(1, std::memory_order_relaxed);
+        auto*      mem   = index < maxThreadNum ? std::malloc(sizeof(ThreadCounter)) : nullptr;
+        if (mem) {
+            threadCounter = ::new (mem) ThreadCounter{};
+            threadCounters[index].store(threadCounter, std::memory_order_release);
+        } else {
+            threadCounter = &sharedCounter;
+        }
+    }
+    return *threadCounter;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	確保ごとに前置するヘッダー
+ */
+struct AllocHeader {
+    uint64_t size_;     ///< 確保サイズ
+    uint32_t tag_;      ///< タグ
+    uint32_t padding_;  ///< 未使用
+};
+static_assert(sizeof(AllocHeader) == 16);
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ヘッダーを含めた先頭からユーザー領域までのオフセットを取得する
+ * @param	alignment	アライメント
+ */
+constexpr std::size_t headerOffset(std::size_t alignment) noexcept {
+    return std::max(alignment, sizeof(AllocHeader));
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	確保を記録する
+ * @param	size		確保サイズ
+ * @param	tag			タグ
+ */
+void countAlloc(std::size_t size, MemoryTag tag) noexcept {
+    auto&      counter = localCounter();
+    const bool shared  = &counter == &sharedCounter;
+    auto&      tagged  = counter.tags_[static_cast<size_t>(tag)];
+    add(tagged.allocNum_, 1, shared);
+    add(tagged.allocBytes_, size, shared);
+    threadAllocNum++;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	解放を記録する
+ * @param	size		確保サイズ
+ * @param	tag			確保時のタグ
+ */
+void countFree(std::size_t size, MemoryTag tag) noexcept {
+    auto&      counter = localCounter();
+    const bool shared  = &counter == &sharedCounter;
+    auto&      tagged  = counter.tags_[static_cast<size_t>(tag)];
+    add(tagged.freeNum_, 1, shared);
+    add(tagged.freeBytes_, size, shared);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	メモリを確保する
+ * @param	size		確保サイズ
+ * @param	alignment	アライメント
+ * @return	確保できなかった場合は nullptr
+ */
+void* allocate(std::size_t size, std::size_t alignment) noexcept {
+    const auto offset = headerOffset(alignment);
+    const auto total  = offset + size;
+
+    void* base = nullptr;
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        base = std::malloc(total);
+    } else {
+#if defined(_WIN32)
+        base = _aligned_malloc(total, alignment);
+#else
+        base = std::aligned_alloc(alignment, (total + alignment - 1) & ~(alignment - 1));
+#endif
+    }
+    if (!base) {
+        return nullptr;
+    }
+
+    const auto tag    = threadTag;
+    auto*      p      = static_cast<std::byte*>(base) + offset;
+    auto*      header = reinterpret_cast<AllocHeader*>(p) - 1;
+    header->size_     = size;
+    header->tag_      = static_cast<uint32_t>(tag);
+    countAlloc(size, tag);
+    return p;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	メモリを解放する
+ * @param	p			解放するメモリ
+ * @param	alignment	確保時のアライメント
+ */
+void release(void* p, std::size_t alignment) noexcept {
+    if (!p) {
+        return;
+    }
+
+    const auto* header = static_cast<const AllocHeader*>(p) - 1;
+    countFree(header->size_, static_cast<MemoryTag>(header->tag_));
+
+    auto* base = static_cast<std::byte*>(p) - headerOffset(alignment);
+#if defined(_WIN32)
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        _aligned_free(base);
+        return;
+    }
+#endif
+    std::free(base);
+}
+#endif
+}  // namespace
+
+namespace utility::alloc {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	全スレッドの確保回数の累計を取得する
+ */
+uint64_t globalCount() noexcept {
+    TagTotal totals[memoryTagNum];
+    sumCounters(totals);
+
+    uint64_t num = 0;
+    for (const auto& total : totals) {
+        num += total.allocNum_;
+    }
+    return num;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	全スレッドの確保サイズの累計を取得する
+ */
+uint64_t globalBytes() noexcept {
+    TagTotal totals[memoryTagNum];
+    sumCounters(totals);
+
+    uint64_t bytes = 0;
+    for (const auto& total : totals) {
+        bytes += total.allocBytes_;
+    }
+    return bytes;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	呼び出しスレッドの確保回数の累計を取得する
+ */
+uint64_t threadCount() noexcept {
+    return threadAllocNum;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	呼び出しスレッドに設定されているタグを取得する
+ */
+MemoryTag currentTag() noexcept {
+    return threadTag;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	タグの表示名を取得する
+ */
+const char* tagName(MemoryTag tag) noexcept {
+    static const char* const names[] = {
+        "Untagged",
+        "Texture",
+        "Mesh",
+        "Container",
+        "Log",
+        "Profiler",
+    };
+    static_assert(std::size(names) == memoryTagNum);
+    return static_cast<size_t>(tag) < memoryTagNum ? names[static_cast<size_t>(tag)] : "Unknown";
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームを区切り、フレームごとの確保回数とピークを更新する
+ * @return	区切った時点の集計
+ */
+Snapshot advanceFrame() noexcept {
+    TagTotal totals[memoryTagNum];
+    sumCounters(totals);
+
+    std::lock_guard<std::mutex> lock(frameMutex);
+    for (size_t i = 0; i < memoryTagNum; i++) {
+        frameState.lastFrameNum_[i]    = totals[i].allocNum_ - frameState.frameStartNum_[i];
+        frameState.lastFrameBytes_[i]  = totals[i].allocBytes_ - frameState.frameStartBytes_[i];
+        frameState.frameStartNum_[i]   = totals[i].allocNum_;
+        frameState.frameStartBytes_[i] = totals[i].allocBytes_;
+    }
+    frameState.frame_++;
+    return makeSnapshot(totals);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	全タグの集計を取得する
+ */
+Snapshot snapshot() noexcept {
+    TagTotal totals[memoryTagNum];
+    sumCounters(totals);
+
+    std::lock_guard<std::mutex> lock(frameMutex);
+    return makeSnapshot(totals);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ * @param	tag			スコープ内の確保に設定するタグ
+ */
+MemoryTagScope::MemoryTagScope(MemoryTag tag) noexcept
+    : prev_(threadTag) {
+    threadTag = tag;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ（元のタグに戻す）
+ */
+MemoryTagScope::~MemoryTagScope() {
+    threadTag = prev_;
+}
+
+}  // namespace utility::alloc
+
+#if defined(ENABLE_ALLOC_COUNTER)
+// global operator new / delete の置き換え
+void* operator new(std::size_t size) {
+    if (auto p = allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (auto p = allocate(size, static_cast<std::size_t>(alignment))) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept {
+    release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* p) noexcept {
+    release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* p, std::align_val_t alignment) noexcept {
+    release(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* p, std::align_val_t alignment) noexcept {
+    release(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept {
+    release(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept {
+    release(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    release(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    release(p, static_cast<std::size_t>(alignment));
+}
+#endif
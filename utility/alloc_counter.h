@@ -0,0 +1,147 @@
+﻿#pragma once
+
+#include "utility/noncopyable.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * グローバルヒープ確保回数の計測とサブシステムごとのメモリ集計
+ *
+ * ENABLE_ALLOC_COUNTER を定義してビルドした場合のみ global operator new / delete を置き換えて計測する
+ * 定義していない場合はすべて 0 を返す
+ *
+ * 確保は呼び出しスレッドに設定されているタグ（ MEMORY_TAG ）で分類する
+ * 確保ごとにサイズとタグをヘッダーとして前置し、解放したスレッドでも同じタグから差し引く
+ * 計測値はスレッドごとのカウンタに書き込むだけなので、スレッド間の競合は発生しない
+ */
+namespace alloc {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	メモリの分類タグ
+ */
+enum class MemoryTag : uint8_t {
+    Untagged,   ///< 未分類
+    Texture,    ///< テクスチャ（デコード済みデータなど）
+    Mesh,       ///< メッシュ
+    Container,  ///< 描画オブジェクトのコンテナ
+    Log,        ///< ログ
+    Profiler,   ///< プロファイラ
+    Num,
+};
+
+constexpr size_t memoryTagNum = static_cast<size_t>(MemoryTag::Num);  ///< タグの数
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	タグごとの集計
+ */
+struct TagStats {
+    uint64_t liveBytes_{};        ///< 確保中のサイズ
+    uint64_t liveNum_{};          ///< 確保中の数
+    uint64_t peakBytes_{};        ///< 確保中のサイズの最大値（フレーム境界とスナップショット取得時に標本化した値）
+    uint64_t allocNum_{};         ///< 確保回数の累計
+    uint64_t allocBytes_{};       ///< 確保サイズの累計
+    uint64_t frameAllocNum_{};    ///< 直前のフレームの確保回数
+    uint64_t frameAllocBytes_{};  ///< 直前のフレームの確保サイズ
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	全タグの集計のスナップショット
+ */
+struct Snapshot {
+    uint64_t                           frame_{};  ///< advanceFrame を呼び出した回数
+    std::array<TagStats, memoryTagNum> tags_{};   ///< タグごとの集計
+    TagStats                           total_{};  ///< 全タグの合計
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 呼び出しスレッドのメモリタグをスコープの間だけ切り替える
+ */
+class MemoryTagScope final : public Noncopyable {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     * @param	tag			スコープ内の確保に設定するタグ
+     */
+    explicit MemoryTagScope(MemoryTag tag) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ（元のタグに戻す）
+     */
+    ~MemoryTagScope();
+
+private:
+    MemoryTag prev_;  ///< 切り替える前のタグ
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	計測が有効か否かを取得する
+ */
+[[nodiscard]] constexpr bool enabled() noexcept {
+#if defined(ENABLE_ALLOC_COUNTER)
+    return true;
+#else
+    return false;
+#endif
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	全スレッドの確保回数の累計を取得する
+ */
+[[nodiscard]] uint64_t globalCount() noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	全スレッドの確保サイズの累計を取得する
+ */
+[[nodiscard]] uint64_t globalBytes() noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	呼び出しスレッドの確保回数の累計を取得する
+ */
+[[nodiscard]] uint64_t threadCount() noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	呼び出しスレッドに設定されているタグを取得する
+ */
+[[nodiscard]] MemoryTag currentTag() noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	タグの表示名を取得する
+ */
+[[nodiscard]] const char* tagName(MemoryTag tag) noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームを区切り、フレームごとの確保回数とピークを更新する
+ *
+ * プロファイラの markFrame から呼び出される
+ * @return	区切った時点の集計
+ */
+Snapshot advanceFrame() noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	全タグの集計を取得する
+ */
+[[nodiscard]] Snapshot snapshot() noexcept;
+
+}  // namespace alloc
+}  // namespace utility
+
+#define MEMORY_TAG_CONCAT_IMPL(a, b) a##b
+#define MEMORY_TAG_CONCAT(a, b) MEMORY_TAG_CONCAT_IMPL(a, b)
+#define MEMORY_TAG(tag) utility::alloc::MemoryTagScope MEMORY_TAG_CONCAT(memoryTagScope, __LINE__)(tag)
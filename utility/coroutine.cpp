@@ -0,0 +1,297 @@
+﻿#include "coroutine.h"
+
+#include <fstream>
+
+namespace utility {
+
+namespace {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * spawn したタスクを最後まで実行し、自身を破棄するコルーチン
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() const noexcept {
+            return {};
+        }
+
+        void return_void() const noexcept {}
+
+        void unhandled_exception() const noexcept {
+            std::terminate();
+        }
+    };
+
+    std::coroutine_handle<promise_type> handle_{};  ///< コルーチンハンドル
+};
+}  // namespace
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * コルーチンスケジューラのインプリメントクラス
+ */
+class CoroutineScheduler::Impl {
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  フェンス待ち情報
+     */
+    struct FenceWait {
+        const FenceSource*      fence_{};   ///< 監視するフェンス
+        uint64_t                value_{};   ///< 待機するフェンス値
+        std::coroutine_handle<> handle_{};  ///< 再開するコルーチン
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    Impl() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~Impl() {
+        ASSERT(inFlight_.load() == 0, "完了していないコルーチンが残っています");
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	タスクを開始する
+     * @param	task		開始するタスク
+     */
+    void spawn(Task<> task) {
+        inFlight_.fetch_add(1, std::memory_order_relaxed);
+
+        auto detached = detach(std::move(task), inFlight_);
+        schedule(detached.handle_);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コルーチンをワーカー上で再開する
+     * @param	handle		再開するコルーチン
+     */
+    void schedule(std::coroutine_handle<> handle) {
+        JobSystem::instance().run([handle]() { handle.resume(); });
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フェンス値に到達した時に再開するよう登録する
+     * @param	fence		監視するフェンス
+     * @param	value		待機するフェンス値
+     * @param	handle		再開するコルーチン
+     */
+    void waitFence(const FenceSource& fence, uint64_t value, std::coroutine_handle<> handle) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fenceWaits_.push_back({&fence, value, handle});
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	次のフレームで再開するよう登録する
+     * @param	handle		再開するコルーチン
+     */
+    void waitNextFrame(std::coroutine_handle<> handle) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        frameWaits_.push_back(handle);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フェンス待ちのコルーチンを確認し、到達したものを再開する
+     */
+    void poll() {
+        std::vector<std::coroutine_handle<>> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = std::remove_if(fenceWaits_.begin(), fenceWaits_.end(), [&ready](const FenceWait& wait) {
+                if (wait.value_ <= wait.fence_->completedValue()) {
+                    ready.push_back(wait.handle_);
+                    return true;
+                }
+                return false;
+            });
+            fenceWaits_.erase(it, fenceWaits_.end());
+        }
+
+        for (auto handle : ready) {
+            schedule(handle);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームを進め、次フレーム待ちのコルーチンを再開する
+     */
+    void advanceFrame() {
+        std::vector<std::coroutine_handle<>> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready.swap(frameWaits_);
+            frame_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        for (auto handle : ready) {
+            schedule(handle);
+        }
+
+        poll();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	spawn されて完了していないタスク数を取得する
+     */
+    uint32_t inFlight() const noexcept {
+        return inFlight_.load(std::memory_order_acquire);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	現在のフレーム番号を取得する
+     */
+    uint64_t frame() const noexcept {
+        return frame_.load(std::memory_order_relaxed);
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	タスクを最後まで実行して破棄するコルーチンを生成する
+     * @param	task		実行するタスク
+     * @param	inFlight	完了時に減算するカウンタ
+     */
+    static DetachedTask detach(Task<> task, std::atomic<uint32_t>& inFlight) {
+        co_await task;
+        inFlight.fetch_sub(1, std::memory_order_release);
+    }
+
+private:
+    std::mutex                           mutex_{};       ///< 待機リストの同期オブジェクト
+    std::vector<FenceWait>               fenceWaits_{};  ///< フェンス待ちのコルーチン
+    std::vector<std::coroutine_handle<>> frameWaits_{};  ///< 次フレーム待ちのコルーチン
+    std::atomic<uint32_t>                inFlight_{};    ///< 完了していないタスク数
+    std::atomic<uint64_t>                frame_{};       ///< フレーム番号
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ファイル読み込みをワーカーに投入する
+ * @param	handle		読み込み完了後に再開するコルーチン
+ */
+void FileReadAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    JobSystem::instance().run([this, handle]() {
+        std::ifstream file(path_, std::ios::binary | std::ios::ate);
+        if (file) {
+            const auto size = static_cast<size_t>(file.tellg());
+            data_.resize(size);
+            file.seekg(0);
+            if (!file.read(reinterpret_cast<char*>(data_.data()), size)) {
+                data_.clear();
+            }
+        }
+        handle.resume();
+    });
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ
+ */
+CoroutineScheduler::~CoroutineScheduler() {
+    impl_.reset();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	タスクを開始する（完了後に自動で破棄される）
+ * @param	task		開始するタスク
+ */
+void CoroutineScheduler::spawn(Task<> task) {
+    impl_->spawn(std::move(task));
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コルーチンをワーカー上で再開する
+ * @param	handle		再開するコルーチン
+ */
+void CoroutineScheduler::schedule(std::coroutine_handle<> handle) {
+    impl_->schedule(handle);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フェンス値に到達した時に再開するよう登録する
+ * @param	fence		監視するフェンス
+ * @param	value		待機するフェンス値
+ * @param	handle		再開するコルーチン
+ */
+void CoroutineScheduler::waitFence(const FenceSource& fence, uint64_t value, std::coroutine_handle<> handle) {
+    impl_->waitFence(fence, value, handle);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	次のフレームで再開するよう登録する
+ * @param	handle		再開するコルーチン
+ */
+void CoroutineScheduler::waitNextFrame(std::coroutine_handle<> handle) {
+    impl_->waitNextFrame(handle);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フェンス待ちのコルーチンを確認し、到達したものを再開する
+ */
+void CoroutineScheduler::poll() {
+    impl_->poll();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームを進め、次フレーム待ちのコルーチンを再開する
+ */
+void CoroutineScheduler::advanceFrame() {
+    impl_->advanceFrame();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	spawn されて完了していないタスク数を取得する
+ */
+uint32_t CoroutineScheduler::inFlight() const noexcept {
+    return impl_->inFlight();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	現在のフレーム番号を取得する
+ */
+uint64_t CoroutineScheduler::frame() const noexcept {
+    return impl_->frame();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ */
+CoroutineScheduler::CoroutineScheduler() {
+    impl_.reset(new CoroutineScheduler::Impl());
+}
+}  // namespace utility
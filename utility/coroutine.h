@@ -0,0 +1,478 @@
+﻿#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "utility/fence_source.h"
+#include "utility/job_system.h"
+
+namespace utility {
+
+template <class T = void>
+class Task;
+
+namespace detail {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * コルーチン終了時に待機元へ制御を戻す
+ */
+struct FinalAwaiter {
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    template <class Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        auto continuation = handle.promise().continuation_;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * タスクのプロミス共通部分
+ */
+struct PromiseBase {
+    std::coroutine_handle<> continuation_{};  ///< 完了後に再開するコルーチン
+
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    void unhandled_exception() const noexcept {
+        ASSERT(false, "コルーチン内で例外が発生しました");
+        std::terminate();
+    }
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 戻り値を持つタスクのプロミス
+ */
+template <class T>
+struct Promise : PromiseBase {
+    std::optional<T> value_{};  ///< 戻り値
+
+    Task<T> get_return_object() noexcept;
+
+    template <class U>
+    void return_value(U&& value) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
+        value_.emplace(std::forward<U>(value));
+    }
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 戻り値を持たないタスクのプロミス
+ */
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+};
+}  // namespace detail
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * コルーチンタスク
+ *
+ * 生成時には実行されず、 co_await された時か CoroutineScheduler::spawn に渡された時に開始する
+ */
+template <class T>
+class Task final : Noncopyable {
+public:
+    using promise_type = detail::Promise<T>;
+    using handle_type  = std::coroutine_handle<promise_type>;
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    Task() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     * @param	handle		コルーチンハンドル
+     */
+    explicit Task(handle_type handle) noexcept
+        : handle_(handle) {
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ムーブコンストラクタ
+     */
+    Task(Task&& src) noexcept
+        : handle_(std::exchange(src.handle_, {})) {
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ムーブ代入
+     */
+    Task& operator=(Task&& src) noexcept {
+        if (this != &src) {
+            destroy();
+            handle_ = std::exchange(src.handle_, {});
+        }
+        return *this;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~Task() {
+        destroy();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	有効なコルーチンを保持しているか否かを取得する
+     */
+    [[nodiscard]] bool valid() const noexcept {
+        return static_cast<bool>(handle_);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	co_await 用の待機オブジェクトを取得する
+     */
+    auto operator co_await() & noexcept {
+        return Awaiter{handle_};
+    }
+
+    auto operator co_await() && noexcept {
+        return Awaiter{handle_};
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief
+     * タスクの完了を待機する
+     */
+    struct Awaiter {
+        handle_type handle_{};
+
+        bool await_ready() const noexcept {
+            return !handle_ || handle_.done();
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            // 待機元を登録してタスクを開始する（対称転送）
+            handle_.promise().continuation_ = awaiting;
+            return handle_;
+        }
+
+        decltype(auto) await_resume() noexcept {
+            if constexpr (!std::is_void_v<T>) {
+                return std::move(*handle_.promise().value_);
+            }
+        }
+    };
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コルーチンを破棄する
+     */
+    void destroy() noexcept {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = {};
+        }
+    }
+
+private:
+    handle_type handle_{};  ///< コルーチンハンドル
+};
+
+namespace detail {
+template <class T>
+inline Task<T> Promise<T>::get_return_object() noexcept {
+    return Task<T>{std::coroutine_handle<Promise<T>>::from_promise(*this)};
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept {
+    return Task<void>{std::coroutine_handle<Promise<void>>::from_promise(*this)};
+}
+}  // namespace detail
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * コルーチンの再開を管理するスケジューラ
+ *
+ * 再開はジョブシステムのワーカー上で行われる
+ * フェンス待ちとフレーム待ちは poll / advanceFrame を毎フレーム呼び出すことで再開される
+ */
+class CoroutineScheduler final : public Singleton<CoroutineScheduler> {
+private:
+    friend class Singleton<CoroutineScheduler>;
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~CoroutineScheduler();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	タスクを開始する（完了後に自動で破棄される）
+     * @param	task		開始するタスク
+     */
+    void spawn(Task<> task);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コルーチンをワーカー上で再開する
+     * @param	handle		再開するコルーチン
+     */
+    void schedule(std::coroutine_handle<> handle);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フェンス値に到達した時に再開するよう登録する
+     * @param	fence		監視するフェンス
+     * @param	value		待機するフェンス値
+     * @param	handle		再開するコルーチン
+     */
+    void waitFence(const FenceSource& fence, uint64_t value, std::coroutine_handle<> handle);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	次のフレームで再開するよう登録する
+     * @param	handle		再開するコルーチン
+     */
+    void waitNextFrame(std::coroutine_handle<> handle);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フェンス待ちのコルーチンを確認し、到達したものを再開する
+     */
+    void poll();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームを進め、次フレーム待ちのコルーチンを再開する
+     */
+    void advanceFrame();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	spawn されて完了していないタスク数を取得する
+     */
+    [[nodiscard]] uint32_t inFlight() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	現在のフレーム番号を取得する
+     */
+    [[nodiscard]] uint64_t frame() const noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    CoroutineScheduler();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;  ///< インプリメントクラスポインタ
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フェンス値への到達を待機する
+ */
+struct FenceAwaiter {
+    const FenceSource& fence_;
+    uint64_t           value_{};
+
+    bool await_ready() const noexcept {
+        return value_ <= fence_.completedValue();
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) const {
+        CoroutineScheduler::instance().waitFence(fence_, value_, handle);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ワーカー上に移って再開する
+ */
+struct ScheduleAwaiter {
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) const {
+        CoroutineScheduler::instance().schedule(handle);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ジョブカウンタの完了を待機する
+ */
+struct JobAwaiter {
+    JobCounter& counter_;
+
+    bool await_ready() const noexcept {
+        return counter_.isDone();
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) const {
+        JobSystem::instance().then(counter_, [handle]() { handle.resume(); });
+    }
+
+    void await_resume() const noexcept {}
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 次のフレームまで待機する
+ */
+struct NextFrameAwaiter {
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) const {
+        CoroutineScheduler::instance().waitNextFrame(handle);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ファイルの読み込み完了を待機する
+ *
+ * 読み込みはワーカー上で行われ、完了したワーカー上でそのまま再開する
+ * 読み込みに失敗した場合は空のデータを返す
+ */
+struct FileReadAwaiter {
+    std::string          path_{};
+    std::vector<uint8_t> data_{};
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle);
+
+    std::vector<uint8_t> await_resume() noexcept {
+        return std::move(data_);
+    }
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フェンス値への到達を待機する
+ * @param	fence		監視するフェンス
+ * @param	value		待機するフェンス値
+ */
+[[nodiscard]] inline FenceAwaiter waitFence(const FenceSource& fence, uint64_t value) noexcept {
+    return {fence, value};
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ワーカー上に移る（以降の処理はワーカー上で行う）
+ */
+[[nodiscard]] inline ScheduleAwaiter schedule() noexcept {
+    return {};
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ジョブカウンタの完了を待機する
+ * @param	counter		待機するカウンタ
+ */
+[[nodiscard]] inline JobAwaiter waitJob(JobCounter& counter) noexcept {
+    return {counter};
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	次のフレームまで待機する
+ */
+[[nodiscard]] inline NextFrameAwaiter nextFrame() noexcept {
+    return {};
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ファイルを読み込む
+ * @param	path		ファイルパス
+ */
+[[nodiscard]] inline FileReadAwaiter readFile(std::string_view path) {
+    return {std::string(path)};
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	タスクの完了まで呼び出しスレッドをブロックする
+ *
+ * 待機中はフェンス待ちの確認を行うので、メインスレッドから呼び出してよい
+ * @param	task		実行するタスク
+ * @return	タスクの戻り値
+ */
+template <class T>
+T syncWait(Task<T> task) {
+    std::atomic<bool>                                            done{};
+    std::optional<std::conditional_t<std::is_void_v<T>, int, T>> result{};
+
+    auto wrapper = [](Task<T>& task, std::atomic<bool>& done, auto& result) -> Task<> {
+        if constexpr (std::is_void_v<T>) {
+            co_await task;
+        } else {
+            result.emplace(co_await task);
+        }
+        done.store(true, std::memory_order_release);
+    };
+
+    auto& scheduler = CoroutineScheduler::instance();
+    scheduler.spawn(wrapper(task, done, result));
+
+    while (!done.load(std::memory_order_acquire)) {
+        scheduler.poll();
+        std::this_thread::yield();
+    }
+
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*result);
+    }
+}
+}  // namespace utility
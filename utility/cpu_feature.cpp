@@ -0,0 +1,80 @@
+﻿#include "cpu_feature.h"
+
+#if defined(UTILITY_X64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+
+#if defined(UTILITY_X64)
+//---------------------------------------------------------------------------------
+/**
+ * @brief	cpuid を実行する
+ * @param	leaf		リーフ
+ * @param	subLeaf		サブリーフ
+ * @param	regs		eax ebx ecx edx の格納先
+ */
+void cpuid(uint32_t leaf, uint32_t subLeaf, uint32_t (&regs)[4]) noexcept {
+#if defined(_MSC_VER)
+    int info[4]{};
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subLeaf));
+    for (auto i = 0; i < 4; i++) {
+        regs[i] = static_cast<uint32_t>(info[i]);
+    }
+#else
+    __cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	OS が YMM レジスタを保存するか否かを取得する
+ */
+bool osSavesYmm() noexcept {
+#if defined(_MSC_VER)
+    const auto xcr0 = _xgetbv(0);
+#else
+    uint32_t eax = 0, edx = 0;
+    __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    const auto xcr0 = (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+    return (xcr0 & 0x6) == 0x6;
+}
+#endif
+}  // namespace
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	CPU が対応している命令セットを取得する（初回のみ cpuid で判定する）
+ */
+const CpuFeature& cpuFeature() noexcept {
+    static const CpuFeature feature = [] {
+        CpuFeature f{};
+#if defined(UTILITY_X64)
+        uint32_t regs[4]{};
+        cpuid(0, 0, regs);
+        const auto maxLeaf = regs[0];
+
+        cpuid(1, 0, regs);
+        const auto ecx = regs[2];
+        f.sse42_       = (ecx & (1u << 20)) != 0;
+        f.pclmul_      = (ecx & (1u << 1)) && (ecx & (1u << 19));
+
+        const bool avx = (ecx & (1u << 27)) && (ecx & (1u << 28)) && osSavesYmm();
+        if (avx && maxLeaf >= 7) {
+            cpuid(7, 0, regs);
+            f.avx2_ = (regs[1] & (1u << 5)) != 0;
+        }
+#endif
+        return f;
+    }();
+    return feature;
+}
+
+}  // namespace utility
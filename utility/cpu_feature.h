@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define UTILITY_X64 1
+#include <immintrin.h>
+#endif
+
+// 関数単位で命令セットを有効にする指定（ MSVC は指定なしで利用できる）
+#if defined(UTILITY_X64) && !defined(_MSC_VER)
+#define TARGET_SSE42  __attribute__((target("sse4.2")))
+#define TARGET_PCLMUL __attribute__((target("pclmul,sse4.1")))
+#define TARGET_AVX2   __attribute__((target("avx2")))
+#else
+#define TARGET_SSE42
+#define TARGET_PCLMUL
+#define TARGET_AVX2
+#endif
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * CPU が対応している命令セット
+ */
+struct CpuFeature {
+    bool sse42_{};   ///< SSE4.2
+    bool pclmul_{};  ///< PCLMULQDQ と SSE4.1
+    bool avx2_{};    ///< AVX2 （ OS が YMM レジスタを保存する場合のみ）
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	CPU が対応している命令セットを取得する（初回のみ cpuid で判定する）
+ */
+[[nodiscard]] const CpuFeature& cpuFeature() noexcept;
+
+}  // namespace utility
@@ -1,19 +1,280 @@
 ﻿#include "crc32.h"
 
+#include <cstring>
+#include <fstream>
+
+#include "utility/cpu_feature.h"
+
+namespace {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	slice-by-8 用のテーブルを生成する
+ * @param	poly		多項式（ビット反転表現）
+ * @return	8 バイト分のテーブル
+ */
+constexpr std::array<std::array<uint32_t, 256>, 8> makeSliceTable(uint32_t poly) noexcept {
+    std::array<std::array<uint32_t, 256>, 8> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (auto bit = 0; bit < 8; bit++) {
+            c = (c & 1) ? (poly ^ (c >> 1)) : (c >> 1);
+        }
+        table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (auto slice = 1; slice < 8; slice++) {
+            table[slice][i] = table[0][table[slice - 1][i] & 0xFF] ^ (table[slice - 1][i] >> 8);
+        }
+    }
+    return table;
+}
+
+constexpr auto crc32Table  = makeSliceTable(0xEDB88320);  ///< crc32 ( IEEE 802.3 ) のテーブル
+constexpr auto crc32cTable = makeSliceTable(0x82F63B78);  ///< crc32c ( Castagnoli ) のテーブル
+
+static_assert(crc32Table[0][1] == utility::CRC32Table[1] && crc32Table[0][255] == utility::CRC32Table[255], "テーブルが一致しません");
+
+constexpr size_t pclmulMinSize = 64;  ///< PCLMULQDQ を利用する最小サイズ
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	テーブル参照で crc を計算する
+ * @param	table		テーブル
+ * @param	data		データの先頭アドレス
+ * @param	size		データのサイズ
+ * @param	c			計算途中の値（反転済み）
+ * @return	計算途中の値（反転済み）
+ */
+uint32_t sliceBy8(const std::array<std::array<uint32_t, 256>, 8>& table, const uint8_t* data, size_t size, uint32_t c) noexcept {
+    // 8 バイトずつ処理する（リトルエンディアン前提）
+    while (size >= 8) {
+        uint32_t lo = 0;
+        uint32_t hi = 0;
+        std::memcpy(&lo, data, sizeof(lo));
+        std::memcpy(&hi, data + 4, sizeof(hi));
+        lo ^= c;
+
+        c = table[7][lo & 0xFF] ^ table[6][(lo >> 8) & 0xFF] ^ table[5][(lo >> 16) & 0xFF] ^ table[4][lo >> 24] ^
+            table[3][hi & 0xFF] ^ table[2][(hi >> 8) & 0xFF] ^ table[1][(hi >> 16) & 0xFF] ^ table[0][hi >> 24];
+
+        data += 8;
+        size -= 8;
+    }
+
+    while (size--) {
+        c = table[0][(c ^ *data++) & 0xFF] ^ (c >> 8);
+    }
+    return c;
+}
+
+#if defined(UTILITY_X64)
+//---------------------------------------------------------------------------------
+/**
+ * @brief	16 バイトを読み込む
+ */
+TARGET_PCLMUL inline __m128i load(const uint8_t* p) noexcept {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	128 ビットを定数で畳み込み、次のブロックと合成する
+ * @param	x			畳み込む値
+ * @param	k			畳み込み定数
+ * @param	next		次のブロック
+ * @return	畳み込んだ値
+ */
+TARGET_PCLMUL inline __m128i fold(__m128i x, __m128i k, __m128i next) noexcept {
+    const auto lo = _mm_clmulepi64_si128(x, k, 0x00);
+    const auto hi = _mm_clmulepi64_si128(x, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	PCLMULQDQ で 64 バイトずつ畳み込んで crc32 を計算する
+ *
+ * Intel "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" の手法
+ * @param	data		データの先頭アドレス
+ * @param	size		データのサイズ（ 64 以上かつ 16 の倍数）
+ * @param	c			計算途中の値（反転済み）
+ * @return	計算途中の値（反転済み）
+ */
+TARGET_PCLMUL uint32_t crc32Pclmul(const uint8_t* data, size_t size, uint32_t c) noexcept {
+    alignas(16) static constexpr uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+    alignas(16) static constexpr uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+    alignas(16) static constexpr uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+    alignas(16) static constexpr uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+    auto x1 = _mm_xor_si128(load(data + 0x00), _mm_cvtsi32_si128(static_cast<int>(c)));
+    auto x2 = load(data + 0x10);
+    auto x3 = load(data + 0x20);
+    auto x4 = load(data + 0x30);
+    data += 64;
+    size -= 64;
+
+    // 4 レーン並列に 64 バイトずつ畳み込む
+    auto k = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+    while (size >= 64) {
+        x1 = fold(x1, k, load(data + 0x00));
+        x2 = fold(x2, k, load(data + 0x10));
+        x3 = fold(x3, k, load(data + 0x20));
+        x4 = fold(x4, k, load(data + 0x30));
+        data += 64;
+        size -= 64;
+    }
+
+    // 128 ビットにまとめる
+    k  = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    x1 = fold(x1, k, x2);
+    x1 = fold(x1, k, x3);
+    x1 = fold(x1, k, x4);
+
+    // 残りを 16 バイトずつ畳み込む
+    while (size >= 16) {
+        x1 = fold(x1, k, load(data));
+        data += 16;
+        size -= 16;
+    }
+
+    // 64 ビットにまとめる
+    const auto mask = _mm_setr_epi32(~0, 0, ~0, 0);
+    x2              = _mm_clmulepi64_si128(x1, k, 0x10);
+    x1              = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+    k  = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett 還元で 32 ビットにする
+    k  = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), k, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	SSE4.2 の crc32 命令で crc32c を計算する
+ * @param	data		データの先頭アドレス
+ * @param	size		データのサイズ
+ * @param	c			計算途中の値（反転済み）
+ * @return	計算途中の値（反転済み）
+ */
+TARGET_SSE42 uint32_t crc32cSse42(const uint8_t* data, size_t size, uint32_t c) noexcept {
+    uint64_t c64 = c;
+    while (size >= 8) {
+        uint64_t v = 0;
+        std::memcpy(&v, data, sizeof(v));
+        c64 = _mm_crc32_u64(c64, v);
+        data += 8;
+        size -= 8;
+    }
+
+    c = static_cast<uint32_t>(c64);
+    while (size--) {
+        c = _mm_crc32_u8(c, *data++);
+    }
+    return c;
+}
+#endif
+}  // namespace
+
 namespace utility {
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief	crc32 ( IEEE 802.3 ) を計算する
+ * @param	data		データの先頭アドレス
+ * @param	size		データのサイズ
+ * @param	crc			前回の計算結果
+ * @return	crc32
+ */
+uint32_t crc32(const void* data, size_t size, uint32_t crc) noexcept {
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint32_t    c = ~crc;
+
+#if defined(UTILITY_X64)
+    if (size >= pclmulMinSize && utility::cpuFeature().pclmul_) {
+        // 16 の倍数分を畳み込み、端数はテーブルで処理する
+        const auto bulk = size & ~static_cast<size_t>(15);
+        c               = crc32Pclmul(p, bulk, c);
+        p += bulk;
+        size -= bulk;
+    }
+#endif
+    return ~sliceBy8(crc32Table, p, size, c);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	crc32c ( Castagnoli ) を計算する
+ * @param	data		データの先頭アドレス
+ * @param	size		データのサイズ
+ * @param	crc			前回の計算結果
+ * @return	crc32c
+ */
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) noexcept {
+    const auto* p = static_cast<const uint8_t*>(data);
+
+#if defined(UTILITY_X64)
+    if (utility::cpuFeature().sse42_) {
+        return ~crc32cSse42(p, size, ~crc);
+    }
+#endif
+    return ~sliceBy8(crc32cTable, p, size, ~crc);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	crc32 の計算に利用している実装を取得する
+ */
+Crc32Impl crc32Impl() noexcept {
+#if defined(UTILITY_X64)
+    if (utility::cpuFeature().pclmul_) {
+        return Crc32Impl::Pclmul;
+    }
+#endif
+    return Crc32Impl::Table;
+}
+
 //---------------------------------------------------------------------------------
 /**
  * @brief 文字列をcrc32ハッシュ化する
  */
-uint32_t stringToHash(std::string str) noexcept {
-    uint32_t c = 0xFFFFFFFF;
+uint32_t stringToHash(std::string_view str) noexcept {
+    return crc32(str.data(), str.size());
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ファイルの内容をcrc32ハッシュ化する
+ * @param	path		ファイルパス
+ * @param	hash		ハッシュの格納先
+ * @return	読み込みに成功した場合は true
+ */
+bool fileToHash(const std::filesystem::path& path, uint32_t& hash) noexcept {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
 
-    // 終端文字は含めない
-    auto len = str.size() - 1;
-    for (auto i = 0; i < len; i++) {
-        c = CRC32Table[(c ^ str[i]) & 0xFF] ^ (c >> 8);
+    constexpr size_t        bufferSize = 64 * 1024;
+    std::unique_ptr<char[]> buffer(new char[bufferSize]);
+    Crc32Stream             stream;
+    while (file) {
+        file.read(buffer.get(), bufferSize);
+        stream.update(buffer.get(), static_cast<size_t>(file.gcount()));
     }
-    return c ^ 0xFFFFFFFF;
+    if (file.bad()) {
+        return false;
+    }
+
+    hash = stream.value();
+    return true;
 }
 }  // namespace utility
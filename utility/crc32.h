@@ -23,9 +23,109 @@ constexpr uint32_t CRC32Table[256] = {
 
 //---------------------------------------------------------------------------------
 /**
- * @brief 文字列をcrc32ハッシュ化する
+ * @brief	crc32 の計算に利用する実装
+ */
+enum class Crc32Impl : uint8_t {
+    Table,   ///< テーブル参照（ slice-by-8 ）
+    Pclmul,  ///< PCLMULQDQ による畳み込み
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	crc32 ( IEEE 802.3 ) を計算する
+ *
+ * CPU が対応していれば PCLMULQDQ を利用し、非対応の場合はテーブル参照で計算する
+ * crc に前回の結果を渡すと続きから計算する（分割して計算した結果は一括で計算した結果と一致する）
+ * @param	data		データの先頭アドレス
+ * @param	size		データのサイズ
+ * @param	crc			前回の計算結果
+ * @return	crc32
+ */
+[[nodiscard]] uint32_t crc32(const void* data, size_t size, uint32_t crc = 0) noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	crc32c ( Castagnoli ) を計算する
+ *
+ * CPU が対応していれば SSE4.2 の crc32 命令を利用する
+ * crc32 とは多項式が異なるため、 TO_HASH のキーとは互換性がない（ファイルの検証などキーとして使わない用途向け）
+ * @param	data		データの先頭アドレス
+ * @param	size		データのサイズ
+ * @param	crc			前回の計算結果
+ * @return	crc32c
+ */
+[[nodiscard]] uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0) noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	crc32 の計算に利用している実装を取得する
+ */
+[[nodiscard]] Crc32Impl crc32Impl() noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief 文字列をcrc32ハッシュ化する（ stringToHashT と同じ値になる）
  */
-uint32_t stringToHash(std::string str) noexcept;
+[[nodiscard]] uint32_t stringToHash(std::string_view str) noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ファイルの内容をcrc32ハッシュ化する
+ * @param	path		ファイルパス
+ * @param	hash		ハッシュの格納先
+ * @return	読み込みに成功した場合は true
+ */
+[[nodiscard]] bool fileToHash(const std::filesystem::path& path, uint32_t& hash) noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * crc32 の逐次計算
+ *
+ * 大きなデータやファイルを分割して渡しながらハッシュ化する
+ */
+class Crc32Stream final {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	データを追加する
+     * @param	data		データの先頭アドレス
+     * @param	size		データのサイズ
+     */
+    void update(const void* data, size_t size) noexcept {
+        crc_ = crc32(data, size, crc_);
+        size_ += size;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	これまでに追加したデータのハッシュを取得する
+     */
+    [[nodiscard]] uint32_t value() const noexcept {
+        return crc_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	これまでに追加したデータのサイズを取得する
+     */
+    [[nodiscard]] uint64_t size() const noexcept {
+        return size_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	計算を最初からやり直す
+     */
+    void reset() noexcept {
+        crc_  = 0;
+        size_ = 0;
+    }
+
+private:
+    uint32_t crc_{};   ///< これまでのハッシュ
+    uint64_t size_{};  ///< これまでに追加したサイズ
+};
 
 //---------------------------------------------------------------------------------
 /**
@@ -36,8 +136,8 @@ constexpr uint32_t stringToHashT(const char (&str)[size]) noexcept {
     uint32_t c = 0xFFFFFFFF;
 
     // 終端文字は含めない
-    auto len = size - 1;
-    for (auto i = 0; i < len; i++) {
+    constexpr auto len = size - 1;
+    for (size_t i = 0; i < len; i++) {
         c = CRC32Table[(c ^ str[i]) & 0xFF] ^ (c >> 8);
     }
     return c ^ 0xFFFFFFFF;
@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#include <atomic>
+
+#include "utility/noncopyable.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フェンス値の取得元
+ *
+ * GPU フェンスなど、単調増加する完了値を持つものを抽象化する
+ */
+class FenceSource : Noncopyable {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    virtual ~FenceSource() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	完了済みのフェンス値を取得する
+     */
+    [[nodiscard]] virtual uint64_t completedValue() const noexcept = 0;
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 手動でシグナルするフェンス
+ *
+ * CPU 側のタイムラインや、デバイスの無い環境での動作確認に利用する
+ */
+class ManualFenceSource final : public FenceSource {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    ManualFenceSource() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~ManualFenceSource() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フェンス値を設定する
+     * @param	value		完了済みとするフェンス値
+     */
+    void signal(uint64_t value) noexcept {
+        value_.store(value, std::memory_order_release);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	完了済みのフェンス値を取得する
+     */
+    [[nodiscard]] uint64_t completedValue() const noexcept override {
+        return value_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<uint64_t> value_{};  ///< 完了済みのフェンス値
+};
+}  // namespace utility
@@ -0,0 +1,674 @@
+﻿#pragma once
+
+#include <bit>
+#include <cstring>
+#include <memory>
+
+#include "utility/cpu_feature.h"
+#include "utility/hash.h"
+#include "utility/noncopyable.h"
+
+namespace utility {
+
+namespace detail::flat_map {
+
+constexpr int8_t   ctrlEmpty   = -128;  ///< 空きスロットの制御バイト
+constexpr int8_t   ctrlDeleted = -2;    ///< 削除済みスロットの制御バイト
+constexpr uint32_t groupWidth  = 16;    ///< 一度に比較する制御バイト数
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 制御バイト 16 個分のグループ
+ *
+ * 使用中のスロットはハッシュの下位 7 ビット（ 0 ～ 127 ）を、空きと削除済みは負の値を持つ
+ * 各 match はグループ内で一致した位置をビットマスクで返す
+ */
+class Group final {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     * @param	ctrl		グループ先頭の制御バイト（アラインメント不要）
+     */
+    explicit Group(const int8_t* ctrl) noexcept {
+#if defined(UTILITY_X64)
+        ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+        std::memcpy(ctrl_, ctrl, groupWidth);
+#endif
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	指定した制御バイトと一致する位置を取得する
+     * @param	h2			ハッシュの下位 7 ビット
+     */
+    [[nodiscard]] uint32_t match(int8_t h2) const noexcept {
+#if defined(UTILITY_X64)
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2))));
+#else
+        uint32_t mask = 0;
+        for (uint32_t i = 0; i < groupWidth; i++) {
+            mask |= static_cast<uint32_t>(ctrl_[i] == h2) << i;
+        }
+        return mask;
+#endif
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	空きスロットの位置を取得する
+     */
+    [[nodiscard]] uint32_t matchEmpty() const noexcept {
+        return match(ctrlEmpty);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	空きか削除済みのスロットの位置を取得する
+     */
+    [[nodiscard]] uint32_t matchEmptyOrDeleted() const noexcept {
+#if defined(UTILITY_X64)
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl_)));
+#else
+        uint32_t mask = 0;
+        for (uint32_t i = 0; i < groupWidth; i++) {
+            mask |= static_cast<uint32_t>(ctrl_[i] < -1) << i;
+        }
+        return mask;
+#endif
+    }
+
+private:
+#if defined(UTILITY_X64)
+    __m128i ctrl_;  ///< 制御バイト
+#else
+    int8_t ctrl_[groupWidth];  ///< 制御バイト
+#endif
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	要素が無いマップが参照する制御バイト（検索を分岐無しで空振りさせる）
+ */
+inline const int8_t* emptyGroup() noexcept {
+    alignas(16) static constexpr int8_t group[groupWidth] = {
+        ctrlEmpty, ctrlEmpty, ctrlEmpty, ctrlEmpty, ctrlEmpty, ctrlEmpty, ctrlEmpty, ctrlEmpty,
+        ctrlEmpty, ctrlEmpty, ctrlEmpty, ctrlEmpty, ctrlEmpty, ctrlEmpty, ctrlEmpty, ctrlEmpty,
+    };
+    return group;
+}
+
+}  // namespace detail::flat_map
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フラットマップ用のハッシュ
+ *
+ * 制御バイトとプローブ開始位置にハッシュの上位と下位を分けて使うので、全ビットを攪拌する
+ * 文字列は std::string / std::string_view / const char* のどれでも同じ値になる（異種検索用）
+ */
+template <class T, class = void>
+struct FlatHash {
+    [[nodiscard]] uint64_t operator()(const T& value) const noexcept {
+        return hashCombine(0, static_cast<uint64_t>(std::hash<T>{}(value)));
+    }
+};
+
+template <class T>
+struct FlatHash<T, std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>>> {
+    [[nodiscard]] uint64_t operator()(T value) const noexcept {
+        if constexpr (std::is_pointer_v<T>) {
+            return hashCombine(0, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+        } else {
+            return hashCombine(0, static_cast<uint64_t>(value));
+        }
+    }
+};
+
+template <>
+struct FlatHash<std::string> {
+    using is_transparent = void;
+
+    [[nodiscard]] uint64_t operator()(std::string_view value) const noexcept {
+        return hash64(value);
+    }
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * オープンアドレス方式のフラットなハッシュマップ
+ *
+ * 要素はスロット配列に直接格納し、スロットごとの制御バイトを 16 個ずつ SIMD で比較してプローブする
+ * 負荷率が 7/8 を超えると容量を 2 倍にして再構築する（要素のアドレスは再構築で変わる）
+ * ハッシュが is_transparent を持つ場合は、キーを変換せずに異なる型で検索できる
+ *
+ * スレッドセーフではない
+ * 反復で得られる要素のキーは変更しないこと
+ */
+template <class Key, class Value, class Hash = FlatHash<Key>, class Equal = std::equal_to<>>
+class FlatMap final : Noncopyable {
+public:
+    using value_type = std::pair<Key, Value>;
+
+private:
+    using Group = detail::flat_map::Group;
+
+    static constexpr uint32_t groupWidth  = detail::flat_map::groupWidth;
+    static constexpr size_t   minCapacity = groupWidth;  ///< 最小の容量
+    static constexpr size_t   npos        = ~size_t(0);  ///< 見つからなかったことを表す値
+
+    // K で検索できるか否か（ハッシュが is_transparent を持つか、 Key に変換できる）
+    template <class K>
+    static constexpr bool keyLike = requires { typename Hash::is_transparent; } || std::is_convertible_v<K, Key>;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  反復子
+     */
+    template <bool Const>
+    class Iterator {
+    public:
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+        using pointer   = std::conditional_t<Const, const value_type*, value_type*>;
+
+        Iterator() = default;
+        Iterator(const int8_t* ctrl, pointer slot, const int8_t* end) noexcept
+            : ctrl_(ctrl), slot_(slot), end_(end) {
+            skip();
+        }
+
+        //---------------------------------------------------------------------------------
+        /**
+         * @brief	const 版に変換する
+         */
+        operator Iterator<true>() const noexcept
+            requires(!Const)
+        {
+            return Iterator<true>(ctrl_, slot_, end_);
+        }
+
+        reference operator*() const noexcept {
+            return *slot_;
+        }
+        pointer operator->() const noexcept {
+            return slot_;
+        }
+        Iterator& operator++() noexcept {
+            ++ctrl_;
+            ++slot_;
+            skip();
+            return *this;
+        }
+        bool operator==(const Iterator& r) const noexcept {
+            return ctrl_ == r.ctrl_;
+        }
+
+    private:
+        //---------------------------------------------------------------------------------
+        /**
+         * @brief	使用中のスロットまで進める
+         */
+        void skip() noexcept {
+            while (ctrl_ != end_ && *ctrl_ < 0) {
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+
+    private:
+        const int8_t* ctrl_{};  ///< 現在の制御バイト
+        pointer       slot_{};  ///< 現在のスロット
+        const int8_t* end_{};   ///< 終端の制御バイト
+    };
+
+public:
+    using iterator       = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    FlatMap() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ムーブコンストラクタ
+     */
+    FlatMap(FlatMap&& r) noexcept {
+        swap(r);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ムーブ代入
+     */
+    FlatMap& operator=(FlatMap&& r) noexcept {
+        FlatMap temp(std::move(r));
+        swap(temp);
+        return *this;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~FlatMap() {
+        destroy();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素数を取得する
+     */
+    [[nodiscard]] size_t size() const noexcept {
+        return size_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素が無いか否か
+     */
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スロット数を取得する
+     */
+    [[nodiscard]] size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    iterator begin() noexcept {
+        return iterator(ctrl_, slots_, ctrl_ + capacity_);
+    }
+    iterator end() noexcept {
+        return iterator(ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(ctrl_, slots_, ctrl_ + capacity_);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キーを検索する
+     * @param	key			キー（ハッシュが is_transparent を持つ場合は異なる型でもよい）
+     * @return	要素の反復子（無い場合は end ）
+     */
+    template <class K>
+        requires keyLike<K>
+    [[nodiscard]] iterator find(const K& key) noexcept {
+        const auto index = findIndex(key);
+        return index == npos ? end() : iterator(ctrl_ + index, slots_ + index, ctrl_ + capacity_);
+    }
+
+    template <class K>
+        requires keyLike<K>
+    [[nodiscard]] const_iterator find(const K& key) const noexcept {
+        const auto index = findIndex(key);
+        return index == npos ? end() : const_iterator(ctrl_ + index, slots_ + index, ctrl_ + capacity_);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キーの値を検索する
+     * @param	key			キー
+     * @return	値のポインタ（無い場合は nullptr ）
+     */
+    template <class K>
+        requires keyLike<K>
+    [[nodiscard]] Value* findValue(const K& key) noexcept {
+        const auto index = findIndex(key);
+        return index == npos ? nullptr : &slots_[index].second;
+    }
+
+    template <class K>
+        requires keyLike<K>
+    [[nodiscard]] const Value* findValue(const K& key) const noexcept {
+        const auto index = findIndex(key);
+        return index == npos ? nullptr : &slots_[index].second;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キーが登録されているか否か
+     * @param	key			キー
+     */
+    template <class K>
+        requires keyLike<K>
+    [[nodiscard]] bool contains(const K& key) const noexcept {
+        return findIndex(key) != npos;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キーが無い場合のみ要素を追加する
+     *
+     * キーが異なる型の場合は、追加する時だけ Key に変換する
+     * @param	key			キー
+     * @param	args		値のコンストラクタ引数
+     * @return	要素の反復子と、追加したか否か
+     */
+    template <class K, class... Args>
+        requires keyLike<K>
+    std::pair<iterator, bool> tryEmplace(K&& key, Args&&... args) {
+        const auto hash  = Hash{}(key);
+        auto       index = findIndex(key, hash);
+        if (index != npos) {
+            return {iterator(ctrl_ + index, slots_ + index, ctrl_ + capacity_), false};
+        }
+
+        index = prepareInsert(hash);
+        new (slots_ + index) value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        growthLeft_ -= (ctrl_[index] == detail::flat_map::ctrlEmpty) ? 1 : 0;
+        setCtrl(index, static_cast<int8_t>(hash & 0x7f));
+        size_++;
+        return {iterator(ctrl_ + index, slots_ + index, ctrl_ + capacity_), true};
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素を追加する（キーがある場合は値を上書きする）
+     * @param	key			キー
+     * @param	value		値
+     * @return	要素の反復子と、追加したか否か
+     */
+    template <class K, class V>
+        requires keyLike<K>
+    std::pair<iterator, bool> insertOrAssign(K&& key, V&& value) {
+        auto result = tryEmplace(std::forward<K>(key), std::forward<V>(value));
+        if (!result.second) {
+            result.first->second = std::forward<V>(value);
+        }
+        return result;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キーの値を取得する（無い場合は値を初期化して追加する）
+     * @param	key			キー
+     * @return	値
+     */
+    template <class K>
+        requires keyLike<K>
+    Value& operator[](K&& key) {
+        return tryEmplace(std::forward<K>(key)).first->second;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素を削除する
+     * @param	key			キー
+     * @return	削除した場合は true
+     */
+    template <class K>
+        requires keyLike<K>
+    bool erase(const K& key) noexcept {
+        const auto index = findIndex(key);
+        if (index == npos) {
+            return false;
+        }
+        eraseIndex(index);
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素を削除する
+     * @param	it			削除する要素の反復子
+     * @return	次の要素の反復子
+     */
+    iterator erase(iterator it) noexcept {
+        const auto index = static_cast<size_t>(&*it - slots_);
+        eraseIndex(index);
+        return ++it;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	すべての要素を削除する（容量は保持する）
+     */
+    void clear() noexcept {
+        if (capacity_ == 0) {
+            return;
+        }
+        for (size_t i = 0; i < capacity_; i++) {
+            if (ctrl_[i] >= 0) {
+                slots_[i].~value_type();
+            }
+        }
+        std::memset(ctrl_, detail::flat_map::ctrlEmpty, capacity_ + groupWidth);
+        size_       = 0;
+        growthLeft_ = maxLoad(capacity_);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	指定した要素数まで再構築せずに追加できるように容量を確保する
+     * @param	num			要素数
+     */
+    void reserve(size_t num) {
+        if (num > size_ + growthLeft_) {
+            rehash(num * 8 / 7 + 1);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スロット数を変更して再構築する
+     *
+     * 実際のスロット数は、指定数と現在の要素数を収められる数以上の 2 のべき乗になる
+     * 0 を指定すると要素数に合わせて縮小する
+     * @param	num			スロット数
+     */
+    void rehash(size_t num) {
+        auto capacity = std::max<size_t>(std::bit_ceil(std::max(num, size_ * 8 / 7 + 1)), minCapacity);
+        while (maxLoad(capacity) < size_) {
+            capacity *= 2;
+        }
+        if (size_ == 0 && num == 0) {
+            destroy();
+            return;
+        }
+        resize(capacity);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	入れ替える
+     */
+    void swap(FlatMap& r) noexcept {
+        std::swap(ctrl_, r.ctrl_);
+        std::swap(slots_, r.slots_);
+        std::swap(capacity_, r.capacity_);
+        std::swap(size_, r.size_);
+        std::swap(growthLeft_, r.growthLeft_);
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	容量に対して追加できる最大要素数（負荷率 7/8 ）
+     */
+    static constexpr size_t maxLoad(size_t capacity) noexcept {
+        return capacity - capacity / 8;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	制御バイトを設定する（先頭グループの複製も更新する）
+     * @param	index		スロットのインデックス
+     * @param	h			制御バイト
+     */
+    void setCtrl(size_t index, int8_t h) noexcept {
+        ctrl_[index] = h;
+        if (index < groupWidth) {
+            ctrl_[capacity_ + index] = h;
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キーのスロットを検索する
+     * @param	key			キー
+     * @param	hash		キーのハッシュ
+     * @return	スロットのインデックス（無い場合は npos ）
+     */
+    template <class K>
+    size_t findIndex(const K& key, uint64_t hash) const noexcept {
+        // 容量が 0 の場合は空のグループを 1 回だけ見て終わる
+        const auto mask = capacity_ == 0 ? 0 : capacity_ - 1;
+        const auto h2   = static_cast<int8_t>(hash & 0x7f);
+        auto       pos  = static_cast<size_t>(hash >> 7) & mask;
+        for (size_t step = groupWidth;; step += groupWidth) {
+            const Group group(ctrl_ + pos);
+            for (auto bits = group.match(h2); bits != 0; bits &= bits - 1) {
+                const auto index = (pos + std::countr_zero(bits)) & mask;
+                if (Equal{}(slots_[index].first, key)) [[likely]] {
+                    return index;
+                }
+            }
+            if (group.matchEmpty() != 0) [[likely]] {
+                return npos;
+            }
+            pos = (pos + step) & mask;
+        }
+    }
+
+    template <class K>
+    size_t findIndex(const K& key) const noexcept {
+        return findIndex(key, Hash{}(key));
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	追加先のスロットを探す（必要なら再構築する）
+     *
+     * 制御バイトは要素の生成後に呼び出し側で設定する
+     * @param	hash		追加するキーのハッシュ
+     * @return	スロットのインデックス
+     */
+    size_t prepareInsert(uint64_t hash) {
+        auto index = findFirstNonFull(hash);
+
+        // 空きスロットを使う場合のみ負荷率が上がる（削除済みスロットの再利用は上がらない）
+        if (growthLeft_ == 0 && ctrl_[index] == detail::flat_map::ctrlEmpty) {
+            // 削除済みスロットが多いだけなら同じ容量で作り直す
+            resize(size_ < maxLoad(capacity_) / 2 ? capacity_ : std::max<size_t>(capacity_ * 2, minCapacity));
+            index = findFirstNonFull(hash);
+        }
+        return index;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	プローブ順で最初の空きか削除済みのスロットを検索する
+     * @param	hash		キーのハッシュ
+     * @return	スロットのインデックス（容量が 0 の場合は 0 ）
+     */
+    size_t findFirstNonFull(uint64_t hash) const noexcept {
+        if (capacity_ == 0) {
+            return 0;
+        }
+
+        const auto mask = capacity_ - 1;
+        auto       pos  = static_cast<size_t>(hash >> 7) & mask;
+        for (size_t step = groupWidth;; step += groupWidth) {
+            const auto bits = Group(ctrl_ + pos).matchEmptyOrDeleted();
+            if (bits != 0) {
+                return (pos + std::countr_zero(bits)) & mask;
+            }
+            pos = (pos + step) & mask;
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スロットの要素を削除する
+     * @param	index		スロットのインデックス
+     */
+    void eraseIndex(size_t index) noexcept {
+        slots_[index].~value_type();
+        size_--;
+
+        // 同じグループに空きがあれば、このスロットを通り過ぎたプローブは無いので空きに戻せる
+        const auto mask   = capacity_ - 1;
+        const auto before = Group(ctrl_ + ((index - groupWidth) & mask)).matchEmpty();
+        const auto after  = Group(ctrl_ + index).matchEmpty();
+        if (before != 0 && after != 0 && std::countl_zero(before << 16) + std::countr_zero(after) < static_cast<int>(groupWidth)) {
+            setCtrl(index, detail::flat_map::ctrlEmpty);
+            growthLeft_++;
+        } else {
+            setCtrl(index, detail::flat_map::ctrlDeleted);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	容量を変更して全要素を再配置する
+     * @param	capacity	新しいスロット数（ 2 のべき乗）
+     */
+    void resize(size_t capacity) {
+        auto* oldCtrl     = ctrl_;
+        auto* oldSlots    = slots_;
+        auto  oldCapacity = capacity_;
+
+        ctrl_       = new int8_t[capacity + groupWidth];
+        slots_      = std::allocator<value_type>{}.allocate(capacity);
+        capacity_   = capacity;
+        growthLeft_ = maxLoad(capacity) - size_;
+        std::memset(ctrl_, detail::flat_map::ctrlEmpty, capacity + groupWidth);
+
+        for (size_t i = 0; i < oldCapacity; i++) {
+            if (oldCtrl[i] < 0) {
+                continue;
+            }
+            const auto hash  = Hash{}(oldSlots[i].first);
+            const auto index = findFirstNonFull(hash);
+            setCtrl(index, static_cast<int8_t>(hash & 0x7f));
+            new (slots_ + index) value_type(std::move(oldSlots[i]));
+            oldSlots[i].~value_type();
+        }
+
+        if (oldCapacity > 0) {
+            delete[] oldCtrl;
+            std::allocator<value_type>{}.deallocate(oldSlots, oldCapacity);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	全要素を破棄してメモリを解放する
+     */
+    void destroy() noexcept {
+        if (capacity_ == 0) {
+            return;
+        }
+        clear();
+        delete[] ctrl_;
+        std::allocator<value_type>{}.deallocate(slots_, capacity_);
+
+        ctrl_       = const_cast<int8_t*>(detail::flat_map::emptyGroup());
+        slots_      = nullptr;
+        capacity_   = 0;
+        growthLeft_ = 0;
+    }
+
+private:
+    int8_t*     ctrl_{const_cast<int8_t*>(detail::flat_map::emptyGroup())};  ///< 制御バイト（末尾に先頭グループの複製を持つ）
+    value_type* slots_{};                                                    ///< スロット
+    size_t      capacity_{};                                                 ///< スロット数（ 0 か 2 のべき乗）
+    size_t      size_{};                                                     ///< 要素数
+    size_t      growthLeft_{};                                               ///< 再構築せずに追加できる残り数
+};
+}  // namespace utility
@@ -0,0 +1,94 @@
+﻿#pragma once
+
+#include <cstdint>
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フライトレコーダーのダンプファイル形式
+ *
+ * エンジン本体とオフラインのデコーダー（ tools/flight_decode ）で共有するので、標準ヘッダー以外に依存しないこと
+ * 値はすべてリトルエンディアンで、構造体はパディング無しでそのまま書き出す
+ *
+ * ファイルの構成
+ *   FileHeader
+ *   ThreadHeader + Record * recordNum_ （スレッド数分、古い順）
+ *   NameHeader + 名前の文字列（終端文字無し） （名前数分）
+ */
+namespace utility::flight {
+
+constexpr char     fileMagic[8]  = {'E', 'N', 'G', 'F', 'L', 'T', 'R', '1'};  ///< ファイル識別子
+constexpr uint32_t fileVersion   = 1;                                         ///< ファイル形式のバージョン
+constexpr uint32_t threadNameMax = 32;                                        ///< スレッド名の最大長（終端文字を含む）
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	イベントの種類
+ */
+enum class EventType : uint16_t {
+    Frame,            ///< フレームの区切り（ arg0 : フレーム番号、 arg1 : フレーム時間のティック）
+    Scope,            ///< 計測スコープ（時刻は終了時刻、 arg0 : 時間のティック、 arg1 : スレッドインデックス << 16 | 深さ）
+    ResourceCreate,   ///< GPU リソースの作成（ arg0 : サイズ、 arg1 : 個数）
+    QueueSubmit,      ///< コマンドキューへの投入（ arg0 : コマンドリスト数）
+    FenceSignal,      ///< フェンスのシグナル（ arg0 : フェンス値）
+    FenceWait,        ///< フェンス待ち（ arg0 : フェンス値）
+    DescriptorAlloc,  ///< ディスクリプタの確保（ arg0 : 先頭インデックス、 arg1 : 個数）
+    Present,          ///< スワップチェインのプレゼント（ arg0 : バッファインデックス）
+    Marker,           ///< 任意のマーカー
+    DescriptorFree,   ///< ディスクリプタの解放（ arg0 : 先頭インデックス、 arg1 : 個数）
+    Num,
+};
+
+#pragma pack(push, 1)
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ファイルヘッダー
+ */
+struct FileHeader {
+    char     magic_[8];        ///< ファイル識別子（ fileMagic ）
+    uint32_t version_;         ///< ファイル形式のバージョン
+    uint32_t recordSize_;      ///< 1 レコードのバイト数
+    double   nanosecPerTick_;  ///< 1 ティックあたりのナノ秒
+    uint64_t dumpTime_;        ///< ダンプした時刻（ティック）
+    uint32_t threadNum_;       ///< スレッド数
+    uint32_t nameNum_;         ///< 名前の数
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	スレッドごとのヘッダー
+ */
+struct ThreadHeader {
+    uint32_t index_;                ///< スレッドインデックス
+    char     name_[threadNameMax];  ///< スレッド名
+    uint32_t recordNum_;            ///< 続くレコード数
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	イベントの記録
+ */
+struct Record {
+    uint64_t time_;  ///< 時刻（ティック）
+    uint64_t arg0_;  ///< 引数 0
+    uint64_t arg1_;  ///< 引数 1
+    uint32_t name_;  ///< 名前のハッシュ値（ stringToHash ）
+    uint16_t type_;  ///< イベントの種類（ EventType ）
+    uint16_t pad_;   ///< 未使用
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	名前テーブルの要素のヘッダー
+ */
+struct NameHeader {
+    uint32_t hash_;    ///< ハッシュ値
+    uint16_t length_;  ///< 続く文字列のバイト数
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(Record) == 32);
+
+}  // namespace utility::flight
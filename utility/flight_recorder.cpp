@@ -0,0 +1,510 @@
+﻿#include "flight_recorder.h"
+
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <share.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#include "utility/flat_map.h"
+#include "utility/profiler.h"
+
+namespace {
+using namespace utility::flight;
+
+constexpr uint32_t recordMask = utility::FlightRecorder::recordNum - 1;
+static_assert((utility::FlightRecorder::recordNum & recordMask) == 0, "レコード数は 2 のべき乗で指定してください");
+
+std::atomic<uint32_t> recorderSerial{};     ///< レコーダーの生成ごとに割り当てる番号
+constexpr size_t      crashPathMax = 1024;  ///< クラッシュ時の出力先の最大長（終端を含む）
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	書き出し先のファイルを開く（ open を直接使うので、シグナルハンドラからも呼び出せる）
+ * @param	path		ファイルパス
+ * @return	ファイルディスクリプタ（失敗した場合は負数）
+ */
+int openDumpFile(const char* path) noexcept {
+#if defined(_WIN32)
+    int file = -1;
+    _sopen_s(&file, path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _SH_DENYNO, _S_IREAD | _S_IWRITE);
+    return file;
+#else
+    return ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+}
+
+#if defined(_WIN32)
+//---------------------------------------------------------------------------------
+/**
+ * @brief	書き出し先のファイルを開く（ std::filesystem::path のワイド文字列用）
+ * @param	path		ファイルパス
+ * @return	ファイルディスクリプタ（失敗した場合は負数）
+ */
+int openDumpFile(const wchar_t* path) noexcept {
+    int file = -1;
+    _wsopen_s(&file, path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _SH_DENYNO, _S_IREAD | _S_IWRITE);
+    return file;
+}
+#endif
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ファイルにすべて書き込む（途中までしか書き込めなかった場合は続きを書き込む）
+ * @param	file		ファイルディスクリプタ
+ * @param	data		書き込むデータ
+ * @param	size		バイト数
+ * @return	すべて書き込めた場合は true
+ */
+bool writeAll(int file, const void* data, size_t size) noexcept {
+    const auto* p = static_cast<const char*>(data);
+    while (size > 0) {
+#if defined(_WIN32)
+        const auto n = _write(file, p, static_cast<unsigned int>(std::min<size_t>(size, INT_MAX)));
+#else
+        const auto n = ::write(file, p, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ファイルの先頭に戻る
+ * @param	file		ファイルディスクリプタ
+ * @return	成功した場合は true
+ */
+bool rewindFile(int file) noexcept {
+#if defined(_WIN32)
+    return _lseek(file, 0, SEEK_SET) == 0;
+#else
+    return ::lseek(file, 0, SEEK_SET) == 0;
+#endif
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ファイルを閉じる
+ * @param	file		ファイルディスクリプタ
+ * @return	成功した場合は true
+ */
+bool closeFile(int file) noexcept {
+#if defined(_WIN32)
+    return _close(file) == 0;
+#else
+    return ::close(file) == 0;
+#endif
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	クラッシュやアサートの際に記録を書き出す（生成済みのレコーダーのみ）
+ */
+void dumpOnFailure() {
+    static std::atomic<bool> dumped{};
+    auto*                    recorder = utility::FlightRecorder::pointer();
+    if (!recorder || dumped.exchange(true)) {
+        return;
+    }
+    recorder->dumpOnCrash();
+}
+
+#if defined(_WIN32)
+//---------------------------------------------------------------------------------
+/**
+ * @brief	未処理の例外で記録を書き出す
+ */
+LONG WINAPI unhandledExceptionFilter(EXCEPTION_POINTERS*) {
+    dumpOnFailure();
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+#else
+//---------------------------------------------------------------------------------
+/**
+ * @brief	シグナルで記録を書き出し、既定の処理に戻して再送する
+ */
+void signalHandler(int sig) {
+    dumpOnFailure();
+    std::signal(sig, SIG_DFL);
+    std::raise(sig);
+}
+#endif
+}  // namespace
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フライトレコーダーのインプリメントクラス
+ */
+class FlightRecorder::Impl {
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  スレッドごとの記録先
+     */
+    struct ThreadRing {
+        std::array<Record, recordNum> records_{};              ///< レコード（古いものから上書きする）
+        std::atomic<uint64_t>         head_{};                 ///< 次に書き込む位置（書き込んだ総数）
+        uint32_t                      index_{};                ///< スレッドインデックス
+        char                          name_[threadNameMax]{};  ///< スレッド名
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    Impl()
+        : serial_(recorderSerial.fetch_add(1, std::memory_order_relaxed) + 1) {
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~Impl() {
+        const auto num = std::min(ringNum_.load(std::memory_order_acquire), maxThreadNum);
+        for (uint32_t i = 0; i < num; i++) {
+            delete rings_[i].load(std::memory_order_acquire);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	イベントを記録する
+     */
+    void record(FlightEvent type, uint32_t name, uint64_t time, uint64_t arg0, uint64_t arg1) noexcept {
+        if (!enabled_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        auto* ring = local();
+        if (!ring) {
+            return;
+        }
+
+        // 書き込みは所有スレッドのみなので、位置を進めるのはレコードを書いた後でよい
+        const auto head = ring->head_.load(std::memory_order_relaxed);
+        auto&      rec  = ring->records_[head & recordMask];
+        rec.time_       = time;
+        rec.arg0_       = arg0;
+        rec.arg1_       = arg1;
+        rec.name_       = name;
+        rec.type_       = static_cast<uint16_t>(type);
+        ring->head_.store(head + 1, std::memory_order_release);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	プロファイラが区切ったフレームとスコープを記録する
+     * @param	frame		区切ったフレーム
+     */
+    void recordFrame(const ProfileFrame& frame) noexcept {
+        for (const auto& scope : frame.scopes_) {
+            if (scope.clipped_) {
+                continue;
+            }
+            const auto arg1 = (static_cast<uint64_t>(scope.thread_) << 16) | scope.depth_;
+            record(FlightEvent::Scope, scopeName(scope.name_), scope.end_, scope.end_ - scope.start_, arg1);
+        }
+        record(FlightEvent::Frame, 0, frame.end_, frame.index_, frame.end_ - frame.start_);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	呼び出しスレッドの名前を設定する
+     * @param	name		スレッド名
+     */
+    void setThreadName(std::string_view name) noexcept {
+        auto* ring = local();
+        if (!ring) {
+            return;
+        }
+        const auto len = std::min<size_t>(name.size(), threadNameMax - 1);
+        std::memcpy(ring->name_, name.data(), len);
+        ring->name_[len] = '\0';
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	記録の有効・無効を切り替える
+     * @param	enable		有効にする場合は true
+     */
+    void setEnabled(bool enable) noexcept {
+        enabled_.store(enable, std::memory_order_relaxed);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	クラッシュ時の出力先と時間の換算比率を保持する
+     * @param	path			出力先のファイルパス
+     * @param	nanosecPerTick	1 ティックあたりのナノ秒
+     */
+    void setCrashTarget(std::string_view path, double nanosecPerTick) noexcept {
+        const auto len = std::min(path.size(), sizeof(crashPath_) - 1);
+        std::memcpy(crashPath_, path.data(), len);
+        crashPath_[len]      = '\0';
+        crashNanosecPerTick_ = nanosecPerTick;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	setCrashTarget で保持した出力先に記録を書き出す
+     * @return	書き出しに成功した場合は true
+     */
+    bool dumpOnCrash() const noexcept {
+        if (crashPath_[0] == '\0') {
+            return false;
+        }
+        return dump(openDumpFile(crashPath_), crashNanosecPerTick_);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	記録をファイルに書き出す
+     *
+     * ヒープの確保やロック、バッファリングされた入出力を使わないので、シグナルハンドラからも呼び出せる
+     * @param	file			openDumpFile で開いたファイル（書き出し後に閉じる）
+     * @param	nanosecPerTick	1 ティックあたりのナノ秒
+     * @return	書き出しに成功した場合は true
+     */
+    bool dump(int file, double nanosecPerTick) const noexcept {
+        if (file < 0) {
+            return false;
+        }
+
+        const auto threadNum = std::min(ringNum_.load(std::memory_order_acquire), maxThreadNum);
+
+        FileHeader header{};
+        std::memcpy(header.magic_, fileMagic, sizeof(fileMagic));
+        header.version_        = fileVersion;
+        header.recordSize_     = sizeof(Record);
+        header.nanosecPerTick_ = nanosecPerTick;
+        header.dumpTime_       = profiler::now();
+        header.threadNum_      = 0;
+        header.nameNum_        = 0;
+
+        // スレッド数と名前の数は書き出した後に確定するので、ヘッダーは最後に書き直す
+        bool ok = writeAll(file, &header, sizeof(header));
+
+        // 名前テーブルは重複を除くため固定長の配列に集める（クラッシュ時にヒープを使わない）
+        static uint32_t names[maxThreadNum * 64]{};
+        uint32_t        nameNum = 0;
+
+        for (uint32_t i = 0; i < threadNum && ok; i++) {
+            const auto* ring = rings_[i].load(std::memory_order_acquire);
+            if (!ring) {
+                continue;
+            }
+
+            const auto head  = ring->head_.load(std::memory_order_acquire);
+            const auto num   = static_cast<uint32_t>(std::min<uint64_t>(head, recordNum));
+            const auto first = head - num;
+
+            ThreadHeader thread{};
+            thread.index_     = ring->index_;
+            thread.recordNum_ = num;
+            std::memcpy(thread.name_, ring->name_, threadNameMax);
+            thread.name_[threadNameMax - 1] = '\0';
+            ok = ok && writeAll(file, &thread, sizeof(thread));
+
+            // 古い順に書き出す（リングの末尾で折り返す場合は 2 回に分ける）
+            const auto start = static_cast<uint32_t>(first & recordMask);
+            const auto tail  = std::min(num, recordNum - start);
+            ok               = ok && writeAll(file, &ring->records_[start], sizeof(Record) * tail);
+            ok               = ok && writeAll(file, &ring->records_[0], sizeof(Record) * (num - tail));
+
+            for (uint32_t r = 0; r < num; r++) {
+                const auto hash = ring->records_[(first + r) & recordMask].name_;
+                if (hash == 0 || std::find(names, names + nameNum, hash) != names + nameNum) {
+                    continue;
+                }
+                if (nameNum < std::size(names)) {
+                    names[nameNum++] = hash;
+                }
+            }
+            header.threadNum_++;
+        }
+
+        for (uint32_t i = 0; i < nameNum && ok; i++) {
+            const auto str = internedName(names[i]);
+            if (str.empty()) {
+                continue;
+            }
+            NameHeader name{};
+            name.hash_   = names[i];
+            name.length_ = static_cast<uint16_t>(std::min<size_t>(str.size(), UINT16_MAX));
+            ok           = ok && writeAll(file, &name, sizeof(name));
+            ok           = ok && writeAll(file, str.data(), name.length_);
+            header.nameNum_++;
+        }
+
+        ok = ok && rewindFile(file);
+        ok = ok && writeAll(file, &header, sizeof(header));
+        ok = closeFile(file) && ok;
+        return ok;
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	呼び出しスレッドの記録先を取得する（初回のみ確保する）
+     * @return	記録先（最大スレッド数を超えた場合は nullptr ）
+     */
+    ThreadRing* local() noexcept {
+        thread_local ThreadRing* cache       = nullptr;
+        thread_local uint32_t    cacheSerial = 0;
+
+        if (cacheSerial != serial_) {
+            cacheSerial      = serial_;
+            cache            = nullptr;
+            const auto index = ringNum_.fetch_add(1, std::memory_order_relaxed);
+            if (index < maxThreadNum) {
+                cache         = new ThreadRing();
+                cache->index_ = index;
+                snprintf(cache->name_, threadNameMax, "Thread %u", index);
+                rings_[index].store(cache, std::memory_order_release);
+            }
+        }
+        return cache;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スコープ名のハッシュ値を取得する（フレームを区切るスレッドのみ、ポインタごとにキャッシュする）
+     */
+    uint32_t scopeName(const char* name) noexcept {
+        if (!name) {
+            return 0;
+        }
+        if (const auto* hash = scopeNames_.findValue(name)) {
+            return *hash;
+        }
+        const auto hash = HashedString(std::string_view(name)).hash();
+        scopeNames_.tryEmplace(name, hash);
+        return hash;
+    }
+
+private:
+    const uint32_t                                      serial_;                     ///< 識別番号
+    std::array<std::atomic<ThreadRing*>, maxThreadNum> rings_{};                     ///< スレッドごとの記録先
+    std::atomic<uint32_t>                               ringNum_{};                  ///< 割り当てたスレッド数
+    std::atomic<bool>                                   enabled_{true};              ///< 記録が有効か否か
+    FlatMap<const char*, uint32_t>                      scopeNames_{};               ///< スコープ名とハッシュ値のキャッシュ
+    char                                                crashPath_[crashPathMax]{};  ///< クラッシュ時の出力先（ハンドラ内で確保しないよう固定長で保持する）
+    double                                              crashNanosecPerTick_{};      ///< クラッシュ時に書き出す時間の換算比率（ハンドラ内でプロファイラを参照しない）
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ
+ */
+FlightRecorder::~FlightRecorder() {
+    impl_.reset();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	イベントを記録する
+ * @param	type		イベントの種類
+ * @param	name		名前
+ * @param	arg0		引数 0
+ * @param	arg1		引数 1
+ */
+void FlightRecorder::record(FlightEvent type, const HashedString& name, uint64_t arg0, uint64_t arg1) noexcept {
+    impl_->record(type, name.hash(), profiler::now(), arg0, arg1);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	プロファイラが区切ったフレームとスコープを記録する
+ * @param	frame		区切ったフレーム
+ */
+void FlightRecorder::recordFrame(const ProfileFrame& frame) noexcept {
+    impl_->recordFrame(frame);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	呼び出しスレッドの名前を設定する
+ * @param	name		スレッド名
+ */
+void FlightRecorder::setThreadName(std::string_view name) noexcept {
+    impl_->setThreadName(name);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	記録の有効・無効を切り替える
+ * @param	enable		有効にする場合は true
+ */
+void FlightRecorder::setEnabled(bool enable) noexcept {
+    impl_->setEnabled(enable);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	記録をファイルに書き出す
+ * @param	path		出力先のファイルパス
+ * @return	書き出しに成功した場合は true
+ */
+bool FlightRecorder::dump(const std::filesystem::path& path) const noexcept {
+    return impl_->dump(openDumpFile(path.c_str()), Profiler::instance().toMicrosec(1'000'000) / 1000.0);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	installCrashHandler で登録したパスに記録を書き出す
+ * @return	書き出しに成功した場合は true （登録していない場合は false ）
+ */
+bool FlightRecorder::dumpOnCrash() const noexcept {
+    return impl_->dumpOnCrash();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	アサートとクラッシュの際に記録を書き出すよう登録する
+ * @param	path		出力先のファイルパス
+ */
+void FlightRecorder::installCrashHandler(const std::filesystem::path& path) {
+    // ハンドラ内ではプロファイラを参照しないよう、時間の換算比率もここで確定しておく
+    const auto str = path.string();
+    ASSERT(str.size() < crashPathMax, "パスが長すぎます : %s", str.c_str());
+    impl_->setCrashTarget(str, Profiler::instance().toMicrosec(1'000'000) / 1000.0);
+
+    setAssertHook(dumpOnFailure);
+#if defined(_WIN32)
+    SetUnhandledExceptionFilter(unhandledExceptionFilter);
+#else
+    for (const auto sig : {SIGSEGV, SIGABRT, SIGFPE, SIGILL}) {
+        std::signal(sig, signalHandler);
+    }
+#endif
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ */
+FlightRecorder::FlightRecorder() {
+    impl_.reset(new FlightRecorder::Impl());
+}
+
+}  // namespace utility
@@ -0,0 +1,119 @@
+﻿#pragma once
+
+#include "utility/flight_record_format.h"
+#include "utility/hashed_string.h"
+#include "utility/singleton.h"
+
+namespace utility {
+
+struct ProfileFrame;
+
+using FlightEvent = flight::EventType;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フライトレコーダー
+ *
+ * スレッドごとの固定長リングバッファに、古いものから上書きしながらイベントを記録し続ける
+ * 記録はロック無しで行い、アサートやクラッシュの際に直近のイベントをバイナリファイルに書き出す
+ * 名前はハッシュ値で記録し、ダンプ時にインターンテーブルから名前を引いてファイルに含める
+ */
+class FlightRecorder final : public Singleton<FlightRecorder> {
+private:
+    friend class Singleton<FlightRecorder>;
+
+public:
+    static constexpr uint32_t recordNum    = 4096;  ///< スレッドごとのレコード数（ 2 のべき乗）
+    static constexpr uint32_t maxThreadNum = 64;    ///< 記録できる最大スレッド数
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~FlightRecorder();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	イベントを記録する
+     * @param	type		イベントの種類
+     * @param	name		名前（インターン済みであること）
+     * @param	arg0		引数 0
+     * @param	arg1		引数 1
+     */
+    void record(FlightEvent type, const HashedString& name, uint64_t arg0 = 0, uint64_t arg1 = 0) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	プロファイラが区切ったフレームとスコープを記録する
+     * @param	frame		区切ったフレーム
+     */
+    void recordFrame(const ProfileFrame& frame) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	呼び出しスレッドの名前を設定する
+     * @param	name		スレッド名（ threadNameMax - 1 文字を超える分は切り捨てる）
+     */
+    void setThreadName(std::string_view name) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	記録の有効・無効を切り替える
+     * @param	enable		有効にする場合は true
+     */
+    void setEnabled(bool enable) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	記録をファイルに書き出す
+     *
+     * 他のスレッドが記録中でも呼び出せる（書き込み途中のレコードは壊れている可能性がある）
+     * @param	path		出力先のファイルパス
+     * @return	書き出しに成功した場合は true
+     */
+    bool dump(const std::filesystem::path& path) const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	installCrashHandler で登録したパスに記録を書き出す
+     *
+     * ヒープの確保やロック、プロファイラの参照を行わないので、シグナルハンドラから呼び出せる
+     * @return	書き出しに成功した場合は true （登録していない場合は false ）
+     */
+    bool dumpOnCrash() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	アサートとクラッシュの際に記録を書き出すよう登録する
+     * @param	path		出力先のファイルパス
+     */
+    void installCrashHandler(const std::filesystem::path& path);
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    FlightRecorder();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;  ///< インプリメントクラスポインタ
+};
+
+}  // namespace utility
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フライトレコーダーにイベントを記録する
+ *
+ * 名前は文字列リテラルで指定する（コンパイル時にハッシュ化し、呼び出し箇所ごとに初回だけインターンする）
+ */
+#define FLIGHT_RECORD(type, name, ...)                                                       \
+    do {                                                                                     \
+        static constexpr utility::HashedString flightName(name);                             \
+        [[maybe_unused]] static const bool     flightInterned = (flightName.intern(), true); \
+        utility::FlightRecorder::instance().record(type, flightName, ##__VA_ARGS__);         \
+    } while (false)
@@ -0,0 +1,290 @@
+﻿#include "frame_arena.h"
+
+#include "utility/alloc_counter.h"
+
+namespace {
+constexpr size_t chunkSize      = 256 * 1024;  ///< チャンクの標準サイズ
+constexpr size_t chunkAlignment = 64;          ///< チャンクのアライメント
+
+std::atomic<uint32_t> arenaSerial{};  ///< アリーナの生成ごとに割り当てる番号
+}  // namespace
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フレームアリーナのインプリメントクラス
+ */
+class FrameArena::Impl {
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  チャンク
+     */
+    struct Chunk {
+        std::byte* data_{};  ///< 先頭アドレス
+        size_t     size_{};  ///< サイズ
+    };
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  スレッドごとのアリーナ
+     */
+    struct ThreadArena {
+        std::vector<Chunk>    chunks_{};      ///< チャンク
+        uint32_t              chunkIndex_{};  ///< 確保中のチャンク
+        size_t                offset_{};      ///< 確保中のチャンク内の位置
+        std::atomic<size_t>   used_{};        ///< このフレームで確保したサイズ（集計用に他スレッドから読む）
+        std::atomic<uint64_t> frame_{};       ///< 最後に確保したフレーム番号（集計用に他スレッドから読む）
+    };
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  標準コンテナ用のメモリリソース
+     */
+    class Resource final : public std::pmr::memory_resource {
+    public:
+        explicit Resource(Impl& impl)
+            : impl_(impl) {
+        }
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            return impl_.allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void*, size_t, size_t) override {
+            // 個別には解放しない（ reset でまとめて破棄する）
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    private:
+        Impl& impl_;
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    Impl()
+        : serial_(arenaSerial.fetch_add(1, std::memory_order_relaxed) + 1), resource_(*this) {
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~Impl() {
+        for (auto& arena : arenas_) {
+            for (auto& chunk : arena->chunks_) {
+                ::operator delete(chunk.data_, std::align_val_t{chunkAlignment});
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	メモリを確保する
+     * @param	size		確保サイズ
+     * @param	alignment	アライメント
+     * @return	確保したメモリ
+     */
+    void* allocate(size_t size, size_t alignment) {
+        auto& arena = local();
+
+        // 前のフレームの確保は破棄されているので先頭に巻き戻す
+        const auto frame = frame_.load(std::memory_order_acquire);
+        if (arena.frame_.load(std::memory_order_relaxed) != frame) {
+            arena.frame_.store(frame, std::memory_order_relaxed);
+            arena.used_.store(0, std::memory_order_relaxed);
+            arena.chunkIndex_ = 0;
+            arena.offset_     = 0;
+        }
+
+        while (true) {
+            if (arena.chunkIndex_ < arena.chunks_.size()) {
+                auto&      chunk = arena.chunks_[arena.chunkIndex_];
+                const auto head  = reinterpret_cast<uintptr_t>(chunk.data_) + arena.offset_;
+                const auto start = (head + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+                const auto end   = start + size;
+                if (end <= reinterpret_cast<uintptr_t>(chunk.data_) + chunk.size_) {
+                    arena.offset_ = end - reinterpret_cast<uintptr_t>(chunk.data_);
+                    arena.used_.store(arena.used_.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+                    return reinterpret_cast<void*>(start);
+                }
+
+                // 次のチャンクが残っていればそちらを使う
+                if (arena.chunkIndex_ + 1 < arena.chunks_.size()) {
+                    arena.chunkIndex_++;
+                    arena.offset_ = 0;
+                    continue;
+                }
+            }
+
+            // チャンクが足りないので追加する（定常状態では発生しない）
+            const auto newSize = std::max(chunkSize, size + alignment);
+            auto*      data    = static_cast<std::byte*>(::operator new(newSize, std::align_val_t{chunkAlignment}));
+            arena.chunks_.push_back({data, newSize});
+            arena.chunkIndex_ = static_cast<uint32_t>(arena.chunks_.size() - 1);
+            arena.offset_     = 0;
+            chunkNum_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームを終了し、確保したメモリをすべて破棄する
+     */
+    void reset() noexcept {
+        frame_.fetch_add(1, std::memory_order_release);
+
+        const auto allocNum = alloc::globalCount();
+        lastFrameAllocNum_  = allocNum - frameStartAllocNum_;
+        frameStartAllocNum_ = allocNum;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	現在のフレームで確保したサイズを取得する
+     */
+    size_t usedBytes() const noexcept {
+        const auto                  frame = frame_.load(std::memory_order_acquire);
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        size_t used = 0;
+        for (const auto& arena : arenas_) {
+            if (arena->frame_.load(std::memory_order_relaxed) == frame) {
+                used += arena->used_.load(std::memory_order_relaxed);
+            }
+        }
+        return used;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	確保済みのチャンク数を取得する
+     */
+    uint32_t chunkNum() const noexcept {
+        return chunkNum_.load(std::memory_order_relaxed);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	直前のフレームでのグローバルヒープの確保回数を取得する
+     */
+    uint64_t lastFrameGlobalAllocNum() const noexcept {
+        return lastFrameAllocNum_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	標準コンテナ用のメモリリソースを取得する
+     */
+    std::pmr::memory_resource* resource() noexcept {
+        return &resource_;
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	呼び出しスレッドのアリーナを取得する（初回のみ登録する）
+     */
+    ThreadArena& local() {
+        thread_local ThreadArena* cache       = nullptr;
+        thread_local uint32_t     cacheSerial = 0;
+
+        if (cacheSerial != serial_) {
+            auto arena = std::make_unique<ThreadArena>();
+            arena->frame_.store(frame_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            cache       = arena.get();
+            cacheSerial = serial_;
+            arenas_.emplace_back(std::move(arena));
+        }
+        return *cache;
+    }
+
+private:
+    const uint32_t                            serial_;                ///< アリーナの識別番号
+    std::atomic<uint64_t>                     frame_{};               ///< フレーム番号
+    std::atomic<uint32_t>                     chunkNum_{};            ///< 確保済みのチャンク数
+    mutable std::mutex                        mutex_{};               ///< スレッド登録の同期オブジェクト
+    std::vector<std::unique_ptr<ThreadArena>> arenas_{};              ///< スレッドごとのアリーナ
+    uint64_t                                  frameStartAllocNum_{};  ///< フレーム開始時のグローバルヒープ確保回数
+    uint64_t                                  lastFrameAllocNum_{};   ///< 直前のフレームのグローバルヒープ確保回数
+    Resource                                  resource_;              ///< メモリリソース
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ
+ */
+FrameArena::~FrameArena() {
+    impl_.reset();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	メモリを確保する
+ * @param	size		確保サイズ
+ * @param	alignment	アライメント
+ * @return	確保したメモリ
+ */
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    return impl_->allocate(size, alignment);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームを終了し、確保したメモリをすべて破棄する
+ */
+void FrameArena::reset() noexcept {
+    impl_->reset();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	標準コンテナ用のメモリリソースを取得する
+ */
+std::pmr::memory_resource* FrameArena::resource() noexcept {
+    return impl_->resource();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	現在のフレームで確保したサイズを取得する
+ */
+size_t FrameArena::usedBytes() const noexcept {
+    return impl_->usedBytes();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	確保済みのチャンク数を取得する（チャンクの追加はグローバルヒープを利用する）
+ */
+uint32_t FrameArena::chunkNum() const noexcept {
+    return impl_->chunkNum();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	直前のフレームでのグローバルヒープの確保回数を取得する
+ */
+uint64_t FrameArena::lastFrameGlobalAllocNum() const noexcept {
+    return impl_->lastFrameGlobalAllocNum();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ */
+FrameArena::FrameArena() {
+    impl_.reset(new FrameArena::Impl());
+}
+}  // namespace utility
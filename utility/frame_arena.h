@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include <atomic>
+#include <memory_resource>
+
+#include "utility/singleton.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フレーム単位の線形アロケータ
+ *
+ * スレッドごとにチャンクを持ち、ロック無しでポインタを進めるだけで確保する
+ * reset はフレーム番号を進めるだけで、各スレッドは次の確保時に先頭へ巻き戻す
+ * 確保したメモリは次の reset まで有効で、個別の解放やデストラクタ呼び出しは行わない
+ * reset はどのスレッドも確保していないタイミング（フレーム終端）で呼び出すこと
+ */
+class FrameArena final : public Singleton<FrameArena> {
+private:
+    friend class Singleton<FrameArena>;
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~FrameArena();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	メモリを確保する
+     * @param	size		確保サイズ
+     * @param	alignment	アライメント
+     * @return	確保したメモリ
+     */
+    [[nodiscard]] void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	オブジェクトを生成する（デストラクタは呼ばれない）
+     * @param	args		コンストラクタ引数
+     * @return	生成したオブジェクト
+     */
+    template <class T, class... Args>
+    [[nodiscard]] T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible_v<T>, "デストラクタが呼ばれないため、自明なデストラクタを持つ型のみ生成できます");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームを終了し、確保したメモリをすべて破棄する
+     */
+    void reset() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	標準コンテナ用のメモリリソースを取得する
+     */
+    [[nodiscard]] std::pmr::memory_resource* resource() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	現在のフレームで確保したサイズを取得する（確保中のスレッドがある場合は概算）
+     */
+    [[nodiscard]] size_t usedBytes() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	確保済みのチャンク数を取得する（チャンクの追加はグローバルヒープを利用する）
+     */
+    [[nodiscard]] uint32_t chunkNum() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	直前のフレームでのグローバルヒープの確保回数を取得する
+     *
+     * ENABLE_ALLOC_COUNTER 定義時のみ有効（未定義の場合は常に 0 ）
+     * 定常状態のフレームでは 0 になることを期待する
+     */
+    [[nodiscard]] uint64_t lastFrameGlobalAllocNum() const noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    FrameArena();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;  ///< インプリメントクラスポインタ
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームアリーナを利用するコンテナ
+ */
+template <class T>
+using FrameVector = std::pmr::vector<T>;
+using FrameString = std::pmr::string;
+
+}  // namespace utility
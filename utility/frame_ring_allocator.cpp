@@ -0,0 +1,75 @@
+﻿#include "frame_ring_allocator.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ * @param	capacity	管理する範囲の大きさ
+ */
+FrameRingAllocator::FrameRingAllocator(uint32_t capacity) {
+    reset(capacity);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	すべての確保を破棄して初期状態に戻す
+ * @param	capacity	管理する範囲の大きさ
+ */
+void FrameRingAllocator::reset(uint32_t capacity) noexcept {
+    frames_.clear();
+    head_     = 0;
+    tail_     = 0;
+    capacity_ = capacity;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	連続した範囲を確保する
+ * @param	num			個数
+ * @return	先頭（空きが無い場合は invalidOffset ）
+ */
+uint32_t FrameRingAllocator::allocate(uint32_t num) noexcept {
+    ASSERT(num > 0, "0 個は確保できません");
+    if (num == 0 || num > capacity_) {
+        return invalidOffset;
+    }
+
+    // 末尾に収まらない場合は残りを読み飛ばして先頭に折り返す
+    const auto position = static_cast<uint32_t>(head_ % capacity_);
+    const auto skip     = (position + num > capacity_) ? capacity_ - position : 0u;
+    if (usedNum() + skip + num > capacity_) {
+        return invalidOffset;
+    }
+
+    head_ += skip + num;
+    return skip > 0 ? 0 : position;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームを終了する
+ * @param	fenceValue	フレームのコマンドの完了時にシグナルされるフェンス値（単調増加であること）
+ */
+void FrameRingAllocator::endFrame(uint64_t fenceValue) {
+    ASSERT(frames_.empty() || frames_.back().fenceValue_ <= fenceValue, "フェンス値が単調増加になっていません");
+    frames_.push_back({head_, fenceValue});
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フェンスが完了したフレームの範囲を回収する
+ * @param	completedValue	完了済みのフェンス値
+ * @return	回収したフレームの数
+ */
+uint32_t FrameRingAllocator::reclaim(uint64_t completedValue) noexcept {
+    uint32_t count = 0;
+    while (!frames_.empty() && frames_.front().fenceValue_ <= completedValue) {
+        tail_ = frames_.front().end_;
+        frames_.pop_front();
+        count++;
+    }
+    return count;
+}
+
+}  // namespace utility
@@ -0,0 +1,108 @@
+﻿#pragma once
+
+#include <deque>
+
+#include "utility/noncopyable.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * フレーム単位で回収するリング状の範囲の割り当て
+ *
+ * [ 0, capacity ) の整数範囲を先頭から順に確保し、末尾に収まらない場合は先頭に折り返す
+ * 個別の解放は無く、 endFrame でフレームの終端にフェンス値を記録し、
+ * reclaim に完了済みのフェンス値を渡すとそのフレームまでに確保した範囲をまとめて回収する
+ *
+ * スレッドセーフではない
+ */
+class FrameRingAllocator final : Noncopyable {
+public:
+    static constexpr uint32_t invalidOffset = ~0u;  ///< 確保に失敗したことを表す値
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  回収待ちのフレーム
+     */
+    struct Frame {
+        uint64_t end_{};         ///< フレーム終了時点の確保位置（累計）
+        uint64_t fenceValue_{};  ///< 完了を待つフェンス値
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     * @param	capacity	管理する範囲の大きさ
+     */
+    explicit FrameRingAllocator(uint32_t capacity = 0);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~FrameRingAllocator() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	すべての確保を破棄して初期状態に戻す
+     * @param	capacity	管理する範囲の大きさ
+     */
+    void reset(uint32_t capacity) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	連続した範囲を確保する
+     * @param	num			個数
+     * @return	先頭（空きが無い場合は invalidOffset ）
+     */
+    [[nodiscard]] uint32_t allocate(uint32_t num) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームを終了する
+     * @param	fenceValue	フレームのコマンドの完了時にシグナルされるフェンス値（単調増加であること）
+     */
+    void endFrame(uint64_t fenceValue);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フェンスが完了したフレームの範囲を回収する
+     * @param	completedValue	完了済みのフェンス値
+     * @return	回収したフレームの数
+     */
+    uint32_t reclaim(uint64_t completedValue) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	管理する範囲の大きさを取得する
+     */
+    [[nodiscard]] uint32_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	回収されていない個数を取得する（折り返しで読み飛ばした末尾を含む）
+     */
+    [[nodiscard]] uint32_t usedNum() const noexcept {
+        return static_cast<uint32_t>(head_ - tail_);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	回収待ちのフレーム数を取得する
+     */
+    [[nodiscard]] uint32_t pendingFrameNum() const noexcept {
+        return static_cast<uint32_t>(frames_.size());
+    }
+
+private:
+    std::deque<Frame> frames_{};    ///< 回収待ちのフレーム（フェンス値の順）
+    uint64_t          head_{};      ///< 次の確保位置（累計）
+    uint64_t          tail_{};      ///< 回収済みの位置（累計）
+    uint32_t          capacity_{};  ///< 管理する範囲の大きさ
+};
+}  // namespace utility
@@ -0,0 +1,150 @@
+﻿#include "hash.h"
+
+#include "utility/cpu_feature.h"
+
+namespace {
+using namespace utility::detail::hash;
+
+using BlockFunc = void (*)(uint64_t (&acc)[laneNum], const char* p, size_t blockNum);
+
+#if defined(UTILITY_X64)
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ブロック単位で蓄積とスクランブルを行う（ SSE2 版）
+ *
+ * 2 レーンずつ処理する。 _mm_mul_epu32 が各レーンの下位 32 ビット同士を掛けるので、
+ * 上位 32 ビットを下位へ移した値と掛けてスカラー版の (k & 0xffffffff) * (k >> 32) と一致させる
+ */
+void accumulateBlocksSse2(uint64_t (&acc)[laneNum], const char* p, size_t blockNum) noexcept {
+    __m128i a[laneNum / 2];
+    for (size_t i = 0; i < laneNum / 2; i++) {
+        a[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + i);
+    }
+
+    const auto* key   = reinterpret_cast<const char*>(secret.data());
+    const auto  prime = _mm_set1_epi32(static_cast<int>(prime3));
+
+    for (size_t b = 0; b < blockNum; b++) {
+        for (size_t s = 0; s < stripesPerBlock; s++) {
+            const auto* stripe = p + b * blockSize + s * stripeSize;
+            for (size_t i = 0; i < laneNum / 2; i++) {
+                const auto v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stripe) + i);
+                const auto k  = _mm_xor_si128(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + s * 8) + i));
+                const auto m  = _mm_mul_epu32(k, _mm_shuffle_epi32(k, _MM_SHUFFLE(2, 3, 0, 1)));
+                const auto sw = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+                a[i]          = _mm_add_epi64(a[i], _mm_add_epi64(m, sw));
+            }
+        }
+
+        for (size_t i = 0; i < laneNum / 2; i++) {
+            auto x = _mm_xor_si128(a[i], _mm_srli_epi64(a[i], 47));
+            x      = _mm_xor_si128(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + scrambleKey * 8) + i));
+            // 64 ビット x 32 ビットの積を下位と上位に分けて求める
+            const auto lo = _mm_mul_epu32(x, prime);
+            const auto hi = _mm_mul_epu32(_mm_srli_epi64(x, 32), prime);
+            a[i]          = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+        }
+    }
+
+    for (size_t i = 0; i < laneNum / 2; i++) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + i, a[i]);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ブロック単位で蓄積とスクランブルを行う（ AVX2 版）
+ */
+TARGET_AVX2 void accumulateBlocksAvx2(uint64_t (&acc)[laneNum], const char* p, size_t blockNum) noexcept {
+    __m256i a[laneNum / 4];
+    for (size_t i = 0; i < laneNum / 4; i++) {
+        a[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + i);
+    }
+
+    const auto* key   = reinterpret_cast<const char*>(secret.data());
+    const auto  prime = _mm256_set1_epi32(static_cast<int>(prime3));
+
+    for (size_t b = 0; b < blockNum; b++) {
+        for (size_t s = 0; s < stripesPerBlock; s++) {
+            const auto* stripe = p + b * blockSize + s * stripeSize;
+            for (size_t i = 0; i < laneNum / 4; i++) {
+                const auto v  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stripe) + i);
+                const auto k  = _mm256_xor_si256(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + s * 8) + i));
+                const auto m  = _mm256_mul_epu32(k, _mm256_shuffle_epi32(k, _MM_SHUFFLE(2, 3, 0, 1)));
+                const auto sw = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+                a[i]          = _mm256_add_epi64(a[i], _mm256_add_epi64(m, sw));
+            }
+        }
+
+        for (size_t i = 0; i < laneNum / 4; i++) {
+            auto x        = _mm256_xor_si256(a[i], _mm256_srli_epi64(a[i], 47));
+            x             = _mm256_xor_si256(x, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + scrambleKey * 8) + i));
+            const auto lo = _mm256_mul_epu32(x, prime);
+            const auto hi = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), prime);
+            a[i]          = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+        }
+    }
+
+    for (size_t i = 0; i < laneNum / 4; i++) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + i, a[i]);
+    }
+}
+#endif
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	CPU に応じたブロック処理を取得する
+ */
+BlockFunc blockFunc() noexcept {
+#if defined(UTILITY_X64)
+    static const BlockFunc func = utility::cpuFeature().avx2_ ? accumulateBlocksAvx2 : accumulateBlocksSse2;
+    return func;
+#else
+    return accumulateBlocks;
+#endif
+}
+}  // namespace
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	64 ビットハッシュを計算する
+ * @param	data		データの先頭アドレス
+ * @param	size		データのサイズ
+ * @param	seed		シード
+ * @return	ハッシュ
+ */
+uint64_t hash64(const void* data, size_t size, uint64_t seed) noexcept {
+    const auto* p = static_cast<const char*>(data);
+    if (size <= shortMaxSize) {
+        return hashShort(p, size, seed);
+    }
+
+    uint64_t acc[laneNum]{};
+    initAccumulator(acc, seed);
+    accumulateLong(acc, p, size, blockFunc());
+    return merge(acc, size * prime2 + seed, 3);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	128 ビットハッシュを計算する
+ * @param	data		データの先頭アドレス
+ * @param	size		データのサイズ
+ * @param	seed		シード
+ * @return	ハッシュ
+ */
+Hash128 hash128(const void* data, size_t size, uint64_t seed) noexcept {
+    const auto* p = static_cast<const char*>(data);
+    if (size <= shortMaxSize) {
+        return {hashShort(p, size, seed), hashShort(p, size, seed ^ prime2)};
+    }
+
+    uint64_t acc[laneNum]{};
+    initAccumulator(acc, seed);
+    accumulateLong(acc, p, size, blockFunc());
+    return {merge(acc, size * prime2 + seed, 3), merge(acc, ~(size * prime0) - seed, 11)};
+}
+
+}  // namespace utility
@@ -0,0 +1,363 @@
+﻿#pragma once
+
+#include <cstring>
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 128 ビットハッシュ
+ */
+struct Hash128 {
+    uint64_t low_{};   ///< 下位 64 ビット
+    uint64_t high_{};  ///< 上位 64 ビット
+
+    constexpr bool operator==(const Hash128&) const noexcept = default;
+};
+
+namespace detail::hash {
+
+constexpr uint64_t prime0 = 0xa0761d6478bd642full;  ///< 混合用の定数
+constexpr uint64_t prime1 = 0xe7037ed1a0b428dbull;  ///< 混合用の定数
+constexpr uint64_t prime2 = 0x8ebc6af09c88c6e3ull;  ///< 混合用の定数
+constexpr uint32_t prime3 = 0x9e3779b1u;            ///< スクランブル用の定数
+
+constexpr size_t laneNum         = 8;                             ///< アキュムレータのレーン数
+constexpr size_t stripeSize      = laneNum * 8;                   ///< 1 回の蓄積で読むサイズ
+constexpr size_t stripesPerBlock = 16;                            ///< スクランブルまでの蓄積回数
+constexpr size_t blockSize       = stripeSize * stripesPerBlock;  ///< スクランブル単位のサイズ
+constexpr size_t lastStripeKey   = 11;                            ///< 最後のストライプで使う鍵の位置
+constexpr size_t scrambleKey     = stripesPerBlock;               ///< スクランブルで使う鍵の位置
+constexpr size_t shortMaxSize    = 128;                           ///< 短い入力として扱う最大サイズ
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	鍵を生成する（ splitmix64 ）
+ */
+constexpr std::array<uint64_t, stripesPerBlock + laneNum> makeSecret() noexcept {
+    std::array<uint64_t, stripesPerBlock + laneNum> secret{};
+    uint64_t                                        x = 0x2545f4914f6cdd1dull;
+    for (auto& s : secret) {
+        x += 0x9e3779b97f4a7c15ull;
+        auto z = x;
+        z      = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z      = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        s      = z ^ (z >> 31);
+    }
+    return secret;
+}
+
+inline constexpr auto secret = makeSecret();  ///< 鍵（ SIMD 版と共有する）
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	64 ビット同士の積を 128 ビットで求め、上位と下位を返す
+ */
+constexpr void mum(uint64_t& a, uint64_t& b) noexcept {
+    if (!std::is_constant_evaluated()) {
+#if defined(_MSC_VER) && defined(_M_X64)
+        a = _umul128(a, b, &b);
+        return;
+#elif defined(__SIZEOF_INT128__)
+        const auto r = static_cast<unsigned __int128>(a) * b;
+        a            = static_cast<uint64_t>(r);
+        b            = static_cast<uint64_t>(r >> 64);
+        return;
+#endif
+    }
+
+    const uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+    const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64_t t  = rl + (rm0 << 32);
+    const uint64_t lo = t + (rm1 << 32);
+    const uint64_t c  = (t < rl) + (lo < t);
+    a                 = lo;
+    b                 = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	64 ビット同士の積の上位と下位を合成する
+ */
+constexpr uint64_t mix(uint64_t a, uint64_t b) noexcept {
+    mum(a, b);
+    return a ^ b;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	リトルエンディアンで読み込む
+ */
+template <class T>
+constexpr T read(const char* p) noexcept {
+    if (std::is_constant_evaluated()) {
+        T v = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            v |= static_cast<T>(static_cast<uint8_t>(p[i])) << (i * 8);
+        }
+        return v;
+    }
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+constexpr uint64_t read64(const char* p) noexcept {
+    return read<uint64_t>(p);
+}
+constexpr uint64_t read32(const char* p) noexcept {
+    return read<uint32_t>(p);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	1 ストライプを蓄積する
+ * @param	acc			アキュムレータ
+ * @param	p			ストライプの先頭
+ * @param	key			鍵の位置
+ */
+constexpr void accumulate(uint64_t (&acc)[laneNum], const char* p, size_t key) noexcept {
+    for (size_t i = 0; i < laneNum; i++) {
+        const auto v = read64(p + i * 8);
+        const auto k = v ^ secret[key + i];
+        acc[i ^ 1] += v;
+        acc[i] += (k & 0xffffffffull) * (k >> 32);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	アキュムレータをかき混ぜる
+ */
+constexpr void scramble(uint64_t (&acc)[laneNum]) noexcept {
+    for (size_t i = 0; i < laneNum; i++) {
+        auto a = acc[i];
+        a ^= a >> 47;
+        a ^= secret[scrambleKey + i];
+        acc[i] = a * prime3;
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	アキュムレータの初期値を設定する
+ */
+constexpr void initAccumulator(uint64_t (&acc)[laneNum], uint64_t seed) noexcept {
+    for (size_t i = 0; i < laneNum; i++) {
+        acc[i] = secret[i] + ((i & 1) ? ~seed : seed);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	アキュムレータを 64 ビットにまとめる
+ * @param	acc			アキュムレータ
+ * @param	start		初期値
+ * @param	key			鍵の位置
+ */
+constexpr uint64_t merge(const uint64_t (&acc)[laneNum], uint64_t start, size_t key) noexcept {
+    auto result = start;
+    for (size_t i = 0; i < laneNum; i += 2) {
+        result += mix(acc[i] ^ secret[key + i], acc[i + 1] ^ secret[key + i + 1]);
+    }
+    result ^= result >> 37;
+    result *= 0x165667919e3779f9ull;
+    return result ^ (result >> 32);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	長い入力を蓄積する（ shortMaxSize を超える入力）
+ * @param	acc			アキュムレータ
+ * @param	p			データの先頭
+ * @param	size		データのサイズ
+ * @param	block		ブロック単位で蓄積とスクランブルを行う関数
+ */
+template <class BlockFunc>
+constexpr void accumulateLong(uint64_t (&acc)[laneNum], const char* p, size_t size, BlockFunc&& block) noexcept {
+    // 最後のストライプを必ず残すため、 size - 1 までをブロック単位で処理する
+    const auto blockNum = (size - 1) / blockSize;
+    block(acc, p, blockNum);
+
+    const auto tail      = p + blockNum * blockSize;
+    const auto stripeNum = ((size - 1) - blockNum * blockSize) / stripeSize;
+    for (size_t s = 0; s < stripeNum; s++) {
+        accumulate(acc, tail + s * stripeSize, s);
+    }
+    accumulate(acc, p + size - stripeSize, lastStripeKey);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ブロック単位で蓄積とスクランブルを行う（スカラー版）
+ */
+constexpr void accumulateBlocks(uint64_t (&acc)[laneNum], const char* p, size_t blockNum) noexcept {
+    for (size_t b = 0; b < blockNum; b++) {
+        for (size_t s = 0; s < stripesPerBlock; s++) {
+            accumulate(acc, p + b * blockSize + s * stripeSize, s);
+        }
+        scramble(acc);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	短い入力をハッシュ化する（ shortMaxSize 以下の入力）
+ */
+constexpr uint64_t hashShort(const char* p, size_t size, uint64_t seed) noexcept {
+    seed ^= mix(seed ^ prime0, prime1);
+
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (size <= 16) {
+        if (size >= 4) {
+            const auto shift = (size >> 3) << 2;
+            a                = (read32(p) << 32) | read32(p + shift);
+            b                = (read32(p + size - 4) << 32) | read32(p + size - 4 - shift);
+        } else if (size > 0) {
+            a = (static_cast<uint64_t>(static_cast<uint8_t>(p[0])) << 16) |
+                (static_cast<uint64_t>(static_cast<uint8_t>(p[size >> 1])) << 8) | static_cast<uint8_t>(p[size - 1]);
+        }
+    } else {
+        auto rest = size;
+        auto q    = p;
+        while (rest > 16) {
+            seed = mix(read64(q) ^ prime1, read64(q + 8) ^ seed);
+            q += 16;
+            rest -= 16;
+        }
+        a = read64(p + size - 16);
+        b = read64(p + size - 8);
+    }
+
+    a ^= prime1;
+    b ^= seed;
+    mum(a, b);
+    return mix(a ^ prime0 ^ size, b ^ prime1);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	64 ビットハッシュを計算する（スカラー版）
+ */
+constexpr uint64_t hash64(const char* p, size_t size, uint64_t seed) noexcept {
+    if (size <= shortMaxSize) {
+        return hashShort(p, size, seed);
+    }
+
+    uint64_t acc[laneNum]{};
+    initAccumulator(acc, seed);
+    accumulateLong(acc, p, size, accumulateBlocks);
+    return merge(acc, size * prime2 + seed, 3);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	128 ビットハッシュを計算する（スカラー版）
+ */
+constexpr Hash128 hash128(const char* p, size_t size, uint64_t seed) noexcept {
+    if (size <= shortMaxSize) {
+        return {hashShort(p, size, seed), hashShort(p, size, seed ^ prime2)};
+    }
+
+    uint64_t acc[laneNum]{};
+    initAccumulator(acc, seed);
+    accumulateLong(acc, p, size, accumulateBlocks);
+    return {merge(acc, size * prime2 + seed, 3), merge(acc, ~(size * prime0) - seed, 11)};
+}
+
+}  // namespace detail::hash
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	64 ビットハッシュを計算する
+ *
+ * 長い入力は CPU に応じて SSE2 / AVX2 で蓄積する（結果はスカラー版と一致する）
+ * @param	data		データの先頭アドレス
+ * @param	size		データのサイズ
+ * @param	seed		シード
+ * @return	ハッシュ
+ */
+[[nodiscard]] uint64_t hash64(const void* data, size_t size, uint64_t seed = 0) noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	128 ビットハッシュを計算する
+ * @param	data		データの先頭アドレス
+ * @param	size		データのサイズ
+ * @param	seed		シード
+ * @return	ハッシュ
+ */
+[[nodiscard]] Hash128 hash128(const void* data, size_t size, uint64_t seed = 0) noexcept;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	文字列を 64 ビットハッシュ化する（コンパイル時にも計算できる）
+ * @param	str			文字列（終端文字は含めない）
+ * @param	seed		シード
+ * @return	ハッシュ
+ */
+[[nodiscard]] constexpr uint64_t hash64(std::string_view str, uint64_t seed = 0) noexcept {
+    if (std::is_constant_evaluated()) {
+        return detail::hash::hash64(str.data(), str.size(), seed);
+    }
+    return hash64(static_cast<const void*>(str.data()), str.size(), seed);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	文字列を 128 ビットハッシュ化する（コンパイル時にも計算できる）
+ * @param	str			文字列（終端文字は含めない）
+ * @param	seed		シード
+ * @return	ハッシュ
+ */
+[[nodiscard]] constexpr Hash128 hash128(std::string_view str, uint64_t seed = 0) noexcept {
+    if (std::is_constant_evaluated()) {
+        return detail::hash::hash128(str.data(), str.size(), seed);
+    }
+    return hash128(static_cast<const void*>(str.data()), str.size(), seed);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ハッシュを合成する
+ * @param	seed		合成元のハッシュ
+ * @param	value		合成するハッシュ
+ * @return	合成したハッシュ
+ */
+[[nodiscard]] constexpr uint64_t hashCombine(uint64_t seed, uint64_t value) noexcept {
+    return detail::hash::mix(seed ^ detail::hash::prime0, value ^ detail::hash::prime1);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	POD 構造体をメモリイメージでハッシュ化する
+ *
+ * パディングもそのままハッシュ化するため、パディングを含む型は値初期化（ {} ）してから値を設定すること
+ * @param	value		ハッシュ化する値
+ * @param	seed		シード
+ * @return	ハッシュ
+ */
+template <class T>
+[[nodiscard]] uint64_t hashPod(const T& value, uint64_t seed = 0) noexcept {
+    static_assert(std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>, "メモリイメージでハッシュ化できる型ではありません");
+    return hash64(static_cast<const void*>(&value), sizeof(T), seed);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	テンプレートパラメータで計算済みの 64 ビットハッシュを取得する
+ */
+template <uint64_t v>
+constexpr uint64_t getHash64() noexcept {
+    return v;
+}
+
+}  // namespace utility
+
+#define TO_HASH64(key) utility::getHash64<utility::hash64(std::string_view(key))>()
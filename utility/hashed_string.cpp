@@ -0,0 +1,139 @@
+﻿#include "hashed_string.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace {
+constexpr uint32_t tableCapacity = 8192;        ///< インターンテーブルのスロット数（ 2 のべき乗）
+constexpr uint64_t usedBit       = 1ull << 32;  ///< スロット使用中を表すビット（ハッシュ値 0 と空きを区別する）
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * インターンテーブルのスロット
+ */
+struct Slot {
+    std::atomic<uint64_t>    key_{};   ///< usedBit | ハッシュ値（ 0 は空き）
+    std::atomic<const char*> name_{};  ///< 名前（キーの確保後に設定される）
+};
+
+Slot table[tableCapacity]{};  ///< インターンテーブル（開番地法、削除はしない）
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	スロットの名前が設定されるまで待つ（キーを確保したスレッドが書き込み中の場合のみ待つ）
+ */
+const char* waitName(const Slot& slot) noexcept {
+    auto* name = slot.name_.load(std::memory_order_acquire);
+    while (!name) {
+        std::this_thread::yield();
+        name = slot.name_.load(std::memory_order_acquire);
+    }
+    return name;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	名前の複製を作成する（インターンテーブルはプロセス終了まで保持するので解放しない）
+ */
+const char* duplicate(std::string_view str) noexcept {
+    auto* copy = new char[str.size() + 1];
+    std::memcpy(copy, str.data(), str.size());
+    copy[str.size()] = '\0';
+    return copy;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	名前を登録する
+ * @param	hash		ハッシュ値
+ * @param	str			名前
+ * @param	isStatic	名前がプロセス終了まで有効か否か（ false の場合は複製して登録する）
+ * @return	テーブル内の名前
+ */
+const char* insert(uint32_t hash, std::string_view str, bool isStatic) noexcept {
+    const auto key = usedBit | hash;
+
+    for (uint32_t i = 0; i < tableCapacity; i++) {
+        auto& slot     = table[(hash + i) & (tableCapacity - 1)];
+        auto  expected = slot.key_.load(std::memory_order_acquire);
+
+        if (expected == 0) {
+            if (slot.key_.compare_exchange_strong(expected, key, std::memory_order_acq_rel)) {
+                auto* name = isStatic ? str.data() : duplicate(str);
+                slot.name_.store(name, std::memory_order_release);
+                return name;
+            }
+            // 他のスレッドが先に確保したスロットを調べ直す
+        }
+
+        if (expected == key) {
+            auto* name = waitName(slot);
+            ASSERT(str == name, "ハッシュ値が衝突しています : %s と %s ( 0x%08x )", name, std::string(str).c_str(), hash);
+            return name;
+        }
+    }
+
+    ASSERT(false, "インターンテーブルが一杯です : %s", std::string(str).c_str());
+    return nullptr;
+}
+}  // namespace
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	実行時の文字列から生成する（名前をインターンテーブルに登録する）
+ * @param	str			文字列
+ */
+HashedString::HashedString(std::string_view str) noexcept
+    : hash_(stringToHash(str)) {
+    name_ = insert(hash_, str, false);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	名前を取得する（不明な場合は空文字列）
+ */
+std::string_view HashedString::name() const noexcept {
+    if (name_) {
+        return name_;
+    }
+    return internedName(hash_);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	インターンテーブルに名前を登録する
+ */
+void HashedString::intern() const noexcept {
+    if (name_) {
+        // 文字列リテラル、またはインターン済みの文字列なので複製せずに登録する
+        insert(hash_, name_, true);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	インターンテーブルからハッシュ値に対応する名前を取得する
+ * @param	hash		ハッシュ値
+ * @return	名前（登録されていない場合は空文字列）
+ */
+std::string_view internedName(uint32_t hash) noexcept {
+    const auto key = usedBit | hash;
+
+    for (uint32_t i = 0; i < tableCapacity; i++) {
+        const auto& slot = table[(hash + i) & (tableCapacity - 1)];
+        const auto  k    = slot.key_.load(std::memory_order_acquire);
+        if (k == 0) {
+            break;
+        }
+        if (k == key) {
+            return waitName(slot);
+        }
+    }
+    return {};
+}
+
+}  // namespace utility
@@ -0,0 +1,103 @@
+﻿#pragma once
+
+#include "utility/crc32.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ハッシュ化済みの文字列
+ *
+ * 比較はハッシュ値のみで行い、名前はデバッグ表示やプロファイル用に保持する
+ * 文字列リテラルからはコンパイル時にハッシュを計算する（ TO_HASH と同じ値になる）
+ * 実行時の文字列から生成した場合は名前をインターンテーブルに登録する
+ */
+class HashedString final {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    constexpr HashedString() noexcept = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	文字列リテラルから生成する（コンパイル時にハッシュ化する）
+     * @param	str			文字列リテラル
+     */
+    template <size_t size>
+    consteval HashedString(const char (&str)[size]) noexcept
+        : hash_(stringToHashT(str)), name_(str) {
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	実行時の文字列から生成する（名前をインターンテーブルに登録する）
+     * @param	str			文字列
+     */
+    explicit HashedString(std::string_view str) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ハッシュ値のみから生成する（インターンテーブルに登録済みであれば名前を引ける）
+     * @param	hash		ハッシュ値
+     */
+    [[nodiscard]] static constexpr HashedString fromHash(uint32_t hash) noexcept {
+        HashedString s;
+        s.hash_ = hash;
+        return s;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ハッシュ値を取得する
+     */
+    [[nodiscard]] constexpr uint32_t hash() const noexcept {
+        return hash_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	名前を取得する（不明な場合は空文字列）
+     */
+    [[nodiscard]] std::string_view name() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	インターンテーブルに名前を登録する
+     *
+     * 同じハッシュ値に異なる名前が登録済みの場合はアサートする
+     * 名前を持たない（ fromHash で生成した）場合は何もしない
+     */
+    void intern() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	比較する（ハッシュ値のみを比較する）
+     */
+    [[nodiscard]] constexpr bool operator==(const HashedString& other) const noexcept {
+        return hash_ == other.hash_;
+    }
+
+private:
+    uint32_t    hash_{};  ///< ハッシュ値
+    const char* name_{};  ///< 名前（文字列リテラルまたはインターンテーブル内の文字列）
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	インターンテーブルからハッシュ値に対応する名前を取得する
+ * @param	hash		ハッシュ値
+ * @return	名前（登録されていない場合は空文字列）
+ */
+[[nodiscard]] std::string_view internedName(uint32_t hash) noexcept;
+
+}  // namespace utility
+
+template <>
+struct std::hash<utility::HashedString> {
+    size_t operator()(const utility::HashedString& s) const noexcept {
+        return s.hash();
+    }
+};
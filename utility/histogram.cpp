@@ -0,0 +1,182 @@
+﻿#include "histogram.h"
+
+#include <bit>
+#include <cmath>
+
+namespace {
+constexpr uint64_t maxValue = (1ull << utility::Histogram::valueBits) - 1;  ///< 記録できる最大値
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	最小値を更新する
+ */
+void updateMin(std::atomic<uint64_t>& target, uint64_t value) noexcept {
+    auto current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	最大値を更新する
+ */
+void updateMax(std::atomic<uint64_t>& target, uint64_t value) noexcept {
+    auto current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+}  // namespace
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ */
+Histogram::Histogram() noexcept {
+    reset();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	値を記録する
+ * @param	value		値
+ */
+void Histogram::record(uint64_t value) noexcept {
+    value = std::min(value, maxValue);
+
+    // 統計の取得側はバケットを母数にするので、最小・最大値を先に更新する
+    auto& counts = counts_[active_.load(std::memory_order_acquire)];
+    updateMin(counts.min_, value);
+    updateMax(counts.max_, value);
+    counts.sum_.fetch_add(value, std::memory_order_relaxed);
+    counts.buckets_[toBucket(value)].fetch_add(1, std::memory_order_release);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ウィンドウを閉じて新しいウィンドウの記録を開始する
+ *
+ * 切り替え直前に古いインデックスを読んだ記録は閉じたウィンドウに入る
+ */
+void Histogram::rotate() noexcept {
+    const auto next = 1 - active_.load(std::memory_order_relaxed);
+    clear(counts_[next]);
+    active_.store(next, std::memory_order_release);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	すべてのウィンドウを空にする
+ */
+void Histogram::reset() noexcept {
+    for (auto& counts : counts_) {
+        clear(counts);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	統計値を取得する
+ * @param	window		対象のウィンドウ
+ * @return	統計値
+ */
+HistogramStats Histogram::stats(Window window) const noexcept {
+    const auto  active = active_.load(std::memory_order_acquire);
+    const auto& counts = counts_[(window == Window::Current) ? active : 1 - active];
+
+    // 記録中でも読めるように、バケットを集計した数を母数にする
+    std::array<uint64_t, bucketNum> buckets{};
+    uint64_t                        total = 0;
+    for (uint32_t i = 0; i < bucketNum; i++) {
+        buckets[i] = counts.buckets_[i].load(std::memory_order_acquire);
+        total += buckets[i];
+    }
+
+    HistogramStats result{};
+    if (total == 0) {
+        return result;
+    }
+
+    result.count_ = total;
+    result.min_   = static_cast<double>(counts.min_.load(std::memory_order_relaxed));
+    result.max_   = static_cast<double>(counts.max_.load(std::memory_order_relaxed));
+    result.mean_  = static_cast<double>(counts.sum_.load(std::memory_order_relaxed)) / static_cast<double>(total);
+
+    // 各パーセンタイルを 1 回の走査で求める（値はバケットの中央値を最小・最大値の範囲に収めたもの）
+    const std::array<std::pair<double, double*>, 4> targets{{
+        {0.5, &result.p50_},
+        {0.9, &result.p90_},
+        {0.99, &result.p99_},
+        {0.999, &result.p999_},
+    }};
+
+    size_t   target     = 0;
+    uint64_t cumulative = 0;
+    for (uint32_t i = 0; i < bucketNum && target < targets.size(); i++) {
+        cumulative += buckets[i];
+        while (target < targets.size() && static_cast<double>(cumulative) >= std::ceil(targets[target].first * static_cast<double>(total))) {
+            const auto mid          = (static_cast<double>(bucketLow(i)) + static_cast<double>(bucketHigh(i))) * 0.5;
+            *targets[target].second = std::clamp(mid, result.min_, result.max_);
+            target++;
+        }
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	値をバケットのインデックスに変換する
+ *
+ * subBucketNum 未満はそのまま、それ以上は上位 subBucketBits + 1 ビットと桁数で決める
+ */
+uint32_t Histogram::toBucket(uint64_t value) noexcept {
+    value = std::min(value, maxValue);
+    if (value < subBucketNum) {
+        return static_cast<uint32_t>(value);
+    }
+    const auto shift = static_cast<uint32_t>(std::bit_width(value)) - 1 - subBucketBits;
+    const auto sub   = static_cast<uint32_t>(value >> shift) - subBucketNum;
+    return (shift + 1) * subBucketNum + sub;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	バケットに含まれる最小値を取得する
+ */
+uint64_t Histogram::bucketLow(uint32_t index) noexcept {
+    if (index < subBucketNum) {
+        return index;
+    }
+    const auto shift = index / subBucketNum - 1;
+    const auto sub   = static_cast<uint64_t>(index % subBucketNum + subBucketNum);
+    return sub << shift;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	バケットに含まれる最大値を取得する
+ */
+uint64_t Histogram::bucketHigh(uint32_t index) noexcept {
+    if (index < subBucketNum) {
+        return index;
+    }
+    const auto shift = index / subBucketNum - 1;
+    const auto sub   = static_cast<uint64_t>(index % subBucketNum + subBucketNum);
+    return ((sub + 1) << shift) - 1;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ウィンドウを空にする
+ */
+void Histogram::clear(Counts& counts) noexcept {
+    for (auto& bucket : counts.buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    counts.sum_.store(0, std::memory_order_relaxed);
+    counts.min_.store(UINT64_MAX, std::memory_order_relaxed);
+    counts.max_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace utility
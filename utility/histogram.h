@@ -0,0 +1,127 @@
+﻿#pragma once
+
+#include <atomic>
+
+#include "utility/noncopyable.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ヒストグラムの統計値
+ */
+struct HistogramStats {
+    uint64_t count_{};  ///< サンプル数
+    double   min_{};    ///< 最小値
+    double   max_{};    ///< 最大値
+    double   mean_{};   ///< 平均値
+    double   p50_{};    ///< 50 パーセンタイル
+    double   p90_{};    ///< 90 パーセンタイル
+    double   p99_{};    ///< 99 パーセンタイル
+    double   p999_{};   ///< 99.9 パーセンタイル
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 対数線形（ HDR 形式）のヒストグラム
+ *
+ * 2 のべき乗ごとの区間を subBucketNum 個に等分したバケットに記録する（相対誤差は 1 / subBucketNum 以下）
+ * 記録はロック無しで複数スレッドから同時に行える
+ * 現在のウィンドウと直前のウィンドウを持ち、 rotate で切り替える
+ */
+class Histogram final : Noncopyable {
+public:
+    static constexpr uint32_t subBucketBits = 6;                                               ///< 区間内の分割数のビット数
+    static constexpr uint32_t subBucketNum  = 1u << subBucketBits;                             ///< 区間内の分割数
+    static constexpr uint32_t valueBits     = 40;                                              ///< 記録できる値のビット数（超えた値は最大値に丸める）
+    static constexpr uint32_t bucketNum     = (valueBits - subBucketBits + 1) * subBucketNum;  ///< バケット数
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	統計を取るウィンドウ
+     */
+    enum class Window : uint8_t {
+        Current,   ///< 記録中のウィンドウ
+        Previous,  ///< 直前に閉じたウィンドウ
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    Histogram() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	値を記録する
+     * @param	value		値
+     */
+    void record(uint64_t value) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ウィンドウを閉じて新しいウィンドウの記録を開始する
+     *
+     * 呼び出しは 1 つのスレッドから行うこと（記録は並行して行える）
+     */
+    void rotate() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	すべてのウィンドウを空にする
+     */
+    void reset() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	統計値を取得する
+     * @param	window		対象のウィンドウ
+     * @return	統計値（サンプルが無い場合は count_ が 0 ）
+     */
+    [[nodiscard]] HistogramStats stats(Window window = Window::Previous) const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	値をバケットのインデックスに変換する
+     */
+    [[nodiscard]] static uint32_t toBucket(uint64_t value) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	バケットに含まれる最小値を取得する
+     */
+    [[nodiscard]] static uint64_t bucketLow(uint32_t index) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	バケットに含まれる最大値を取得する
+     */
+    [[nodiscard]] static uint64_t bucketHigh(uint32_t index) noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  ウィンドウごとの記録
+     */
+    struct Counts {
+        std::array<std::atomic<uint64_t>, bucketNum> buckets_{};  ///< バケットごとのサンプル数
+        std::atomic<uint64_t>                         sum_{};      ///< 値の合計
+        std::atomic<uint64_t>                         min_{};      ///< 最小値
+        std::atomic<uint64_t>                         max_{};      ///< 最大値
+    };
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ウィンドウを空にする
+     */
+    static void clear(Counts& counts) noexcept;
+
+private:
+    std::array<Counts, 2> counts_{};  ///< 記録（現在と直前のウィンドウ）
+    std::atomic<uint32_t> active_{};  ///< 記録中のウィンドウのインデックス
+};
+
+}  // namespace utility
@@ -0,0 +1,516 @@
+﻿#include "job_system.h"
+#include "utility/flight_recorder.h"
+#include "utility/profiler.h"
+#include "utility/ring_buffer.h"
+#include "utility/thread.h"
+#include "utility/work_steal_queue.h"
+
+#include <condition_variable>
+
+namespace {
+constexpr uint32_t queueCapacity   = 4096;  ///< ワーカーごとのキュー容量
+constexpr uint32_t freeJobCapacity = 4096;  ///< 再利用のために保持するジョブ数
+
+thread_local int32_t currentWorkerIndex = -1;  ///< 現在のスレッドのワーカーインデックス
+}  // namespace
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ジョブシステムのインプリメントクラス
+ */
+class JobSystem::Impl {
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  ジョブ情報
+     */
+    struct Job {
+        JobFunc     func_{};     ///< ジョブの処理
+        JobCounter* counter_{};  ///< 完了を通知するカウンタ
+    };
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  ワーカー情報
+     */
+    struct Worker {
+        Impl*                               owner_{};   ///< 所属するジョブシステム
+        int32_t                             index_{};   ///< ワーカーインデックス
+        WorkStealQueue<Job*, queueCapacity> queue_{};   ///< ワーカー専用キュー
+        Thread                              thread_{};  ///< ワーカースレッド
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    Impl() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~Impl() {
+        stop();
+
+        Job* job = nullptr;
+        while (freeJobs_.pop(job)) {
+            delete job;
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ワーカースレッドを開始する
+     * @param	workerNum	ワーカー数（ 0 の場合は論理コア数 - 1 ）
+     */
+    void start(uint32_t workerNum) {
+        ASSERT(workers_.empty(), "すでにジョブシステムが開始しています");
+
+        if (workerNum == 0) {
+            const auto hardware = std::thread::hardware_concurrency();
+            workerNum           = hardware > 1 ? hardware - 1 : 1;
+        }
+
+        running_.store(true);
+
+        workers_.reserve(workerNum);
+        for (uint32_t i = 0; i < workerNum; ++i) {
+            auto worker    = std::make_unique<Worker>();
+            worker->owner_ = this;
+            worker->index_ = static_cast<int32_t>(i);
+            workers_.emplace_back(std::move(worker));
+        }
+
+        // すべてのワーカー情報が揃ってから開始する（ steal 先の列挙のため）
+        for (auto& worker : workers_) {
+            worker->thread_.start(workerMain, worker.get());
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ワーカースレッドを停止する
+     */
+    void stop() {
+        if (workers_.empty()) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            running_.store(false);
+        }
+        sleepCondition_.notify_all();
+
+        for (auto& worker : workers_) {
+            worker->thread_.wait();
+        }
+
+        // 実行されずに残ったジョブを破棄する
+        for (auto& worker : workers_) {
+            while (auto* job = worker->queue_.pop()) {
+                releaseJob(job);
+            }
+        }
+        workers_.clear();
+
+        Job* job = nullptr;
+        while (injectQueue_.pop(job)) {
+            releaseJob(job);
+        }
+        pendingNum_.store(0);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ワーカー数を取得する
+     */
+    uint32_t workerNum() const noexcept {
+        return static_cast<uint32_t>(workers_.size());
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ジョブを投入する
+     * @param	func		ジョブの処理
+     * @param	counter		完了を通知するカウンタ
+     */
+    void run(const JobFunc& func, JobCounter* counter) {
+        if (counter) {
+            counter->value_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        auto* job = acquireJob(func, counter);
+
+        // ワーカーが無い場合は呼び出しスレッドで実行する
+        if (workers_.empty()) {
+            execute(job);
+            return;
+        }
+
+        // 取得側より先に加算しておく（一時的に負数にならないように）
+        pendingNum_.fetch_add(1);
+
+        if (currentWorkerIndex >= 0 && currentWorkerIndex < static_cast<int32_t>(workers_.size())) {
+            // ワーカーからの投入は自身のキューへ（満杯なら即時実行）
+            if (!workers_[currentWorkerIndex]->queue_.push(job)) {
+                pendingNum_.fetch_sub(1);
+                execute(job);
+                return;
+            }
+        } else if (!injectQueue_.push(job)) {
+            // 外部投入キューが満杯なら即時実行
+            pendingNum_.fetch_sub(1);
+            execute(job);
+            return;
+        }
+
+        wakeWorker();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	カウンタが 0 になるまで待機する
+     * @param	counter		待機するカウンタ
+     */
+    void wait(JobCounter& counter) {
+        while (!counter.isDone()) {
+            if (auto* job = findJob(currentWorkerIndex)) {
+                execute(job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        // 完了処理中のスレッドがロックを手放すまで待つ（待機後にカウンタを破棄できるように）
+        counter.lock_.lock();
+        counter.lock_.unlock();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	カウンタが 0 になった時に実行する継続処理を登録する
+     * @param	counter		監視するカウンタ
+     * @param	func		継続処理
+     */
+    void then(JobCounter& counter, const JobFunc& func) {
+        counter.lock_.lock();
+        if (counter.value_.load(std::memory_order_acquire) == 0) {
+            counter.lock_.unlock();
+            run(func, nullptr);
+            return;
+        }
+        counter.continuations_.emplace_back(func);
+        counter.lock_.unlock();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	範囲を分割して並列に処理する
+     * @param	begin		開始インデックス
+     * @param	end			終了インデックス（含まない）
+     * @param	grainSize	1 ジョブあたりの要素数
+     * @param	func		分割された範囲を処理する関数
+     */
+    void parallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, const RangeFunc& func) {
+        if (end <= begin) {
+            return;
+        }
+
+        const auto count = end - begin;
+        if (grainSize == 0) {
+            // ワーカー 1 つあたり 4 分割程度にして steal の余地を残す
+            const auto split = (workerNum() + 1) * 4;
+            grainSize        = std::max(1u, (count + split - 1) / split);
+        }
+
+        if (workers_.empty() || count <= grainSize) {
+            func(begin, end);
+            return;
+        }
+
+        JobCounter counter;
+        // 先頭の範囲は呼び出しスレッドで処理するため残しておく
+        for (auto i = begin + grainSize; i < end; i += grainSize) {
+            const auto last = std::min(end, i + grainSize);
+            run([&func, i, last]() { func(i, last); }, &counter);
+        }
+        func(begin, begin + grainSize);
+
+        wait(counter);
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ワーカースレッドのワーク関数
+     * @param	parameter	ワーカー情報
+     * @return
+     */
+    static uint32_t workerMain(void* parameter) {
+        auto* worker       = static_cast<Worker*>(parameter);
+        currentWorkerIndex = worker->index_;
+        const auto name    = "JobWorker " + std::to_string(worker->index_);
+        Profiler::instance().setThreadName(name);
+        FlightRecorder::instance().setThreadName(name);
+        worker->owner_->workerLoop(worker->index_);
+        currentWorkerIndex = -1;
+        return 0;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ワーカーのメインループ
+     * @param	index	ワーカーインデックス
+     */
+    void workerLoop(int32_t index) {
+        while (running_.load(std::memory_order_relaxed)) {
+            if (auto* job = findJob(index)) {
+                execute(job);
+                continue;
+            }
+
+            // ジョブが無いので投入されるまで眠る
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            sleepingNum_.fetch_add(1);
+            sleepCondition_.wait(lock, [this]() {
+                return !running_.load() || pendingNum_.load() > 0;
+            });
+            sleepingNum_.fetch_sub(1);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	実行するジョブを探す
+     * @param	index	呼び出しスレッドのワーカーインデックス（ワーカー以外は -1 ）
+     * @return	見つかったジョブ（無い場合は nullptr ）
+     */
+    Job* findJob(int32_t index) {
+        Job* job = nullptr;
+
+        // 自身のキュー
+        if (index >= 0) {
+            job = workers_[index]->queue_.pop();
+        }
+
+        // 外部スレッドから投入されたジョブ
+        if (!job && pendingNum_.load(std::memory_order_relaxed) > 0) {
+            injectQueue_.pop(job);
+        }
+
+        // 他のワーカーから盗む
+        if (!job) {
+            const auto num   = static_cast<uint32_t>(workers_.size());
+            const auto start = static_cast<uint32_t>(index + 1);
+            for (uint32_t i = 0; i < num && !job; ++i) {
+                const auto target = (start + i) % num;
+                if (static_cast<int32_t>(target) != index) {
+                    job = workers_[target]->queue_.steal();
+                }
+            }
+        }
+
+        if (job) {
+            pendingNum_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ジョブを実行して破棄する
+     * @param	job		実行するジョブ
+     */
+    void execute(Job* job) {
+        job->func_();
+
+        if (job->counter_) {
+            finish(*job->counter_);
+        }
+        releaseJob(job);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ジョブを取得する（再利用できるジョブがあればヒープ確保を行わない）
+     * @param	func		ジョブの処理
+     * @param	counter		完了を通知するカウンタ
+     */
+    Job* acquireJob(const JobFunc& func, JobCounter* counter) {
+        Job* job = nullptr;
+        if (!freeJobs_.pop(job)) {
+            return new Job{func, counter};
+        }
+
+        job->func_    = func;
+        job->counter_ = counter;
+        return job;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	実行済みのジョブを再利用のために戻す
+     * @param	job		ジョブ
+     */
+    void releaseJob(Job* job) {
+        // キャプチャした値はここで破棄する
+        job->func_    = nullptr;
+        job->counter_ = nullptr;
+        if (!freeJobs_.push(job)) {
+            delete job;
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	カウンタを減算し、 0 になったら継続処理を投入する
+     * @param	counter		減算するカウンタ
+     */
+    void finish(JobCounter& counter) {
+        auto value = counter.value_.load(std::memory_order_relaxed);
+        while (true) {
+            // 最後の 1 つでなければ減算するだけ
+            if (value > 1) {
+                if (counter.value_.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel)) {
+                    return;
+                }
+                continue;
+            }
+
+            // 最後の 1 つはロックを保持したまま 0 にする
+            // 待機側は 0 を確認した後にロックを取り直すので、解放後にカウンタへ触れることは無い
+            std::vector<JobFunc> continuations;
+            counter.lock_.lock();
+            if (counter.value_.compare_exchange_strong(value, 0, std::memory_order_acq_rel)) {
+                continuations.swap(counter.continuations_);
+                counter.lock_.unlock();
+
+                for (const auto& func : continuations) {
+                    run(func, nullptr);
+                }
+                return;
+            }
+            counter.lock_.unlock();
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	眠っているワーカーを 1 つ起こす
+     */
+    void wakeWorker() {
+        if (sleepingNum_.load() == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        sleepCondition_.notify_one();
+    }
+
+private:
+    std::vector<std::unique_ptr<Worker>>   workers_{};         ///< ワーカー
+    MpmcRingBuffer<Job*, queueCapacity>   injectQueue_{};     ///< 外部スレッドから投入されたジョブ
+    MpmcRingBuffer<Job*, freeJobCapacity> freeJobs_{};        ///< 再利用するジョブ
+    std::mutex                             sleepMutex_{};      ///< 待機用の同期オブジェクト
+    std::condition_variable                sleepCondition_{};  ///< 待機用の条件変数
+    std::atomic<uint32_t>                  pendingNum_{};      ///< 未取得のジョブ数
+    std::atomic<uint32_t>                  sleepingNum_{};     ///< 眠っているワーカー数
+    std::atomic<bool>                      running_{};         ///< ワーカーの稼働フラグ
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ
+ */
+JobSystem::~JobSystem() {
+    impl_.reset();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ワーカースレッドを開始する
+ * @param	workerNum	ワーカー数（ 0 の場合は論理コア数 - 1 ）
+ */
+void JobSystem::start(uint32_t workerNum) {
+    impl_->start(workerNum);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ワーカースレッドを停止する
+ */
+void JobSystem::stop() {
+    impl_->stop();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ワーカー数を取得する
+ */
+uint32_t JobSystem::workerNum() const noexcept {
+    return impl_->workerNum();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ジョブを投入する
+ * @param	func		ジョブの処理
+ * @param	counter		完了を通知するカウンタ（不要な場合は nullptr ）
+ */
+void JobSystem::run(const JobFunc& func, JobCounter* counter) {
+    impl_->run(func, counter);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	カウンタが 0 になるまで待機する
+ * @param	counter		待機するカウンタ
+ */
+void JobSystem::wait(JobCounter& counter) {
+    impl_->wait(counter);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	カウンタが 0 になった時に実行する継続処理を登録する
+ * @param	counter		監視するカウンタ
+ * @param	func		継続処理（すでに 0 の場合は即座に投入される）
+ */
+void JobSystem::then(JobCounter& counter, const JobFunc& func) {
+    impl_->then(counter, func);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	範囲を分割して並列に処理する
+ * @param	begin		開始インデックス
+ * @param	end			終了インデックス（含まない）
+ * @param	grainSize	1 ジョブあたりの要素数（ 0 の場合はワーカー数から自動で決める）
+ * @param	func		分割された範囲 [ begin, end ) を処理する関数
+ */
+void JobSystem::parallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, const RangeFunc& func) {
+    impl_->parallelFor(begin, end, grainSize, func);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	現在のスレッドのワーカーインデックスを取得する
+ * @return	ワーカーインデックス（ワーカー以外のスレッドでは -1 ）
+ */
+int32_t JobSystem::workerIndex() noexcept {
+    return currentWorkerIndex;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ */
+JobSystem::JobSystem() {
+    impl_.reset(new JobSystem::Impl());
+}
+}  // namespace utility
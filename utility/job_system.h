@@ -0,0 +1,155 @@
+﻿#pragma once
+
+#include <atomic>
+
+#include "utility/singleton.h"
+#include "utility/spin_lock.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ジョブの完了待ちカウンタ
+ *
+ * 登録されたジョブ数を保持し、すべて完了すると 0 になる
+ * 0 になった時点で登録済みの継続処理がジョブとして投入される
+ */
+class JobCounter final : Noncopyable {
+private:
+    friend class JobSystem;
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    JobCounter() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~JobCounter() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	すべてのジョブが完了しているか否かを取得する
+     * @return	完了していれば true
+     */
+    [[nodiscard]] bool isDone() const noexcept {
+        return value_.load(std::memory_order_acquire) == 0;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	未完了のジョブ数を取得する
+     */
+    [[nodiscard]] uint32_t value() const noexcept {
+        return value_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<uint32_t>              value_{};          ///< 未完了のジョブ数
+    SharedSpinLock                     lock_{};           ///< 継続処理リストの同期オブジェクト
+    std::vector<std::function<void()>> continuations_{};  ///< 完了時に投入する継続処理
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ジョブシステム
+ *
+ * 固定数のワーカースレッドと、ワーカーごとのワークスティーリングキューで
+ * 細かな処理を全コアに分散させる
+ * 開始前（ワーカー数 0 ）に投入されたジョブは呼び出しスレッドで即時実行される
+ */
+class JobSystem final : public Singleton<JobSystem> {
+private:
+    friend class Singleton<JobSystem>;
+
+public:
+    using JobFunc   = std::function<void()>;
+    using RangeFunc = std::function<void(uint32_t begin, uint32_t end)>;
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~JobSystem();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ワーカースレッドを開始する
+     * @param	workerNum	ワーカー数（ 0 の場合は論理コア数 - 1 ）
+     */
+    void start(uint32_t workerNum = 0);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ワーカースレッドを停止する
+     */
+    void stop();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ワーカー数を取得する
+     */
+    [[nodiscard]] uint32_t workerNum() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ジョブを投入する
+     * @param	func		ジョブの処理
+     * @param	counter		完了を通知するカウンタ（不要な場合は nullptr ）
+     */
+    void run(const JobFunc& func, JobCounter* counter = nullptr);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	カウンタが 0 になるまで待機する
+     *
+     * 待機中も他のジョブを実行するので、ジョブの中から呼び出してもデッドロックしない
+     * 戻った後はカウンタを破棄してよい
+     * @param	counter		待機するカウンタ
+     */
+    void wait(JobCounter& counter);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	カウンタが 0 になった時に実行する継続処理を登録する
+     * @param	counter		監視するカウンタ
+     * @param	func		継続処理（すでに 0 の場合は即座に投入される）
+     */
+    void then(JobCounter& counter, const JobFunc& func);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	範囲を分割して並列に処理する
+     * @param	begin		開始インデックス
+     * @param	end			終了インデックス（含まない）
+     * @param	grainSize	1 ジョブあたりの要素数（ 0 の場合はワーカー数から自動で決める）
+     * @param	func		分割された範囲 [ begin, end ) を処理する関数
+     */
+    void parallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, const RangeFunc& func);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	現在のスレッドのワーカーインデックスを取得する
+     * @return	ワーカーインデックス（ワーカー以外のスレッドでは -1 ）
+     */
+    [[nodiscard]] static int32_t workerIndex() noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    JobSystem();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;  ///< インプリメントクラスポインタ
+};
+}  // namespace utility
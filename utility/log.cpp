@@ -1,4 +1,23 @@
 ﻿#include "log.h"
+#include <cstdarg>
+
+namespace {
+#if !defined(_WIN32)
+//---------------------------------------------------------------------------------
+/**
+ * @brief Windows 以外ではデバッグ出力を標準エラーに出力する
+ */
+void OutputDebugString(const char* str) {
+    fputs(str, stderr);
+}
+
+#define vsprintf_s vsnprintf
+#define _CrtDbgBreak() __builtin_trap()
+using TCHAR = char;
+#endif
+
+void (*assertHook)() = nullptr;  ///< アサート時にブレークする直前に呼び出す処理
+}  // namespace
 
 namespace utility {
 //---------------------------------------------------------------------------------
@@ -15,7 +34,7 @@ void debugMsg(const char* str, ...) {
 
     va_list args;
     va_start(args, str);
-    vsprintf_s(msg, temp.c_str(), args);
+    vsprintf_s(msg, sizeof(msg), temp.c_str(), args);
     va_end(args);
 
     OutputDebugString(msg);
@@ -38,13 +57,27 @@ void assertMsg(bool condition, const char* str, ...) {
 
         va_list args;
         va_start(args, str);
-        vsprintf_s(msg, temp.c_str(), args);
+        vsprintf_s(msg, sizeof(msg), temp.c_str(), args);
         va_end(args);
         OutputDebugString(msg);
 
         OutputDebugString("=======================================================================\n");
 
+        if (assertHook) {
+            assertHook();
+        }
+
         _CrtDbgBreak();
     }
 }
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief アサート時にブレークする直前に呼び出す処理を設定する
+ * @param	hook		呼び出す処理（ nullptr の場合は解除）
+ * @return
+ */
+void setAssertHook(void (*hook)()) {
+    assertHook = hook;
+}
 }  // namespace utility
@@ -1,5 +1,7 @@
 ﻿#pragma once
+#if defined(_WIN32)
 #include <tchar.h>
+#endif
 
 namespace utility {
 //---------------------------------------------------------------------------------
@@ -18,11 +20,19 @@ void debugMsg(const char* str, ...);
  * @return
  */
 void assertMsg(bool condition, const char* str, ...);
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief アサート時にブレークする直前に呼び出す処理を設定する
+ * @param	hook		呼び出す処理（ nullptr の場合は解除）
+ * @return
+ */
+void setAssertHook(void (*hook)());
 }  // namespace utility
 
 #if _DEBUG
-#define TRACE(str, ...) utility::debugMsg(str, __VA_ARGS__)
-#define ASSERT(condition, str, ...) utility::assertMsg((condition), str, __VA_ARGS__)
+#define TRACE(str, ...) utility::debugMsg(str, ##__VA_ARGS__)
+#define ASSERT(condition, str, ...) utility::assertMsg((condition), str, ##__VA_ARGS__)
 #else
 #define TRACE(str, ...)
 #define ASSERT(condition, str, ...)
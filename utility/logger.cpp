@@ -0,0 +1,638 @@
+﻿#include "logger.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <fstream>
+
+#include "utility/alloc_counter.h"
+#include "utility/ring_buffer.h"
+#include "utility/thread.h"
+
+namespace {
+constexpr uint32_t ringCapacity = 1024;  ///< スレッドごとのエントリ数
+constexpr uint32_t drainNum     = 64;    ///< 1 回にまとめて回収するエントリ数
+
+std::atomic<uint32_t> loggerSerial{};  ///< ロガーの生成ごとに割り当てる番号
+
+#if !defined(_WIN32)
+//---------------------------------------------------------------------------------
+/**
+ * @brief Windows 以外ではデバッグ出力を標準エラーに出力する
+ */
+void OutputDebugStringA(const char* str) {
+    fputs(str, stderr);
+}
+#endif
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	steady_clock のナノ秒を取得する
+ */
+int64_t steadyNanosec() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ログレベルの表示名を取得する
+ */
+const char* levelName(utility::LogLevel level) noexcept {
+    switch (level) {
+        case utility::LogLevel::Trace:
+            return "TRACE";
+        case utility::LogLevel::Debug:
+            return "DEBUG";
+        case utility::LogLevel::Info:
+            return "INFO ";
+        case utility::LogLevel::Warning:
+            return "WARN ";
+        case utility::LogLevel::Error:
+            return "ERROR";
+    }
+    return "?????";
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	書式付きで追加する
+ */
+void appendFormat(std::string& out, const char* format, ...) {
+    char buf[256];
+
+    va_list args;
+    va_start(args, format);
+    const auto len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+
+    if (len < 0) {
+        return;
+    }
+    if (static_cast<size_t>(len) < sizeof(buf)) {
+        out.append(buf, static_cast<size_t>(len));
+        return;
+    }
+
+    // 収まらない場合は必要なサイズを確保して整形し直す
+    const auto size = out.size();
+    out.resize(size + static_cast<size_t>(len) + 1);
+    va_start(args, format);
+    vsnprintf(out.data() + size, static_cast<size_t>(len) + 1, format, args);
+    va_end(args);
+    out.resize(size + static_cast<size_t>(len));
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * エントリの引数
+ */
+struct LogArg {
+    utility::detail::LogArgType type_{};  ///< 種類
+    int64_t                     int_{};   ///< 符号付き整数
+    uint64_t                    uint_{};  ///< 符号無し整数
+    double                      real_{};  ///< 浮動小数点数
+    std::string_view            str_{};   ///< 文字列
+    const void*                 ptr_{};   ///< ポインタ
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * エントリの引数を先頭から順に読み出す
+ */
+class LogArgReader {
+public:
+    explicit LogArgReader(const utility::detail::LogEntry& entry) noexcept
+        : entry_(entry) {
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	次の引数を読み出す
+     * @param	arg			読み出し先
+     * @return	引数が残っていない場合は false
+     */
+    bool next(LogArg& arg) noexcept {
+        using utility::detail::LogArgType;
+
+        if (pos_ >= entry_.size_) {
+            return false;
+        }
+        const auto* data = entry_.payload_ + pos_;
+        arg              = {};
+        arg.type_        = static_cast<LogArgType>(data[0]);
+        switch (arg.type_) {
+            case LogArgType::Int:
+                std::memcpy(&arg.int_, data + 1, sizeof(arg.int_));
+                arg.uint_ = static_cast<uint64_t>(arg.int_);
+                arg.real_ = static_cast<double>(arg.int_);
+                pos_ += 1 + sizeof(arg.int_);
+                break;
+            case LogArgType::UInt:
+                std::memcpy(&arg.uint_, data + 1, sizeof(arg.uint_));
+                arg.int_  = static_cast<int64_t>(arg.uint_);
+                arg.real_ = static_cast<double>(arg.uint_);
+                pos_ += 1 + sizeof(arg.uint_);
+                break;
+            case LogArgType::Double:
+                std::memcpy(&arg.real_, data + 1, sizeof(arg.real_));
+                arg.int_  = static_cast<int64_t>(arg.real_);
+                arg.uint_ = static_cast<uint64_t>(arg.int_);
+                pos_ += 1 + sizeof(arg.real_);
+                break;
+            case LogArgType::String: {
+                const auto len = static_cast<uint8_t>(data[1]);
+                arg.str_       = std::string_view(data + 2, len);
+                pos_ += 2 + len;
+                break;
+            }
+            case LogArgType::Pointer:
+                std::memcpy(&arg.ptr_, data + 1, sizeof(arg.ptr_));
+                arg.uint_ = reinterpret_cast<uintptr_t>(arg.ptr_);
+                arg.int_  = static_cast<int64_t>(arg.uint_);
+                pos_ += 1 + sizeof(arg.ptr_);
+                break;
+        }
+        return true;
+    }
+
+private:
+    const utility::detail::LogEntry& entry_;  ///< 読み出すエントリ
+    size_t                           pos_{};  ///< 読み出し位置
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	1 つの変換指定を整形して追加する
+ * @param	out			出力先
+ * @param	spec		フラグ、幅、精度までの変換指定（長さ修飾子は含まない）
+ * @param	conversion	変換指定子
+ * @param	arg			引数
+ */
+void formatArg(std::string& out, std::string& spec, char conversion, const LogArg& arg) {
+    using utility::detail::LogArgType;
+
+    switch (conversion) {
+        case 'd':
+        case 'i':
+            spec += "lld";
+            appendFormat(out, spec.c_str(), static_cast<long long>(arg.int_));
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            spec += "ll";
+            spec += conversion;
+            appendFormat(out, spec.c_str(), static_cast<unsigned long long>(arg.uint_));
+            break;
+        case 'c':
+            spec += 'c';
+            appendFormat(out, spec.c_str(), static_cast<int>(arg.int_));
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            spec += conversion;
+            appendFormat(out, spec.c_str(), arg.real_);
+            break;
+        case 'p':
+            spec += 'p';
+            appendFormat(out, spec.c_str(), arg.ptr_ ? arg.ptr_ : reinterpret_cast<const void*>(static_cast<uintptr_t>(arg.uint_)));
+            break;
+        case 's':
+            // 文字列以外が渡された場合は値をそのまま文字列にする
+            spec += 's';
+            if (arg.type_ == LogArgType::String) {
+                appendFormat(out, spec.c_str(), std::string(arg.str_).c_str());
+            } else if (arg.type_ == LogArgType::Double) {
+                appendFormat(out, spec.c_str(), std::to_string(arg.real_).c_str());
+            } else if (arg.type_ == LogArgType::Int) {
+                appendFormat(out, spec.c_str(), std::to_string(arg.int_).c_str());
+            } else {
+                appendFormat(out, spec.c_str(), std::to_string(arg.uint_).c_str());
+            }
+            break;
+        default:
+            out += '%';
+            out += conversion;
+            break;
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	エントリのメッセージを書式に従って整形する
+ * @param	out			出力先
+ * @param	entry		エントリ
+ */
+void formatMessage(std::string& out, const utility::detail::LogEntry& entry) {
+    LogArgReader reader(entry);
+    std::string  spec;
+
+    const char* f = entry.format_ ? entry.format_ : "";
+    while (*f) {
+        const char* percent = std::strchr(f, '%');
+        if (!percent) {
+            out.append(f);
+            break;
+        }
+        out.append(f, percent);
+        f = percent + 1;
+
+        if (*f == '%') {
+            out += '%';
+            f++;
+            continue;
+        }
+
+        // フラグ、幅、精度を取り出し、長さ修飾子は引数の型で決めるので読み飛ばす
+        spec = "%";
+        while (*f && std::strchr("-+ #0", *f)) {
+            spec += *f++;
+        }
+        while (*f >= '0' && *f <= '9') {
+            spec += *f++;
+        }
+        if (*f == '.') {
+            spec += *f++;
+            while (*f >= '0' && *f <= '9') {
+                spec += *f++;
+            }
+        }
+        while (*f && std::strchr("hlLqjzt", *f)) {
+            f++;
+        }
+        if (!*f) {
+            out.append(percent);
+            break;
+        }
+
+        const auto conversion = *f++;
+        LogArg     arg;
+        if (!reader.next(arg)) {
+            out += "<?>";
+            continue;
+        }
+        formatArg(out, spec, conversion, arg);
+    }
+
+    if (entry.truncated_) {
+        out += " ...(truncated)";
+    }
+}
+}  // namespace
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ * @param	path		出力先のファイルパス
+ */
+FileLogSink::FileLogSink(const std::filesystem::path& path)
+    : file_(std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::trunc)) {
+    ASSERT(file_->is_open(), "ログファイルを開けません : %s", path.string().c_str());
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ
+ */
+FileLogSink::~FileLogSink() {
+    file_->flush();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	1 行を出力する
+ */
+void FileLogSink::write(LogLevel, std::string_view line) {
+    file_->write(line.data(), static_cast<std::streamsize>(line.size()));
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	バッファリングしている内容を書き出す
+ */
+void FileLogSink::flush() {
+    file_->flush();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	1 行を出力する
+ */
+void StdoutLogSink::write(LogLevel, std::string_view line) {
+    fwrite(line.data(), 1, line.size(), stdout);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	バッファリングしている内容を書き出す
+ */
+void StdoutLogSink::flush() {
+    fflush(stdout);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	1 行を出力する
+ */
+void DebugLogSink::write(LogLevel, std::string_view line) {
+    // 整形済みの行は終端文字を持たないので複製して渡す
+    OutputDebugStringA(std::string(line).c_str());
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ロガーのインプリメントクラス
+ */
+class Logger::Impl {
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  スレッドごとの記録先
+     */
+    struct ThreadState {
+        SpscRingBuffer<detail::LogEntry, ringCapacity> ring_{};   ///< エントリのバッファ
+        uint32_t                                       index_{};  ///< スレッドインデックス
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    Impl()
+        : serial_(loggerSerial.fetch_add(1, std::memory_order_relaxed) + 1), baseTime_(steadyNanosec()) {
+        sinks_.emplace_back(std::make_unique<DebugLogSink>());
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~Impl() {
+        stop();
+        flush();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	エントリを呼び出しスレッドのリングバッファに積む
+     * @param	entry		エントリ
+     */
+    void submit(detail::LogEntry& entry) noexcept {
+        auto& state   = local();
+        entry.time_   = steadyNanosec();
+        entry.thread_ = state.index_;
+        if (!state.ring_.push(entry)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	バックグラウンドスレッドを開始する
+     */
+    void start() {
+        if (running_.exchange(true)) {
+            return;
+        }
+        thread_.start(
+            [this](void*) -> uint32_t {
+                while (running_.load(std::memory_order_acquire)) {
+                    // 何も無い場合だけ待機し、連続して記録される間は回収を続ける
+                    if (drain() == 0) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                }
+                return 0;
+            },
+            nullptr);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	残っているログを出力してバックグラウンドスレッドを終了する
+     */
+    void stop() {
+        if (!running_.exchange(false)) {
+            return;
+        }
+        thread_.wait();
+        flush();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	記録済みのログを呼び出しスレッドで出力する
+     */
+    void flush() {
+        drain();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& sink : sinks_) {
+            sink->flush();
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	出力先を追加する
+     * @param	sink		出力先
+     */
+    void addSink(std::unique_ptr<LogSink> sink) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sinks_.emplace_back(std::move(sink));
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	すべての出力先を取り除く
+     */
+    void clearSinks() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sinks_.clear();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	バッファが一杯で破棄したログの総数を取得する
+     */
+    uint64_t droppedNum() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	呼び出しスレッドの記録先を取得する（初回のみ登録する）
+     */
+    ThreadState& local() {
+        thread_local ThreadState* cache       = nullptr;
+        thread_local uint32_t     cacheSerial = 0;
+
+        if (cacheSerial != serial_) {
+            MEMORY_TAG(alloc::MemoryTag::Log);
+            auto state = std::make_unique<ThreadState>();
+
+            std::lock_guard<std::mutex> lock(threadMutex_);
+            state->index_ = static_cast<uint32_t>(threads_.size());
+            cache         = state.get();
+            cacheSerial   = serial_;
+            threads_.emplace_back(std::move(state));
+        }
+        return *cache;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	全スレッドのエントリを回収し、時刻順に整形して出力する
+     * @return	出力したエントリ数
+     */
+    size_t drain() {
+        MEMORY_TAG(alloc::MemoryTag::Log);
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        batch_.clear();
+        {
+            std::lock_guard<std::mutex> threadLock(threadMutex_);
+            for (auto& state : threads_) {
+                while (true) {
+                    const auto size = batch_.size();
+                    batch_.resize(size + drainNum);
+                    const auto num = state->ring_.popBatch(batch_.data() + size, drainNum);
+                    batch_.resize(size + num);
+                    if (num == 0) {
+                        break;
+                    }
+                }
+            }
+        }
+
+        std::stable_sort(batch_.begin(), batch_.end(), [](const detail::LogEntry& a, const detail::LogEntry& b) {
+            return a.time_ < b.time_;
+        });
+
+        for (const auto& entry : batch_) {
+            line_.clear();
+            appendFormat(line_, "[%12.6f] [%s] [%2u] ", static_cast<double>(entry.time_ - baseTime_) / 1e9, levelName(entry.level_), entry.thread_);
+            formatMessage(line_, entry);
+            line_ += '\n';
+            for (auto& sink : sinks_) {
+                sink->write(entry.level_, line_);
+            }
+        }
+
+        // 破棄したエントリがあれば出力のたびに知らせる
+        const auto dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != reportedDropped_) {
+            line_.clear();
+            appendFormat(line_, "[%12.6f] [%s] [--] %llu log entries dropped\n", static_cast<double>(steadyNanosec() - baseTime_) / 1e9, levelName(LogLevel::Warning), static_cast<unsigned long long>(dropped - reportedDropped_));
+            for (auto& sink : sinks_) {
+                sink->write(LogLevel::Warning, line_);
+            }
+            reportedDropped_ = dropped;
+        }
+
+        return batch_.size();
+    }
+
+private:
+    const uint32_t                            serial_;             ///< ロガーの識別番号
+    const int64_t                             baseTime_;           ///< 生成時刻（ナノ秒）
+    std::mutex                                mutex_{};            ///< 回収と出力先の同期オブジェクト
+    std::mutex                                threadMutex_{};      ///< スレッド登録の同期オブジェクト
+    std::vector<std::unique_ptr<ThreadState>> threads_{};          ///< スレッドごとの記録先
+    std::vector<std::unique_ptr<LogSink>>     sinks_{};            ///< 出力先
+    std::vector<detail::LogEntry>             batch_{};            ///< 回収したエントリ
+    std::string                               line_{};             ///< 整形中の行
+    std::atomic<uint64_t>                     dropped_{};          ///< 破棄したエントリ数
+    uint64_t                                  reportedDropped_{};  ///< 通知済みの破棄したエントリ数
+    std::atomic<bool>                         running_{};          ///< バックグラウンドスレッドが動作中か否か
+    Thread                                    thread_{};           ///< バックグラウンドスレッド
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ
+ */
+Logger::~Logger() {
+    impl_.reset();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	バックグラウンドスレッドを開始する
+ */
+void Logger::start() {
+    impl_->start();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	残っているログを出力してバックグラウンドスレッドを終了する
+ */
+void Logger::stop() {
+    impl_->stop();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	記録済みのログを呼び出しスレッドで出力する
+ */
+void Logger::flush() {
+    impl_->flush();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	出力先を追加する
+ * @param	sink		出力先
+ */
+void Logger::addSink(std::unique_ptr<LogSink> sink) {
+    impl_->addSink(std::move(sink));
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	すべての出力先を取り除く
+ */
+void Logger::clearSinks() {
+    impl_->clearSinks();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	バッファが一杯で破棄したログの総数を取得する
+ */
+uint64_t Logger::droppedNum() const noexcept {
+    return impl_->droppedNum();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ */
+Logger::Logger() {
+    impl_.reset(new Logger::Impl());
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	エントリを呼び出しスレッドのリングバッファに積む
+ * @param	entry		エントリ
+ */
+void Logger::submit(detail::LogEntry& entry) noexcept {
+    impl_->submit(entry);
+}
+
+}  // namespace utility
@@ -0,0 +1,338 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstring>
+
+#include "utility/noncopyable.h"
+#include "utility/singleton.h"
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンパイル時に残すログレベルの下限（ LogLevel の値）
+ *
+ * 未定義の場合はデバッグビルドですべて、それ以外では Info 以上を残す
+ */
+#if !defined(LOG_LEVEL_MIN)
+#if _DEBUG
+#define LOG_LEVEL_MIN 0
+#else
+#define LOG_LEVEL_MIN 2
+#endif
+#endif
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ログレベル
+ */
+enum class LogLevel : uint8_t {
+    Trace,    ///< 詳細な追跡
+    Debug,    ///< デバッグ情報
+    Info,     ///< 通常の情報
+    Warning,  ///< 警告
+    Error,    ///< エラー
+};
+
+namespace detail {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ログ引数の種類
+ */
+enum class LogArgType : uint8_t {
+    Int,
+    UInt,
+    Double,
+    String,
+    Pointer,
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * スレッドごとのリングバッファに積むログの 1 エントリ
+ *
+ * 書式はポインタのみを記録するので、文字列リテラルなどプロセス終了まで有効な文字列であること
+ * 引数は種類と値を payload_ に詰める（文字列は複製し、入りきらない分は切り捨てる）
+ */
+struct LogEntry {
+    static constexpr size_t payloadSize = 104;  ///< 引数の格納領域のサイズ（エントリ全体で 128 バイト）
+
+    int64_t     time_;                  ///< 記録時刻（ナノ秒）
+    const char* format_;                ///< 書式
+    LogLevel    level_;                 ///< ログレベル
+    uint8_t     size_;                  ///< 使用中の payload_ のバイト数
+    bool        truncated_;             ///< 引数を切り捨てたか否か
+    uint8_t     padding_;               ///< 未使用
+    uint32_t    thread_;                ///< スレッドインデックス
+    char        payload_[payloadSize];  ///< 引数
+};
+static_assert(sizeof(LogEntry) == 128);
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	固定長の引数を追加する
+ */
+inline void putLogArg(LogEntry& entry, LogArgType type, const void* data, size_t size) noexcept {
+    if (entry.truncated_ || static_cast<size_t>(entry.size_) + 1 + size > LogEntry::payloadSize) {
+        entry.truncated_ = true;
+        return;
+    }
+    entry.payload_[entry.size_] = static_cast<char>(type);
+    std::memcpy(entry.payload_ + entry.size_ + 1, data, size);
+    entry.size_ = static_cast<uint8_t>(entry.size_ + 1 + size);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	文字列の引数を追加する（入りきらない場合は切り詰める）
+ */
+inline void putLogString(LogEntry& entry, std::string_view str) noexcept {
+    if (entry.truncated_ || static_cast<size_t>(entry.size_) + 2 > LogEntry::payloadSize) {
+        entry.truncated_ = true;
+        return;
+    }
+    const auto len = std::min(str.size(), LogEntry::payloadSize - entry.size_ - 2);
+    if (len < str.size()) {
+        entry.truncated_ = true;
+    }
+    entry.payload_[entry.size_]     = static_cast<char>(LogArgType::String);
+    entry.payload_[entry.size_ + 1] = static_cast<char>(len);
+    std::memcpy(entry.payload_ + entry.size_ + 2, str.data(), len);
+    entry.size_ = static_cast<uint8_t>(entry.size_ + 2 + len);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	引数を型に応じて追加する
+ */
+template <class T>
+void encodeLogArg(LogEntry& entry, const T& value) noexcept {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_enum_v<U>) {
+        encodeLogArg(entry, static_cast<std::underlying_type_t<U>>(value));
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        const auto v = static_cast<int64_t>(value);
+        putLogArg(entry, LogArgType::Int, &v, sizeof(v));
+    } else if constexpr (std::is_integral_v<U>) {
+        const auto v = static_cast<uint64_t>(value);
+        putLogArg(entry, LogArgType::UInt, &v, sizeof(v));
+    } else if constexpr (std::is_floating_point_v<U>) {
+        const auto v = static_cast<double>(value);
+        putLogArg(entry, LogArgType::Double, &v, sizeof(v));
+    } else if constexpr (std::is_array_v<T>) {
+        putLogString(entry, std::string_view(value));
+    } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+        putLogString(entry, value ? std::string_view(value) : std::string_view("(null)"));
+    } else if constexpr (std::is_convertible_v<const U&, std::string_view>) {
+        putLogString(entry, std::string_view(value));
+    } else if constexpr (std::is_pointer_v<U> || std::is_null_pointer_v<U>) {
+        const auto* v = static_cast<const void*>(value);
+        putLogArg(entry, LogArgType::Pointer, &v, sizeof(v));
+    } else {
+        static_assert(sizeof(U) == 0, "ログに出力できない型です");
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ログレベルがコンパイル時に残す対象か否かを取得する
+ */
+constexpr bool isLogEnabled(LogLevel level) noexcept {
+    constexpr int levelMin = LOG_LEVEL_MIN;
+    return static_cast<int>(level) >= levelMin;
+}
+
+}  // namespace detail
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ログの出力先
+ *
+ * ロガーのバックグラウンドスレッドから呼び出される
+ */
+class LogSink : Noncopyable {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    virtual ~LogSink() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	1 行を出力する
+     * @param	level		ログレベル
+     * @param	line		整形済みの行（改行を含む）
+     */
+    virtual void write(LogLevel level, std::string_view line) = 0;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	バッファリングしている内容を書き出す
+     */
+    virtual void flush() {
+    }
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ファイルへの出力
+ */
+class FileLogSink final : public LogSink {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     * @param	path		出力先のファイルパス（既存のファイルは上書きする）
+     */
+    explicit FileLogSink(const std::filesystem::path& path);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~FileLogSink() override;
+
+    void write(LogLevel level, std::string_view line) override;
+    void flush() override;
+
+private:
+    std::unique_ptr<std::ofstream> file_;  ///< 出力先のファイル
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 標準出力への出力
+ */
+class StdoutLogSink final : public LogSink {
+public:
+    void write(LogLevel level, std::string_view line) override;
+    void flush() override;
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * デバッガへの出力（ Windows 以外では標準エラー）
+ */
+class DebugLogSink final : public LogSink {
+public:
+    void write(LogLevel level, std::string_view line) override;
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 非同期ロガー
+ *
+ * 呼び出しスレッドは書式のポインタと引数をスレッドごとのロックフリーリングバッファに積むだけで、
+ * 整形と出力はバックグラウンドスレッドで行う
+ * バッファが一杯の場合は破棄し、破棄した数を後でまとめて出力する
+ * 書式は printf 形式（ * による幅の指定は非対応）
+ */
+class Logger final : public Singleton<Logger> {
+private:
+    friend class Singleton<Logger>;
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ（残っているログを出力して終了する）
+     */
+    ~Logger();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ログを記録する
+     * @param	level		ログレベル
+     * @param	format		書式（文字列リテラルなどプロセス終了まで有効な文字列）
+     * @param	args		引数
+     */
+    template <class... Args>
+    void write(LogLevel level, const char* format, const Args&... args) noexcept {
+        detail::LogEntry entry;
+        entry.format_    = format;
+        entry.level_     = level;
+        entry.size_      = 0;
+        entry.truncated_ = false;
+        (detail::encodeLogArg(entry, args), ...);
+        submit(entry);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	バックグラウンドスレッドを開始する
+     *
+     * 開始前に記録したログは開始後、または flush で出力する
+     */
+    void start();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	残っているログを出力してバックグラウンドスレッドを終了する
+     */
+    void stop();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	記録済みのログを呼び出しスレッドで出力する
+     */
+    void flush();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	出力先を追加する
+     * @param	sink		出力先
+     */
+    void addSink(std::unique_ptr<LogSink> sink);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	すべての出力先を取り除く
+     */
+    void clearSinks();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	バッファが一杯で破棄したログの総数を取得する
+     */
+    [[nodiscard]] uint64_t droppedNum() const noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ（デバッガへの出力を登録する）
+     */
+    Logger();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	エントリを呼び出しスレッドのリングバッファに積む
+     * @param	entry		エントリ
+     */
+    void submit(detail::LogEntry& entry) noexcept;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;  ///< インプリメントクラスポインタ
+};
+
+}  // namespace utility
+
+#define LOG_WRITE(level, format, ...)                                        \
+    do {                                                                     \
+        if constexpr (utility::detail::isLogEnabled(level)) {                \
+            utility::Logger::instance().write(level, format, ##__VA_ARGS__); \
+        }                                                                    \
+    } while (false)
+
+#define LOG_TRACE(format, ...) LOG_WRITE(utility::LogLevel::Trace, format, ##__VA_ARGS__)
+#define LOG_DEBUG(format, ...) LOG_WRITE(utility::LogLevel::Debug, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...) LOG_WRITE(utility::LogLevel::Info, format, ##__VA_ARGS__)
+#define LOG_WARN(format, ...) LOG_WRITE(utility::LogLevel::Warning, format, ##__VA_ARGS__)
+#define LOG_ERROR(format, ...) LOG_WRITE(utility::LogLevel::Error, format, ##__VA_ARGS__)
@@ -0,0 +1,184 @@
+﻿#pragma once
+
+#include <mutex>
+#include <new>
+
+#include "utility/noncopyable.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 固定サイズのオブジェクトプール
+ *
+ * SlabNum 個分のスロットをまとめて確保し（スラブ）、空きスロットはフリーリストで管理する
+ * スラブは解放しないため、一度確保したスロットは以降 new / delete を伴わずに再利用される
+ * 生成と破棄はスレッドセーフ
+ */
+template <class T, uint32_t SlabNum = 64>
+class ObjectPool final : Noncopyable {
+private:
+    static_assert(SlabNum > 0, "スラブのスロット数は 1 以上を指定してください");
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  スロット（空きの間はフリーリストのリンクとして利用する）
+     */
+    union Slot {
+        Slot*                next_;                ///< 次の空きスロット
+        alignas(T) std::byte storage_[sizeof(T)];  ///< オブジェクトの格納先
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    ObjectPool() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~ObjectPool() {
+        ASSERT(liveNum_ == 0, "破棄されていないオブジェクトがあります : %d", liveNum_);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	オブジェクトを生成する
+     * @param	args		コンストラクタ引数
+     * @return	生成したオブジェクト
+     */
+    template <class... Args>
+    [[nodiscard]] T* create(Args&&... args) {
+        auto* slot = acquire();
+        if constexpr (std::is_nothrow_constructible_v<T, Args...>) {
+            return new (slot->storage_) T(std::forward<Args>(args)...);
+        } else {
+            try {
+                return new (slot->storage_) T(std::forward<Args>(args)...);
+            } catch (...) {
+                release(slot);
+                throw;
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	オブジェクトを破棄する
+     * @param	p			このプールで生成したオブジェクト
+     */
+    void destroy(T* p) noexcept {
+        if (!p) {
+            return;
+        }
+        p->~T();
+        release(std::launder(reinterpret_cast<Slot*>(p)));
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	生成中のオブジェクト数を取得する
+     */
+    [[nodiscard]] uint32_t liveNum() const noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return liveNum_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	確保済みのスロット数を取得する
+     */
+    [[nodiscard]] uint32_t capacity() const noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return static_cast<uint32_t>(slabs_.size()) * SlabNum;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	型ごとの共有プールを取得する
+     *
+     * 静的オブジェクトの破棄順序に依存せずに利用できるよう、共有プールはプロセス終了まで破棄しない
+     */
+    [[nodiscard]] static ObjectPool& shared() noexcept {
+        static auto* pool = new ObjectPool();
+        return *pool;
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	空きスロットを取得する（無ければスラブを追加する）
+     */
+    Slot* acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (!freeList_) {
+            // スラブを追加し、先頭のスロットから順に使われるようにフリーリストへ繋ぐ
+            auto& slab = slabs_.emplace_back(std::make_unique<Slot[]>(SlabNum));
+            for (uint32_t i = 0; i < SlabNum; ++i) {
+                slab[i].next_ = (i + 1 < SlabNum) ? &slab[i + 1] : nullptr;
+            }
+            freeList_ = &slab[0];
+        }
+
+        auto* slot = freeList_;
+        freeList_  = slot->next_;
+        liveNum_++;
+        return slot;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スロットを空きに戻す
+     * @param	slot		戻すスロット
+     */
+    void release(Slot* slot) noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        slot->next_ = freeList_;
+        freeList_   = slot;
+        liveNum_--;
+    }
+
+private:
+    mutable std::mutex                   mutex_{};     ///< 同期オブジェクト
+    Slot*                                freeList_{};  ///< 空きスロットの先頭
+    std::vector<std::unique_ptr<Slot[]>> slabs_{};     ///< スラブ
+    uint32_t                             liveNum_{};   ///< 生成中のオブジェクト数
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 共有プールへオブジェクトを返却するデリータ
+ */
+template <class T>
+struct PoolDeleter {
+    void operator()(T* p) const noexcept {
+        ObjectPool<T>::shared().destroy(p);
+    }
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	共有プールで生成したオブジェクトを保持するポインタ
+ */
+template <class T>
+using PoolPtr = std::unique_ptr<T, PoolDeleter<T>>;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	共有プールでオブジェクトを生成する
+ * @param	args		コンストラクタ引数
+ * @return	生成したオブジェクトを保持するポインタ
+ */
+template <class T, class... Args>
+[[nodiscard]] PoolPtr<T> makePooled(Args&&... args) {
+    return PoolPtr<T>(ObjectPool<T>::shared().create(std::forward<Args>(args)...));
+}
+
+}  // namespace utility
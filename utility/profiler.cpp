@@ -0,0 +1,687 @@
+﻿#include "profiler.h"
+
+#include <chrono>
+
+#include "utility/alloc_counter.h"
+#include "utility/cpu_feature.h"
+#include "utility/flight_recorder.h"
+#include "utility/job_system.h"
+#include "utility/ring_buffer.h"
+#include "utility/time_counter.h"
+#include "utility/trace_export.h"
+
+namespace {
+constexpr uint32_t ringCapacity = 8192;  ///< スレッドごとのイベントバッファ容量
+constexpr uint32_t drainNum     = 256;   ///< 1 回にまとめて回収するイベント数
+
+std::atomic<uint32_t> profilerSerial{};  ///< プロファイラの生成ごとに割り当てる番号
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	メモリタグごとの確保中サイズを記録するカウンタ名
+ */
+constexpr const char* memoryCounterNames[] = {
+    "Memory/Untagged",
+    "Memory/Texture",
+    "Memory/Mesh",
+    "Memory/Container",
+    "Memory/Log",
+    "Memory/Profiler",
+};
+static_assert(std::size(memoryCounterNames) == utility::alloc::memoryTagNum);
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	steady_clock のナノ秒を取得する
+ */
+uint64_t steadyNanosec() noexcept {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+}  // namespace
+
+namespace utility {
+
+namespace profiler {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	現在の時刻をプロファイラのティックで取得する
+ */
+uint64_t now() noexcept {
+#if defined(UTILITY_X64)
+    return __rdtsc();
+#else
+    return steadyNanosec();
+#endif
+}
+
+}  // namespace profiler
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * プロファイラのインプリメントクラス
+ */
+class Profiler::Impl {
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  イベントの種類
+     */
+    enum class EventType : uint8_t {
+        Begin,
+        End,
+        Counter,
+    };
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  イベント
+     */
+    struct Event {
+        uint64_t    time_{};   ///< 時刻（ティック）
+        const char* name_{};   ///< 名前（ End の場合は nullptr ）
+        double      value_{};  ///< カウンタの値
+        EventType   type_{};   ///< 種類
+    };
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  回収側で保持する実行中のスコープ
+     */
+    struct OpenScope {
+        const char* name_{};   ///< 名前
+        uint64_t    start_{};  ///< 開始時刻
+        int32_t     index_{};  ///< 構築中のフレームでのインデックス
+    };
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  スレッドごとの記録先
+     */
+    struct ThreadState {
+        SpscRingBuffer<Event, ringCapacity> ring_{};     ///< イベントバッファ
+        uint16_t                            index_{};    ///< スレッドインデックス
+        std::string                         name_{};     ///< スレッド名（ mutex_ で保護する）
+        uint32_t                            depth_{};    ///< 記録中のスコープの深さ（記録スレッドのみ）
+        uint32_t                            skip_{};     ///< 記録を見送ったスコープの深さ（記録スレッドのみ）
+        std::atomic<uint32_t>               dropped_{};  ///< 記録を見送ったスコープ数
+        std::vector<Event>                  pending_{};  ///< 回収したイベント（回収側のみ）
+        std::vector<OpenScope>              stack_{};    ///< 実行中のスコープ（回収側のみ）
+    };
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  トレースファイルへのキャプチャ
+     */
+    struct Capture {
+        TraceData             data_{};    ///< キャプチャしたデータ
+        uint32_t              remain_{};  ///< 残りのフレーム数
+        std::filesystem::path path_{};    ///< 出力先のファイルパス
+        TraceFormat           format_{};  ///< 出力形式
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    Impl()
+        : serial_(profilerSerial.fetch_add(1, std::memory_order_relaxed) + 1) {
+        calibrate();
+        frameStart_ = profiler::now();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スコープを開始する
+     * @param	name		スコープ名
+     */
+    void begin(const char* name) noexcept {
+        auto& state = local();
+
+        // 見送ったスコープの内側、または終了イベントを書き込む余裕がない場合は記録しない
+        const auto free = ringCapacity - state.ring_.size();
+        if (state.skip_ > 0 || !enabled_.load(std::memory_order_relaxed) || free < state.depth_ + 2) {
+            if (state.skip_ == 0 && enabled_.load(std::memory_order_relaxed)) {
+                state.dropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+            state.skip_++;
+            return;
+        }
+
+        state.ring_.push(Event{profiler::now(), name, 0.0, EventType::Begin});
+        state.depth_++;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スコープを終了する
+     */
+    void end() noexcept {
+        auto& state = local();
+        if (state.skip_ > 0) {
+            state.skip_--;
+            return;
+        }
+
+        // 開始時に空きを確保しているので失敗しない
+        state.ring_.push(Event{profiler::now(), nullptr, 0.0, EventType::End});
+        state.depth_--;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	カウンタの値を記録する
+     * @param	name		カウンタ名
+     * @param	value		値
+     */
+    void counter(const char* name, double value) noexcept {
+        auto& state = local();
+
+        const auto free = ringCapacity - state.ring_.size();
+        if (!enabled_.load(std::memory_order_relaxed) || free < state.depth_ + 2) {
+            return;
+        }
+        state.ring_.push(Event{profiler::now(), name, value, EventType::Counter});
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	呼び出しスレッドの名前を設定する
+     * @param	name		スレッド名
+     */
+    void setThreadName(std::string_view name) {
+        auto&                       state = local();
+        std::lock_guard<std::mutex> lock(mutex_);
+        state.name_ = name;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームを区切り、全スレッドのイベントを回収する
+     */
+    void markFrame() noexcept {
+        MEMORY_TAG(alloc::MemoryTag::Profiler);
+
+        // タグごとの確保中サイズとフレーム中の確保回数をカウンタとしてこのフレームに含める
+        if constexpr (alloc::enabled()) {
+            const auto snapshot = alloc::advanceFrame();
+            for (size_t i = 0; i < alloc::memoryTagNum; i++) {
+                counter(memoryCounterNames[i], static_cast<double>(snapshot.tags_[i].liveBytes_));
+            }
+            counter("Memory/FrameAllocNum", static_cast<double>(snapshot.total_.frameAllocNum_));
+        }
+
+        const auto frameEnd = profiler::now();
+
+        auto& frame = frames_[(frameIndex_ + 1) % frames_.size()];
+        frame.index_   = frameIndex_ + 1;
+        frame.start_   = frameStart_;
+        frame.end_     = frameEnd;
+        frame.dropped_ = 0;
+        frame.scopes_.clear();
+        frame.counters_.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& state : threads_) {
+                collect(*state, frame, frameEnd);
+            }
+        }
+
+        frameStart_ = frameEnd;
+        frameIndex_++;
+        updateCalibration();
+
+        // 平均時間の集計（ TIME_PRINT ）へ完了したスコープを渡す
+        recordTimes(frame);
+        FlightRecorder::instance().recordFrame(frame);
+
+        if (capturing_.load(std::memory_order_acquire)) {
+            capture(frame);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	記録の有効・無効を切り替える
+     * @param	enable		有効にする場合は true
+     */
+    void setEnabled(bool enable) noexcept {
+        enabled_.store(enable, std::memory_order_relaxed);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	直前に区切ったフレームの計測結果を取得する
+     */
+    const ProfileFrame& lastFrame() const noexcept {
+        return frames_[frameIndex_ % frames_.size()];
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	記録したことのあるスレッド数を取得する
+     */
+    uint32_t threadNum() const noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return static_cast<uint32_t>(threads_.size());
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スレッド名を取得する
+     * @param	index		スレッドインデックス
+     */
+    std::string threadName(uint32_t index) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index >= threads_.size()) {
+            return {};
+        }
+        return threads_[index]->name_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	完了したスコープの処理時間を TimeContainer のヒストグラムに記録する
+     *
+     * スコープ名のポインタからヒストグラムへの対応を保持し、既知の名前は文字列の比較も TimeContainer のロックも行わない
+     * TimeContainer の世代が変わった（ remove された）場合は、破棄されたヒストグラムを参照しないよう対応を作り直す
+     * @param	frame		区切ったフレーム
+     */
+    void recordTimes(const ProfileFrame& frame) {
+        auto& container = TIME_CONTAINER();
+        if (const auto generation = container.generation(); generation != timeGeneration_) {
+            histograms_.clear();
+            timeGeneration_ = generation;
+        }
+
+        for (const auto& scope : frame.scopes_) {
+            if (scope.clipped_) {
+                continue;
+            }
+            auto*& histogram = histograms_[scope.name_];
+            if (!histogram) {
+                histogram = &container.histogram(scope.name_);
+            }
+            histogram->record(static_cast<uint64_t>(toMicrosec(scope.end_ - scope.start_) * 1000.0));
+        }
+        container.advanceFrame();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ティックをマイクロ秒に変換する
+     * @param	ticks		ティック
+     * @return	マイクロ秒
+     */
+    double toMicrosec(uint64_t ticks) const noexcept {
+        return static_cast<double>(ticks) * microsecPerTick_.load(std::memory_order_relaxed);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	次のフレームから指定フレーム数をキャプチャしてトレースファイルに出力する
+     * @param	frameNum	キャプチャするフレーム数
+     * @param	path		出力先のファイルパス
+     * @param	format		出力形式
+     * @return	開始できた場合は true
+     */
+    bool startCapture(uint32_t frameNum, const std::filesystem::path& path, TraceFormat format) {
+        if (frameNum == 0) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(captureMutex_);
+        if (capture_) {
+            TRACE("キャプチャ中のため開始できません : %s", path.string().c_str());
+            return false;
+        }
+
+        capture_          = std::make_unique<Capture>();
+        capture_->remain_ = frameNum;
+        capture_->path_   = path;
+        capture_->format_ = format;
+        capture_->data_.frames_.reserve(frameNum);
+        capturing_.store(true, std::memory_order_release);
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キャプチャ中か否かを取得する
+     */
+    bool isCapturing() const noexcept {
+        return capturing_.load(std::memory_order_acquire);
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	区切ったフレームをキャプチャに追加し、指定フレーム数に達したらファイルに出力する
+     * @param	frame		区切ったフレーム
+     */
+    void capture(const ProfileFrame& frame) {
+        std::unique_ptr<Capture> done;
+        {
+            std::lock_guard<std::mutex> lock(captureMutex_);
+            if (!capture_) {
+                return;
+            }
+            capture_->data_.frames_.push_back(frame);
+            if (--capture_->remain_ > 0) {
+                return;
+            }
+            done = std::move(capture_);
+            capturing_.store(false, std::memory_order_release);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& state : threads_) {
+                done->data_.threadNames_.push_back(state->name_);
+            }
+        }
+        done->data_.microsecPerTick_ = microsecPerTick_.load(std::memory_order_relaxed);
+
+        // 変換と書き込みはフレームを止めないようにジョブで行う（ワーカーが無い場合は即時実行される）
+        std::shared_ptr<Capture> shared(std::move(done));
+        JobSystem::instance().run([shared]() {
+            PROFILE_SCOPE("Profiler::writeTrace");
+            if (writeTrace(shared->path_, shared->data_, shared->format_)) {
+                TRACE("トレースを出力しました : %s", shared->path_.string().c_str());
+            }
+        });
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	呼び出しスレッドの記録先を取得する（初回のみ登録する）
+     */
+    ThreadState& local() {
+        thread_local ThreadState* cache       = nullptr;
+        thread_local uint32_t     cacheSerial = 0;
+
+        if (cacheSerial != serial_) {
+            MEMORY_TAG(alloc::MemoryTag::Profiler);
+            auto state = std::make_unique<ThreadState>();
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            state->index_ = static_cast<uint16_t>(threads_.size());
+            state->name_  = "Thread " + std::to_string(state->index_);
+            cache         = state.get();
+            cacheSerial   = serial_;
+            threads_.emplace_back(std::move(state));
+        }
+        return *cache;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スレッドのイベントを回収してフレームに格納する
+     * @param	state		回収するスレッド
+     * @param	frame		格納先のフレーム
+     * @param	frameEnd	フレームの終了時刻（以降のイベントは次のフレームに回す）
+     */
+    void collect(ThreadState& state, ProfileFrame& frame, uint64_t frameEnd) noexcept {
+        auto& stack = state.stack_;
+
+        // 前のフレームから続くスコープを先頭に置き直す
+        for (size_t i = 0; i < stack.size(); i++) {
+            const auto parent = (i == 0) ? -1 : stack[i - 1].index_;
+            stack[i].index_   = pushScope(frame, state, stack[i].name_, stack[i].start_, parent, i);
+        }
+
+        // リングバッファのイベントを前回の残りの後ろにすべて回収する
+        auto& events = state.pending_;
+        while (true) {
+            const auto size = events.size();
+            events.resize(size + drainNum);
+            const auto num = state.ring_.popBatch(events.data() + size, drainNum);
+            events.resize(size + num);
+            if (num == 0) {
+                break;
+            }
+        }
+
+        // フレーム終了時刻までのイベントを処理し、以降は次のフレームに回す（スレッド内では時刻順に並んでいる）
+        size_t processed = 0;
+        for (; processed < events.size() && events[processed].time_ <= frameEnd; processed++) {
+            const auto& event = events[processed];
+            switch (event.type_) {
+                case EventType::Begin: {
+                    const auto parent = stack.empty() ? -1 : stack.back().index_;
+                    const auto index  = pushScope(frame, state, event.name_, event.time_, parent, stack.size());
+                    stack.push_back({event.name_, event.time_, index});
+                    break;
+                }
+                case EventType::End:
+                    if (!stack.empty()) {
+                        frame.scopes_[stack.back().index_].end_ = event.time_;
+                        stack.pop_back();
+                    }
+                    break;
+                case EventType::Counter:
+                    frame.counters_.push_back({event.name_, event.time_, event.value_, state.index_});
+                    break;
+            }
+        }
+        events.erase(events.begin(), events.begin() + processed);
+
+        // 終了していないスコープはフレーム終端で打ち切る
+        for (const auto& open : stack) {
+            auto& scope    = frame.scopes_[open.index_];
+            scope.end_     = frameEnd;
+            scope.clipped_ = true;
+        }
+
+        frame.dropped_ += state.dropped_.exchange(0, std::memory_order_relaxed);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームにスコープを追加する
+     * @param	frame		追加先のフレーム
+     * @param	state		スコープを記録したスレッド
+     * @param	name		スコープ名
+     * @param	start		開始時刻
+     * @param	parent		親スコープのインデックス
+     * @param	depth		階層の深さ
+     * @return	追加したスコープのインデックス
+     */
+    int32_t pushScope(ProfileFrame& frame, const ThreadState& state, const char* name, uint64_t start, int32_t parent, size_t depth) noexcept {
+        ProfileFrame::Scope scope{};
+        scope.name_   = name;
+        scope.start_  = start;
+        scope.parent_ = parent;
+        scope.depth_  = static_cast<uint16_t>(depth);
+        scope.thread_ = state.index_;
+
+        frame.scopes_.push_back(scope);
+        return static_cast<int32_t>(frame.scopes_.size() - 1);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ティックと時間の比率を求める（起動時に短時間だけ計測する）
+     */
+    void calibrate() noexcept {
+        baseTick_ = profiler::now();
+        baseNano_ = steadyNanosec();
+#if defined(UTILITY_X64)
+        // 2 ミリ秒程度計測して初期値とし、以降はフレームごとに計測期間を伸ばして精度を上げる
+        while (steadyNanosec() - baseNano_ < 2'000'000) {
+        }
+#endif
+        updateCalibration();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	起動時からの経過時間でティックと時間の比率を更新する
+     */
+    void updateCalibration() noexcept {
+#if defined(UTILITY_X64)
+        const auto ticks = profiler::now() - baseTick_;
+        const auto nano  = steadyNanosec() - baseNano_;
+        if (ticks > 0 && nano > 0) {
+            microsecPerTick_.store(static_cast<double>(nano) / 1000.0 / static_cast<double>(ticks), std::memory_order_relaxed);
+        }
+#else
+        microsecPerTick_.store(1.0 / 1000.0, std::memory_order_relaxed);
+#endif
+    }
+
+private:
+    const uint32_t                            serial_;             ///< プロファイラの識別番号
+    mutable std::mutex                        mutex_{};            ///< スレッド登録の同期オブジェクト
+    std::vector<std::unique_ptr<ThreadState>> threads_{};          ///< スレッドごとの記録先
+    std::atomic<bool>                         enabled_{true};      ///< 記録が有効か否か
+    std::array<ProfileFrame, 2>               frames_{};           ///< 構築中と直前のフレーム
+    uint64_t                                  frameIndex_{};       ///< 直前に区切ったフレーム番号
+    uint64_t                                  frameStart_{};       ///< 構築中のフレームの開始時刻
+    uint64_t                                  baseTick_{};         ///< 比率計算の基準ティック
+    uint64_t                                  baseNano_{};         ///< 比率計算の基準時刻
+    std::atomic<double>                       microsecPerTick_{};  ///< 1 ティックあたりのマイクロ秒
+    std::mutex                                captureMutex_{};     ///< キャプチャの同期オブジェクト
+    std::unique_ptr<Capture>                  capture_{};          ///< 実行中のキャプチャ
+    std::atomic<bool>                         capturing_{};        ///< キャプチャ中か否か
+    FlatMap<const char*, Histogram*>          histograms_{};       ///< スコープ名からヒストグラムへの対応（ markFrame のみ）
+    uint64_t                                  timeGeneration_{};   ///< histograms_ を作成した時の TimeContainer の世代
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ
+ */
+Profiler::~Profiler() {
+    impl_.reset();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	スコープを開始する
+ * @param	name		スコープ名
+ */
+void Profiler::begin(const char* name) noexcept {
+    impl_->begin(name);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	スコープを開始する
+ * @param	name		スコープ名
+ */
+void Profiler::begin(const HashedString& name) noexcept {
+    const auto str = name.name();
+    impl_->begin(str.empty() ? "(unknown)" : str.data());
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	スコープを終了する
+ */
+void Profiler::end() noexcept {
+    impl_->end();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	カウンタの値を記録する
+ * @param	name		カウンタ名
+ * @param	value		値
+ */
+void Profiler::counter(const char* name, double value) noexcept {
+    impl_->counter(name, value);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	呼び出しスレッドの名前を設定する
+ * @param	name		スレッド名
+ */
+void Profiler::setThreadName(std::string_view name) {
+    impl_->setThreadName(name);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームを区切り、全スレッドのイベントを回収する
+ */
+void Profiler::markFrame() noexcept {
+    impl_->markFrame();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	記録の有効・無効を切り替える
+ * @param	enable		有効にする場合は true
+ */
+void Profiler::setEnabled(bool enable) noexcept {
+    impl_->setEnabled(enable);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	直前に区切ったフレームの計測結果を取得する
+ */
+const ProfileFrame& Profiler::lastFrame() const noexcept {
+    return impl_->lastFrame();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	記録したことのあるスレッド数を取得する
+ */
+uint32_t Profiler::threadNum() const noexcept {
+    return impl_->threadNum();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	スレッド名を取得する
+ * @param	index		スレッドインデックス
+ */
+std::string Profiler::threadName(uint32_t index) const {
+    return impl_->threadName(index);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ティックをマイクロ秒に変換する
+ * @param	ticks		ティック
+ * @return	マイクロ秒
+ */
+double Profiler::toMicrosec(uint64_t ticks) const noexcept {
+    return impl_->toMicrosec(ticks);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	次のフレームから指定フレーム数をキャプチャしてトレースファイルに出力する
+ * @param	frameNum	キャプチャするフレーム数
+ * @param	path		出力先のファイルパス
+ * @param	format		出力形式
+ * @return	開始できた場合は true
+ */
+bool Profiler::startCapture(uint32_t frameNum, const std::filesystem::path& path, TraceFormat format) {
+    return impl_->startCapture(frameNum, path, format);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	キャプチャ中か否かを取得する
+ */
+bool Profiler::isCapturing() const noexcept {
+    return impl_->isCapturing();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ */
+Profiler::Profiler() {
+    impl_.reset(new Profiler::Impl());
+}
+}  // namespace utility
@@ -0,0 +1,225 @@
+﻿#pragma once
+
+#include <atomic>
+
+#include "utility/hashed_string.h"
+#include "utility/noncopyable.h"
+#include "utility/singleton.h"
+
+namespace utility {
+
+enum class TraceFormat : uint8_t;
+
+namespace profiler {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	現在の時刻をプロファイラのティックで取得する
+ *
+ * x64 では rdtsc 、それ以外では steady_clock のナノ秒を利用する
+ */
+[[nodiscard]] uint64_t now() noexcept;
+
+}  // namespace profiler
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 1 フレーム分の計測結果
+ *
+ * スコープはフレーム内で記録されたもの（フレームをまたぐものは終端で打ち切ったもの）をスレッドごとに開始順で格納する
+ */
+struct ProfileFrame {
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  スコープ
+     */
+    struct Scope {
+        const char* name_{};     ///< 名前
+        uint64_t    start_{};    ///< 開始時刻（ティック）
+        uint64_t    end_{};      ///< 終了時刻（ティック）
+        int32_t     parent_{};   ///< 親スコープのインデックス（無い場合は -1 ）
+        uint16_t    depth_{};    ///< 階層の深さ
+        uint16_t    thread_{};   ///< スレッドインデックス
+        bool        clipped_{};  ///< フレーム終端で打ち切ったか否か（次のフレームに続きがある）
+    };
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  カウンタ
+     */
+    struct Counter {
+        const char* name_{};    ///< 名前
+        uint64_t    time_{};    ///< 時刻（ティック）
+        double      value_{};   ///< 値
+        uint16_t    thread_{};  ///< スレッドインデックス
+    };
+
+    uint64_t             index_{};     ///< フレーム番号
+    uint64_t             start_{};     ///< 開始時刻（ティック）
+    uint64_t             end_{};       ///< 終了時刻（ティック）
+    uint32_t             dropped_{};   ///< バッファ不足で記録できなかったスコープ数
+    std::vector<Scope>   scopes_{};    ///< スコープ
+    std::vector<Counter> counters_{};  ///< カウンタ
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 階層型 CPU プロファイラ
+ *
+ * 各スレッドはロック無しで自身のリングバッファにイベントを記録する
+ * フレーム終端で markFrame を呼び出すと、全スレッドのイベントを回収してフレームごとのスコープ階層を構築する
+ * スコープ名は文字列リテラルかインターン済みの文字列（ HashedString ）であること（ポインタのみを記録する）
+ */
+class Profiler final : public Singleton<Profiler> {
+private:
+    friend class Singleton<Profiler>;
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~Profiler();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スコープを開始する
+     * @param	name		スコープ名（文字列リテラルなどプロセス終了まで有効な文字列）
+     */
+    void begin(const char* name) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スコープを開始する
+     * @param	name		スコープ名
+     */
+    void begin(const HashedString& name) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スコープを終了する
+     */
+    void end() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	カウンタの値を記録する
+     * @param	name		カウンタ名（文字列リテラルなどプロセス終了まで有効な文字列）
+     * @param	value		値
+     */
+    void counter(const char* name, double value) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	呼び出しスレッドの名前を設定する
+     * @param	name		スレッド名
+     */
+    void setThreadName(std::string_view name);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームを区切り、全スレッドのイベントを回収する
+     *
+     * フレーム終端で 1 つのスレッドから呼び出すこと
+     */
+    void markFrame() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	記録の有効・無効を切り替える（実行中のスコープは終了まで記録する）
+     * @param	enable		有効にする場合は true
+     */
+    void setEnabled(bool enable) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	直前に区切ったフレームの計測結果を取得する（次の markFrame まで有効）
+     */
+    [[nodiscard]] const ProfileFrame& lastFrame() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	記録したことのあるスレッド数を取得する
+     */
+    [[nodiscard]] uint32_t threadNum() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スレッド名を取得する
+     * @param	index		スレッドインデックス
+     */
+    [[nodiscard]] std::string threadName(uint32_t index) const;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ティックをマイクロ秒に変換する
+     * @param	ticks		ティック
+     * @return	マイクロ秒
+     */
+    [[nodiscard]] double toMicrosec(uint64_t ticks) const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	次のフレームから指定フレーム数をキャプチャしてトレースファイルに出力する
+     *
+     * 指定フレーム数を区切った後、ファイルの書き込みはジョブシステムで行う
+     * @param	frameNum	キャプチャするフレーム数
+     * @param	path		出力先のファイルパス
+     * @param	format		出力形式
+     * @return	開始できた場合は true （キャプチャ中の場合は false ）
+     */
+    bool startCapture(uint32_t frameNum, const std::filesystem::path& path, TraceFormat format);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	キャプチャ中か否かを取得する
+     */
+    [[nodiscard]] bool isCapturing() const noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    Profiler();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;  ///< インプリメントクラスポインタ
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * スコープの開始と終了を記録する
+ */
+class ProfileScope final : Noncopyable {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ（スコープ開始）
+     * @param	name		スコープ名
+     */
+    template <class Name>
+    explicit ProfileScope(const Name& name) noexcept {
+        Profiler::instance().begin(name);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ（スコープ終了）
+     */
+    ~ProfileScope() {
+        Profiler::instance().end();
+    }
+};
+
+}  // namespace utility
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) utility::ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) utility::Profiler::instance().counter(name, static_cast<double>(value))
+#define PROFILE_FRAME() utility::Profiler::instance().markFrame()
@@ -0,0 +1,336 @@
+﻿#include "range_allocator.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+constexpr uint32_t mantissaBits = 3;                         ///< 2 のべき乗ごとの分割数のビット数
+constexpr uint32_t mantissaMask = (1u << mantissaBits) - 1;  ///< 分割位置のマスク
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	個数を切り下げてビンに変換する（空き領域の登録先）
+ *
+ * 上位 3 ビットを仮数とした浮動小数点数のように扱い、 8 未満はそのままビンとする
+ */
+uint32_t binRoundDown(uint32_t num) noexcept {
+    if (num <= mantissaMask) {
+        return num;
+    }
+    const auto shift = static_cast<uint32_t>(std::bit_width(num)) - 1 - mantissaBits;
+    return ((shift + 1) << mantissaBits) + ((num >> shift) & mantissaMask);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	個数を切り上げてビンに変換する（確保時の検索開始位置、そのビンの空き領域は必ず num 以上）
+ */
+uint32_t binRoundUp(uint32_t num) noexcept {
+    if (num <= mantissaMask) {
+        return num;
+    }
+    const auto shift = static_cast<uint32_t>(std::bit_width(num)) - 1 - mantissaBits;
+    const auto bin   = ((shift + 1) << mantissaBits) + ((num >> shift) & mantissaMask);
+    return (num & ((1u << shift) - 1)) ? bin + 1 : bin;
+}
+}  // namespace
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	コンストラクタ
+ * @param	capacity	管理する範囲の大きさ
+ */
+RangeAllocator::RangeAllocator(uint32_t capacity) {
+    reset(capacity);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	すべての確保を破棄して初期状態に戻す
+ * @param	capacity	管理する範囲の大きさ
+ */
+void RangeAllocator::reset(uint32_t capacity) {
+    nodes_.clear();
+    freeNodes_.clear();
+    pending_.clear();
+    std::fill(std::begin(binHeads_), std::end(binHeads_), noNode);
+    std::fill(std::begin(leafMask_), std::end(leafMask_), uint8_t(0));
+    topMask_  = 0;
+    capacity_ = capacity;
+    freeNum_  = capacity;
+
+    if (capacity > 0) {
+        insertFree(createNode(0, capacity, noNode, noNode));
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	連続した範囲を確保する
+ *
+ * 先頭をそろえるために空いた手前の領域は空きのまま残す
+ * @param	num			個数
+ * @param	alignment	先頭のアライメント（ 2 のべき乗）
+ * @return	確保した範囲（空きが無い場合は valid() が false ）
+ */
+RangeAllocator::Allocation RangeAllocator::allocate(uint32_t num, uint32_t alignment) {
+    ASSERT(num > 0, "0 個は確保できません");
+    ASSERT(std::has_single_bit(alignment), "アライメントは 2 のべき乗で指定してください");
+    if (num == 0 || num > freeNum_ || !std::has_single_bit(alignment)) {
+        return {};
+    }
+
+    // 余白を含めて必ず足りる個数（範囲外になる場合は線形に探す）
+    const auto worstNum = static_cast<uint64_t>(num) + alignment - 1;
+
+    // 切り上げたビン以降なら先頭の空き領域で必ず足りる
+    auto index = noNode;
+    auto bin   = worstNum <= capacity_ ? findBin(binRoundUp(static_cast<uint32_t>(worstNum))) : binNum;
+    if (bin < binNum) {
+        index = binHeads_[bin];
+    } else {
+        // 足りる領域がより小さいビンにしか無い場合（ほぼ満杯の時）は線形に探す
+        for (bin = findBin(binRoundDown(num)); bin < binNum && index == noNode; bin = findBin(bin + 1)) {
+            for (auto i = binHeads_[bin]; i != noNode; i = nodes_[i].binNext_) {
+                if (nodes_[i].num_ >= num + alignPadding(i, alignment)) {
+                    index = i;
+                    break;
+                }
+            }
+        }
+        if (index == noNode) {
+            return {};
+        }
+    }
+
+    removeFree(index);
+    nodes_[index].used_ = true;
+
+    // アライメントの余白は直前の空き領域として分割する（元が空き領域なので直前は使用中で結合は不要）
+    if (const auto padding = alignPadding(index, alignment); padding > 0) {
+        const auto prev    = nodes_[index].physPrev_;
+        const auto leading = createNode(nodes_[index].offset_, padding, prev, index);
+        if (prev != noNode) {
+            nodes_[prev].physNext_ = leading;
+        }
+        nodes_[index].physPrev_  = leading;
+        nodes_[index].offset_   += padding;
+        nodes_[index].num_      -= padding;
+        insertFree(leading);
+    }
+
+    // 余りは直後の空き領域として分割する
+    if (const auto rest = nodes_[index].num_ - num; rest > 0) {
+        const auto next      = nodes_[index].physNext_;
+        const auto remainder = createNode(nodes_[index].offset_ + num, rest, index, next);
+        if (next != noNode) {
+            nodes_[next].physPrev_ = remainder;
+        }
+        nodes_[index].physNext_ = remainder;
+        nodes_[index].num_      = num;
+        insertFree(remainder);
+    }
+
+    freeNum_ -= num;
+    return {nodes_[index].offset_, num, index};
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	範囲を即座に解放する
+ * @param	allocation	allocate で確保した範囲
+ */
+void RangeAllocator::free(const Allocation& allocation) noexcept {
+    if (!allocation.valid()) {
+        return;
+    }
+
+    const auto index = allocation.node_;
+    ASSERT(index < nodes_.size() && nodes_[index].used_ && nodes_[index].offset_ == allocation.offset_, "確保されていない範囲を解放しようとしました");
+
+    auto& node  = nodes_[index];
+    node.used_  = false;
+    freeNum_   += node.num_;
+
+    // 前後が空いていれば結合する
+    if (const auto prev = node.physPrev_; prev != noNode && !nodes_[prev].used_) {
+        removeFree(prev);
+        node.offset_   = nodes_[prev].offset_;
+        node.num_     += nodes_[prev].num_;
+        node.physPrev_ = nodes_[prev].physPrev_;
+        if (node.physPrev_ != noNode) {
+            nodes_[node.physPrev_].physNext_ = index;
+        }
+        releaseNode(prev);
+    }
+    if (const auto next = node.physNext_; next != noNode && !nodes_[next].used_) {
+        removeFree(next);
+        node.num_     += nodes_[next].num_;
+        node.physNext_ = nodes_[next].physNext_;
+        if (node.physNext_ != noNode) {
+            nodes_[node.physNext_].physPrev_ = index;
+        }
+        releaseNode(next);
+    }
+
+    insertFree(index);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フェンスの完了後に範囲を解放する
+ * @param	allocation	allocate で確保した範囲
+ * @param	fenceValue	範囲を参照するコマンドの完了時にシグナルされるフェンス値（前後してもよい）
+ */
+void RangeAllocator::free(const Allocation& allocation, uint64_t fenceValue) {
+    if (!allocation.valid()) {
+        return;
+    }
+
+    // 解放する側が複数あるとフェンス値は前後するので、フェンス値の順に挿入する（ほとんどは末尾への追加になる）
+    const auto it = std::upper_bound(pending_.begin(), pending_.end(), fenceValue, [](uint64_t value, const Pending& p) { return value < p.fenceValue_; });
+    pending_.insert(it, {allocation, fenceValue});
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フェンスが完了した遅延解放の範囲を解放する
+ * @param	completedValue	完了済みのフェンス値
+ * @return	解放した範囲の数
+ */
+uint32_t RangeAllocator::reclaim(uint64_t completedValue) noexcept {
+    uint32_t count = 0;
+    while (!pending_.empty() && pending_.front().fenceValue_ <= completedValue) {
+        free(pending_.front().allocation_);
+        pending_.pop_front();
+        count++;
+    }
+    return count;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	一度に確保できる最大の個数を取得する
+ */
+uint32_t RangeAllocator::largestFree() const noexcept {
+    if (topMask_ == 0) {
+        return 0;
+    }
+
+    // 最も大きいビンの中から探す
+    const auto top = static_cast<uint32_t>(std::bit_width(topMask_)) - 1;
+    const auto bin = (top << mantissaBits) | (static_cast<uint32_t>(std::bit_width(leafMask_[top])) - 1);
+
+    uint32_t result = 0;
+    for (auto i = binHeads_[bin]; i != noNode; i = nodes_[i].binNext_) {
+        result = std::max(result, nodes_[i].num_);
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	管理ノードを取得する
+ * @return	ノードのインデックス
+ */
+uint32_t RangeAllocator::createNode(uint32_t offset, uint32_t num, uint32_t physPrev, uint32_t physNext) {
+    uint32_t index;
+    if (!freeNodes_.empty()) {
+        index = freeNodes_.back();
+        freeNodes_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+        // 解放時（ noexcept ）に再確保しないよう、戻し先はノード数分を確保しておく
+        freeNodes_.reserve(nodes_.capacity());
+    }
+
+    auto& node     = nodes_[index];
+    node           = {};
+    node.offset_   = offset;
+    node.num_      = num;
+    node.physPrev_ = physPrev;
+    node.physNext_ = physNext;
+    return index;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	管理ノードを再利用のために戻す
+ */
+void RangeAllocator::releaseNode(uint32_t index) noexcept {
+    freeNodes_.push_back(index);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	空きノードをビンに追加する
+ */
+void RangeAllocator::insertFree(uint32_t index) noexcept {
+    const auto bin  = binRoundDown(nodes_[index].num_);
+    auto&      node = nodes_[index];
+    node.binPrev_   = noNode;
+    node.binNext_   = binHeads_[bin];
+    if (node.binNext_ != noNode) {
+        nodes_[node.binNext_].binPrev_ = index;
+    }
+    binHeads_[bin] = index;
+
+    leafMask_[bin >> mantissaBits] |= static_cast<uint8_t>(1u << (bin & mantissaMask));
+    topMask_ |= 1u << (bin >> mantissaBits);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	空きノードをビンから外す
+ */
+void RangeAllocator::removeFree(uint32_t index) noexcept {
+    const auto  bin  = binRoundDown(nodes_[index].num_);
+    const auto& node = nodes_[index];
+    if (node.binPrev_ != noNode) {
+        nodes_[node.binPrev_].binNext_ = node.binNext_;
+    } else {
+        binHeads_[bin] = node.binNext_;
+    }
+    if (node.binNext_ != noNode) {
+        nodes_[node.binNext_].binPrev_ = node.binPrev_;
+    }
+
+    if (binHeads_[bin] == noNode) {
+        const auto top = bin >> mantissaBits;
+        leafMask_[top] &= static_cast<uint8_t>(~(1u << (bin & mantissaMask)));
+        if (leafMask_[top] == 0) {
+            topMask_ &= ~(1u << top);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	指定ビン以降で空きノードのある最初のビンを探す
+ * @return	ビン（無い場合は binNum ）
+ */
+uint32_t RangeAllocator::findBin(uint32_t bin) const noexcept {
+    const auto top = bin >> mantissaBits;
+    if (top >= topNum) {
+        return binNum;
+    }
+
+    // 同じ 2 のべき乗の中で探す
+    const auto leaf = leafMask_[top] & (0xffu << (bin & mantissaMask));
+    if (leaf != 0) {
+        return (top << mantissaBits) | static_cast<uint32_t>(std::countr_zero(leaf));
+    }
+
+    // より大きい 2 のべき乗の中で探す
+    const auto upper = (top + 1 < topNum) ? topMask_ & (~0u << (top + 1)) : 0u;
+    if (upper == 0) {
+        return binNum;
+    }
+    const auto next = static_cast<uint32_t>(std::countr_zero(upper));
+    return (next << mantissaBits) | static_cast<uint32_t>(std::countr_zero(leafMask_[next]));
+}
+
+}  // namespace utility
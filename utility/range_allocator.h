@@ -0,0 +1,210 @@
+﻿#pragma once
+
+#include <deque>
+
+#include "utility/noncopyable.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 連続した範囲の割り当て
+ *
+ * [ 0, capacity ) の整数範囲から指定数の連続領域を確保する（ディスクリプタヒープのインデックスなど）
+ * 空き領域は大きさごとのビン（ 2 のべき乗を 8 分割）で管理し、ビットマップで空きビンを探すので確保と解放は O(1)
+ * 解放時は前後の空き領域と結合する
+ *
+ * GPU が参照中の領域を上書きしないよう、フェンス値を指定した遅延解放を行える
+ * 遅延解放した領域は reclaim に完了済みのフェンス値を渡すまで再利用されない
+ *
+ * スレッドセーフではない
+ */
+class RangeAllocator final : Noncopyable {
+public:
+    static constexpr uint32_t invalidOffset = ~0u;  ///< 確保に失敗したことを表す値
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  確保した範囲
+     */
+    struct Allocation {
+        uint32_t offset_{invalidOffset};  ///< 先頭
+        uint32_t num_{};                  ///< 個数
+        uint32_t node_{invalidOffset};    ///< 管理ノード（解放に利用する）
+
+        //---------------------------------------------------------------------------------
+        /**
+         * @brief	確保に成功しているか否か
+         */
+        [[nodiscard]] bool valid() const noexcept {
+            return offset_ != invalidOffset;
+        }
+    };
+
+private:
+    static constexpr uint32_t leafNum = 8;                 ///< 2 のべき乗ごとのビン数（上位 3 ビットで分割する）
+    static constexpr uint32_t topNum  = 32;                ///< 2 のべき乗の段数
+    static constexpr uint32_t binNum  = topNum * leafNum;  ///< ビン数
+    static constexpr uint32_t noNode  = ~0u;               ///< ノードが無いことを表す値
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  領域の管理ノード
+     */
+    struct Node {
+        uint32_t offset_{};          ///< 先頭
+        uint32_t num_{};             ///< 個数
+        uint32_t binPrev_{noNode};   ///< 同じビンの前の空きノード
+        uint32_t binNext_{noNode};   ///< 同じビンの次の空きノード
+        uint32_t physPrev_{noNode};  ///< 直前の領域
+        uint32_t physNext_{noNode};  ///< 直後の領域
+        bool     used_{};            ///< 使用中か否か
+    };
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  遅延解放待ちの領域
+     */
+    struct Pending {
+        Allocation allocation_{};  ///< 解放する範囲
+        uint64_t   fenceValue_{};  ///< 完了を待つフェンス値
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     * @param	capacity	管理する範囲の大きさ
+     */
+    explicit RangeAllocator(uint32_t capacity = 0);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~RangeAllocator() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	すべての確保を破棄して初期状態に戻す
+     * @param	capacity	管理する範囲の大きさ
+     */
+    void reset(uint32_t capacity);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	連続した範囲を確保する
+     *
+     * 先頭をそろえるために空いた手前の領域は空きのまま残す
+     * @param	num			個数
+     * @param	alignment	先頭のアライメント（ 2 のべき乗）
+     * @return	確保した範囲（空きが無い場合は valid() が false ）
+     */
+    [[nodiscard]] Allocation allocate(uint32_t num, uint32_t alignment = 1);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	範囲を即座に解放する
+     * @param	allocation	allocate で確保した範囲
+     */
+    void free(const Allocation& allocation) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フェンスの完了後に範囲を解放する
+     * @param	allocation	allocate で確保した範囲
+     * @param	fenceValue	範囲を参照するコマンドの完了時にシグナルされるフェンス値（前後してもよい）
+     */
+    void free(const Allocation& allocation, uint64_t fenceValue);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フェンスが完了した遅延解放の範囲を解放する
+     * @param	completedValue	完了済みのフェンス値
+     * @return	解放した範囲の数
+     */
+    uint32_t reclaim(uint64_t completedValue) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	管理する範囲の大きさを取得する
+     */
+    [[nodiscard]] uint32_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	空いている個数の合計を取得する（遅延解放待ちは含まない）
+     */
+    [[nodiscard]] uint32_t freeNum() const noexcept {
+        return freeNum_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	遅延解放待ちの範囲の数を取得する
+     */
+    [[nodiscard]] uint32_t pendingNum() const noexcept {
+        return static_cast<uint32_t>(pending_.size());
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	一度に確保できる最大の個数を取得する
+     */
+    [[nodiscard]] uint32_t largestFree() const noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	管理ノードを取得する
+     * @return	ノードのインデックス
+     */
+    uint32_t createNode(uint32_t offset, uint32_t num, uint32_t physPrev, uint32_t physNext);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	管理ノードを再利用のために戻す
+     */
+    void releaseNode(uint32_t index) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	空きノードをビンに追加する
+     */
+    void insertFree(uint32_t index) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	空きノードをビンから外す
+     */
+    void removeFree(uint32_t index) noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	指定ビン以降で空きノードのある最初のビンを探す
+     * @return	ビン（無い場合は binNum ）
+     */
+    uint32_t findBin(uint32_t bin) const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	空きノードの先頭をアライメントにそろえた場合の手前の余白を取得する
+     */
+    uint32_t alignPadding(uint32_t index, uint32_t alignment) const noexcept {
+        return (alignment - (nodes_[index].offset_ & (alignment - 1))) & (alignment - 1);
+    }
+
+private:
+    std::vector<Node>     nodes_{};             ///< 管理ノード
+    std::vector<uint32_t> freeNodes_{};         ///< 再利用できる管理ノード
+    uint32_t              binHeads_[binNum]{};  ///< ビンごとの先頭の空きノード
+    uint8_t               leafMask_[topNum]{};  ///< 2 のべき乗ごとの空きビンのビットマスク
+    uint32_t              topMask_{};           ///< 空きビンのある 2 のべき乗のビットマスク
+    uint32_t              capacity_{};          ///< 管理する範囲の大きさ
+    uint32_t              freeNum_{};           ///< 空いている個数の合計
+    std::deque<Pending>   pending_{};           ///< 遅延解放待ちの範囲（フェンス値の順）
+};
+}  // namespace utility
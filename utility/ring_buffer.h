@@ -0,0 +1,540 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "utility/noncopyable.h"
+
+namespace utility {
+
+namespace detail {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * リングバッファの空き／データ待ちを通知する
+ *
+ * 待機スレッドがいない場合の通知はフェンス 1 回で済む
+ */
+class RingSignal final : Noncopyable {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	処理が成功するまで待機する
+     * @param	tryFunc		処理（成功した場合に true を返す）
+     */
+    template <class Func>
+    void wait(Func&& tryFunc) {
+        while (!tryFunc()) {
+            const auto epoch = epoch_.load(std::memory_order_acquire);
+
+            // 待機を登録してから再確認し、通知側との行き違いを防ぐ
+            waitNum_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (tryFunc()) {
+                waitNum_.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+
+            epoch_.wait(epoch, std::memory_order_acquire);
+            waitNum_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	待機しているスレッドを起こす
+     */
+    void notify() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waitNum_.load(std::memory_order_relaxed) > 0) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            epoch_.notify_all();
+        }
+    }
+
+private:
+    std::atomic<uint32_t> epoch_{};    ///< 通知のたびに進める値
+    std::atomic<uint32_t> waitNum_{};  ///< 待機しているスレッド数
+};
+}  // namespace detail
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 単一生産者・単一消費者のロックフリーリングバッファ
+ *
+ * 生産者と消費者の書き込む変数はキャッシュラインを分け、相手側のインデックスはキャッシュして読み込みを減らす
+ * T はデフォルト構築とムーブ代入ができること
+ */
+template <class T, uint32_t Capacity>
+class SpscRingBuffer final : Noncopyable {
+public:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "容量は 2 のべき乗で指定してください");
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    SpscRingBuffer() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~SpscRingBuffer() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素を追加する（生産者スレッドのみ）
+     * @param	value		追加する要素
+     * @return	満杯で追加できなかった場合は false
+     */
+    template <class U>
+    bool push(U&& value) {
+        if (!tryPush(std::forward<U>(value))) {
+            return false;
+        }
+        notEmpty_.notify();
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	空きができるまで待機して要素を追加する（生産者スレッドのみ）
+     * @param	value		追加する要素
+     */
+    template <class U>
+    void pushWait(U&& value) {
+        notFull_.wait([&]() { return tryPush(std::forward<U>(value)); });
+        notEmpty_.notify();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素をまとめて追加する（生産者スレッドのみ）
+     * @param	src			追加する要素の配列
+     * @param	num			要素数
+     * @return	追加できた要素数
+     */
+    uint32_t pushBatch(const T* src, uint32_t num) {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (Capacity - (tail - cachedHead_) < num) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+        }
+
+        num = std::min(num, Capacity - (tail - cachedHead_));
+        for (uint32_t i = 0; i < num; ++i) {
+            buffer_[(tail + i) & mask] = src[i];
+        }
+
+        if (num > 0) {
+            tail_.store(tail + num, std::memory_order_release);
+            notEmpty_.notify();
+        }
+        return num;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素を取り出す（消費者スレッドのみ）
+     * @param	value		取り出した要素の格納先
+     * @return	空で取り出せなかった場合は false
+     */
+    bool pop(T& value) {
+        if (!tryPop(value)) {
+            return false;
+        }
+        notFull_.notify();
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素が追加されるまで待機して取り出す（消費者スレッドのみ）
+     * @param	value		取り出した要素の格納先
+     */
+    void popWait(T& value) {
+        notEmpty_.wait([&]() { return tryPop(value); });
+        notFull_.notify();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素をまとめて取り出す（消費者スレッドのみ）
+     * @param	dst			取り出した要素の格納先
+     * @param	maxNum		取り出す最大数
+     * @return	取り出した要素数
+     */
+    uint32_t popBatch(T* dst, uint32_t maxNum) {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (cachedTail_ - head < maxNum) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+        }
+
+        const auto num = std::min(maxNum, cachedTail_ - head);
+        for (uint32_t i = 0; i < num; ++i) {
+            dst[i] = std::move(buffer_[(head + i) & mask]);
+        }
+
+        if (num > 0) {
+            head_.store(head + num, std::memory_order_release);
+            notFull_.notify();
+        }
+        return num;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	格納されている要素数を取得する（他方のスレッドから見た場合は概算）
+     */
+    [[nodiscard]] uint32_t size() const noexcept {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	容量を取得する
+     */
+    [[nodiscard]] static constexpr uint32_t capacity() noexcept {
+        return Capacity;
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素を追加する（待機スレッドへの通知は行わない）
+     * @param	value		追加する要素
+     * @return	満杯で追加できなかった場合は false
+     */
+    template <class U>
+    bool tryPush(U&& value) {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ == Capacity) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ == Capacity) {
+                return false;
+            }
+        }
+
+        buffer_[tail & mask] = std::forward<U>(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素を取り出す（待機スレッドへの通知は行わない）
+     * @param	value		取り出した要素の格納先
+     * @return	空で取り出せなかった場合は false
+     */
+    bool tryPop(T& value) {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) {
+                return false;
+            }
+        }
+
+        value = std::move(buffer_[head & mask]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr uint32_t mask = Capacity - 1;
+
+    alignas(64) std::atomic<uint32_t> head_{};  ///< 取り出し位置（消費者が更新）
+    uint32_t cachedTail_{};                     ///< 消費者が最後に読んだ追加位置
+    alignas(64) std::atomic<uint32_t> tail_{};  ///< 追加位置（生産者が更新）
+    uint32_t cachedHead_{};                     ///< 生産者が最後に読んだ取り出し位置
+    alignas(64) detail::RingSignal notEmpty_{};  ///< データ待ちの通知
+    detail::RingSignal notFull_{};               ///< 空き待ちの通知
+    alignas(64) std::array<T, Capacity> buffer_{};  ///< バッファ
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 複数生産者・複数消費者のロックフリーリングバッファ（ Vyukov 方式）
+ *
+ * 各セルのシーケンス番号で書き込み完了と読み込み完了を判定するので、生産者同士・消費者同士は CAS 1 回で位置を確保する
+ * T はデフォルト構築とムーブ代入ができること
+ */
+template <class T, uint32_t Capacity>
+class MpmcRingBuffer final : Noncopyable {
+public:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "容量は 2 のべき乗で指定してください");
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    MpmcRingBuffer() {
+        for (uint32_t i = 0; i < Capacity; ++i) {
+            cells_[i].sequence_.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~MpmcRingBuffer() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素を追加する
+     * @param	value		追加する要素
+     * @return	満杯で追加できなかった場合は false
+     */
+    template <class U>
+    bool push(U&& value) {
+        if (!tryPush(std::forward<U>(value))) {
+            return false;
+        }
+        notEmpty_.notify();
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	空きができるまで待機して要素を追加する
+     * @param	value		追加する要素
+     */
+    template <class U>
+    void pushWait(U&& value) {
+        notFull_.wait([&]() { return tryPush(std::forward<U>(value)); });
+        notEmpty_.notify();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素をまとめて追加する
+     *
+     * 連続して空いているセルを CAS 1 回でまとめて確保する
+     * @param	src			追加する要素の配列
+     * @param	num			要素数
+     * @return	追加できた要素数
+     */
+    uint32_t pushBatch(const T* src, uint32_t num) {
+        if (num == 0) {
+            return 0;
+        }
+
+        auto     pos   = enqueuePos_.load(std::memory_order_relaxed);
+        uint32_t count = 0;
+        while (true) {
+            // pos から連続して書き込み可能なセル数を数える
+            count = 0;
+            while (count < num) {
+                const auto seq = cells_[(pos + count) & mask].sequence_.load(std::memory_order_acquire);
+                if (seq != pos + count) {
+                    break;
+                }
+                ++count;
+            }
+
+            if (count == 0) {
+                const auto seq  = cells_[pos & mask].sequence_.load(std::memory_order_acquire);
+                const auto diff = static_cast<int64_t>(seq - pos);
+                if (diff < 0) {
+                    return 0;
+                }
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (enqueuePos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            auto& cell = cells_[(pos + i) & mask];
+            cell.data_ = src[i];
+            cell.sequence_.store(pos + i + 1, std::memory_order_release);
+        }
+        notEmpty_.notify();
+
+        return count;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素を取り出す
+     * @param	value		取り出した要素の格納先
+     * @return	空で取り出せなかった場合は false
+     */
+    bool pop(T& value) {
+        if (!tryPop(value)) {
+            return false;
+        }
+        notFull_.notify();
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素が追加されるまで待機して取り出す
+     * @param	value		取り出した要素の格納先
+     */
+    void popWait(T& value) {
+        notEmpty_.wait([&]() { return tryPop(value); });
+        notFull_.notify();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素をまとめて取り出す
+     *
+     * 連続して書き込み済みのセルを CAS 1 回でまとめて確保する
+     * @param	dst			取り出した要素の格納先
+     * @param	maxNum		取り出す最大数
+     * @return	取り出した要素数
+     */
+    uint32_t popBatch(T* dst, uint32_t maxNum) {
+        if (maxNum == 0) {
+            return 0;
+        }
+
+        auto     pos   = dequeuePos_.load(std::memory_order_relaxed);
+        uint32_t count = 0;
+        while (true) {
+            // pos から連続して読み込み可能なセル数を数える
+            count = 0;
+            while (count < maxNum) {
+                const auto seq = cells_[(pos + count) & mask].sequence_.load(std::memory_order_acquire);
+                if (seq != pos + count + 1) {
+                    break;
+                }
+                ++count;
+            }
+
+            if (count == 0) {
+                const auto seq  = cells_[pos & mask].sequence_.load(std::memory_order_acquire);
+                const auto diff = static_cast<int64_t>(seq - (pos + 1));
+                if (diff < 0) {
+                    return 0;
+                }
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (dequeuePos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            auto& cell = cells_[(pos + i) & mask];
+            dst[i]     = std::move(cell.data_);
+            cell.sequence_.store(pos + i + Capacity, std::memory_order_release);
+        }
+        notFull_.notify();
+
+        return count;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	格納されている要素数の概算を取得する
+     */
+    [[nodiscard]] uint32_t size() const noexcept {
+        const auto enqueuePos = enqueuePos_.load(std::memory_order_acquire);
+        const auto dequeuePos = dequeuePos_.load(std::memory_order_acquire);
+        return enqueuePos > dequeuePos ? static_cast<uint32_t>(enqueuePos - dequeuePos) : 0;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	容量を取得する
+     */
+    [[nodiscard]] static constexpr uint32_t capacity() noexcept {
+        return Capacity;
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素を追加する（待機スレッドへの通知は行わない）
+     * @param	value		追加する要素
+     * @return	満杯で追加できなかった場合は false
+     */
+    template <class U>
+    bool tryPush(U&& value) {
+        auto  pos  = enqueuePos_.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        while (true) {
+            cell            = &cells_[pos & mask];
+            const auto seq  = cell->sequence_.load(std::memory_order_acquire);
+            const auto diff = static_cast<int64_t>(seq - pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // 1 周前の要素が取り出されていないので満杯
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data_ = std::forward<U>(value);
+        cell->sequence_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	要素を取り出す（待機スレッドへの通知は行わない）
+     * @param	value		取り出した要素の格納先
+     * @return	空で取り出せなかった場合は false
+     */
+    bool tryPop(T& value) {
+        auto  pos  = dequeuePos_.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        while (true) {
+            cell            = &cells_[pos & mask];
+            const auto seq  = cell->sequence_.load(std::memory_order_acquire);
+            const auto diff = static_cast<int64_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // まだ書き込まれていないので空
+                return false;
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->data_);
+        cell->sequence_.store(pos + Capacity, std::memory_order_release);
+        return true;
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  セル
+     */
+    struct Cell {
+        std::atomic<uint64_t> sequence_{};  ///< シーケンス番号
+        T                     data_{};      ///< 要素
+    };
+
+    static constexpr uint64_t mask = Capacity - 1;
+
+    alignas(64) std::atomic<uint64_t> enqueuePos_{};  ///< 追加位置
+    alignas(64) std::atomic<uint64_t> dequeuePos_{};  ///< 取り出し位置
+    alignas(64) detail::RingSignal notEmpty_{};       ///< データ待ちの通知
+    detail::RingSignal notFull_{};                    ///< 空き待ちの通知
+    alignas(64) std::array<Cell, Capacity> cells_{};  ///< セル
+};
+}  // namespace utility
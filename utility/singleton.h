@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+#include <atomic>
+#include <mutex>
+
 namespace utility {
 
 //---------------------------------------------------------------------------------
@@ -8,6 +11,7 @@ namespace utility {
  * シングルトン化制御
  *
  * このクラスを継承したクラスをシングルトン化させる
+ * 生成と破棄は複数スレッドから呼び出してもよい（生成済みの場合はロックを取らない）
  */
 template <class T>
 class Singleton {
@@ -21,10 +25,22 @@ public:
      * @return	シングルトンインスタンス
      */
     static T& instance() noexcept {
-        if (!instance_) {
-            instance_.reset(new T());
+        auto* p = pointer_.load(std::memory_order_acquire);
+        if (!p) [[unlikely]] {
+            p = create();
         }
-        return *instance_;
+        return *p;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	生成済みのシングルトンインスタンスを確認無しで取得する
+     *
+     * SubsystemRegistry などで明示的に生成した後に利用する（生成前は nullptr ）
+     * @return	シングルトンインスタンスのポインタ
+     */
+    [[nodiscard]] static T* pointer() noexcept {
+        return pointer_.load(std::memory_order_relaxed);
     }
 
     //---------------------------------------------------------------------------------
@@ -32,6 +48,8 @@ public:
      * @brief	シングルトンインスタンスを破棄する
      */
     static void release() noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pointer_.store(nullptr, std::memory_order_release);
         instance_.reset();
     }
 
@@ -48,10 +66,30 @@ private:
     Singleton(Singleton&& r) noexcept            = delete;
     Singleton& operator=(Singleton&& r) noexcept = delete;
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	シングルトンインスタンスを生成する（生成済みの場合はそれを返す）
+     * @return	シングルトンインスタンスのポインタ
+     */
+    static T* create() noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!instance_) {
+            instance_.reset(new T());
+            pointer_.store(instance_.get(), std::memory_order_release);
+        }
+        return instance_.get();
+    }
+
 private:
-    static instance_ptr instance_;  ///< インスタンス
+    static instance_ptr    instance_;  ///< インスタンス
+    static std::atomic<T*> pointer_;   ///< 生成済みインスタンスのポインタ（確認無しで参照する）
+    static std::mutex      mutex_;     ///< 生成と破棄の排他制御
 };
 
 template <class T>
 typename Singleton<T>::instance_ptr Singleton<T>::instance_;
+template <class T>
+std::atomic<T*> Singleton<T>::pointer_{};
+template <class T>
+std::mutex Singleton<T>::mutex_;
 }  // namespace utility
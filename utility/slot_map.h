@@ -0,0 +1,281 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <new>
+
+#include "utility/noncopyable.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 世代付きハンドル
+ *
+ * 下位 indexBits ビットがスロットのインデックス、上位ビットが世代
+ * 世代は 1 から始まるので、値が 0 のハンドルは無効
+ */
+struct SlotHandle {
+    static constexpr uint32_t indexBits      = 20;                            ///< インデックスのビット数
+    static constexpr uint32_t indexMask      = (1u << indexBits) - 1;         ///< インデックスのマスク
+    static constexpr uint32_t generationMask = (1u << (32 - indexBits)) - 1;  ///< 世代のマスク（シフト後）
+
+    uint32_t value_{};  ///< 世代とインデックス
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スロットのインデックスを取得する
+     */
+    [[nodiscard]] constexpr uint32_t index() const noexcept {
+        return value_ & indexMask;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	世代を取得する
+     */
+    [[nodiscard]] constexpr uint32_t generation() const noexcept {
+        return value_ >> indexBits;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	有効なハンドルか否か（参照先が生存しているかは SlotMap で確認する）
+     */
+    [[nodiscard]] constexpr bool valid() const noexcept {
+        return value_ != 0;
+    }
+
+    friend constexpr bool operator==(SlotHandle a, SlotHandle b) noexcept = default;
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 世代付きハンドルで参照するスロットマップ
+ *
+ * オブジェクトは 2^PageBits 個ずつ連続したページに格納し、ページは破棄まで移動しない
+ * ハンドルからの参照は配列の添字と世代の比較のみで、破棄済みのハンドルは nullptr になる
+ * 破棄したスロットは世代を進めて再利用するので、古いハンドルが別のオブジェクトを指すことは無い
+ *
+ * 生成と破棄はスレッドセーフで、参照はロック無しで生成と並行して行ってよい
+ * 破棄は、そのオブジェクトを参照しているスレッドが無いことを呼び出し側で保証すること
+ */
+template <class T, uint32_t PageBits = 8>
+class SlotMap final : Noncopyable {
+private:
+    static_assert(PageBits > 0 && PageBits < SlotHandle::indexBits, "ページのビット数が不正です");
+
+    static constexpr uint32_t pageSize = 1u << PageBits;                           ///< 1 ページのスロット数
+    static constexpr uint32_t pageMask = pageSize - 1;                             ///< ページ内インデックスのマスク
+    static constexpr uint32_t pageNum  = (SlotHandle::indexMask + 1) >> PageBits;  ///< 最大ページ数
+    static constexpr uint32_t noFree   = ~0u;                                      ///< 空きスロットが無いことを表す値
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  スロット
+     */
+    struct Slot {
+        alignas(T) std::byte  storage_[sizeof(T)];  ///< オブジェクトの格納先
+        std::atomic<uint32_t> handle_{};            ///< 生存中のハンドル値（空きの間は 0 ）
+        uint32_t              generation_{};        ///< 次に割り当てる世代
+        uint32_t              nextFree_{};          ///< 次の空きスロット
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    SlotMap() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~SlotMap() {
+        clear();
+        for (auto& page : pages_) {
+            delete[] page.load(std::memory_order_relaxed);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	オブジェクトを生成する
+     * @param	args		コンストラクタ引数
+     * @return	生成したオブジェクトのハンドル（スロットが足りない場合は無効なハンドル）
+     */
+    template <class... Args>
+    [[nodiscard]] SlotHandle emplace(Args&&... args) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // 空きスロットが無ければ末尾に追加する（コンストラクタが例外を投げた場合に備えて確定は生成後に行う）
+        const bool reuse = freeHead_ != noFree;
+        const auto index = reuse ? freeHead_ : slotNum_;
+        if (!reuse) {
+            if (index > SlotHandle::indexMask) {
+                ASSERT(false, "スロットマップの容量を超えました");
+                return {};
+            }
+            auto& page = pages_[index >> PageBits];
+            if (!page.load(std::memory_order_relaxed)) {
+                page.store(new Slot[pageSize], std::memory_order_release);
+            }
+        }
+
+        auto& slot = slotAt(index);
+        new (slot.storage_) T(std::forward<Args>(args)...);
+
+        if (reuse) {
+            freeHead_ = slot.nextFree_;
+        } else {
+            slotNum_++;
+        }
+        if (slot.generation_ == 0) {
+            slot.generation_ = 1;
+        }
+
+        const SlotHandle handle{(slot.generation_ << SlotHandle::indexBits) | index};
+        slot.handle_.store(handle.value_, std::memory_order_release);
+        liveNum_.fetch_add(1, std::memory_order_relaxed);
+
+        return handle;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	オブジェクトを破棄する
+     * @param	handle		破棄するオブジェクトのハンドル
+     * @return	破棄した場合は true（破棄済みのハンドルの場合は false ）
+     */
+    bool remove(SlotHandle handle) noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto* slot = find(handle);
+        if (!slot) {
+            return false;
+        }
+        release(*slot, handle.index());
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	オブジェクトを取得する
+     * @param	handle		オブジェクトのハンドル
+     * @return	オブジェクトのポインタ（破棄済み、無効なハンドルの場合は nullptr ）
+     */
+    [[nodiscard]] T* get(SlotHandle handle) const noexcept {
+        auto* slot = find(handle);
+        return slot ? std::launder(reinterpret_cast<T*>(slot->storage_)) : nullptr;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ハンドルの参照先が生存しているか否か
+     * @param	handle		オブジェクトのハンドル
+     */
+    [[nodiscard]] bool contains(SlotHandle handle) const noexcept {
+        return find(handle) != nullptr;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	生存中のオブジェクト数を取得する
+     */
+    [[nodiscard]] uint32_t size() const noexcept {
+        return liveNum_.load(std::memory_order_relaxed);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	生存中のすべてのオブジェクトに対して処理を行う（処理中は生成と破棄を待たせる）
+     * @param	func		( SlotHandle, T& ) を受け取る処理
+     */
+    template <class Func>
+    void forEach(Func&& func) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        for (uint32_t i = 0; i < slotNum_; ++i) {
+            auto&      slot   = slotAt(i);
+            const auto handle = slot.handle_.load(std::memory_order_relaxed);
+            if (handle != 0) {
+                func(SlotHandle{handle}, *std::launder(reinterpret_cast<T*>(slot.storage_)));
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	すべてのオブジェクトを破棄する（ページは再利用のため保持する）
+     */
+    void clear() noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        for (uint32_t i = 0; i < slotNum_; ++i) {
+            auto& slot = slotAt(i);
+            if (slot.handle_.load(std::memory_order_relaxed) != 0) {
+                release(slot, i);
+            }
+        }
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	インデックスのスロットを取得する（ページは確保済みであること）
+     * @param	index		スロットのインデックス
+     */
+    Slot& slotAt(uint32_t index) const noexcept {
+        return pages_[index >> PageBits].load(std::memory_order_acquire)[index & pageMask];
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ハンドルの参照先が生存していればスロットを取得する
+     * @param	handle		オブジェクトのハンドル
+     * @return	スロット（破棄済み、無効なハンドルの場合は nullptr ）
+     */
+    Slot* find(SlotHandle handle) const noexcept {
+        const auto index = handle.index();
+        auto*      page  = pages_[index >> PageBits].load(std::memory_order_acquire);
+        if (!page || !handle.valid()) {
+            return nullptr;
+        }
+
+        auto& slot = page[index & pageMask];
+        return slot.handle_.load(std::memory_order_acquire) == handle.value_ ? &slot : nullptr;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	スロットのオブジェクトを破棄して空きに戻す
+     * @param	slot		破棄するスロット
+     * @param	index		スロットのインデックス
+     */
+    void release(Slot& slot, uint32_t index) noexcept {
+        slot.handle_.store(0, std::memory_order_release);
+        std::launder(reinterpret_cast<T*>(slot.storage_))->~T();
+
+        // 世代を進める（一周した場合は 0 を飛ばす）
+        slot.generation_ = (slot.generation_ + 1) & SlotHandle::generationMask;
+        if (slot.generation_ == 0) {
+            slot.generation_ = 1;
+        }
+
+        slot.nextFree_ = freeHead_;
+        freeHead_      = index;
+        liveNum_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<Slot*>, pageNum> pages_{};           ///< ページ（参照はロック無しで行う）
+    mutable std::mutex                      mutex_{};           ///< 生成と破棄の同期オブジェクト
+    uint32_t                                slotNum_{};         ///< 使用したことのあるスロット数
+    uint32_t                                freeHead_{noFree};  ///< 空きスロットの先頭
+    std::atomic<uint32_t>                   liveNum_{};         ///< 生存中のオブジェクト数
+};
+}  // namespace utility
@@ -1,11 +1,51 @@
 ﻿#pragma once
 
 #include <atomic>
+#include <immintrin.h>
+#include <thread>
 
 #include "utility/noncopyable.h"
 
 namespace utility {
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * スピン待機のバックオフ
+ *
+ * 待機のたびに pause 回数を倍にし、上限を超えたらスレッドを譲る
+ */
+class Backoff final {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	待機する
+     */
+    void pause() noexcept {
+        if (count_ <= maxPauseNum) {
+            for (uint32_t i = 0; i < count_; ++i) {
+                _mm_pause();
+            }
+            count_ <<= 1;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	待機回数を初期状態に戻す
+     */
+    void reset() noexcept {
+        count_ = 1;
+    }
+
+private:
+    static constexpr uint32_t maxPauseNum = 64;  ///< スレッドを譲るまでの pause 回数の上限
+
+    uint32_t count_ = 1;  ///< 次回の pause 回数
+};
+
 //---------------------------------------------------------------------------------
 /**
  * @brief
@@ -74,4 +114,283 @@ public:
 private:
     std::atomic<int32_t> state_{};
 };
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 書き込み優先のスピンロック同期オブジェクト
+ *
+ * 排他ロックの待機中は新しい共有ロックを受け付けないため、読み込みが続いても書き込みが飢餓状態にならない
+ */
+class WriterPreferSpinLock final : Noncopyable {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    WriterPreferSpinLock() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~WriterPreferSpinLock() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	排他ロック ( unique_lock ) を取得する
+     */
+    void lock() noexcept {
+        writerWaitNum_.fetch_add(1, std::memory_order_relaxed);
+
+        Backoff backoff;
+        int32_t e = 0;
+        while (!state_.compare_exchange_weak(e, -1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            e = 0;
+            backoff.pause();
+        }
+
+        writerWaitNum_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	排他ロック ( unique_lock ) を開放する
+     */
+    void unlock() noexcept {
+        state_.store(0, std::memory_order_release);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	共有ロック ( shared_lock ) を取得する
+     */
+    void lockShared() noexcept {
+        Backoff backoff;
+        while (true) {
+            // 排他ロックを待機しているスレッドがいれば譲る
+            if (writerWaitNum_.load(std::memory_order_relaxed) == 0) {
+                auto e = state_.load(std::memory_order_relaxed);
+                if (e >= 0 && state_.compare_exchange_weak(e, e + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return;
+                }
+            }
+            backoff.pause();
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	共有ロック ( shared_lock ) を開放する
+     */
+    void unlockShared() noexcept {
+        state_.fetch_sub(1, std::memory_order_release);
+    }
+
+private:
+    alignas(64) std::atomic<int32_t> state_{};          ///< 共有ロック数（排他ロック中は -1 ）
+    alignas(64) std::atomic<int32_t> writerWaitNum_{};  ///< 排他ロックの待機数
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * チケット方式の共有ロック同期オブジェクト
+ *
+ * 到着順にロックを取得するので読み込みと書き込みのどちらも飢餓状態にならない
+ * 連続して到着した共有ロックは同時に取得される
+ */
+class TicketSharedLock final : Noncopyable {
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    TicketSharedLock() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~TicketSharedLock() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	排他ロック ( unique_lock ) を取得する
+     */
+    void lock() noexcept {
+        const auto ticket = next_.fetch_add(1, std::memory_order_relaxed);
+        waitTurn(write_, ticket);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	排他ロック ( unique_lock ) を開放する
+     */
+    void unlock() noexcept {
+        // 次のチケットが読み込みと書き込みのどちらでも進めるようにする
+        read_.fetch_add(1, std::memory_order_release);
+        write_.fetch_add(1, std::memory_order_release);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	共有ロック ( shared_lock ) を取得する
+     */
+    void lockShared() noexcept {
+        const auto ticket = next_.fetch_add(1, std::memory_order_relaxed);
+        waitTurn(read_, ticket);
+
+        // 後続の共有ロックをすぐに通す
+        read_.fetch_add(1, std::memory_order_release);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	共有ロック ( shared_lock ) を開放する
+     */
+    void unlockShared() noexcept {
+        write_.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	チケットの順番が来るまで待機する
+     * @param	serving		処理中のチケット番号
+     * @param	ticket		自身のチケット番号
+     */
+    static void waitTurn(const std::atomic<uint32_t>& serving, uint32_t ticket) noexcept {
+        uint32_t spinNum = 0;
+        while (true) {
+            const auto ahead = ticket - serving.load(std::memory_order_acquire);
+            if (ahead == 0) {
+                return;
+            }
+
+            // 前に並んでいる数に比例して待機し、長引く場合はスレッドを譲る
+            if (ahead < 64 && spinNum++ < 64) {
+                for (uint32_t i = 0; i < ahead * 8; ++i) {
+                    _mm_pause();
+                }
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    alignas(64) std::atomic<uint32_t> next_{};   ///< 次に発行するチケット番号
+    alignas(64) std::atomic<uint32_t> read_{};   ///< 共有ロックを取得できるチケット番号
+    std::atomic<uint32_t>             write_{};  ///< 排他ロックを取得できるチケット番号
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 読み込みの多いデータ向けの分散共有ロック同期オブジェクト
+ *
+ * 共有ロックはスレッドごとに割り当てたシャードのカウンタのみを更新するので、
+ * 読み込み同士でキャッシュラインを奪い合わない
+ * 排他ロックはすべてのシャードを確認するため重い
+ */
+template <uint32_t ShardNum = 16>
+class BigReaderLock final : Noncopyable {
+public:
+    static_assert((ShardNum & (ShardNum - 1)) == 0, "シャード数は 2 のべき乗で指定してください");
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    BigReaderLock() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~BigReaderLock() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	排他ロック ( unique_lock ) を取得する
+     */
+    void lock() noexcept {
+        Backoff backoff;
+        bool    e = false;
+        while (!writer_.compare_exchange_weak(e, true, std::memory_order_seq_cst)) {
+            e = false;
+            backoff.pause();
+        }
+
+        // 取得済みの共有ロックが解放されるのを待つ
+        for (auto& shard : shards_) {
+            backoff.reset();
+            while (shard.readerNum_.load(std::memory_order_seq_cst) != 0) {
+                backoff.pause();
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	排他ロック ( unique_lock ) を開放する
+     */
+    void unlock() noexcept {
+        writer_.store(false, std::memory_order_release);
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	共有ロック ( shared_lock ) を取得する
+     */
+    void lockShared() noexcept {
+        auto&   readerNum = shards_[shardIndex()].readerNum_;
+        Backoff backoff;
+        while (true) {
+            readerNum.fetch_add(1, std::memory_order_seq_cst);
+            if (!writer_.load(std::memory_order_seq_cst)) {
+                return;
+            }
+
+            // 排他ロック中なので取り消して待つ
+            readerNum.fetch_sub(1, std::memory_order_relaxed);
+            while (writer_.load(std::memory_order_relaxed)) {
+                backoff.pause();
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	共有ロック ( shared_lock ) を開放する
+     */
+    void unlockShared() noexcept {
+        shards_[shardIndex()].readerNum_.fetch_sub(1, std::memory_order_release);
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	呼び出しスレッドのシャードインデックスを取得する
+     */
+    static uint32_t shardIndex() noexcept {
+        static std::atomic<uint32_t> threadNum{};
+        thread_local const uint32_t  index = threadNum.fetch_add(1, std::memory_order_relaxed);
+        return index & (ShardNum - 1);
+    }
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  シャード（キャッシュライン単位で分離する）
+     */
+    struct alignas(64) Shard {
+        std::atomic<int32_t> readerNum_{};  ///< 共有ロック数
+    };
+
+    std::array<Shard, ShardNum> shards_{};   ///< シャード
+    alignas(64) std::atomic<bool> writer_{};  ///< 排他ロックフラグ
+};
 }  // namespace utility
@@ -0,0 +1,233 @@
+﻿#include "subsystem.h"
+
+namespace {
+constexpr uint32_t timelineWidth = 40;  ///< 計測結果の表示で起動全体に割り当てる文字数
+}  // namespace
+
+namespace utility {
+using namespace std;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	デストラクタ（初期化済みのサブシステムを終了する）
+ */
+SubsystemRegistry::~SubsystemRegistry() {
+    shutdown();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	サブシステムを登録する
+ * @param	name			サブシステム名
+ * @param	dependencies	先に初期化するサブシステム
+ * @param	init			初期化処理（失敗した場合は false を返す）
+ * @param	shutdown		終了処理（不要な場合は空）
+ * @return	サブシステムの識別子
+ */
+SubsystemRegistry::Id SubsystemRegistry::add(std::string_view name, std::initializer_list<Id> dependencies, const InitFunc& init, const ShutdownFunc& shutdown) {
+    ASSERT(!initialized_, "初期化後にサブシステムは登録できません");
+
+    const auto id = static_cast<Id>(subsystems_.size());
+    for ([[maybe_unused]] auto dependency : dependencies) {
+        ASSERT(dependency < id, "未登録のサブシステムに依存しています");
+    }
+
+    auto& subsystem         = subsystems_.emplace_back();
+    subsystem.name_         = name;
+    subsystem.init_         = init;
+    subsystem.shutdown_     = shutdown;
+    subsystem.dependencies_ = dependencies;
+    subsystem.state_        = State::Registered;
+
+    return id;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	登録したサブシステムを依存関係に従って並列に初期化する
+ * @return	循環が無く、すべてのサブシステムの初期化に成功した場合は true
+ */
+bool SubsystemRegistry::initialize() {
+    ASSERT(!initialized_, "サブシステムはすでに初期化されています");
+    if (initialized_) {
+        return false;
+    }
+
+    // サブシステムの識別子とノードの識別子を一致させる
+    for (Id i = 0; i < subsystems_.size(); ++i) {
+        graph_.addNode(subsystems_[i].name_, [this, i]() { initializeOne(i); });
+    }
+    for (Id i = 0; i < subsystems_.size(); ++i) {
+        for (auto dependency : subsystems_[i].dependencies_) {
+            graph_.addDependency(dependency, i);
+        }
+    }
+
+    if (!graph_.build()) {
+        return false;
+    }
+
+    auto& jobSystem = JobSystem::instance();
+    if (jobSystem.workerNum() == 0) {
+        jobSystem.start();
+    }
+
+    order_.clear();
+    order_.reserve(subsystems_.size());
+    initialized_ = true;
+
+    graph_.execute();
+
+    return std::all_of(subsystems_.begin(), subsystems_.end(), [](const auto& s) { return s.state_ == State::Initialized; });
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	初期化済みのサブシステムを初期化の逆順で終了する
+ */
+void SubsystemRegistry::shutdown() {
+    // 依存先は必ず先に初期化を終えているので、完了順の逆順は依存の逆順になる
+    for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+        auto& subsystem = subsystems_[*it];
+        if (subsystem.shutdown_) {
+            subsystem.shutdown_();
+        }
+        subsystem.state_ = State::Shutdown;
+    }
+    order_.clear();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	起動時の計測情報を取得する
+ * @return	登録順の計測情報
+ */
+std::vector<SubsystemRegistry::Timeline> SubsystemRegistry::timeline() const {
+    vector<Timeline> result;
+    if (!initialized_) {
+        return result;
+    }
+
+    result.resize(subsystems_.size());
+    for (Id i = 0; i < subsystems_.size(); ++i) {
+        const auto& t = graph_.timing(i);
+        auto&       r = result[i];
+        r.name_       = subsystems_[i].name_;
+        r.start_      = t.start_;
+        r.end_        = t.end_;
+        r.worker_     = t.worker_;
+        r.state_      = subsystems_[i].state_;
+    }
+
+    for (auto id : graph_.criticalPath()) {
+        result[id].critical_ = true;
+    }
+
+    return result;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	起動時の計測結果を表示する
+ */
+void SubsystemRegistry::print() const noexcept {
+#if _DEBUG
+    static constexpr const char* stateNames[] = {"registered", "ok", "failed", "skipped", "shutdown"};
+
+    const auto entries = timeline();
+    const auto total   = std::max(startupTime(), 1.0);
+
+    // 直列に初期化した場合との比較
+    double serial = 0.0;
+    for (const auto& e : entries) {
+        serial += e.end_ - e.start_;
+    }
+    TRACE("startup : millisec [ %f ] serial [ %f ] speedup [ %.2f ]", total / 1000.0, serial / 1000.0, serial / total);
+
+    for (const auto& e : entries) {
+        // 起動全体を timelineWidth 文字として、開始から終了までを帯で表す
+        char bar[timelineWidth + 1];
+        const auto begin = static_cast<uint32_t>(e.start_ / total * timelineWidth);
+        const auto end   = std::max(begin + 1, static_cast<uint32_t>(e.end_ / total * timelineWidth));
+        for (uint32_t i = 0; i < timelineWidth; i++) {
+            bar[i] = (begin <= i && i < end) ? '#' : '.';
+        }
+        bar[timelineWidth] = '\0';
+
+        TRACE("  %c [ %s ] %-16.*s start [ %f ] millisec [ %f ] worker [ %d ] %s",
+              e.critical_ ? '*' : ' ', bar, static_cast<int>(e.name_.size()), e.name_.data(),
+              e.start_ / 1000.0, (e.end_ - e.start_) / 1000.0, e.worker_, stateNames[static_cast<size_t>(e.state_)]);
+    }
+#endif
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	起動時の計測結果をトレースとしてファイルに出力する
+ * @param	path		出力先のファイルパス
+ * @param	format		出力形式
+ * @return	出力に成功した場合は true
+ */
+bool SubsystemRegistry::writeTimeline(const std::filesystem::path& path, TraceFormat format) const noexcept {
+    // 起動全体を 1 フレームとし、ティックをナノ秒として格納する
+    const auto toTick = [](double microsec) {
+        return static_cast<uint64_t>(microsec * 1000.0);
+    };
+
+    TraceData data;
+    data.microsecPerTick_ = 0.001;
+
+    auto& frame  = data.frames_.emplace_back();
+    frame.start_ = 0;
+    frame.end_   = toTick(startupTime());
+
+    // スレッド 0 は呼び出しスレッド、以降はワーカーインデックス順
+    data.threadNames_.emplace_back("Main");
+    for (uint32_t i = 0; i < JobSystem::instance().workerNum(); i++) {
+        data.threadNames_.emplace_back("Worker " + to_string(i));
+    }
+
+    for (Id i = 0; i < subsystems_.size() && initialized_; ++i) {
+        const auto& t = graph_.timing(i);
+
+        auto& scope   = frame.scopes_.emplace_back();
+        scope.name_   = subsystems_[i].name_.c_str();
+        scope.start_  = toTick(t.start_);
+        scope.end_    = toTick(t.end_);
+        scope.parent_ = -1;
+        scope.thread_ = static_cast<uint16_t>(t.worker_ + 1);
+    }
+
+    return writeTrace(path, data, format);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	サブシステムを 1 つ初期化する（タスクグラフのノードから呼び出す）
+ * @param	id			サブシステムの識別子
+ */
+void SubsystemRegistry::initializeOne(Id id) noexcept {
+    auto& subsystem = subsystems_[id];
+
+    // 依存先の状態はタスクグラフの依存関係により確定している
+    for (auto dependency : subsystem.dependencies_) {
+        if (subsystems_[dependency].state_ != State::Initialized) {
+            TRACE("subsystem [ %s ] : skipped ( depends on [ %s ] )", subsystem.name_.c_str(), subsystems_[dependency].name_.c_str());
+            subsystem.state_ = State::Skipped;
+            return;
+        }
+    }
+
+    if (subsystem.init_ && !subsystem.init_()) {
+        TRACE("subsystem [ %s ] : failed", subsystem.name_.c_str());
+        subsystem.state_ = State::Failed;
+        return;
+    }
+
+    subsystem.state_ = State::Initialized;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    order_.emplace_back(id);
+}
+
+}  // namespace utility
@@ -0,0 +1,198 @@
+﻿#pragma once
+
+#include "utility/task_graph.h"
+#include "utility/trace_export.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * サブシステムの初期化順序と寿命を管理する
+ *
+ * 各サブシステムを依存関係付きで登録し、initialize で依存の無いものから並列に初期化する
+ * 初期化はタスクグラフとしてジョブシステム上で一度だけ実行し、各サブシステムの開始・終了時間を記録する
+ * shutdown は初期化に成功したものを初期化の逆順で終了する
+ *
+ * addSingleton で登録したシングルトンは初期化ノードの中で生成されるので、
+ * initialize の後は T::pointer() で確認無しにポインタを取得して保持してよい
+ *
+ * @code
+ *   SubsystemRegistry registry;
+ *   auto window = registry.add("Window", {}, [&] { return SUCCEEDED(window::Window::instance().create(hinstance)); });
+ *   auto device = registry.addSingleton<dx12::Device>("Device", {}, [](auto& d) { return d.create(); });
+ *   registry.addSingleton<dx12::Device>("DisplayMode", {device}, [](auto& d) { return d.checkDisplayMode(); });
+ *   registry.add("SwapChain", {window, device}, [] { ... });
+ *   registry.initialize();
+ *   registry.print();
+ * @endcode
+ */
+class SubsystemRegistry final : Noncopyable {
+public:
+    using Id           = uint32_t;
+    using InitFunc     = std::function<bool()>;
+    using ShutdownFunc = std::function<void()>;
+
+    static constexpr Id invalidId = ~0u;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  サブシステムの状態
+     */
+    enum class State : uint8_t {
+        Registered,   ///< 未初期化
+        Initialized,  ///< 初期化済み
+        Failed,       ///< 初期化に失敗
+        Skipped,      ///< 依存先の失敗により初期化しなかった
+        Shutdown,     ///< 終了済み
+    };
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  起動時の計測情報（時間は initialize 開始からのマイクロ秒）
+     */
+    struct Timeline {
+        std::string_view name_{};      ///< サブシステム名
+        double           start_{};     ///< 開始時間
+        double           end_{};       ///< 終了時間
+        int32_t          worker_{};    ///< 実行したワーカーインデックス（ワーカー以外は -1 ）
+        State            state_{};     ///< 状態
+        bool             critical_{};  ///< クリティカルパス上にあるか否か
+    };
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  サブシステム情報
+     */
+    struct Subsystem {
+        std::string     name_{};          ///< サブシステム名
+        InitFunc        init_{};          ///< 初期化処理
+        ShutdownFunc    shutdown_{};      ///< 終了処理
+        std::vector<Id> dependencies_{};  ///< 依存先
+        State           state_{};         ///< 状態
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    SubsystemRegistry() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ（初期化済みのサブシステムを終了する）
+     */
+    ~SubsystemRegistry();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	サブシステムを登録する
+     * @param	name			サブシステム名
+     * @param	dependencies	先に初期化するサブシステム
+     * @param	init			初期化処理（失敗した場合は false を返す）
+     * @param	shutdown		終了処理（不要な場合は空）
+     * @return	サブシステムの識別子
+     */
+    Id add(std::string_view name, std::initializer_list<Id> dependencies, const InitFunc& init, const ShutdownFunc& shutdown = {});
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	シングルトンをサブシステムとして登録する
+     *
+     * 初期化ノードの中でインスタンスを生成してから init を呼び出す
+     * 同じ型を複数回登録した場合、インスタンスの破棄は最初に登録したものの終了時に行う
+     * @param	name			サブシステム名
+     * @param	dependencies	先に初期化するサブシステム
+     * @param	init			生成したインスタンスを受け取る初期化処理（失敗した場合は false を返す）
+     * @return	サブシステムの識別子
+     */
+    template <class T, class Init>
+    Id addSingleton(std::string_view name, std::initializer_list<Id> dependencies, Init&& init) {
+        const bool owner = std::find(singletons_.begin(), singletons_.end(), &T::release) == singletons_.end();
+        if (owner) {
+            singletons_.emplace_back(&T::release);
+        }
+
+        return add(
+            name, dependencies,
+            [init = std::forward<Init>(init)]() mutable {
+                return init(T::instance());
+            },
+            owner ? ShutdownFunc(&T::release) : ShutdownFunc());
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	登録したサブシステムを依存関係に従って並列に初期化する
+     *
+     * ジョブシステムが開始されていない場合は開始する
+     * 初期化に失敗したサブシステムに依存するものは初期化しない
+     * @return	循環が無く、すべてのサブシステムの初期化に成功した場合は true
+     */
+    bool initialize();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	初期化済みのサブシステムを初期化の逆順で終了する
+     */
+    void shutdown();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	サブシステムの状態を取得する
+     * @param	id			サブシステムの識別子
+     */
+    [[nodiscard]] State state(Id id) const noexcept {
+        return subsystems_[id].state_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	起動時の計測情報を取得する
+     * @return	登録順の計測情報
+     */
+    [[nodiscard]] std::vector<Timeline> timeline() const;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	起動全体の処理時間を取得する
+     * @return	マイクロ秒
+     */
+    [[nodiscard]] double startupTime() const noexcept {
+        return graph_.frameTime();
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	起動時の計測結果を表示する
+     */
+    void print() const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	起動時の計測結果をトレースとしてファイルに出力する
+     * @param	path		出力先のファイルパス
+     * @param	format		出力形式
+     * @return	出力に成功した場合は true
+     */
+    bool writeTimeline(const std::filesystem::path& path, TraceFormat format) const noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	サブシステムを 1 つ初期化する（タスクグラフのノードから呼び出す）
+     * @param	id			サブシステムの識別子
+     */
+    void initializeOne(Id id) noexcept;
+
+private:
+    std::vector<Subsystem>  subsystems_{};   ///< サブシステム（登録順）
+    std::vector<Id>         order_{};        ///< 初期化が完了した順序
+    std::vector<void (*)()> singletons_{};   ///< 登録済みシングルトンの破棄関数
+    std::mutex              mutex_{};        ///< 完了順序の排他制御
+    TaskGraph               graph_{};        ///< 初期化のタスクグラフ
+    bool                    initialized_{};  ///< 初期化済みフラグ
+};
+}  // namespace utility
@@ -0,0 +1,281 @@
+﻿#include "task_graph.h"
+
+namespace {
+constexpr double averageRate     = 0.1;  ///< 処理時間の移動平均に加える割合
+constexpr double initialEstimate = 1.0;  ///< 未計測ノードの推定処理時間（マイクロ秒）
+}  // namespace
+
+namespace utility {
+using namespace std;
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ノードを追加する
+ * @param	name		ノード名（計測結果の表示に利用する）
+ * @param	func		ノードの処理
+ * @return	ノードの識別子
+ */
+TaskGraph::NodeId TaskGraph::addNode(std::string_view name, const NodeFunc& func) {
+    auto node              = std::make_unique<Node>();
+    node->name_            = name;
+    node->func_            = func;
+    node->timing_.average_ = initialEstimate;
+    node->timing_.worker_  = -1;
+
+    nodes_.emplace_back(std::move(node));
+    built_      = false;
+    executeNum_ = 0;
+
+    return static_cast<NodeId>(nodes_.size() - 1);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	依存関係を追加する
+ * @param	before		先に実行するノード
+ * @param	after		before の完了後に実行するノード
+ */
+void TaskGraph::addDependency(NodeId before, NodeId after) {
+    ASSERT(before < nodes_.size() && after < nodes_.size(), "存在しないノードが指定されました");
+    ASSERT(before != after, "自身への依存は設定できません");
+
+    auto& successors = nodes_[before]->successors_;
+    if (std::find(successors.begin(), successors.end(), after) != successors.end()) {
+        return;
+    }
+
+    successors.emplace_back(after);
+    nodes_[after]->predecessors_.emplace_back(before);
+    built_ = false;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	グラフを構築する
+ * @return	循環が無く構築に成功した場合は true
+ */
+bool TaskGraph::build() {
+    // トポロジカルソート（ Kahn ）
+    const auto       num = nodes_.size();
+    vector<uint32_t> degree(num);
+    vector<NodeId>   ready;
+
+    order_.clear();
+    for (NodeId i = 0; i < num; ++i) {
+        degree[i] = static_cast<uint32_t>(nodes_[i]->predecessors_.size());
+        if (degree[i] == 0) {
+            ready.emplace_back(i);
+        }
+    }
+
+    while (!ready.empty()) {
+        const auto id = ready.back();
+        ready.pop_back();
+        order_.emplace_back(id);
+
+        for (auto next : nodes_[id]->successors_) {
+            if (--degree[next] == 0) {
+                ready.emplace_back(next);
+            }
+        }
+    }
+
+    if (order_.size() != num) {
+        ASSERT(false, "タスクグラフに循環があります");
+        order_.clear();
+        return false;
+    }
+
+    built_ = true;
+    updatePriority();
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	グラフを 1 回実行する（すべてのノードが完了するまで戻らない）
+ */
+void TaskGraph::execute() {
+    ASSERT(built_, "タスクグラフが構築されていません");
+    if (!built_ || nodes_.empty()) {
+        return;
+    }
+
+    for (auto& node : nodes_) {
+        node->pending_.store(static_cast<uint32_t>(node->predecessors_.size()), std::memory_order_relaxed);
+    }
+
+    frameStart_ = chrono::steady_clock::now();
+
+    // ワーカーからの投入は自身のキュー（ LIFO ）に積まれるので優先度の低い順に、
+    // それ以外のスレッドからは外部投入キュー（ FIFO ）に入るので高い順に投入して、高い順に取り出されるようにする
+    auto&      jobSystem = JobSystem::instance();
+    JobCounter counter;
+    const auto runRoot = [&](NodeId id) {
+        jobSystem.run([this, id, &counter]() { runNode(id, counter); }, &counter);
+    };
+    if (JobSystem::workerIndex() >= 0) {
+        std::for_each(roots_.rbegin(), roots_.rend(), runRoot);
+    } else {
+        std::for_each(roots_.begin(), roots_.end(), runRoot);
+    }
+    jobSystem.wait(counter);
+
+    frameTime_ = chrono::duration<double, micro>(chrono::steady_clock::now() - frameStart_).count();
+
+    // 処理時間の移動平均を更新する（初回は計測値をそのまま使う）
+    for (auto& node : nodes_) {
+        auto&      t        = node->timing_;
+        const auto duration = t.end_ - t.start_;
+        t.average_          = executeNum_ == 0 ? duration : t.average_ + (duration - t.average_) * averageRate;
+    }
+    executeNum_++;
+
+    updatePriority();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ノード名を取得する
+ * @param	id			ノードの識別子
+ */
+std::string_view TaskGraph::name(NodeId id) const noexcept {
+    return nodes_[id]->name_;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	直前の実行でのノードの計測情報を取得する
+ * @param	id			ノードの識別子
+ */
+const TaskGraph::Timing& TaskGraph::timing(NodeId id) const noexcept {
+    return nodes_[id]->timing_;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	直前の実行でのクリティカルパスを取得する
+ * @return	開始ノードから終了ノードまでの識別子
+ */
+std::vector<TaskGraph::NodeId> TaskGraph::criticalPath() const {
+    vector<NodeId> path;
+    if (nodes_.empty()) {
+        return path;
+    }
+
+    // 最後に終わったノードから、そのノードを実行可能にした（最後に終わった）先行ノードを辿る
+    auto current = invalidNode;
+    for (NodeId i = 0; i < nodes_.size(); ++i) {
+        if (current == invalidNode || nodes_[current]->timing_.end_ < nodes_[i]->timing_.end_) {
+            current = i;
+        }
+    }
+
+    while (current != invalidNode) {
+        path.emplace_back(current);
+
+        auto prev = invalidNode;
+        for (auto p : nodes_[current]->predecessors_) {
+            if (prev == invalidNode || nodes_[prev]->timing_.end_ < nodes_[p]->timing_.end_) {
+                prev = p;
+            }
+        }
+        current = prev;
+    }
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	直前の実行の計測結果を表示する
+ */
+void TaskGraph::print() const noexcept {
+#if _DEBUG
+    TRACE("task graph : millisec [ %f ]", frameTime_ / 1000.0);
+    for (const auto& node : nodes_) {
+        const auto& t = node->timing_;
+        TRACE("  node [ %s ] : start [ %f ] millisec [ %f ] average [ %f ] worker [ %d ]",
+              node->name_.c_str(), t.start_ / 1000.0, (t.end_ - t.start_) / 1000.0, t.average_ / 1000.0, t.worker_);
+    }
+
+    for (auto id : criticalPath()) {
+        TRACE("  critical path [ %s ]", nodes_[id]->name_.c_str());
+    }
+#endif
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ノードを実行し、実行可能になった後続ノードを続けて処理する
+ * @param	id			実行するノード
+ * @param	counter		グラフ全体の完了カウンタ
+ */
+void TaskGraph::runNode(NodeId id, JobCounter& counter) {
+    auto& jobSystem = JobSystem::instance();
+
+    while (id != invalidNode) {
+        auto& node = *nodes_[id];
+
+        const auto start = chrono::steady_clock::now();
+        if (node.func_) {
+            node.func_();
+        }
+        const auto end = chrono::steady_clock::now();
+
+        node.timing_.start_  = chrono::duration<double, micro>(start - frameStart_).count();
+        node.timing_.end_    = chrono::duration<double, micro>(end - frameStart_).count();
+        node.timing_.worker_ = JobSystem::workerIndex();
+
+        // 後続ノードは優先度の高い順に並んでいるので、逆順に見て低いものから投入する
+        // 最も優先度の高いものは投入せずにこのまま続けて実行する
+        auto next = invalidNode;
+        for (auto it = node.successors_.rbegin(); it != node.successors_.rend(); ++it) {
+            const auto successor = *it;
+            if (nodes_[successor]->pending_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                continue;
+            }
+
+            if (next != invalidNode) {
+                jobSystem.run([this, next, &counter]() { runNode(next, counter); }, &counter);
+            }
+            next = successor;
+        }
+        id = next;
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	処理時間の移動平均から優先度を更新し、後続ノードを優先度順に並べ直す
+ */
+void TaskGraph::updatePriority() {
+    // 逆トポロジカル順で終端までの最長経路を求める
+    for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+        auto&  node = *nodes_[*it];
+        double tail = 0.0;
+        for (auto next : node.successors_) {
+            tail = std::max(tail, nodes_[next]->priority_);
+        }
+        node.priority_ = node.timing_.average_ + tail;
+    }
+
+    const auto higher = [this](NodeId a, NodeId b) {
+        return nodes_[b]->priority_ < nodes_[a]->priority_;
+    };
+
+    roots_.clear();
+    for (NodeId i = 0; i < nodes_.size(); ++i) {
+        auto& successors = nodes_[i]->successors_;
+        std::sort(successors.begin(), successors.end(), higher);
+
+        if (nodes_[i]->predecessors_.empty()) {
+            roots_.emplace_back(i);
+        }
+    }
+    std::sort(roots_.begin(), roots_.end(), higher);
+}
+
+}  // namespace utility
@@ -0,0 +1,163 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#include "utility/job_system.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 依存関係付きのタスクグラフ
+ *
+ * フレーム内の処理をノードとして登録し、依存関係を張って一度だけ構築する
+ * 毎フレーム execute を呼ぶとジョブシステム上で並列に実行される
+ * 実行可能なノードが複数ある場合はクリティカルパスが長いものから実行する
+ */
+class TaskGraph final : Noncopyable {
+public:
+    using NodeId   = uint32_t;
+    using NodeFunc = std::function<void()>;
+
+    static constexpr NodeId invalidNode = ~0u;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  ノードの計測情報（時間はフレーム開始からのマイクロ秒）
+     */
+    struct Timing {
+        double  start_{};    ///< 開始時間
+        double  end_{};      ///< 終了時間
+        double  average_{};  ///< 処理時間の移動平均
+        int32_t worker_{};   ///< 実行したワーカーインデックス（ワーカー以外は -1 ）
+    };
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief  ノード情報
+     */
+    struct Node {
+        std::string           name_{};          ///< ノード名
+        NodeFunc              func_{};          ///< 処理
+        std::vector<NodeId>   successors_{};    ///< 後続ノード（優先度の高い順）
+        std::vector<NodeId>   predecessors_{};  ///< 先行ノード
+        std::atomic<uint32_t> pending_{};       ///< 未完了の先行ノード数
+        double                priority_{};      ///< 終端までの推定処理時間（クリティカルパス長）
+        Timing                timing_{};        ///< 計測情報
+    };
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    TaskGraph() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~TaskGraph() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ノードを追加する
+     * @param	name		ノード名（計測結果の表示に利用する）
+     * @param	func		ノードの処理
+     * @return	ノードの識別子
+     */
+    NodeId addNode(std::string_view name, const NodeFunc& func);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	依存関係を追加する
+     * @param	before		先に実行するノード
+     * @param	after		before の完了後に実行するノード
+     */
+    void addDependency(NodeId before, NodeId after);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	グラフを構築する
+     * @return	循環が無く構築に成功した場合は true
+     */
+    bool build();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	グラフを 1 回実行する（すべてのノードが完了するまで戻らない）
+     */
+    void execute();
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ノード数を取得する
+     */
+    [[nodiscard]] uint32_t nodeNum() const noexcept {
+        return static_cast<uint32_t>(nodes_.size());
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ノード名を取得する
+     * @param	id			ノードの識別子
+     */
+    [[nodiscard]] std::string_view name(NodeId id) const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	直前の実行でのノードの計測情報を取得する
+     * @param	id			ノードの識別子
+     */
+    [[nodiscard]] const Timing& timing(NodeId id) const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	直前の実行全体の処理時間を取得する
+     * @return	マイクロ秒
+     */
+    [[nodiscard]] double frameTime() const noexcept {
+        return frameTime_;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	直前の実行でのクリティカルパスを取得する
+     * @return	開始ノードから終了ノードまでの識別子
+     */
+    [[nodiscard]] std::vector<NodeId> criticalPath() const;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	直前の実行の計測結果を表示する
+     */
+    void print() const noexcept;
+
+private:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ノードを実行し、実行可能になった後続ノードを続けて処理する
+     * @param	id			実行するノード
+     * @param	counter		グラフ全体の完了カウンタ
+     */
+    void runNode(NodeId id, JobCounter& counter);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	処理時間の移動平均から優先度を更新し、後続ノードを優先度順に並べ直す
+     */
+    void updatePriority();
+
+private:
+    std::vector<std::unique_ptr<Node>>    nodes_{};       ///< ノード
+    std::vector<NodeId>                   order_{};       ///< トポロジカル順序
+    std::vector<NodeId>                   roots_{};       ///< 先行ノードの無いノード（優先度の高い順）
+    std::chrono::steady_clock::time_point frameStart_{};  ///< 実行開始時間
+    double                                frameTime_{};   ///< 直前の実行全体の処理時間
+    uint64_t                              executeNum_{};  ///< 構築後の実行回数
+    bool                                  built_{};       ///< 構築済みフラグ
+};
+}  // namespace utility
@@ -1,5 +1,7 @@
 ﻿#include "thread.h"
+#if defined(_WIN32)
 #include <process.h>
+#endif
 
 namespace utility {
 
@@ -1,10 +1,6 @@
 ﻿#include "time_counter.h"
 #include "utility/log.h"
-#include <chrono>
-
-namespace {
-constexpr double framerate = 60;
-}
+#include "utility/profiler.h"
 
 namespace utility {
 using namespace std;
@@ -14,11 +10,8 @@ using namespace std;
  * @brief	コンストラクタ（計測開始）
  * @param	tag			識別タグ
  */
-Time::Time(std::string_view tag) {
-    auto time  = chrono::system_clock::now().time_since_epoch();
-    startTime_ = chrono::duration_cast<chrono::microseconds>(time).count();
-
-    tag_ = tag;
+Time::Time(const char* tag) noexcept {
+    Profiler::instance().begin(tag);
 }
 
 //---------------------------------------------------------------------------------
@@ -26,11 +19,7 @@ Time::Time(std::string_view tag) {
  * @brief	デストラクタ（計測終了）
  */
 Time::~Time() {
-    auto time    = chrono::system_clock::now().time_since_epoch();
-    auto endTime = chrono::duration_cast<chrono::microseconds>(time).count();
-
-    auto microsec = endTime - startTime_;
-    TIME_CONTAINER().add(tag_.c_str(), static_cast<double>(microsec));
+    Profiler::instance().end();
 }
 
 //---------------------------------------------------------------------------------
@@ -49,13 +38,78 @@ TimeContainer::~TimeContainer() {
  * @return
  */
 void TimeContainer::add(std::string_view tag, double microsec) noexcept {
-    const auto& it = container_.find(tag.data());
-    if (it == container_.end()) {
-        container_.emplace(tag, Data{microsec, 1});
-    } else {
-        it->second.total_ = (it->second.count_ == framerate) ? microsec : it->second.total_ + microsec;
-        it->second.count_ = (it->second.count_ == framerate) ? 1 : it->second.count_ + 1;
+    histogram(tag).record(static_cast<uint64_t>(std::max(microsec, 0.0) * 1000.0));
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	識別タグのヒストグラムを取得する（無い場合は作成する）
+ * @param	tag			識別タグ
+ */
+Histogram& TimeContainer::histogram(std::string_view tag) {
+    if (auto* histogram = find(tag)) {
+        return *histogram;
+    }
+
+    std::unique_lock lock(mutex_);
+    auto&            histogram = container_[tag];
+    if (!histogram) {
+        histogram = std::make_unique<Histogram>();
     }
+    return *histogram;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	統計値を取得する（単位はマイクロ秒）
+ * @param	tag			識別タグ
+ * @param	window		対象のウィンドウ
+ * @return	統計値
+ */
+HistogramStats TimeContainer::stats(std::string_view tag, Window window) const noexcept {
+    const auto* histogram = find(tag);
+    if (!histogram) {
+        return {};
+    }
+
+    auto result = histogram->stats(window);
+    for (auto* value : {&result.min_, &result.max_, &result.mean_, &result.p50_, &result.p90_, &result.p99_, &result.p999_}) {
+        *value /= 1000.0;
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	フレームを進める（ウィンドウのフレーム数に達したらすべてのヒストグラムを切り替える）
+ */
+void TimeContainer::advanceFrame() noexcept {
+    const auto frameNum = windowFrameNum_.load(std::memory_order_relaxed);
+    if (frameNum == 0 || ++frameCount_ < frameNum) {
+        return;
+    }
+    frameCount_ = 0;
+    rotate();
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	すべてのヒストグラムのウィンドウを切り替える
+ */
+void TimeContainer::rotate() noexcept {
+    std::shared_lock lock(mutex_);
+    for (const auto& x : container_) {
+        x.second->rotate();
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ウィンドウを切り替えるフレーム数を設定する
+ * @param	frameNum	フレーム数（ 0 の場合は自動で切り替えない）
+ */
+void TimeContainer::setWindowFrameNum(uint32_t frameNum) noexcept {
+    windowFrameNum_.store(frameNum, std::memory_order_relaxed);
 }
 
 //---------------------------------------------------------------------------------
@@ -64,7 +118,12 @@ void TimeContainer::add(std::string_view tag, double microsec) noexcept {
  * @param	tag			識別タグ
  */
 void TimeContainer::remove(std::string_view tag) noexcept {
-    container_.erase(tag.data());
+    std::unique_lock lock(mutex_);
+    const auto       it = container_.find(tag);
+    if (it != container_.end()) {
+        container_.erase(it);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
 }
 
 //---------------------------------------------------------------------------------
@@ -74,19 +133,15 @@ void TimeContainer::remove(std::string_view tag) noexcept {
  * @return
  */
 void TimeContainer::print(std::string_view tag) const noexcept {
+    std::shared_lock lock(mutex_);
     if (tag.empty()) {
         for (const auto& x : container_) {
-            if (x.second.count_ < framerate) {
-                continue;
-            }
-            TRACE("tag [ %s ] : millisec [ %f ]", x.first.c_str(), (x.second.total_ / x.second.count_) / 1000.0f);
+            print(x.first, *x.second);
         }
     } else {
-        const auto it = container_.find(tag.data());
+        const auto it = container_.find(tag);
         if (it != container_.end()) {
-            if (framerate <= it->second.count_) {
-                TRACE("tag [ %s ] : millisec [ %f ]", it->first.c_str(), (it->second.total_ / it->second.count_) / 1000.0f);
-            }
+            print(it->first, *it->second);
         }
     }
 }
@@ -99,4 +154,28 @@ TimeContainer::TimeContainer() {
     container_.clear();
 }
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief	識別タグのヒストグラムを検索する
+ * @return	ヒストグラム（無い場合は nullptr ）
+ */
+Histogram* TimeContainer::find(std::string_view tag) const noexcept {
+    std::shared_lock lock(mutex_);
+    const auto       it = container_.find(tag);
+    return (it != container_.end()) ? it->second.get() : nullptr;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	統計値を表示する（直前に閉じたウィンドウのみ）
+ */
+void TimeContainer::print([[maybe_unused]] const std::string& tag, const Histogram& histogram) const noexcept {
+    const auto s = histogram.stats(Window::Previous);
+    if (s.count_ == 0) {
+        return;
+    }
+    TRACE("tag [ %s ] : millisec [ %f ] min [ %f ] p50 [ %f ] p90 [ %f ] p99 [ %f ] p99.9 [ %f ] max [ %f ] count [ %llu ]",
+          tag.c_str(), s.mean_ / 1e6, s.min_ / 1e6, s.p50_ / 1e6, s.p90_ / 1e6, s.p99_ / 1e6, s.p999_ / 1e6, s.max_ / 1e6, static_cast<unsigned long long>(s.count_));
+}
+
 }  // namespace utility
@@ -1,8 +1,9 @@
 ﻿#pragma once
 
-#include <unordered_map>
-
 #include "singleton.h"
+#include "noncopyable.h"
+#include "flat_map.h"
+#include "histogram.h"
 
 namespace utility {
 
@@ -12,15 +13,16 @@ namespace utility {
  * 時間計測クラス
  *
  * スコープ内でインスタンス化される事を想定
+ * 計測はプロファイラのスコープとして記録し、 Profiler::markFrame（ SwapChain::present から毎フレーム呼ばれる）で TimeContainer に集計される
  */
-class Time final {
+class Time final : Noncopyable {
 public:
     //---------------------------------------------------------------------------------
     /**
      * @brief	コンストラクタ（計測開始）
-     * @param	tag			識別タグ
+     * @param	tag			識別タグ（文字列リテラルなどプロセス終了まで有効な文字列）
      */
-    Time(std::string_view tag);
+    explicit Time(const char* tag) noexcept;
     Time() = delete;
 
     //---------------------------------------------------------------------------------
@@ -28,10 +30,6 @@ public:
      * @brief	デストラクタ（計測終了）
      */
     ~Time();
-
-private:
-    uint64_t    startTime_;  ///< 開始時間
-    std::string tag_;        ///< 識別タグ
 };
 
 //---------------------------------------------------------------------------------
@@ -40,15 +38,16 @@ private:
  * 時間計測コンテナ
  *
  * シングルトンによる制御
+ * 識別タグごとにヒストグラムを持ち、 windowFrameNum フレームごとにウィンドウを切り替える
  */
 class TimeContainer : public Singleton<TimeContainer> {
 private:
     friend class Singleton<TimeContainer>;
 
-    struct Data {
-        double total_ = {};
-        double count_ = {};
-    };
+public:
+    using Window = Histogram::Window;
+
+    static constexpr uint32_t defaultWindowFrameNum = 60;  ///< ウィンドウを切り替えるフレーム数の初期値
 
 public:
     //---------------------------------------------------------------------------------
@@ -65,13 +64,63 @@ public:
      */
     void add(std::string_view tag, double microsec) noexcept;
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	識別タグのヒストグラムを取得する（無い場合は作成する）
+     *
+     * 保持しておけば検索無しで記録できる（ remove するまで有効）
+     * 記録する値はナノ秒
+     * @param	tag			識別タグ
+     */
+    [[nodiscard]] Histogram& histogram(std::string_view tag);
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	統計値を取得する（単位はマイクロ秒）
+     * @param	tag			識別タグ
+     * @param	window		対象のウィンドウ
+     * @return	統計値（識別タグが無い場合は count_ が 0 ）
+     */
+    [[nodiscard]] HistogramStats stats(std::string_view tag, Window window = Window::Previous) const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	フレームを進める（ウィンドウのフレーム数に達したらすべてのヒストグラムを切り替える）
+     */
+    void advanceFrame() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	すべてのヒストグラムのウィンドウを切り替える
+     */
+    void rotate() noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	ウィンドウを切り替えるフレーム数を設定する
+     * @param	frameNum	フレーム数（ 0 の場合は自動で切り替えない）
+     */
+    void setWindowFrameNum(uint32_t frameNum) noexcept;
+
     //---------------------------------------------------------------------------------
     /**
      * @brief	計測対象の削除
+     *
+     * 取得済みのヒストグラムは無効になるので、フレームを区切るスレッド（ markFrame ）から呼び出すこと
      * @param	tag			識別タグ
      */
     void remove(std::string_view tag) noexcept;
 
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	世代番号を取得する
+     *
+     * remove でヒストグラムを破棄するたびに変わるので、取得済みのヒストグラムを保持する側が破棄を検出するのに使う
+     */
+    [[nodiscard]] uint64_t generation() const noexcept {
+        return generation_.load(std::memory_order_acquire);
+    }
+
     //---------------------------------------------------------------------------------
     /**
      * @brief	計測結果の表示
@@ -87,7 +136,28 @@ private:
     TimeContainer();
 
 private:
-    std::unordered_map<std::string, Data> container_;  ///< 識別タグと計測時間のコンテナ
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	識別タグのヒストグラムを検索する
+     * @return	ヒストグラム（無い場合は nullptr ）
+     */
+    Histogram* find(std::string_view tag) const noexcept;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	統計値を表示する
+     */
+    void print(const std::string& tag, const Histogram& histogram) const noexcept;
+
+private:
+    // 識別タグは string_view のまま検索する（ std::string は追加時のみ作成する）
+    using Container = FlatMap<std::string, std::unique_ptr<Histogram>>;
+
+    mutable std::shared_mutex mutex_{};                                ///< コンテナの同期オブジェクト
+    Container                 container_{};                            ///< 識別タグとヒストグラムのコンテナ
+    std::atomic<uint32_t>     windowFrameNum_{defaultWindowFrameNum};  ///< ウィンドウを切り替えるフレーム数
+    std::atomic<uint64_t>     generation_{};                           ///< remove のたびに進める世代番号
+    uint32_t                  frameCount_{};                           ///< 現在のウィンドウのフレーム数
 };
 }  // namespace utility
 
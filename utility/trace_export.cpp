@@ -0,0 +1,484 @@
+﻿#include "trace_export.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace {
+constexpr uint64_t processUuid = 1;        ///< プロセスのトラック ID
+constexpr uint64_t frameUuid   = 2;        ///< フレームのトラック ID
+constexpr uint64_t threadUuid  = 0x100;    ///< スレッドのトラック ID の基準値
+constexpr uint64_t counterUuid = 0x10000;  ///< カウンタのトラック ID の基準値
+constexpr uint32_t sequenceId  = 1;        ///< パケットのシーケンス ID
+constexpr uint32_t processId   = 1;        ///< 出力するプロセス ID
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 出力するスコープ
+ */
+struct TraceScope {
+    const char* name_{};    ///< 名前
+    uint64_t    start_{};   ///< 開始時刻（ティック）
+    uint64_t    end_{};     ///< 終了時刻（ティック）
+    uint16_t    depth_{};   ///< 階層の深さ
+    uint16_t    thread_{};  ///< スレッドインデックス
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	出力するスコープを抽出する
+ *
+ * フレームをまたぐスコープは次のフレームにも同じ開始時刻で格納されているので、
+ * 打ち切られたものは最後のフレームのものだけを出力する
+ * スレッドごとに開始時刻順（同時刻の場合は親が先）に並べる
+ */
+std::vector<TraceScope> gatherScopes(const utility::TraceData& data) {
+    std::vector<TraceScope> scopes;
+    for (size_t i = 0; i < data.frames_.size(); i++) {
+        const bool last = (i + 1 == data.frames_.size());
+        for (const auto& scope : data.frames_[i].scopes_) {
+            if (!scope.clipped_ || last) {
+                scopes.push_back({scope.name_, scope.start_, scope.end_, scope.depth_, scope.thread_});
+            }
+        }
+    }
+
+    std::stable_sort(scopes.begin(), scopes.end(), [](const TraceScope& a, const TraceScope& b) {
+        if (a.thread_ != b.thread_) {
+            return a.thread_ < b.thread_;
+        }
+        if (a.start_ != b.start_) {
+            return a.start_ < b.start_;
+        }
+        return a.depth_ < b.depth_;
+    });
+    return scopes;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	時刻の基準（最も古い時刻）を求める
+ */
+uint64_t baseTick(const utility::TraceData& data, const std::vector<TraceScope>& scopes) noexcept {
+    uint64_t base = data.frames_.empty() ? 0 : data.frames_.front().start_;
+    for (const auto& scope : scopes) {
+        base = std::min(base, scope.start_);
+    }
+    return base;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	スレッド名を取得する（未登録の場合は番号から生成する）
+ */
+std::string threadName(const utility::TraceData& data, uint32_t index) {
+    if (index < data.threadNames_.size() && !data.threadNames_[index].empty()) {
+        return data.threadNames_[index];
+    }
+    return "Thread " + std::to_string(index);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	出力するスレッド数を求める（スコープやカウンタに現れるものも含める）
+ */
+uint32_t threadCount(const utility::TraceData& data) noexcept {
+    auto num = static_cast<uint32_t>(data.threadNames_.size());
+    for (const auto& frame : data.frames_) {
+        for (const auto& scope : frame.scopes_) {
+            num = std::max<uint32_t>(num, scope.thread_ + 1u);
+        }
+        for (const auto& counter : frame.counters_) {
+            num = std::max<uint32_t>(num, counter.thread_ + 1u);
+        }
+    }
+    return num;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	JSON の文字列として追加する
+ */
+void appendJsonString(std::string& out, std::string_view str) {
+    out += '"';
+    for (const auto c : str) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+                break;
+        }
+    }
+    out += '"';
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	書式付きで追加する
+ */
+template <class... Args>
+void appendFormat(std::string& out, const char* format, Args... args) {
+    char buf[256];
+    const auto len = snprintf(buf, sizeof(buf), format, args...);
+    out.append(buf, static_cast<size_t>(std::clamp(len, 0, static_cast<int>(sizeof(buf) - 1))));
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	protobuf の可変長整数を追加する
+ */
+void appendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	protobuf の整数フィールドを追加する
+ */
+void appendUint(std::string& out, uint32_t field, uint64_t value) {
+    appendVarint(out, (static_cast<uint64_t>(field) << 3) | 0);
+    appendVarint(out, value);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	protobuf の double フィールドを追加する
+ */
+void appendDouble(std::string& out, uint32_t field, double value) {
+    appendVarint(out, (static_cast<uint64_t>(field) << 3) | 1);
+
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; i++) {
+        out += static_cast<char>((bits >> (i * 8)) & 0xff);
+    }
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	protobuf の長さ付きフィールド（文字列、入れ子のメッセージ）を追加する
+ */
+void appendBytes(std::string& out, uint32_t field, std::string_view bytes) {
+    appendVarint(out, (static_cast<uint64_t>(field) << 3) | 2);
+    appendVarint(out, bytes.size());
+    out.append(bytes);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	Perfetto のフィールド番号
+ */
+namespace field {
+constexpr uint32_t tracePacket = 1;  ///< Trace.packet
+
+constexpr uint32_t packetTimestamp  = 8;   ///< TracePacket.timestamp
+constexpr uint32_t packetSequenceId = 10;  ///< TracePacket.trusted_packet_sequence_id
+constexpr uint32_t packetTrackEvent = 11;  ///< TracePacket.track_event
+constexpr uint32_t packetDescriptor = 60;  ///< TracePacket.track_descriptor
+
+constexpr uint32_t descriptorUuid    = 1;  ///< TrackDescriptor.uuid
+constexpr uint32_t descriptorName    = 2;  ///< TrackDescriptor.name
+constexpr uint32_t descriptorProcess = 3;  ///< TrackDescriptor.process
+constexpr uint32_t descriptorThread  = 4;  ///< TrackDescriptor.thread
+constexpr uint32_t descriptorParent  = 5;  ///< TrackDescriptor.parent_uuid
+constexpr uint32_t descriptorCounter = 8;  ///< TrackDescriptor.counter
+
+constexpr uint32_t processPid  = 1;  ///< ProcessDescriptor.pid
+constexpr uint32_t processName = 6;  ///< ProcessDescriptor.process_name
+
+constexpr uint32_t threadPid  = 1;  ///< ThreadDescriptor.pid
+constexpr uint32_t threadTid  = 2;  ///< ThreadDescriptor.tid
+constexpr uint32_t threadName = 5;  ///< ThreadDescriptor.thread_name
+
+constexpr uint32_t eventType         = 9;   ///< TrackEvent.type
+constexpr uint32_t eventTrackUuid    = 11;  ///< TrackEvent.track_uuid
+constexpr uint32_t eventName         = 23;  ///< TrackEvent.name
+constexpr uint32_t eventCounterValue = 44;  ///< TrackEvent.double_counter_value
+}  // namespace field
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	Perfetto のイベントの種類（ TrackEvent.Type ）
+ */
+enum class EventType : uint8_t {
+    SliceBegin = 1,
+    SliceEnd   = 2,
+    Instant    = 3,
+    Counter    = 4,
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	トラック定義のパケットを追加する
+ * @param	out			出力先
+ * @param	descriptor	TrackDescriptor のエンコード結果
+ */
+void appendDescriptorPacket(std::string& out, const std::string& descriptor) {
+    std::string packet;
+    appendUint(packet, field::packetSequenceId, sequenceId);
+    appendBytes(packet, field::packetDescriptor, descriptor);
+    appendBytes(out, field::tracePacket, packet);
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	イベントのパケットを追加する
+ * @param	out			出力先
+ * @param	timestamp	時刻（ナノ秒）
+ * @param	track		トラック ID
+ * @param	type		イベントの種類
+ * @param	name		名前（不要な場合は nullptr ）
+ * @param	value		カウンタの値
+ */
+void appendEventPacket(std::string& out, uint64_t timestamp, uint64_t track, EventType type, const char* name, double value = 0.0) {
+    std::string event;
+    appendUint(event, field::eventType, static_cast<uint64_t>(type));
+    appendUint(event, field::eventTrackUuid, track);
+    if (name) {
+        appendBytes(event, field::eventName, name);
+    }
+    if (type == EventType::Counter) {
+        appendDouble(event, field::eventCounterValue, value);
+    }
+
+    std::string packet;
+    appendUint(packet, field::packetTimestamp, timestamp);
+    appendUint(packet, field::packetSequenceId, sequenceId);
+    appendBytes(packet, field::packetTrackEvent, event);
+    appendBytes(out, field::tracePacket, packet);
+}
+}  // namespace
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	Chrome Trace Event 形式に変換する
+ * @param	data		トレースデータ
+ * @return	JSON 文字列
+ */
+std::string toChromeJson(const TraceData& data) {
+    const auto scopes     = gatherScopes(data);
+    const auto base       = baseTick(data, scopes);
+    const auto threadNum  = threadCount(data);
+    const auto frameTid   = threadNum;  // フレーム区切りは専用のスレッド行に出力する
+    const auto toMicrosec = [&](uint64_t tick) {
+        return static_cast<double>(tick - base) * data.microsecPerTick_;
+    };
+
+    std::string out;
+    out.reserve(128 + scopes.size() * 96);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    auto next  = [&]() {
+        if (!first) {
+            out += ",\n";
+        }
+        first = false;
+    };
+
+    // スレッド名
+    for (uint32_t i = 0; i <= threadNum; i++) {
+        next();
+        appendFormat(out, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":", processId, i);
+        appendJsonString(out, (i == frameTid) ? std::string("Frames") : threadName(data, i));
+        out += "}}";
+
+        next();
+        appendFormat(out, "{\"ph\":\"M\",\"name\":\"thread_sort_index\",\"pid\":%u,\"tid\":%u,\"args\":{\"sort_index\":%d}}", processId, i, (i == frameTid) ? -1 : static_cast<int>(i));
+    }
+
+    // フレーム
+    for (const auto& frame : data.frames_) {
+        next();
+        appendFormat(out, "{\"ph\":\"X\",\"cat\":\"frame\",\"name\":\"Frame %llu\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"dropped\":%u}}",
+                     static_cast<unsigned long long>(frame.index_), processId, frameTid, toMicrosec(frame.start_), toMicrosec(frame.end_) - toMicrosec(frame.start_), frame.dropped_);
+        next();
+        appendFormat(out, "{\"ph\":\"i\",\"s\":\"g\",\"name\":\"Frame\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f}", processId, frameTid, toMicrosec(frame.start_));
+    }
+
+    // スコープ
+    for (const auto& scope : scopes) {
+        next();
+        out += "{\"ph\":\"X\",\"name\":";
+        appendJsonString(out, scope.name_ ? scope.name_ : "(unknown)");
+        appendFormat(out, ",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", processId, static_cast<uint32_t>(scope.thread_), toMicrosec(scope.start_), toMicrosec(scope.end_) - toMicrosec(scope.start_));
+    }
+
+    // カウンタ
+    for (const auto& frame : data.frames_) {
+        for (const auto& counter : frame.counters_) {
+            next();
+            out += "{\"ph\":\"C\",\"name\":";
+            appendJsonString(out, counter.name_ ? counter.name_ : "(unknown)");
+            appendFormat(out, ",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%.17g}}", processId, static_cast<uint32_t>(counter.thread_), toMicrosec(counter.time_), counter.value_);
+        }
+    }
+
+    out += "\n]}\n";
+    return out;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	Perfetto 形式に変換する
+ * @param	data		トレースデータ
+ * @return	protobuf でエンコードしたバイト列
+ */
+std::string toPerfetto(const TraceData& data) {
+    const auto scopes    = gatherScopes(data);
+    const auto base      = baseTick(data, scopes);
+    const auto threadNum = threadCount(data);
+    const auto toNanosec = [&](uint64_t tick) {
+        return static_cast<uint64_t>(static_cast<double>(tick - base) * data.microsecPerTick_ * 1000.0);
+    };
+
+    std::string out;
+    out.reserve(256 + scopes.size() * 64);
+
+    // プロセス
+    {
+        std::string process;
+        appendUint(process, field::processPid, processId);
+        appendBytes(process, field::processName, "engine");
+
+        std::string descriptor;
+        appendUint(descriptor, field::descriptorUuid, processUuid);
+        appendBytes(descriptor, field::descriptorProcess, process);
+        appendDescriptorPacket(out, descriptor);
+    }
+
+    // フレーム
+    {
+        std::string descriptor;
+        appendUint(descriptor, field::descriptorUuid, frameUuid);
+        appendBytes(descriptor, field::descriptorName, "Frames");
+        appendUint(descriptor, field::descriptorParent, processUuid);
+        appendDescriptorPacket(out, descriptor);
+    }
+
+    // スレッド
+    for (uint32_t i = 0; i < threadNum; i++) {
+        std::string thread;
+        appendUint(thread, field::threadPid, processId);
+        appendUint(thread, field::threadTid, i + 1);
+        appendBytes(thread, field::threadName, threadName(data, i));
+
+        std::string descriptor;
+        appendUint(descriptor, field::descriptorUuid, threadUuid + i);
+        appendUint(descriptor, field::descriptorParent, processUuid);
+        appendBytes(descriptor, field::descriptorThread, thread);
+        appendDescriptorPacket(out, descriptor);
+    }
+
+    // カウンタ（名前ごとに 1 つのトラックにまとめる）
+    std::unordered_map<std::string_view, uint64_t> counterTracks;
+    for (const auto& frame : data.frames_) {
+        for (const auto& counter : frame.counters_) {
+            const std::string_view name = counter.name_ ? counter.name_ : "(unknown)";
+            if (counterTracks.contains(name)) {
+                continue;
+            }
+            const auto uuid     = counterUuid + counterTracks.size();
+            counterTracks[name] = uuid;
+
+            std::string descriptor;
+            appendUint(descriptor, field::descriptorUuid, uuid);
+            appendBytes(descriptor, field::descriptorName, name);
+            appendUint(descriptor, field::descriptorParent, processUuid);
+            appendBytes(descriptor, field::descriptorCounter, {});
+            appendDescriptorPacket(out, descriptor);
+        }
+    }
+
+    for (const auto& frame : data.frames_) {
+        const auto name = "Frame " + std::to_string(frame.index_);
+        appendEventPacket(out, toNanosec(frame.start_), frameUuid, EventType::SliceBegin, name.c_str());
+        appendEventPacket(out, toNanosec(frame.end_), frameUuid, EventType::SliceEnd, nullptr);
+    }
+
+    // スコープは階層が崩れないように、深さを見ながら開始と終了を交互に出力する
+    std::vector<const TraceScope*> stack;
+    const auto                     closeTo = [&](size_t depth) {
+        while (stack.size() > depth) {
+            const auto* open = stack.back();
+            appendEventPacket(out, toNanosec(open->end_), threadUuid + open->thread_, EventType::SliceEnd, nullptr);
+            stack.pop_back();
+        }
+    };
+    for (size_t i = 0; i < scopes.size(); i++) {
+        const auto& scope = scopes[i];
+        if (i > 0 && scopes[i - 1].thread_ != scope.thread_) {
+            closeTo(0);
+        }
+        closeTo(std::min<size_t>(scope.depth_, stack.size()));
+        appendEventPacket(out, toNanosec(scope.start_), threadUuid + scope.thread_, EventType::SliceBegin, scope.name_ ? scope.name_ : "(unknown)");
+        stack.push_back(&scope);
+    }
+    closeTo(0);
+
+    for (const auto& frame : data.frames_) {
+        for (const auto& counter : frame.counters_) {
+            const std::string_view name = counter.name_ ? counter.name_ : "(unknown)";
+            appendEventPacket(out, toNanosec(counter.time_), counterTracks[name], EventType::Counter, nullptr, counter.value_);
+        }
+    }
+
+    return out;
+}
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	トレースをファイルに出力する
+ * @param	path		出力先のファイルパス
+ * @param	data		トレースデータ
+ * @param	format		出力形式
+ * @return	出力に成功した場合は true
+ */
+bool writeTrace(const std::filesystem::path& path, const TraceData& data, TraceFormat format) noexcept {
+    try {
+        const auto bytes = (format == TraceFormat::ChromeJson) ? toChromeJson(data) : toPerfetto(data);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            TRACE("トレースファイルを開けません : %s", path.string().c_str());
+            return false;
+        }
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            TRACE("トレースファイルの書き込みに失敗しました : %s", path.string().c_str());
+            return false;
+        }
+    } catch (const std::exception& e) {
+        TRACE("トレースの出力に失敗しました : %s", e.what());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace utility
@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include "utility/profiler.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	トレースの出力形式
+ */
+enum class TraceFormat : uint8_t {
+    ChromeJson,  ///< Chrome Trace Event 形式（ JSON ）
+    Perfetto,    ///< Perfetto 形式（ protobuf ）
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * 出力するトレースデータ
+ */
+struct TraceData {
+    std::vector<ProfileFrame> frames_{};           ///< キャプチャしたフレーム
+    std::vector<std::string>  threadNames_{};      ///< スレッド名（スレッドインデックス順）
+    double                    microsecPerTick_{};  ///< 1 ティックあたりのマイクロ秒
+};
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	Chrome Trace Event 形式に変換する
+ * @param	data		トレースデータ
+ * @return	JSON 文字列
+ */
+[[nodiscard]] std::string toChromeJson(const TraceData& data);
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	Perfetto 形式に変換する
+ * @param	data		トレースデータ
+ * @return	protobuf でエンコードしたバイト列
+ */
+[[nodiscard]] std::string toPerfetto(const TraceData& data);
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief	トレースをファイルに出力する
+ * @param	path		出力先のファイルパス
+ * @param	data		トレースデータ
+ * @param	format		出力形式
+ * @return	出力に成功した場合は true
+ */
+bool writeTrace(const std::filesystem::path& path, const TraceData& data, TraceFormat format) noexcept;
+
+}  // namespace utility
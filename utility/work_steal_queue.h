@@ -0,0 +1,121 @@
+﻿#pragma once
+
+#include <atomic>
+
+#include "utility/noncopyable.h"
+
+namespace utility {
+
+//---------------------------------------------------------------------------------
+/**
+ * @brief
+ * ワークスティーリング用の両端キュー（ Chase-Lev ）
+ *
+ * push / pop は所有スレッドのみ、steal は任意のスレッドから呼び出せる
+ * 所有スレッドは末尾（ LIFO ）から、他スレッドは先頭（ FIFO ）から取り出す
+ */
+template <class T, uint32_t Capacity>
+class WorkStealQueue final : Noncopyable {
+    static_assert(std::is_pointer_v<T>, "ポインタ型のみ格納できます");
+    static_assert((Capacity & (Capacity - 1)) == 0, "容量は 2 のべき乗にしてください");
+
+private:
+    static constexpr int64_t mask = Capacity - 1;
+
+public:
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	コンストラクタ
+     */
+    WorkStealQueue() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	デストラクタ
+     */
+    ~WorkStealQueue() = default;
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	末尾に追加する（所有スレッドのみ）
+     * @param	item		追加する要素
+     * @return	キューが満杯の場合は false
+     */
+    bool push(T item) noexcept {
+        const auto b = bottom_.load(std::memory_order_relaxed);
+        const auto t = top_.load(std::memory_order_acquire);
+        if (b - t >= static_cast<int64_t>(Capacity)) {
+            return false;
+        }
+
+        // 盗む側は bottom_ の acquire で要素の中身まで見えるようになる
+        buffer_[b & mask].store(item, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	末尾から取り出す（所有スレッドのみ）
+     * @return	取り出した要素（空の場合は nullptr ）
+     */
+    T pop() noexcept {
+        const auto b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = top_.load(std::memory_order_relaxed);
+
+        if (b < t) {
+            // 空なので元に戻す
+            bottom_.store(b + 1, std::memory_order_release);
+            return nullptr;
+        }
+
+        T item = buffer_[b & mask].load(std::memory_order_relaxed);
+        if (t == b) {
+            // 最後の 1 要素は steal と競合するので CAS で取り合う
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_release);
+        }
+        return item;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	先頭から盗む（任意のスレッド）
+     * @return	取り出した要素（空または競合に負けた場合は nullptr ）
+     */
+    T steal() noexcept {
+        auto t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto b = bottom_.load(std::memory_order_acquire);
+
+        if (b <= t) {
+            return nullptr;
+        }
+
+        T item = buffer_[t & mask].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    //---------------------------------------------------------------------------------
+    /**
+     * @brief	おおよその要素数を取得する
+     */
+    [[nodiscard]] uint32_t size() const noexcept {
+        const auto b = bottom_.load(std::memory_order_relaxed);
+        const auto t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<uint32_t>(b - t) : 0;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top_{};               ///< 先頭（ steal 側）
+    alignas(64) std::atomic<int64_t> bottom_{};            ///< 末尾（所有スレッド側）
+    alignas(64) std::atomic<T>       buffer_[Capacity]{};  ///< 要素のリングバッファ
+};
+}  // namespace utility
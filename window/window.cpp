@@ -2,6 +2,8 @@
 #include "utility/thread.h"
 #include "input/input.h"
 
+#include <windowsx.h>
+
 #include "../imgui/imgui_impl_win32.h"
 
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -33,6 +35,85 @@ LRESULT CALLBACK wndProc(HWND windouHandle, UINT msg, WPARAM wParam, LPARAM lPar
     return Window::instance().msgProc(windouHandle, msg, wParam, lParam);
 }
 
+//---------------------------------------------------------------------------------
+/**
+ * @brief	ウィンドウメッセージを入力イベントに変換する
+ * @param	msg			メッセージ
+ * @param	wParam		メッセージのパラメータ
+ * @param	lParam		メッセージのパラメータ
+ * @param	event		変換したイベントの格納先
+ * @return	入力イベントに変換した場合は true
+ */
+bool toInputEvent(UINT msg, WPARAM wParam, LPARAM lParam, input::Event& event) noexcept {
+    using input::EventType;
+    using input::MouseButton;
+
+    const auto mouseButton = [&event, lParam](EventType type, MouseButton button) {
+        event.type_ = type;
+        event.code_ = static_cast<uint16_t>(button);
+        event.x_    = GET_X_LPARAM(lParam);
+        event.y_    = GET_Y_LPARAM(lParam);
+    };
+
+    switch (msg) {
+        case WM_KEYDOWN:
+        case WM_SYSKEYDOWN:
+            // キーリピートは押下済みなので無視する
+            if (lParam & (1 << 30)) {
+                return false;
+            }
+            event.type_ = EventType::KeyDown;
+            event.code_ = static_cast<uint16_t>(wParam);
+            break;
+        case WM_KEYUP:
+        case WM_SYSKEYUP:
+            event.type_ = EventType::KeyUp;
+            event.code_ = static_cast<uint16_t>(wParam);
+            break;
+        case WM_MOUSEMOVE:
+            event.type_ = EventType::MouseMove;
+            event.x_    = GET_X_LPARAM(lParam);
+            event.y_    = GET_Y_LPARAM(lParam);
+            break;
+        case WM_LBUTTONDOWN:
+            mouseButton(EventType::MouseButtonDown, MouseButton::Left);
+            break;
+        case WM_LBUTTONUP:
+            mouseButton(EventType::MouseButtonUp, MouseButton::Left);
+            break;
+        case WM_RBUTTONDOWN:
+            mouseButton(EventType::MouseButtonDown, MouseButton::Right);
+            break;
+        case WM_RBUTTONUP:
+            mouseButton(EventType::MouseButtonUp, MouseButton::Right);
+            break;
+        case WM_MBUTTONDOWN:
+            mouseButton(EventType::MouseButtonDown, MouseButton::Middle);
+            break;
+        case WM_MBUTTONUP:
+            mouseButton(EventType::MouseButtonUp, MouseButton::Middle);
+            break;
+        case WM_XBUTTONDOWN:
+            mouseButton(EventType::MouseButtonDown, GET_XBUTTON_WPARAM(wParam) == XBUTTON1 ? MouseButton::X1 : MouseButton::X2);
+            break;
+        case WM_XBUTTONUP:
+            mouseButton(EventType::MouseButtonUp, GET_XBUTTON_WPARAM(wParam) == XBUTTON1 ? MouseButton::X1 : MouseButton::X2);
+            break;
+        case WM_MOUSEWHEEL:
+            event.type_ = EventType::MouseWheel;
+            event.y_    = GET_WHEEL_DELTA_WPARAM(wParam);
+            break;
+        case WM_KILLFOCUS:
+            event.type_ = EventType::FocusLost;
+            break;
+        default:
+            return false;
+    }
+
+    event.time_ = input::eventTime();
+    return true;
+}
+
 }  // namespace
 
 //---------------------------------------------------------------------------------
@@ -68,11 +149,10 @@ public:
     };
 
 public:
-    HWND            windowHandle_;   ///< ウィンドウハンドル
-    HANDLE          createdEvent_;   ///< 生成イベントシグナル
-    uint8_t         status_;         ///< 現在のステータス
-    byte            keyState_[256];  ///< キー入力情報
-    utility::Thread thread_;         ///< ウィンドウ制御スレッド
+    HWND            windowHandle_;  ///< ウィンドウハンドル
+    HANDLE          createdEvent_;  ///< 生成イベントシグナル
+    uint8_t         status_;        ///< 現在のステータス
+    utility::Thread thread_;        ///< ウィンドウ制御スレッド
 
 public:
     Impl()
@@ -141,20 +221,19 @@ public:
      * @param	instance	インスタンスハンドルのポインタ
      */
     void worker(HINSTANCE* instance) {
-        // メッセージループ
+        if (FAILED(create(*instance, windowWidth, windowHeight, appName))) {
+            ASSERT(false, "ウィンドウ作成に失敗");
+            status_ = END;
+            SetEvent(createdEvent_);
+            return;
+        }
+
+        // メッセージループ（メッセージが届くまでスレッドは休止する）
+        // 入力はウィンドウプロシージャでイベントとして入力管理へ送られる
         MSG msg = {};
-        while (msg.message != WM_QUIT) {
-            if (Impl::INITIALIZE == status_) {
-                create(*instance, windowWidth, windowHeight, appName);
-            } else if (Impl::WORK == status_) {
-                if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
-                    TranslateMessage(&msg);
-                    DispatchMessage(&msg);
-                }
-
-                GetKeyboardState(keyState_);
-                input::Input::instance().updateKeyState(keyState_);
-            }
+        while (GetMessage(&msg, NULL, 0, 0) > 0) {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
         }
 
         status_ = END;
@@ -183,6 +262,11 @@ Window::~Window() {
  * @brief	ウィンドウプロシージャ
  */
 LRESULT Window::msgProc(HWND handle, UINT msg, WPARAM wParam, LPARAM lParam) {
+    input::Event event{};
+    if (toInputEvent(msg, wParam, lParam, event)) {
+        input::Input::instance().pushEvent(event);
+    }
+
     if (ImGui_ImplWin32_WndProcHandler(handle, msg, wParam, lParam)) {
         return true;
     }